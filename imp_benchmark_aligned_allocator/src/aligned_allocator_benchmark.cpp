@@ -25,11 +25,62 @@
 #include <cstdint>
 #include <iostream>
 #include <stdlib.h>
+#include <gflags/gflags.h>
 #include <ze/common/logging.hpp>
 #include <ze/common/timer.hpp>
 #include <ze/common/timer_statistics.hpp>
+#include <imp/core/allocation_policy.hpp>
 #include <imp/core/image_raw.hpp>
 
+DEFINE_int32(filter_width, 4000, "Width of the images of the filtering benchmark.");
+DEFINE_int32(filter_height, 3000, "Height of the images of the filtering benchmark.");
+DEFINE_int32(filter_rounds, 20, "Rounds of the filtering benchmark.");
+DEFINE_int32(numa_node, 0, "NUMA node for the bound allocation policy.");
+
+namespace {
+
+//! 3x3 box filter, a typical memory-bound image operation. The image is
+//! allocated and initialized inside the timed scope, such that page faults and
+//! placement of fresh memory are part of the measurement like for real frames.
+double filterThroughput(const ze::AllocationPolicy& policy)
+{
+  using namespace ze;
+  const Size2u size(FLAGS_filter_width, FLAGS_filter_height);
+  TimerStatistics timer;
+  for (int round = 0; round < FLAGS_filter_rounds; ++round)
+  {
+    __attribute__((unused)) auto t = timer.timeScope();
+    ImageRaw32fC1 src(size, policy);
+    ImageRaw32fC1 dst(size, policy);
+    const ImageView<Pixel32fC1> src_view = src.view();
+    const ImageView<Pixel32fC1> dst_view = dst.view();
+    for (uint32_t y = 0u; y < size.height(); ++y)
+    {
+      Pixel32fC1* row = src_view.row(y);
+      for (uint32_t x = 0u; x < size.width(); ++x)
+      {
+        row[x] = static_cast<float>((x + y) & 255u);
+      }
+    }
+    for (uint32_t y = 1u; y + 1u < size.height(); ++y)
+    {
+      const Pixel32fC1* r0 = src_view.row(y - 1u);
+      const Pixel32fC1* r1 = src_view.row(y);
+      const Pixel32fC1* r2 = src_view.row(y + 1u);
+      Pixel32fC1* out = dst_view.row(y);
+      for (uint32_t x = 1u; x + 1u < size.width(); ++x)
+      {
+        out[x] = (r0[x-1] + r0[x] + r0[x+1] + r1[x-1] + r1[x] + r1[x+1]
+                  + r2[x-1] + r2[x] + r2[x+1]) * (1.0f / 9.0f);
+      }
+    }
+  }
+  // Megapixels per second.
+  return size.area() * 1e-3 / timer.mean();
+}
+
+} // anonymous namespace
+
 int main(int argc, char* argv[])
 {
   google::InitGoogleLogging(argv[0]);
@@ -68,4 +119,22 @@ int main(int argc, char* argv[])
     VLOG(1) << "posix_memalign: " << timer.mean() << "ms";
   }
 
+  {
+    ze::AllocationPolicy huge_pages;
+    huge_pages.huge_pages = ze::HugePages::Transparent;
+    ze::AllocationPolicy explicit_huge_pages;
+    explicit_huge_pages.huge_pages = ze::HugePages::Explicit;
+    ze::AllocationPolicy numa_bound;
+    numa_bound.numa_node = FLAGS_numa_node;
+    ze::AllocationPolicy numa_bound_huge_pages = huge_pages;
+    numa_bound_huge_pages.numa_node = FLAGS_numa_node;
+
+    VLOG(1) << "3x3 box filter on " << FLAGS_filter_width << "x"
+            << FLAGS_filter_height << " 32fC1 images [MPixel/s]:";
+    VLOG(1) << "posix_memalign:          " << filterThroughput(ze::AllocationPolicy());
+    VLOG(1) << "transparent huge pages:  " << filterThroughput(huge_pages);
+    VLOG(1) << "explicit huge pages:     " << filterThroughput(explicit_huge_pages);
+    VLOG(1) << "NUMA bound:              " << filterThroughput(numa_bound);
+    VLOG(1) << "NUMA bound, huge pages:  " << filterThroughput(numa_bound_huge_pages);
+  }
 }
@@ -0,0 +1,145 @@
+// Copyright (c) 2015-2016, ETH Zurich, Wyss Zurich, Zurich Eye
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the ETH Zurich, Wyss Zurich, Zurich Eye nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL ETH Zurich, Wyss Zurich, Zurich Eye BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <gflags/gflags.h>
+#include <imp/bridge/opencv/cv_bridge.hpp>
+#include <imp/core/image_pool.hpp>
+#include <imp/io/image_decoder.hpp>
+#include <ze/common/logging.hpp>
+#include <ze/common/path_utils.hpp>
+#include <ze/common/timer_statistics.hpp>
+
+DEFINE_string(image, "", "Image to decode, a synthetic image is written if empty.");
+DEFINE_string(output_dir, "/tmp", "Directory for the synthetic images.");
+DEFINE_int32(width, 1280, "Width of the synthetic images.");
+DEFINE_int32(height, 960, "Height of the synthetic images.");
+DEFINE_int32(rounds, 50, "Decoded images per measurement.");
+
+namespace {
+
+//! Writes a smooth image with noise, which compresses like a camera frame.
+void writeSyntheticImages(const std::string& png_gray, const std::string& png_color,
+                          const std::string& pgm)
+{
+  cv::Mat color(FLAGS_height, FLAGS_width, CV_8UC3);
+  cv::randn(color, cv::Scalar::all(0.0), cv::Scalar::all(8.0));
+  for (int y = 0; y < color.rows; ++y)
+  {
+    for (int x = 0; x < color.cols; ++x)
+    {
+      cv::Vec3b& px = color.at<cv::Vec3b>(y, x);
+      px[0] = cv::saturate_cast<uint8_t>(px[0] + (x * 255) / color.cols);
+      px[1] = cv::saturate_cast<uint8_t>(px[1] + (y * 255) / color.rows);
+      px[2] = cv::saturate_cast<uint8_t>(px[2] + ((x + y) & 255));
+    }
+  }
+  cv::Mat gray;
+  cv::cvtColor(color, gray, CV_BGR2GRAY);
+  CHECK(cv::imwrite(png_gray, gray));
+  CHECK(cv::imwrite(png_color, color));
+  CHECK(cv::imwrite(pgm, gray));
+}
+
+//! Decoding throughput in megapixels per second (mean, best).
+void measure(const std::string& label, const std::string& filename,
+             const std::function<void()>& decode)
+{
+  const ze::ImageFileInfo info = ze::readImageFileInfo(filename);
+  decode();
+  ze::TimerStatistics timer;
+  for (int round = 0; round < FLAGS_rounds; ++round)
+  {
+    __attribute__((unused)) auto t = timer.timeScope();
+    decode();
+  }
+  const double mpix = info.size.area() * 1e-3;
+  VLOG(1) << label << ": " << mpix / timer.mean() << " MPixel/s (best "
+          << mpix / timer.min() << ")";
+}
+
+void benchmark(const std::string& filename)
+{
+  using namespace ze;
+  VLOG(1) << "Decoding " << filename << ":";
+  measure("  cvBridgeLoad ImageCv 8uC1        ", filename, [&]()
+  {
+    ImageCv8uC1::Ptr img;
+    cvBridgeLoad(img, filename, PixelOrder::gray);
+  });
+  measure("  cvBridgeLoad ImageCv 32fC1       ", filename, [&]()
+  {
+    ImageCv32fC1::Ptr img;
+    cvBridgeLoad(img, filename, PixelOrder::gray);
+  });
+  measure("  cvBridgeLoad pooled ImageRaw 8uC1 ", filename, [&]()
+  {
+    ImageRaw8uC1::Ptr img;
+    cvBridgeLoad(img, filename, PixelOrder::gray);
+  });
+  measure("  cvBridgeLoad pooled ImageRaw 32fC1", filename, [&]()
+  {
+    ImageRaw32fC1::Ptr img;
+    cvBridgeLoad(img, filename, PixelOrder::gray);
+  });
+  measure("  loadImage 8uC1                   ", filename, [&]()
+  {
+    loadImage<Pixel8uC1>(filename, PixelOrder::gray);
+  });
+  measure("  loadImage 32fC1                  ", filename, [&]()
+  {
+    loadImage<Pixel32fC1>(filename, PixelOrder::gray);
+  });
+  measure("  loadImage 8uC3 bgr               ", filename, [&]()
+  {
+    loadImage<Pixel8uC3>(filename, PixelOrder::bgr);
+  });
+}
+
+} // anonymous namespace
+
+int main(int argc, char* argv[])
+{
+  google::InitGoogleLogging(argv[0]);
+  google::ParseCommandLineFlags(&argc, &argv, true);
+  google::InstallFailureSignalHandler();
+  FLAGS_alsologtostderr = true;
+  FLAGS_colorlogtostderr = true;
+
+  if (!FLAGS_image.empty())
+  {
+    benchmark(FLAGS_image);
+    return 0;
+  }
+
+  const std::string png_gray = ze::joinPath(FLAGS_output_dir, "decoding_benchmark_gray.png");
+  const std::string png_color = ze::joinPath(FLAGS_output_dir, "decoding_benchmark_color.png");
+  const std::string pgm = ze::joinPath(FLAGS_output_dir, "decoding_benchmark.pgm");
+  writeSyntheticImages(png_gray, png_color, pgm);
+  benchmark(png_gray);
+  benchmark(png_color);
+  benchmark(pgm);
+}
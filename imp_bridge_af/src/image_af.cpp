@@ -36,11 +36,13 @@ struct ImpAfConversionBuffer
   ImpAfConversionBuffer(const Image<Pixel>& from)
     : h_buff(from.numel())
   {
-    for (size_t y = 0; y < from.height(); ++y)
+    const ImageView<const Pixel> from_view = from.view();
+    for (uint32_t y = 0; y < from.height(); ++y)
     {
-      for (size_t x = 0; x < from.width(); ++x)
+      const Pixel* from_row = from_view.row(y);
+      for (uint32_t x = 0; x < from.width(); ++x)
       {
-        h_buff(x*from.height()+y) = from.pixel(x, y);  //! AF array is column-major
+        h_buff(x*from.height()+y) = from_row[x];  //! AF array is column-major
       }
     }
   }
@@ -24,12 +24,16 @@
 // SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #pragma once
 
+#include <fstream>
 #include <memory>
+#include <vector>
 #include <glog/logging.h>
 
 #include <opencv2/highgui/highgui.hpp>
 #include <opencv2/imgproc/imgproc.hpp>
+#include <imp/bridge/opencv/cv_connector_pixel_types.hpp>
 #include <imp/bridge/opencv/image_cv.hpp>
+#include <imp/core/image_pool.hpp>
 #include <ze/common/file_utils.hpp>
 
 namespace ze {
@@ -74,10 +78,95 @@ void cvBridgeLoad(ImageCvPtr<Pixel>& out,
     }
     mat.convertTo(out->cvMat(), CV_32F, 1./255.);
   break;
+#ifdef CV_16F
+  case PixelType::i16fC1:
+    out = std::make_shared<ImageCv<Pixel>>(mat.cols, mat.rows);
+    if (mat.channels() > 1)
+    {
+      cv::cvtColor(mat, mat, CV_BGR2GRAY);
+    }
+    mat.convertTo(out->cvMat(), CV_16F, 1./255.);
+  break;
+#endif
+  default:
+    CHECK(false) << "Conversion for reading given pixel_type not supported yet.";
+    break;
+  }
+}
+
+//------------------------------------------------------------------------------
+/**
+ * @brief cvBridgeLoad loads an image into a buffer taken from \a pool
+ *
+ * The file is decoded into a thread-local matrix, whose memory OpenCV reuses
+ * for equally sized images, and converted into the pooled buffer in one pass.
+ * Loading a sequence of frames therefore does not allocate pixel memory.
+ */
+template<typename Pixel>
+void cvBridgeLoad(std::shared_ptr<ImageRaw<Pixel>>& out,
+                  const std::string& filename, PixelOrder pixel_order,
+                  ImagePool& pool = ImagePool::global())
+{
+  CHECK(fileExists(filename)) << "File does not exist: " << filename;
+  static thread_local std::vector<uchar> file_buffer;
+  static thread_local cv::Mat decoded;
+  static thread_local cv::Mat gray;
+
+  std::ifstream fs(filename, std::ios::binary | std::ios::ate);
+  CHECK(fs.good()) << "Failed to open " << filename;
+  file_buffer.resize(static_cast<size_t>(fs.tellg()));
+  fs.seekg(0, std::ios::beg);
+  fs.read(reinterpret_cast<char*>(file_buffer.data()), file_buffer.size());
+
+  const int flags = (pixel_order == PixelOrder::gray)
+      ? CV_LOAD_IMAGE_GRAYSCALE : CV_LOAD_IMAGE_COLOR;
+  cv::imdecode(file_buffer, flags, &decoded);
+  CHECK(!decoded.empty()) << "Failed to decode " << filename;
+
+  out = pool.template acquire<Pixel>(Size2u(decoded.cols, decoded.rows), pixel_order);
+  cv::Mat dst(decoded.rows, decoded.cols, pixelTypeToCv(pixel_type<Pixel>::type),
+              out->data(), out->pitch());
+  switch(pixel_type<Pixel>::type)
+  {
+  case PixelType::i8uC1:
+    if (decoded.channels() > 1)
+    {
+      cv::cvtColor(decoded, dst, CV_BGR2GRAY);
+    }
+    else
+    {
+      decoded.copyTo(dst);
+    }
+  break;
+  case PixelType::i32fC1:
+    if (decoded.channels() > 1)
+    {
+      cv::cvtColor(decoded, gray, CV_BGR2GRAY);
+      gray.convertTo(dst, CV_32F, 1./255.);
+    }
+    else
+    {
+      decoded.convertTo(dst, CV_32F, 1./255.);
+    }
+  break;
+#ifdef CV_16F
+  case PixelType::i16fC1:
+    if (decoded.channels() > 1)
+    {
+      cv::cvtColor(decoded, gray, CV_BGR2GRAY);
+      gray.convertTo(dst, CV_16F, 1./255.);
+    }
+    else
+    {
+      decoded.convertTo(dst, CV_16F, 1./255.);
+    }
+  break;
+#endif
   default:
     CHECK(false) << "Conversion for reading given pixel_type not supported yet.";
     break;
   }
+  CHECK_EQ(static_cast<void*>(dst.data), static_cast<void*>(out->data()));
 }
 
 //------------------------------------------------------------------------------
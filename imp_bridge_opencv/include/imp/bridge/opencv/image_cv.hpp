@@ -78,8 +78,8 @@ public:
   virtual const Pixel* data(uint32_t ox = 0, uint32_t oy = 0) const override;
 
   /**
-   * @brief setValue Sets image data to the specified \a value.
-   * @param value Value to be set to the whole image data.
+   * @brief setValue Sets the pixels in the region of interest to the specified \a value.
+   * @param value Value to be set to the image data.
    */
   virtual void setValue(const Pixel& value) override;
 
@@ -110,6 +110,14 @@ typedef ImageCv<ze::Pixel32fC2> ImageCv32fC2;
 typedef ImageCv<ze::Pixel32fC3> ImageCv32fC3;
 typedef ImageCv<ze::Pixel32fC4> ImageCv32fC4;
 
+// Half-precision matrices require OpenCV 4 (CV_16F).
+#ifdef CV_16F
+typedef ImageCv<ze::Pixel16fC1> ImageCv16fC1;
+typedef ImageCv<ze::Pixel16fC2> ImageCv16fC2;
+typedef ImageCv<ze::Pixel16fC3> ImageCv16fC3;
+typedef ImageCv<ze::Pixel16fC4> ImageCv16fC4;
+#endif
+
 
 //typedef ImageCv<std::uint8_t, imp::PixelType::i8uC1> ImageCv8uC1;
 //typedef ImageCv<std::uint16_t, imp::PixelType::i8uC1> ImageCv16uC1;
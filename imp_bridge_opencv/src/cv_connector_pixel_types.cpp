@@ -52,6 +52,13 @@ ze::PixelType pixelTypeFromCv(int type)
   case CV_32FC3: return ze::PixelType::i32fC3;
   case CV_32FC4: return ze::PixelType::i32fC4;
   //
+#ifdef CV_16F
+  case CV_16FC1: return ze::PixelType::i16fC1;
+  case CV_16FC2: return ze::PixelType::i16fC2;
+  case CV_16FC3: return ze::PixelType::i16fC3;
+  case CV_16FC4: return ze::PixelType::i16fC4;
+  //
+#endif
   default: return ze::PixelType::undefined;
   }
 }
@@ -81,6 +88,13 @@ int pixelTypeToCv(ze::PixelType type)
   case ze::PixelType::i32fC3: return CV_32FC3;
   case ze::PixelType::i32fC4: return CV_32FC4;
   //
+#ifdef CV_16F
+  case ze::PixelType::i16fC1: return CV_16FC1;
+  case ze::PixelType::i16fC2: return CV_16FC2;
+  case ze::PixelType::i16fC3: return CV_16FC3;
+  case ze::PixelType::i16fC4: return CV_16FC4;
+  //
+#endif
   default: return 0;
   }
 }
@@ -70,7 +70,15 @@ ImageCv<Pixel>::ImageCv(const Image<Pixel>& from)
   this->header_.pitch = mat_.step;
   this->header_.memory_type = (MemoryStorage<Pixel>::isAligned(data())) ?
         MemoryType::CpuAligned : MemoryType::Cpu;
-  from.copyTo(*this);
+  // Copy all pixels, not only the region of interest.
+  if (from.isGpuMemory())
+  {
+    from.copyTo(*this);
+  }
+  else
+  {
+    copyView(from.view(), this->view());
+  }
 }
 
 //-----------------------------------------------------------------------------
@@ -93,18 +101,21 @@ ImageCv<Pixel>::ImageCv(cv::Mat mat, ze::PixelOrder pixel_order)
     case ze::PixelType::i8uC1:
     case ze::PixelType::i16uC1:
     case ze::PixelType::i32fC1:
+    case ze::PixelType::i16fC1:
     case ze::PixelType::i32sC1:
       this->header_.pixel_order = ze::PixelOrder::gray;
       break;
     case ze::PixelType::i8uC3:
     case ze::PixelType::i16uC3:
     case ze::PixelType::i32fC3:
+    case ze::PixelType::i16fC3:
     case ze::PixelType::i32sC3:
       this->header_.pixel_order = ze::PixelOrder::bgr;
       break;
     case ze::PixelType::i8uC4:
     case ze::PixelType::i16uC4:
     case ze::PixelType::i32fC4:
+    case ze::PixelType::i16fC4:
     case ze::PixelType::i32sC4:
       this->header_.pixel_order = ze::PixelOrder::bgra;
       break;
@@ -201,7 +212,9 @@ const Pixel* ImageCv<Pixel>::data(uint32_t ox, uint32_t oy) const
 template<typename Pixel>
 void ImageCv<Pixel>::setValue(const Pixel& value)
 {
-  mat_ = cv::Scalar::all(value);
+  const Roi2u roi = this->roi();
+  mat_(cv::Rect(roi.x(), roi.y(), roi.width(), roi.height())) =
+      cv::Scalar::all(static_cast<double>(value[0]));
 }
 
 
@@ -228,5 +241,12 @@ template class ImageCv<ze::Pixel32fC2>;
 template class ImageCv<ze::Pixel32fC3>;
 template class ImageCv<ze::Pixel32fC4>;
 
+#ifdef CV_16F
+template class ImageCv<ze::Pixel16fC1>;
+template class ImageCv<ze::Pixel16fC2>;
+template class ImageCv<ze::Pixel16fC3>;
+template class ImageCv<ze::Pixel16fC4>;
+#endif
+
 
 } // namespace ze
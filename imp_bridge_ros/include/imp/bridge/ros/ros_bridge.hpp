@@ -29,13 +29,47 @@
 
 namespace ze {
 
+//! Pixel type and order of the message data. Bayer and YUV 4:2:2 encodings
+//! return an undefined order, their data needs a conversion.
 std::pair<PixelType, PixelOrder> getPixelTypeFromRosImageEncoding(
     const std::string& encoding);
 
+/**
+ * @brief toImageCpu converts an image message into a CPU image
+ *
+ * Supported are the mono, rgb/bgr(a) 8 and 16 bit encodings, 8UC1, 16UC1 and
+ * 32FC1, 8 bit Bayer and YUV 4:2:2 (yuv422 and yuv422_yuy2).
+ * @param pixel_order Requested order, undefined keeps the order of the message.
+ *        Bayer images are demosaiced to gray (default), rgb or bgr, YUV images
+ *        to gray. 8 bit color images can be requested as gray.
+ * @note The data is copied (or converted) into an image of the global ImagePool.
+ */
 ImageBase::Ptr toImageCpu(
     const sensor_msgs::Image& src,
     PixelOrder pixel_order = PixelOrder::undefined);
 
+/**
+ * @brief toImageCpu converts an image message into a CPU image without a copy
+ *
+ * Same as above, but images that need no conversion reference the message
+ * data and keep the message alive. The message may be shared with other
+ * subscribers, hence the returned image is read-only.
+ */
+ImageBase::ConstPtr toImageCpu(
+    const sensor_msgs::ImageConstPtr& src,
+    PixelOrder pixel_order = PixelOrder::undefined);
+
+/**
+ * @brief toImageCpu converts a mutable image message into a CPU image without a copy
+ *
+ * For messages owned by the caller, e.g. instantiated from a rosbag. Images
+ * that need no conversion reference the message data and keep the message
+ * alive, writing to the image modifies the message.
+ */
+ImageBase::Ptr toImageCpu(
+    const sensor_msgs::ImagePtr& src,
+    PixelOrder pixel_order = PixelOrder::undefined);
+
 ImageBase::Ptr toImageGpu(
     const sensor_msgs::Image& src,
     PixelOrder pixel_order = PixelOrder::undefined);
@@ -24,9 +24,12 @@
 // SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <imp/bridge/ros/ros_bridge.hpp>
 
+#include <algorithm>
+#include <cstring>
 #include <sensor_msgs/image_encodings.h>
 
-#include <imp/core/image_raw.hpp>
+#include <imp/core/image_pool.hpp>
+#include <imp/core/pixel_conversion.hpp>
 #include <ze/common/logging.hpp>
 #include <ze/common/types.hpp>
 
@@ -35,16 +38,244 @@ namespace ze {
 
 namespace imgenc = sensor_msgs::image_encodings;
 
+namespace {
+
+//! YUYV byte order, not defined by older sensor_msgs versions.
+const std::string c_yuv422_yuy2 = "yuv422_yuy2";
+
+bool getBayerPattern(const std::string& encoding, BayerPattern* pattern)
+{
+  if (encoding == imgenc::BAYER_RGGB8) { *pattern = BayerPattern::RGGB; }
+  else if (encoding == imgenc::BAYER_BGGR8) { *pattern = BayerPattern::BGGR; }
+  else if (encoding == imgenc::BAYER_GRBG8) { *pattern = BayerPattern::GRBG; }
+  else if (encoding == imgenc::BAYER_GBRG8) { *pattern = BayerPattern::GBRG; }
+  else { return false; }
+  return true;
+}
+
+bool hostIsBigEndian()
+{
+  const uint16_t one = 1u;
+  return *reinterpret_cast<const uint8_t*>(&one) == 0u;
+}
+
+uint32_t bytesPerPixel(PixelType pixel_type)
+{
+  switch (pixel_type)
+  {
+    case PixelType::i8uC1: return 1u;
+    case PixelType::i8uC2: return 2u;
+    case PixelType::i8uC3: return 3u;
+    case PixelType::i8uC4: return 4u;
+    case PixelType::i16uC1: return 2u;
+    case PixelType::i16uC3: return 6u;
+    case PixelType::i16uC4: return 8u;
+    case PixelType::i32fC1: return 4u;
+    default: LOG(FATAL) << "Unexpected pixel type."; return 0u;
+  }
+}
+
+//! Pixel data of the message, only read through the returned pointer.
+template<typename Pixel>
+Pixel* messageData(const sensor_msgs::Image& src)
+{
+  return reinterpret_cast<Pixel*>(const_cast<uint8_t*>(src.data.data()));
+}
+
+//! Copy of the message data into a pooled image, row by row as the step of
+//! the message needs not be a multiple of the pixel size.
+template<typename Pixel>
+typename ImageRaw<Pixel>::Ptr copyRows(const sensor_msgs::Image& src,
+                                       PixelOrder pixel_order)
+{
+  typename ImageRaw<Pixel>::Ptr dst = ImagePool::global().acquire<Pixel>(
+        Size2u(src.width, src.height), pixel_order);
+  for (uint32_t y = 0u; y < src.height; ++y)
+  {
+    std::memcpy(dst->data(0u, y), &src.data[y * src.step], src.width * sizeof(Pixel));
+  }
+  return dst;
+}
+
+//! Read-only image of the message data, copied if the rows can't be
+//! addressed in place.
+template<typename Pixel>
+typename ImageRaw<Pixel>::ConstPtr messageImage(const sensor_msgs::Image& src,
+                                                PixelOrder pixel_order)
+{
+  if (src.step % sizeof(Pixel) != 0u)
+  {
+    return copyRows<Pixel>(src, pixel_order);
+  }
+  return std::make_shared<const ImageRaw<Pixel>>(
+        messageData<Pixel>(src), src.width, src.height, src.step, true, pixel_order);
+}
+
+//! Image of the message data. With \a tracked the data is referenced and the
+//! message kept alive by the image, without the data is copied into a pooled
+//! image. Messages with a step that isn't a multiple of the pixel size are
+//! always copied.
+template<typename Pixel>
+typename ImageRaw<Pixel>::Ptr wrapMessage(
+    const sensor_msgs::Image& src, const std::shared_ptr<void const>& tracked,
+    PixelOrder pixel_order)
+{
+  if (tracked && src.step % sizeof(Pixel) == 0u)
+  {
+    return std::make_shared<ImageRaw<Pixel>>(
+          messageData<Pixel>(src), src.width, src.height, src.step, tracked, pixel_order);
+  }
+  return copyRows<Pixel>(src, pixel_order);
+}
+
+//! Copy of a 16-bit image with the byte order of the host.
+template<typename Pixel>
+typename ImageRaw<Pixel>::Ptr swapBytes(const sensor_msgs::Image& src,
+                                        PixelOrder pixel_order)
+{
+  typename ImageRaw<Pixel>::Ptr dst = ImagePool::global().acquire<Pixel>(
+        Size2u(src.width, src.height), pixel_order);
+  const uint32_t values_per_row = src.width * sizeof(Pixel) / sizeof(uint16_t);
+  for (uint32_t y = 0u; y < src.height; ++y)
+  {
+    const uint8_t* in = &src.data[y * src.step];
+    uint8_t* out = reinterpret_cast<uint8_t*>(dst->data(0u, y));
+    for (uint32_t i = 0u; i < values_per_row; ++i)
+    {
+      out[2u * i] = in[2u * i + 1u];
+      out[2u * i + 1u] = in[2u * i];
+    }
+  }
+  return dst;
+}
+
+template<typename Pixel>
+typename ImageRaw<Pixel>::Ptr wrapMessage16(
+    const sensor_msgs::Image& src, const std::shared_ptr<void const>& tracked,
+    PixelOrder pixel_order)
+{
+  if (static_cast<bool>(src.is_bigendian) != hostIsBigEndian())
+  {
+    return swapBytes<Pixel>(src, pixel_order);
+  }
+  return wrapMessage<Pixel>(src, tracked, pixel_order);
+}
+
+//! Reference to the message for images that share its data, which works for
+//! boost and std shared pointers alike.
+template<typename MessagePtr>
+std::shared_ptr<void const> trackMessage(const MessagePtr& src)
+{
+  MessagePtr message = src;
+  return std::shared_ptr<void const>(
+        static_cast<const void*>(message.get()),
+        [message](const void*) mutable { message.reset(); });
+}
+
+ImageBase::Ptr toImageCpu(
+    const sensor_msgs::Image& src, const std::shared_ptr<void const>& tracked,
+    PixelOrder pixel_order)
+{
+  PixelType src_pixel_type;
+  PixelOrder src_pixel_order;
+  std::tie(src_pixel_type, src_pixel_order) =
+      getPixelTypeFromRosImageEncoding(src.encoding);
+
+  uint32_t width = src.width;
+  uint32_t height = src.height;
+  uint32_t pitch = src.step;
+  const Size2u size(width, height);
+
+  // sanity check
+  CHECK_GE(pitch, width * bytesPerPixel(src_pixel_type)) << "Input image seem to wrongly formatted";
+  CHECK_GE(src.data.size(), static_cast<size_t>(pitch) * height) << "Input image seem to wrongly formatted";
+
+  // Encodings that need a conversion.
+  BayerPattern bayer_pattern;
+  if (getBayerPattern(src.encoding, &bayer_pattern))
+  {
+    const ImageRaw8uC1::ConstPtr raw = messageImage<Pixel8uC1>(src, PixelOrder::undefined);
+    if (pixel_order == PixelOrder::rgb || pixel_order == PixelOrder::bgr)
+    {
+      ImageRaw8uC3::Ptr dst = ImagePool::global().acquire<Pixel8uC3>(size, pixel_order);
+      demosaic(*raw, *dst, bayer_pattern);
+      return dst;
+    }
+    CHECK(pixel_order == PixelOrder::undefined || pixel_order == PixelOrder::gray)
+        << "Bayer images convert to gray, rgb or bgr.";
+    ImageRaw8uC1::Ptr dst = ImagePool::global().acquire<Pixel8uC1>(size, PixelOrder::gray);
+    demosaicToGray(*raw, *dst, bayer_pattern);
+    return dst;
+  }
+  if (src.encoding == imgenc::YUV422 || src.encoding == c_yuv422_yuy2)
+  {
+    CHECK(pixel_order == PixelOrder::undefined || pixel_order == PixelOrder::gray)
+        << "YUV 4:2:2 images convert to gray only.";
+    const ImageRaw8uC2::ConstPtr yuv = messageImage<Pixel8uC2>(src, PixelOrder::undefined);
+    ImageRaw8uC1::Ptr dst = ImagePool::global().acquire<Pixel8uC1>(size, PixelOrder::gray);
+    convertYuv422ToGray(*yuv, *dst, src.encoding == imgenc::YUV422 ? Yuv422Layout::UYVY
+                                                                   : Yuv422Layout::YUYV);
+    return dst;
+  }
+
+  // Color images requested as gray.
+  if (pixel_order == PixelOrder::gray && src_pixel_order != PixelOrder::gray)
+  {
+    ImageRaw8uC1::Ptr dst = ImagePool::global().acquire<Pixel8uC1>(size, PixelOrder::gray);
+    switch (src_pixel_type)
+    {
+      case PixelType::i8uC3:
+        convertToGray(*messageImage<Pixel8uC3>(src, src_pixel_order), *dst);
+        return dst;
+      case PixelType::i8uC4:
+        convertToGray(*messageImage<Pixel8uC4>(src, src_pixel_order), *dst);
+        return dst;
+      default:
+        LOG(FATAL) << "No gray conversion for encoding " + src.encoding + ".";
+        return nullptr;
+    }
+  }
+  CHECK(pixel_order == PixelOrder::undefined || pixel_order == src_pixel_order)
+      << "Unsupported conversion of encoding " + src.encoding + ".";
+
+  switch (src_pixel_type)
+  {
+    case PixelType::i8uC1:
+      return wrapMessage<Pixel8uC1>(src, tracked, src_pixel_order);
+    case PixelType::i8uC3:
+      return wrapMessage<Pixel8uC3>(src, tracked, src_pixel_order);
+    case PixelType::i8uC4:
+      return wrapMessage<Pixel8uC4>(src, tracked, src_pixel_order);
+    case PixelType::i16uC1:
+      return wrapMessage16<Pixel16uC1>(src, tracked, src_pixel_order);
+    case PixelType::i16uC3:
+      return wrapMessage16<Pixel16uC3>(src, tracked, src_pixel_order);
+    case PixelType::i16uC4:
+      return wrapMessage16<Pixel16uC4>(src, tracked, src_pixel_order);
+    case PixelType::i32fC1:
+      CHECK_EQ(static_cast<bool>(src.is_bigendian), hostIsBigEndian())
+          << "Unsupported byte order of encoding " + src.encoding + ".";
+      return wrapMessage<Pixel32fC1>(src, tracked, src_pixel_order);
+    default:
+    {
+      LOG(FATAL) << "Unsupported pixel type" + src.encoding + ".";
+      break;
+    }
+  }
+  return nullptr;
+}
+
+} // anonymous namespace
+
 //------------------------------------------------------------------------------
 std::pair<PixelType, PixelOrder> getPixelTypeFromRosImageEncoding(
     const std::string& encoding)
 {
-  //! @todo (MWE) we do not support bayer or YUV images yet.
   if (encoding == imgenc::BGR8)
   {
     return std::make_pair(PixelType::i8uC3, PixelOrder::bgr);
   }
-  else if (encoding == imgenc::MONO8)
+  else if (encoding == imgenc::MONO8 || encoding == imgenc::TYPE_8UC1)
   {
     return std::make_pair(PixelType::i8uC1, PixelOrder::gray);
   }
@@ -52,7 +283,7 @@ std::pair<PixelType, PixelOrder> getPixelTypeFromRosImageEncoding(
   {
     return std::make_pair(PixelType::i8uC3, PixelOrder::rgb);
   }
-  else if (encoding == imgenc::MONO16)
+  else if (encoding == imgenc::MONO16 || encoding == imgenc::TYPE_16UC1)
   {
     return std::make_pair(PixelType::i16uC1, PixelOrder::gray);
   }
@@ -80,84 +311,46 @@ std::pair<PixelType, PixelOrder> getPixelTypeFromRosImageEncoding(
   {
     return std::make_pair(PixelType::i16uC4, PixelOrder::rgba);
   }
+  else if (encoding == imgenc::TYPE_32FC1)
+  {
+    return std::make_pair(PixelType::i32fC1, PixelOrder::gray);
+  }
+  else if (encoding == imgenc::BAYER_RGGB8 || encoding == imgenc::BAYER_BGGR8
+           || encoding == imgenc::BAYER_GRBG8 || encoding == imgenc::BAYER_GBRG8)
+  {
+    // Raw mosaic, toImageCpu demosaics it.
+    return std::make_pair(PixelType::i8uC1, PixelOrder::undefined);
+  }
+  else if (encoding == imgenc::YUV422 || encoding == c_yuv422_yuy2)
+  {
+    // Interleaved luma/chroma, toImageCpu extracts the luma.
+    return std::make_pair(PixelType::i8uC2, PixelOrder::undefined);
+  }
   LOG(FATAL) << "Unsupported image encoding " + encoding + ".";
   return std::make_pair(PixelType::undefined, PixelOrder::undefined);
 }
 
 //------------------------------------------------------------------------------
 ImageBase::Ptr toImageCpu(
-    const sensor_msgs::Image& src, PixelOrder /*pixel_order*/)
+    const sensor_msgs::Image& src, PixelOrder pixel_order)
 {
-  PixelType src_pixel_type;
-  PixelOrder src_pixel_order;
-  std::tie(src_pixel_type, src_pixel_order) =
-      getPixelTypeFromRosImageEncoding(src.encoding);
-
-  int bit_depth = imgenc::bitDepth(src.encoding);
-  int num_channels = imgenc::numChannels(src.encoding);
-  uint32_t width = src.width;
-  uint32_t height = src.height;
-  uint32_t pitch = src.step;
+  return toImageCpu(src, nullptr, pixel_order);
+}
 
-  // sanity check
-  CHECK_GE(pitch, width * num_channels * bit_depth/8) << "Input image seem to wrongly formatted";
+//------------------------------------------------------------------------------
+ImageBase::ConstPtr toImageCpu(
+    const sensor_msgs::ImageConstPtr& src, PixelOrder pixel_order)
+{
+  CHECK(src);
+  return toImageCpu(*src, trackMessage(src), pixel_order);
+}
 
-  switch (src_pixel_type)
-  {
-    case PixelType::i8uC1:
-    {
-      ImageRaw8uC1 src_wrapped(
-          reinterpret_cast<Pixel8uC1*>(const_cast<uint8_t*>(&src.data[0])),
-          width, height, pitch, true, PixelOrder::gray);
-      ImageRaw8uC1::Ptr dst =
-          std::make_shared<ImageRaw8uC1>(src_wrapped); // Deep copy of the image data.
-      return dst;
-    }
-//  case imp::PixelType::i8uC2:
-//  { } break;
-//  case imp::PixelType::i8uC3:
-//  { } break;
-//  case imp::PixelType::i8uC4:
-//  { } break;
-//  case imp::PixelType::i16uC1:
-//  { } break;
-//  case imp::PixelType::i16uC2:
-//  { } break;
-//  case imp::PixelType::i16uC3:
-//  { } break;
-//  case imp::PixelType::i16uC4:
-//  { } break;
-//  case imp::PixelType::i32uC1:
-//  { } break;
-//  case imp::PixelType::i32uC2:
-//  { } break;
-//  case imp::PixelType::i32uC3:
-//  { } break;
-//  case imp::PixelType::i32uC4:
-//  { } break;
-//  case imp::PixelType::i32sC1:
-//  { } break;
-//  case imp::PixelType::i32sC2:
-//  { } break;
-//  case imp::PixelType::i32sC3:
-//  { } break;
-//  case imp::PixelType::i32sC4:
-//  { } break;
-//  case imp::PixelType::i32fC1:
-//  { } break;
-//  case imp::PixelType::i32fC2:
-//  { } break;
-//  case imp::PixelType::i32fC3:
-//  { } break;
-//  case imp::PixelType::i32fC4:
-//  { } break;
-    default:
-    {
-      LOG(FATAL) << "Unsupported pixel type" + src.encoding + ".";
-      break;
-    }
-  }
-  return nullptr;
+//------------------------------------------------------------------------------
+ImageBase::Ptr toImageCpu(
+    const sensor_msgs::ImagePtr& src, PixelOrder pixel_order)
+{
+  CHECK(src);
+  return toImageCpu(*src, trackMessage(src), pixel_order);
 }
 
 } // namespace ze
@@ -0,0 +1,302 @@
+// Copyright (c) 2015-2016, ETH Zurich, Wyss Zurich, Zurich Eye
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the ETH Zurich, Wyss Zurich, Zurich Eye nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL ETH Zurich, Wyss Zurich, Zurich Eye BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <string>
+
+#include <boost/make_shared.hpp>
+#include <boost/weak_ptr.hpp>
+#include <sensor_msgs/image_encodings.h>
+
+#include <ze/common/test_entrypoint.hpp>
+#include <imp/bridge/ros/ros_bridge.hpp>
+#include <imp/core/image_raw.hpp>
+
+namespace {
+
+using namespace ze;
+
+constexpr uint32_t c_width = 10u;
+constexpr uint32_t c_height = 6u;
+//! Row padding of the messages, to check that the step is respected.
+constexpr uint32_t c_padding = 12u;
+
+//! Message with a distinct value in every byte and 0xff in the row padding.
+sensor_msgs::ImagePtr makeMessage(const std::string& encoding,
+                                  uint32_t bytes_per_pixel,
+                                  bool is_bigendian = false)
+{
+  sensor_msgs::ImagePtr msg = boost::make_shared<sensor_msgs::Image>();
+  msg->encoding = encoding;
+  msg->width = c_width;
+  msg->height = c_height;
+  msg->step = c_width * bytes_per_pixel + c_padding;
+  msg->is_bigendian = is_bigendian;
+  msg->data.assign(msg->step * c_height, 0xffu);
+  for (uint32_t y = 0u; y < c_height; ++y)
+  {
+    for (uint32_t i = 0u; i < c_width * bytes_per_pixel; ++i)
+    {
+      msg->data[y * msg->step + i] = static_cast<uint8_t>((y * 31u + i * 7u) % 251u);
+    }
+  }
+  return msg;
+}
+
+bool hostIsBigEndian()
+{
+  const uint16_t one = 1u;
+  return *reinterpret_cast<const uint8_t*>(&one) == 0u;
+}
+
+template<typename Pixel>
+void expectMessageData(const sensor_msgs::Image& msg, const ImageBase& img,
+                       PixelOrder pixel_order)
+{
+  const ImageRaw<Pixel>* raw = dynamic_cast<const ImageRaw<Pixel>*>(&img);
+  ASSERT_NE(nullptr, raw) << msg.encoding;
+  EXPECT_EQ(msg.width, raw->width()) << msg.encoding;
+  EXPECT_EQ(msg.height, raw->height()) << msg.encoding;
+  EXPECT_EQ(pixel_order, raw->pixelOrder()) << msg.encoding;
+  for (uint32_t y = 0u; y < msg.height; ++y)
+  {
+    EXPECT_EQ(0, std::memcmp(raw->data(0u, y), &msg.data[y * msg.step],
+                             msg.width * sizeof(Pixel))) << msg.encoding << " row " << y;
+  }
+}
+
+//! Encodings without a conversion, referenced by the zero-copy overload and
+//! copied by the by-reference overload.
+template<typename Pixel>
+void testWrappedEncoding(const std::string& encoding, PixelOrder pixel_order)
+{
+  sensor_msgs::ImagePtr msg = makeMessage(encoding, sizeof(Pixel), hostIsBigEndian());
+
+  ImageBase::Ptr copy = toImageCpu(*msg);
+  expectMessageData<Pixel>(*msg, *copy, pixel_order);
+  EXPECT_NE(static_cast<const void*>(msg->data.data()),
+            static_cast<const void*>(copy->as<ImageRaw<Pixel>>()->data()));
+
+  // Rows are only referenced in place if the step is a multiple of the pixel
+  // size, e.g. not for rgba16 with the padding above.
+  ImageBase::ConstPtr wrapped = toImageCpu(sensor_msgs::ImageConstPtr(msg));
+  expectMessageData<Pixel>(*msg, *wrapped, pixel_order);
+  const bool zero_copy = msg->step % sizeof(Pixel) == 0u;
+  EXPECT_EQ(zero_copy, msg->step == wrapped->pitch()) << encoding;
+  EXPECT_EQ(zero_copy, static_cast<const void*>(msg->data.data())
+            == static_cast<const void*>(
+              dynamic_cast<const ImageRaw<Pixel>&>(*wrapped).data())) << encoding;
+}
+
+//! Channel of a flat color mosaic, \a pattern lists the 2x2 cell row by row.
+uint8_t mosaicValue(const std::string& pattern, uint32_t x, uint32_t y,
+                    uint8_t r, uint8_t g, uint8_t b)
+{
+  switch (pattern[(y % 2u) * 2u + x % 2u])
+  {
+    case 'R': return r;
+    case 'G': return g;
+    default: return b;
+  }
+}
+
+} // anonymous namespace
+
+TEST(RosBridgeTest, testZeroCopyKeepsMessageAlive)
+{
+  using namespace ze;
+
+  sensor_msgs::ImagePtr msg = makeMessage(sensor_msgs::image_encodings::MONO8, 1u);
+  const uint8_t* msg_data = msg->data.data();
+  boost::weak_ptr<sensor_msgs::Image> msg_weak = msg;
+
+  ImageBase::ConstPtr img = toImageCpu(sensor_msgs::ImageConstPtr(msg));
+  msg.reset();
+  ASSERT_FALSE(msg_weak.expired());
+  const ImageRaw8uC1& img8 = dynamic_cast<const ImageRaw8uC1&>(*img);
+  EXPECT_EQ(static_cast<const void*>(msg_data), static_cast<const void*>(img8.data()));
+  EXPECT_EQ(c_width + c_padding, img8.pitch());
+  EXPECT_EQ(31u * 2u + 7u * 3u, img8(3u, 2u).x);
+  img.reset();
+  EXPECT_TRUE(msg_weak.expired());
+}
+
+TEST(RosBridgeTest, testZeroCopyMutableMessage)
+{
+  using namespace ze;
+
+  sensor_msgs::ImagePtr msg = makeMessage(sensor_msgs::image_encodings::MONO8, 1u);
+  ImageRaw8uC1::Ptr img = toImageCpu(msg)->as<ImageRaw8uC1>();
+  ASSERT_TRUE(img != nullptr);
+  img->pixel(3u, 2u).x = 42u;
+  EXPECT_EQ(42u, msg->data[2u * msg->step + 3u]);
+}
+
+TEST(RosBridgeTest, testWrappedEncodings)
+{
+  using namespace ze;
+  namespace enc = sensor_msgs::image_encodings;
+
+  testWrappedEncoding<Pixel8uC1>(enc::MONO8, PixelOrder::gray);
+  testWrappedEncoding<Pixel8uC1>(enc::TYPE_8UC1, PixelOrder::gray);
+  testWrappedEncoding<Pixel8uC3>(enc::RGB8, PixelOrder::rgb);
+  testWrappedEncoding<Pixel8uC3>(enc::BGR8, PixelOrder::bgr);
+  testWrappedEncoding<Pixel8uC4>(enc::RGBA8, PixelOrder::rgba);
+  testWrappedEncoding<Pixel8uC4>(enc::BGRA8, PixelOrder::bgra);
+  testWrappedEncoding<Pixel16uC1>(enc::MONO16, PixelOrder::gray);
+  testWrappedEncoding<Pixel16uC1>(enc::TYPE_16UC1, PixelOrder::gray);
+  testWrappedEncoding<Pixel16uC3>(enc::RGB16, PixelOrder::rgb);
+  testWrappedEncoding<Pixel16uC3>(enc::BGR16, PixelOrder::bgr);
+  testWrappedEncoding<Pixel16uC4>(enc::RGBA16, PixelOrder::rgba);
+  testWrappedEncoding<Pixel16uC4>(enc::BGRA16, PixelOrder::bgra);
+  testWrappedEncoding<Pixel32fC1>(enc::TYPE_32FC1, PixelOrder::gray);
+}
+
+TEST(RosBridgeTest, testSwappedByteOrder)
+{
+  using namespace ze;
+
+  sensor_msgs::ImagePtr msg =
+      makeMessage(sensor_msgs::image_encodings::RGB16, 6u, !hostIsBigEndian());
+  ImageBase::ConstPtr img = toImageCpu(sensor_msgs::ImageConstPtr(msg));
+  const ImageRaw16uC3& img16 = dynamic_cast<const ImageRaw16uC3&>(*img);
+  EXPECT_NE(static_cast<const void*>(msg->data.data()),
+            static_cast<const void*>(img16.data()));
+  for (uint32_t y = 0u; y < c_height; ++y)
+  {
+    for (uint32_t x = 0u; x < c_width; ++x)
+    {
+      for (uint32_t c = 0u; c < 3u; ++c)
+      {
+        const uint8_t* in = &msg->data[y * msg->step + x * 6u + c * 2u];
+        const uint16_t expected = hostIsBigEndian()
+            ? static_cast<uint16_t>(in[0] | (in[1] << 8))
+            : static_cast<uint16_t>((in[0] << 8) | in[1]);
+        EXPECT_EQ(expected, img16(x, y).c[c]);
+      }
+    }
+  }
+}
+
+TEST(RosBridgeTest, testBayer)
+{
+  using namespace ze;
+  namespace enc = sensor_msgs::image_encodings;
+
+  const uint8_t r = 200u, g = 100u, b = 50u;
+  // BT.601 gray of the flat color.
+  const int gray = 124;
+  for (const std::string& encoding : { enc::BAYER_RGGB8, enc::BAYER_BGGR8,
+                                       enc::BAYER_GRBG8, enc::BAYER_GBRG8 })
+  {
+    std::string pattern = encoding.substr(6u, 4u);
+    std::transform(pattern.begin(), pattern.end(), pattern.begin(), ::toupper);
+    sensor_msgs::ImagePtr msg = makeMessage(encoding, 1u);
+    for (uint32_t y = 0u; y < c_height; ++y)
+    {
+      for (uint32_t x = 0u; x < c_width; ++x)
+      {
+        msg->data[y * msg->step + x] = mosaicValue(pattern, x, y, r, g, b);
+      }
+    }
+
+    ImageBase::Ptr gray_img = toImageCpu(*msg);
+    const ImageRaw8uC1& gray8 = dynamic_cast<const ImageRaw8uC1&>(*gray_img);
+    EXPECT_EQ(PixelOrder::gray, gray8.pixelOrder());
+    ImageBase::Ptr bgr_img = toImageCpu(*msg, PixelOrder::bgr);
+    const ImageRaw8uC3& bgr8 = dynamic_cast<const ImageRaw8uC3&>(*bgr_img);
+    EXPECT_EQ(PixelOrder::bgr, bgr8.pixelOrder());
+    ImageBase::Ptr rgb_img = toImageCpu(*msg, PixelOrder::rgb);
+    const ImageRaw8uC3& rgb8 = dynamic_cast<const ImageRaw8uC3&>(*rgb_img);
+
+    // A flat color is reconstructed exactly away from the border.
+    for (uint32_t y = 1u; y + 1u < c_height; ++y)
+    {
+      for (uint32_t x = 1u; x + 1u < c_width; ++x)
+      {
+        EXPECT_NEAR(gray, gray8(x, y).x, 1) << encoding;
+        EXPECT_EQ(r, rgb8(x, y).x) << encoding;
+        EXPECT_EQ(g, rgb8(x, y).y) << encoding;
+        EXPECT_EQ(b, rgb8(x, y).z) << encoding;
+        EXPECT_EQ(b, bgr8(x, y).x) << encoding;
+        EXPECT_EQ(r, bgr8(x, y).z) << encoding;
+      }
+    }
+  }
+}
+
+TEST(RosBridgeTest, testYuv422)
+{
+  using namespace ze;
+
+  // UYVY has the luma in the odd bytes, YUYV in the even ones.
+  for (const std::string& encoding : { sensor_msgs::image_encodings::YUV422,
+                                       std::string("yuv422_yuy2") })
+  {
+    sensor_msgs::ImagePtr msg = makeMessage(encoding, 2u);
+    const uint32_t luma_offset =
+        encoding == sensor_msgs::image_encodings::YUV422 ? 1u : 0u;
+    ImageBase::Ptr img = toImageCpu(*msg);
+    const ImageRaw8uC1& gray8 = dynamic_cast<const ImageRaw8uC1&>(*img);
+    EXPECT_EQ(PixelOrder::gray, gray8.pixelOrder());
+    for (uint32_t y = 0u; y < c_height; ++y)
+    {
+      for (uint32_t x = 0u; x < c_width; ++x)
+      {
+        EXPECT_EQ(msg->data[y * msg->step + 2u * x + luma_offset], gray8(x, y).x)
+            << encoding;
+      }
+    }
+  }
+}
+
+TEST(RosBridgeTest, testColorToGray)
+{
+  using namespace ze;
+  namespace enc = sensor_msgs::image_encodings;
+
+  for (const std::string& encoding : { enc::RGB8, enc::BGRA8 })
+  {
+    const uint32_t channels = encoding == enc::RGB8 ? 3u : 4u;
+    const bool is_rgb = encoding == enc::RGB8;
+    sensor_msgs::ImagePtr msg = makeMessage(encoding, channels);
+    ImageBase::Ptr img = toImageCpu(*msg, PixelOrder::gray);
+    const ImageRaw8uC1& gray8 = dynamic_cast<const ImageRaw8uC1&>(*img);
+    for (uint32_t y = 0u; y < c_height; ++y)
+    {
+      for (uint32_t x = 0u; x < c_width; ++x)
+      {
+        const uint8_t* in = &msg->data[y * msg->step + x * channels];
+        const double r = is_rgb ? in[0] : in[2];
+        const double b = is_rgb ? in[2] : in[0];
+        EXPECT_NEAR(0.299 * r + 0.587 * in[1] + 0.114 * b, gray8(x, y).x, 1.0)
+            << encoding;
+      }
+    }
+  }
+}
+
+ZE_UNITTEST_ENTRYPOINT
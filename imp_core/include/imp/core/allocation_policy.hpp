@@ -0,0 +1,97 @@
+// Copyright (c) 2015-2016, ETH Zurich, Wyss Zurich, Zurich Eye
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the ETH Zurich, Wyss Zurich, Zurich Eye nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL ETH Zurich, Wyss Zurich, Zurich Eye BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace ze {
+
+//! Page backing of image memory.
+enum class HugePages
+{
+  None,        //!< posix_memalign, the allocator decides.
+  Transparent, //!< 2 MB aligned mmap with madvise(MADV_HUGEPAGE).
+  Explicit     //!< mmap with MAP_HUGETLB, falls back to Transparent if no huge pages are reserved.
+};
+
+/**
+ * @brief The AllocationPolicy struct selects how image memory is allocated
+ *
+ * The default policy keeps the plain aligned allocation. Large float images
+ * and pyramids benefit from huge pages (fewer TLB misses). On multi-socket
+ * machines binding to the node of the processing threads avoids remote
+ * memory accesses. Without binding, Linux places pages on the node of the
+ * thread that first writes to them (first touch), so let the processing
+ * thread initialize the image. Whether huge pages pay off depends on the
+ * kernel and hypervisor, measure with imp_benchmark_aligned_allocator.
+ */
+struct AllocationPolicy
+{
+  HugePages huge_pages = HugePages::None;
+
+  //! NUMA node to bind the memory to, -1 for first touch.
+  int numa_node = -1;
+
+  //! Round the pitch up to the page size (4 KB), such that every row starts
+  //! on a new page.
+  bool page_aligned_pitch = false;
+
+  //! True if the memory is mapped instead of taken from the heap.
+  inline bool isMapped() const
+  {
+    return huge_pages != HugePages::None || numa_node >= 0;
+  }
+};
+
+inline bool operator==(const AllocationPolicy& lhs, const AllocationPolicy& rhs)
+{
+  return lhs.huge_pages == rhs.huge_pages
+      && lhs.numa_node == rhs.numa_node
+      && lhs.page_aligned_pitch == rhs.page_aligned_pitch;
+}
+
+inline bool operator!=(const AllocationPolicy& lhs, const AllocationPolicy& rhs)
+{
+  return !(lhs == rhs);
+}
+
+//! Policy used by images that are not given one explicitly.
+//! Set it once at startup, it is not synchronized with running allocations.
+void setDefaultAllocationPolicy(const AllocationPolicy& policy);
+const AllocationPolicy& defaultAllocationPolicy();
+
+//! Allocates \a bytes aligned to \a alignment (power of two, at most the page size).
+//! Throws std::bad_alloc on failure.
+void* allocateAligned(size_t bytes, uint32_t alignment, const AllocationPolicy& policy);
+
+//! Releases memory of allocateAligned, \a bytes and \a policy must match.
+void freeAligned(void* p, size_t bytes, const AllocationPolicy& policy);
+
+//! Row alignment in bytes the policy requires at least.
+uint32_t pitchAlignment(const AllocationPolicy& policy, uint32_t default_alignment);
+
+} // namespace ze
@@ -0,0 +1,143 @@
+// Copyright (c) 2015-2016, ETH Zurich, Wyss Zurich, Zurich Eye
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the ETH Zurich, Wyss Zurich, Zurich Eye nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL ETH Zurich, Wyss Zurich, Zurich Eye BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+
+#if defined(__F16C__) && !defined(__CUDACC__)
+#  include <immintrin.h>
+#endif
+
+namespace ze {
+
+//------------------------------------------------------------------------------
+//! Bit pattern of the IEEE 754 half-precision float closest to \a value
+//! (round to nearest even).
+inline uint16_t floatToHalfBits(float value)
+{
+#if defined(__F16C__) && !defined(__CUDACC__)
+  return _cvtss_sh(value, _MM_FROUND_TO_NEAREST_INT);
+#else
+  uint32_t f;
+  std::memcpy(&f, &value, sizeof(f));
+  const uint32_t sign = f & 0x80000000u;
+  f ^= sign;
+  uint32_t h;
+  if (f >= 0x47800000u)
+  {
+    // Larger than the half range: infinity, NaN stays (quiet) NaN.
+    h = (f > 0x7f800000u) ? 0x7e00u : 0x7c00u;
+  }
+  else if (f < 0x38800000u)
+  {
+    // Subnormal half or zero. Adding the magic number aligns the mantissa
+    // bits at the bottom and lets the FPU round.
+    const uint32_t magic_bits = 0x3f000000u;
+    float magic, shifted;
+    std::memcpy(&magic, &magic_bits, sizeof(magic));
+    std::memcpy(&shifted, &f, sizeof(shifted));
+    shifted += magic;
+    std::memcpy(&h, &shifted, sizeof(h));
+    h -= magic_bits;
+  }
+  else
+  {
+    // Normal half: rebias the exponent and round the mantissa to nearest even.
+    const uint32_t mantissa_odd = (f >> 13) & 1u;
+    f += 0xc8000fffu + mantissa_odd;
+    h = f >> 13;
+  }
+  return static_cast<uint16_t>(h | (sign >> 16));
+#endif
+}
+
+//------------------------------------------------------------------------------
+//! Float value of the IEEE 754 half-precision bit pattern \a bits (exact).
+inline float halfBitsToFloat(uint16_t bits)
+{
+#if defined(__F16C__) && !defined(__CUDACC__)
+  return _cvtsh_ss(bits);
+#else
+  const uint32_t shifted_exponent = 0x0f800000u;
+  uint32_t f = (static_cast<uint32_t>(bits) & 0x7fffu) << 13;
+  const uint32_t exponent = f & shifted_exponent;
+  f += 0x38000000u;
+  if (exponent == shifted_exponent)
+  {
+    // Infinity or NaN.
+    f += 0x38000000u;
+  }
+  else if (exponent == 0u)
+  {
+    // Zero or subnormal, renormalize.
+    const uint32_t magic_bits = 0x38800000u;
+    float magic, value;
+    f += 0x00800000u;
+    std::memcpy(&magic, &magic_bits, sizeof(magic));
+    std::memcpy(&value, &f, sizeof(value));
+    value -= magic;
+    std::memcpy(&f, &value, sizeof(f));
+  }
+  f |= (static_cast<uint32_t>(bits) & 0x8000u) << 16;
+  float value;
+  std::memcpy(&value, &f, sizeof(value));
+  return value;
+#endif
+}
+
+//------------------------------------------------------------------------------
+/**
+ * @brief The Half struct stores an IEEE 754 half-precision float (16-bit).
+ *
+ * It halves the memory traffic of intermediate float images (gradients,
+ * pyramids, disparities) at about three significant decimal digits and a
+ * range of +-65504. Arithmetic is done in float, convert whole rows with
+ * convertHalfToFloat() / convertFloatToHalf() instead of per pixel.
+ */
+struct Half
+{
+  uint16_t bits;
+
+  Half() = default;
+  Half(float value) : bits(floatToHalfBits(value)) {}
+
+  operator float() const { return halfBitsToFloat(bits); }
+
+  static Half fromBits(uint16_t bits)
+  {
+    Half h;
+    h.bits = bits;
+    return h;
+  }
+
+  Half& operator+=(float rhs) { return *this = Half(static_cast<float>(*this) + rhs); }
+  Half& operator*=(float rhs) { return *this = Half(static_cast<float>(*this) * rhs); }
+  Half& operator/=(float rhs) { return *this = Half(static_cast<float>(*this) / rhs); }
+};
+
+static_assert(sizeof(Half) == 2, "Half must be stored in 16 bits.");
+
+} // namespace ze
@@ -30,6 +30,7 @@
 #include <ze/common/macros.hpp>
 #include <ze/common/logging.hpp>
 #include <imp/core/image_base.hpp>
+#include <imp/core/image_view.hpp>
 #include <imp/core/pixel.hpp>
 
 namespace ze {
@@ -54,6 +55,27 @@ public:
   virtual Pixel* data(uint32_t ox = 0, uint32_t oy = 0) = 0;
   virtual const Pixel* data(uint32_t ox = 0, uint32_t oy = 0) const = 0;
 
+  /** Returns a non-virtual view of the pixel data in CPU memory.
+   * Prefer it over the per-pixel accessors below in loops, these go through
+   * the virtual data() and check bounds for every pixel.
+   */
+  ImageView<Pixel> view()
+  {
+    CHECK(!this->isGpuMemory());
+    return ImageView<Pixel>(this->numel() > 0 ? data() : nullptr,
+                            this->width(), this->height(), this->stride());
+  }
+
+  ImageView<const Pixel> view() const
+  {
+    CHECK(!this->isGpuMemory());
+    return ImageView<const Pixel>(this->numel() > 0 ? data() : nullptr,
+                                  this->width(), this->height(), this->stride());
+  }
+
+  operator ImageView<Pixel>() { return view(); }
+  operator ImageView<const Pixel>() const { return view(); }
+
   /** Get Pixel value at position x,y. */
   Pixel pixel(uint32_t x, uint32_t y) const
   {
@@ -97,37 +119,48 @@ public:
   }
 
 
+  /** Returns a view of the region of interest. */
+  ImageView<Pixel> roiView()
+  {
+    return view().subView(this->roi());
+  }
+
+  ImageView<const Pixel> roiView() const
+  {
+    return view().subView(this->roi());
+  }
+
   /**
-   * @brief setValue Sets image data to the specified \a value.
-   * @param value Value to be set to the whole image data.
+   * @brief setValue Sets the pixels in the region of interest to the specified \a value.
+   * @param value Value to be set to the image data.
    */
   virtual void setValue(const Pixel& value)
   {
     CHECK(roi() != Roi2u(0,0,0,0)) << "ROI not set. Should not happen when initializing the image header properly.";
-    // safety check if memory is contiguous and roi is not set.
-    if ((this->bytes() == this->pitch()*this->height()) &&
-        (this->roi() == ze::Roi2u(this->size())))
+    const ImageView<Pixel> img = roiView();
+    // Only fill across rows if the pixels are contiguous. The row padding of
+    // a sub-image belongs to its parent image.
+    if (img.isContiguous())
     {
-      std::fill(this->data(), this->data()+this->stride()*this->height(), value);
+      std::fill_n(img.data(), img.width()*img.height(), value);
     }
     else
     {
-      for (uint32_t y=this->roi().y(); y<this->roi().y()+this->roi().height(); ++y)
+      for (uint32_t y=0u; y<img.height(); ++y)
       {
-        std::fill_n(this->data(this->roi().x(),y), this->roi().width(), value);
+        std::fill_n(img.row(y), img.width(), value);
       }
     }
   }
 
   /**
-   * @brief copyTo copies the internal image data to another class instance
+   * @brief copyTo copies the pixels in the region of interest to the region
+   *        of interest of another class instance
    * @param dst Image class that will receive this image's data.
-   * @todo (MWE) handle roi
    */
   virtual void copyTo(Image& dst) const
   {
-    CHECK_EQ(this->width(), dst.width());
-    CHECK_EQ(this->height(), dst.height());
+    CHECK_EQ(this->roi().size(), dst.roi().size());
 
     // check if dst image is on the gpu and the src image is not so we can
     // use the copyFrom functionality from the dst image as the Image class
@@ -136,47 +169,28 @@ public:
     {
       dst.copyFrom(*this);
     }
-    else if (this->bytes() == dst.bytes())
-    {
-      std::copy(this->data(), this->data()+this->stride()*this->height(), dst.data());
-    }
     else
     {
-      for (uint32_t y=0; y<this->height(); ++y)
-      {
-        for (uint32_t x=0; x<this->width(); ++x)
-        {
-          dst[y][x] = this->pixel(x,y);
-        }
-      }
+      copyView(roiView(), dst.roiView());
     }
   }
 
   /**
-   * @brief copyFrom copies the image data from another class instance to this image
+   * @brief copyFrom copies the pixels in the region of interest of another
+   *        class instance to the region of interest of this image
    * @param from Image class providing the image data.
    */
   virtual void copyFrom(const Image& from)
   {
-    CHECK_EQ(this->size(), from.size());
+    CHECK_EQ(this->roi().size(), from.roi().size());
 
     if (from.isGpuMemory())
     {
       from.copyTo(*this);
     }
-    else if (this->bytes() == from.bytes())
-    {
-      std::copy(from.data(), from.data()+from.stride()*from.height(), this->data());
-    }
     else
     {
-      for (uint32_t y=0; y<this->height(); ++y)
-      {
-        for (uint32_t x=0; x<this->width(); ++x)
-        {
-          (*this)[y][x] = from.pixel(x, y);
-        }
-      }
+      copyView(from.roiView(), roiView());
     }
   }
 
@@ -226,6 +240,11 @@ typedef Image<ze::Pixel32fC2> Image32fC2;
 typedef Image<ze::Pixel32fC3> Image32fC3;
 typedef Image<ze::Pixel32fC4> Image32fC4;
 
+typedef Image<ze::Pixel16fC1> Image16fC1;
+typedef Image<ze::Pixel16fC2> Image16fC2;
+typedef Image<ze::Pixel16fC3> Image16fC3;
+typedef Image<ze::Pixel16fC4> Image16fC4;
+
 // convenience typedefs
 template<typename Pixel>
 using ImagePtr = typename std::shared_ptr<Image<Pixel>>;
@@ -89,24 +89,28 @@ public:
     case PixelType::i32uC1:
     case PixelType::i32sC1:
     case PixelType::i32fC1:
+    case PixelType::i16fC1:
       return 1;
     case PixelType::i8uC2:
     case PixelType::i16uC2:
     case PixelType::i32uC2:
     case PixelType::i32sC2:
     case PixelType::i32fC2:
+    case PixelType::i16fC2:
       return 2;
     case PixelType::i8uC3:
     case PixelType::i16uC3:
     case PixelType::i32uC3:
     case PixelType::i32sC3:
     case PixelType::i32fC3:
+    case PixelType::i16fC3:
       return 3;
     case PixelType::i8uC4:
     case PixelType::i16uC4:
     case PixelType::i32uC4:
     case PixelType::i32sC4:
     case PixelType::i32fC4:
+    case PixelType::i16fC4:
       return 4;
     default:
       return 0;
@@ -0,0 +1,129 @@
+// Copyright (c) 2015-2016, ETH Zurich, Wyss Zurich, Zurich Eye
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the ETH Zurich, Wyss Zurich, Zurich Eye nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL ETH Zurich, Wyss Zurich, Zurich Eye BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+
+#include <ze/common/macros.hpp>
+#include <imp/core/allocation_policy.hpp>
+#include <imp/core/image_raw.hpp>
+#include <imp/core/memory_storage.hpp>
+#include <imp/core/pixel.hpp>
+#include <imp/core/size.hpp>
+
+namespace ze {
+
+/**
+ * @brief The ImagePool class recycles the pixel buffers of ImageRaw images
+ *
+ * Buffers are keyed by (size, pixel type, pitch, allocation policy). Acquired images reference
+ * their buffer through ImageRaw's tracked pointer. When the last copy of the
+ * image pointer is dropped, the buffer goes back to the pool instead of being
+ * freed, so a steady stream of equally sized frames does not allocate pixel
+ * memory. The pool may be destroyed before the images it handed out, their
+ * buffers are then freed normally.
+ *
+ * Free buffers beyond max_cached_per_key or max_cached_bytes are released,
+ * least recently returned first. The pool is thread-safe.
+ */
+class ImagePool
+{
+public:
+  ZE_POINTER_TYPEDEFS(ImagePool);
+
+  struct Options
+  {
+    //! Upper bound on the memory of free buffers held by the pool.
+    size_t max_cached_bytes = 256u * 1024u * 1024u;
+    //! Upper bound on the free buffers per (size, pixel type, pitch, policy).
+    uint32_t max_cached_per_key = 8u;
+  };
+
+  struct Statistics
+  {
+    uint64_t num_allocations = 0u; //!< Buffers allocated because none was free.
+    uint64_t num_reuses = 0u;      //!< Acquisitions served from a free buffer.
+    uint64_t num_released = 0u;    //!< Free buffers released by the limits or trim().
+    size_t cached_bytes = 0u;      //!< Memory of the free buffers.
+    size_t num_cached = 0u;        //!< Number of free buffers.
+  };
+
+  ImagePool();
+  explicit ImagePool(const Options& options);
+  ~ImagePool();
+
+  ImagePool(const ImagePool&) = delete;
+  ImagePool& operator=(const ImagePool&) = delete;
+
+  /**
+   * @brief acquire returns an image of the given \a size backed by a pooled buffer
+   * @note The pixel values are not initialized.
+   */
+  template<typename Pixel>
+  ImageRawPtr<Pixel> acquire(const Size2u& size,
+                             PixelOrder pixel_order = PixelOrder::undefined,
+                             const AllocationPolicy& policy = defaultAllocationPolicy())
+  {
+    const uint32_t pitch = MemoryStorage<Pixel>::alignedPitch(
+          size.width(), pitchAlignment(policy, MemoryStorage<Pixel>::c_alignment));
+    std::shared_ptr<void> buffer = acquireBuffer(
+          size, pixel_type<Pixel>::type, pitch, policy, &allocate<Pixel>);
+    return std::make_shared<ImageRaw<Pixel>>(
+          static_cast<Pixel*>(buffer.get()), size.width(), size.height(),
+          pitch, buffer, pixel_order);
+  }
+
+  //! Releases free buffers, least recently returned first, until at most
+  //! \a max_cached_bytes are held.
+  void trim(size_t max_cached_bytes = 0u);
+
+  Statistics statistics() const;
+
+  const Options& options() const;
+
+  //! Process-wide pool used by the image bridges and data providers.
+  static ImagePool& global();
+
+private:
+  using Allocator = void* (*)(const Size2u& size, const AllocationPolicy& policy);
+
+  template<typename Pixel>
+  static void* allocate(const Size2u& size, const AllocationPolicy& policy)
+  {
+    uint32_t pitch;
+    return MemoryStorage<Pixel>::alignedAlloc(size, &pitch, policy);
+  }
+
+  std::shared_ptr<void> acquireBuffer(
+      const Size2u& size, PixelType pixel_type, uint32_t pitch,
+      const AllocationPolicy& policy, Allocator allocator);
+
+  struct Impl;
+  std::shared_ptr<Impl> impl_;
+};
+
+} // namespace ze
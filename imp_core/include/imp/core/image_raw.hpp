@@ -69,6 +69,14 @@ public:
   ImageRaw(const ze::Size2u& size,
            PixelOrder pixel_order = ze::PixelOrder::undefined);
 
+  /**
+   * @brief ImageRaw construcs an image of given \a size allocated according to \a policy
+   * (e.g. backed by huge pages or bound to a NUMA node).
+   */
+  ImageRaw(const ze::Size2u& size,
+           const AllocationPolicy& policy,
+           PixelOrder pixel_order = ze::PixelOrder::undefined);
+
   /**
    * @brief ImageRaw construcs an image of given size \a width x \a height
    */
@@ -124,6 +132,9 @@ public:
   virtual const Pixel* data(uint32_t ox = 0, uint32_t oy = 0) const override;
 
 protected:
+  //! Allocates data_ for the current size and sets the pitch.
+  void allocate(const AllocationPolicy& policy);
+
   std::unique_ptr<Pixel, Deallocator> data_; //!< the actual image data
   std::shared_ptr<void const> tracked_ = nullptr; //!< tracked object to share memory
 };
@@ -156,6 +167,11 @@ typedef ImageRaw<ze::Pixel32fC2> ImageRaw32fC2;
 typedef ImageRaw<ze::Pixel32fC3> ImageRaw32fC3;
 typedef ImageRaw<ze::Pixel32fC4> ImageRaw32fC4;
 
+typedef ImageRaw<ze::Pixel16fC1> ImageRaw16fC1;
+typedef ImageRaw<ze::Pixel16fC2> ImageRaw16fC2;
+typedef ImageRaw<ze::Pixel16fC3> ImageRaw16fC3;
+typedef ImageRaw<ze::Pixel16fC4> ImageRaw16fC4;
+
 // shared pointers
 template <typename Pixel>
 using ImageRawPtr = typename ImageRaw<Pixel>::Ptr;
@@ -163,5 +179,36 @@ using ImageRawPtr = typename ImageRaw<Pixel>::Ptr;
 template <typename Pixel>
 using ImageRawConstPtr = typename ImageRaw<Pixel>::ConstPtr;
 
+//-----------------------------------------------------------------------------
+/**
+ * @brief subImage returns the region \a roi of \a image as an image sharing
+ *        the pixels of \a image, e.g., for patches, tiles or rectified crops.
+ *
+ * Nothing is copied. The sub-image has the pitch of \a image and keeps
+ * \a image alive. Writing to the sub-image writes to \a image.
+ */
+template<typename ImageT>
+typename ImageRaw<typename ImageT::pixel_t>::Ptr
+subImage(const std::shared_ptr<ImageT>& image, const Roi2u& roi)
+{
+  CHECK(image);
+  CHECK(!image->isGpuMemory());
+  CHECK_GT(roi.width(), 0u);
+  CHECK_GT(roi.height(), 0u);
+  CHECK_LE(roi.x() + roi.width(), image->width());
+  CHECK_LE(roi.y() + roi.height(), image->height());
+  return std::make_shared<ImageRaw<typename ImageT::pixel_t>>(
+        image->data(roi.x(), roi.y()), roi.width(), roi.height(),
+        image->pitch(), image, image->pixelOrder());
+}
+
+//! Read-only sub-image of a const image.
+template<typename ImageT>
+typename ImageRaw<typename ImageT::pixel_t>::ConstPtr
+subImage(const std::shared_ptr<const ImageT>& image, const Roi2u& roi)
+{
+  return subImage(std::const_pointer_cast<ImageT>(image), roi);
+}
+
 } // namespace ze
 
@@ -0,0 +1,272 @@
+// Copyright (c) 2015-2016, ETH Zurich, Wyss Zurich, Zurich Eye
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the ETH Zurich, Wyss Zurich, Zurich Eye nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL ETH Zurich, Wyss Zurich, Zurich Eye BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <type_traits>
+
+#include <ze/common/logging.hpp>
+#include <imp/core/roi.hpp>
+#include <imp/core/size.hpp>
+
+//! @file image_view.hpp
+//! Non-owning, non-virtual views of CPU image memory. Accessing pixels through
+//! a view costs a multiply-add, bounds are only checked in debug builds.
+
+namespace ze {
+
+//------------------------------------------------------------------------------
+/**
+ * @brief The ImageRowSpan class is a contiguous range of pixels of one row.
+ */
+template<typename Pixel>
+class ImageRowSpan
+{
+public:
+  ImageRowSpan(Pixel* data, uint32_t width)
+    : data_(data)
+    , width_(width)
+  {}
+
+  inline Pixel* begin() const { return data_; }
+  inline Pixel* end() const { return data_ + width_; }
+  inline uint32_t size() const { return width_; }
+
+  inline Pixel& operator[](uint32_t x) const
+  {
+    DCHECK_LT(x, width_);
+    return data_[x];
+  }
+
+private:
+  Pixel* data_;
+  uint32_t width_;
+};
+
+//------------------------------------------------------------------------------
+/**
+ * @brief The ImageViewIterator class iterates row-major over all pixels of a
+ *        view and skips the row padding. x() and y() return the position.
+ */
+template<typename Pixel>
+class ImageViewIterator
+{
+public:
+  using iterator_category = std::forward_iterator_tag;
+  using value_type = typename std::remove_const<Pixel>::type;
+  using difference_type = std::ptrdiff_t;
+  using pointer = Pixel*;
+  using reference = Pixel&;
+
+  ImageViewIterator(Pixel* ptr, uint32_t x, uint32_t y,
+                    uint32_t width, size_t stride)
+    : ptr_(ptr)
+    , x_(x)
+    , y_(y)
+    , width_(width)
+    , row_skip_(stride - width)
+  {}
+
+  inline reference operator*() const { return *ptr_; }
+  inline pointer operator->() const { return ptr_; }
+
+  inline ImageViewIterator& operator++()
+  {
+    ++ptr_;
+    if (++x_ == width_)
+    {
+      x_ = 0u;
+      ++y_;
+      ptr_ += row_skip_;
+    }
+    return *this;
+  }
+
+  inline ImageViewIterator operator++(int)
+  {
+    ImageViewIterator it = *this;
+    ++(*this);
+    return it;
+  }
+
+  inline bool operator==(const ImageViewIterator& rhs) const { return ptr_ == rhs.ptr_; }
+  inline bool operator!=(const ImageViewIterator& rhs) const { return ptr_ != rhs.ptr_; }
+
+  inline uint32_t x() const { return x_; }
+  inline uint32_t y() const { return y_; }
+
+private:
+  Pixel* ptr_;
+  uint32_t x_;
+  uint32_t y_;
+  uint32_t width_;
+  size_t row_skip_;
+};
+
+//------------------------------------------------------------------------------
+/**
+ * @brief The ImageView class references the pixels of an image in CPU memory
+ *        by pointer, size and stride. Use ImageView<const Pixel> for reading.
+ *
+ * Views are cheap to copy and should be passed by value. They do not keep the
+ * image alive.
+ */
+template<typename Pixel>
+class ImageView
+{
+public:
+  using pixel_t = Pixel;
+  using iterator = ImageViewIterator<Pixel>;
+
+  ImageView() = default;
+
+  /**
+   * @param data Pointer to the first pixel.
+   * @param width Image width.
+   * @param height Image height.
+   * @param stride Distance between the starts of consecutive rows in pixels.
+   */
+  ImageView(Pixel* data, uint32_t width, uint32_t height, size_t stride)
+    : data_(data)
+    , width_(width)
+    , height_(height)
+    , stride_(stride)
+  {
+    DCHECK_GE(stride_, width_);
+  }
+
+  //! Views of mutable pixels convert to views of const pixels.
+  template<typename OtherPixel,
+           typename = typename std::enable_if<
+             std::is_same<const OtherPixel, Pixel>::value>::type>
+  ImageView(const ImageView<OtherPixel>& other)
+    : ImageView(other.data(), other.width(), other.height(), other.stride())
+  {}
+
+  inline Pixel* data() const { return data_; }
+  inline uint32_t width() const { return width_; }
+  inline uint32_t height() const { return height_; }
+  inline Size2u size() const { return Size2u(width_, height_); }
+  inline size_t stride() const { return stride_; }
+  inline size_t pitch() const { return stride_ * sizeof(Pixel); }
+  inline bool empty() const { return width_ == 0u || height_ == 0u; }
+
+  //! True if the rows are not padded, i.e., all pixels are one range.
+  inline bool isContiguous() const { return stride_ == width_; }
+
+  inline Pixel* row(uint32_t y) const
+  {
+    DCHECK_LT(y, height_);
+    return data_ + y * stride_;
+  }
+
+  inline ImageRowSpan<Pixel> rowSpan(uint32_t y) const
+  {
+    return ImageRowSpan<Pixel>(row(y), width_);
+  }
+
+  //! Enables the usage of the [y][x] operator.
+  inline Pixel* operator[](uint32_t y) const
+  {
+    return row(y);
+  }
+
+  inline Pixel& operator()(uint32_t x, uint32_t y) const
+  {
+    DCHECK_LT(x, width_);
+    return row(y)[x];
+  }
+
+  inline iterator begin() const
+  {
+    return empty() ? end() : iterator(data_, 0u, 0u, width_, stride_);
+  }
+
+  inline iterator end() const
+  {
+    return iterator(data_ + height_ * stride_, 0u, height_, width_, stride_);
+  }
+
+  //! View of the \a width x \a height pixels starting at (x, y). No pixels are
+  //! copied, the sub-view has the stride of this view.
+  inline ImageView subView(uint32_t x, uint32_t y,
+                           uint32_t width, uint32_t height) const
+  {
+    CHECK_LE(x + width, width_);
+    CHECK_LE(y + height, height_);
+    return ImageView(data_ + y * stride_ + x, width, height, stride_);
+  }
+
+  inline ImageView subView(const Roi2u& roi) const
+  {
+    return subView(roi.x(), roi.y(), roi.width(), roi.height());
+  }
+
+  //! Applies fun(Pixel&) to all pixels, row by row.
+  template<typename Fun>
+  void forEach(Fun fun) const
+  {
+    for (uint32_t y = 0u; y < height_; ++y)
+    {
+      Pixel* r = row(y);
+      for (uint32_t x = 0u; x < width_; ++x)
+      {
+        fun(r[x]);
+      }
+    }
+  }
+
+private:
+  Pixel* data_ = nullptr;
+  uint32_t width_ = 0u;
+  uint32_t height_ = 0u;
+  size_t stride_ = 0u;
+};
+
+//------------------------------------------------------------------------------
+//! Copies the pixels of src to dst, row by row if either one is padded.
+template<typename SrcPixel, typename Pixel>
+void copyView(ImageView<SrcPixel> src, ImageView<Pixel> dst)
+{
+  static_assert(std::is_same<typename std::remove_const<SrcPixel>::type, Pixel>::value,
+                "Views must have the same pixel type.");
+  CHECK_EQ(src.width(), dst.width());
+  CHECK_EQ(src.height(), dst.height());
+  if (src.isContiguous() && dst.isContiguous())
+  {
+    std::copy(src.data(), src.data() + src.width() * src.height(), dst.data());
+    return;
+  }
+  for (uint32_t y = 0u; y < src.height(); ++y)
+  {
+    std::copy(src.row(y), src.row(y) + src.width(), dst.row(y));
+  }
+}
+
+} // namespace ze
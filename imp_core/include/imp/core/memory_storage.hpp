@@ -32,6 +32,7 @@
 
 #include <ze/common/logging.hpp>
 #include <ze/common/types.hpp>
+#include <imp/core/allocation_policy.hpp>
 #include <imp/core/size.hpp>
 #include <imp/core/types.hpp>
 
@@ -45,6 +46,9 @@ public:
   MemoryStorage() = delete;
   virtual ~MemoryStorage() = delete;
 
+  //! Default alignment of the data pointer and the rows in bytes.
+  static constexpr uint32_t c_alignment = memaddr_align;
+
   /**
    * @brief isAligned checks if the given data pointer \a p is aligned according to \a memaddr_align
    */
@@ -113,14 +117,41 @@ public:
     assert((memaddr_align != 0) && memaddr_align <= 128 &&
            ((memaddr_align & (~memaddr_align + 1)) == memaddr_align));
 
+    *pitch = alignedPitch(size.width());
+    return alignedAlloc(*pitch/sizeof(Pixel)*size.height(), init_with_zeros);
+  }
+
+  /**
+   * @brief alignedAlloc allocates an image of size \a size according to \a policy
+   * @param size Image size
+   * @param pitch Row length [bytes], aligned as required by the policy.
+   * @param policy Page backing, NUMA binding and pitch alignment.
+   * @note Release the memory with free(buffer, size, pitch, policy).
+   */
+  static Pixel* alignedAlloc(
+      ze::Size2u size, uint32_t* pitch, const AllocationPolicy& policy)
+  {
+    CHECK_GT(size.width(), 0u);
+    CHECK_GT(size.height(), 0u);
+    const uint32_t alignment = pitchAlignment(policy, memaddr_align);
+    *pitch = alignedPitch(size.width(), alignment);
+    return static_cast<Pixel*>(allocateAligned(
+          static_cast<size_t>(*pitch) * size.height(), alignment, policy));
+  }
+
+  /**
+   * @brief alignedPitch returns the row length in bytes used by alignedAlloc
+   * @param width Image width in pixels
+   * @param alignment Row alignment in bytes
+   */
+  static uint32_t alignedPitch(uint32_t width, uint32_t alignment = memaddr_align)
+  {
     // check if the width allows a correct alignment of every row, otherwise add padding
-    const uint32_t width_bytes = size.width() * sizeof(Pixel);
-    // bytes % memaddr_align = 0 for bytes=n*memaddr_align is the reason for
+    const uint32_t width_bytes = width * sizeof(Pixel);
+    // bytes % alignment = 0 for bytes=n*alignment is the reason for
     // the decrement in the following compution:
-    const uint32_t bytes_to_add = (memaddr_align-1) - ((width_bytes-1) % memaddr_align);
-    const uint32_t pitched_width = size.width() + bytes_to_add/sizeof(Pixel);
-    *pitch = width_bytes + bytes_to_add;
-    return alignedAlloc(pitched_width*size.height(), init_with_zeros);
+    const uint32_t bytes_to_add = (alignment-1) - ((width_bytes-1) % alignment);
+    return width_bytes + bytes_to_add;
   }
 
 
@@ -130,7 +161,16 @@ public:
    */
   static void free(Pixel* buffer)
   {
-    free(buffer);
+    ::free(buffer);
+  }
+
+  /**
+   * @brief free releases the pixel \a buffer allocated with \a policy
+   */
+  static void free(Pixel* buffer, const ze::Size2u& size, uint32_t pitch,
+                   const AllocationPolicy& policy)
+  {
+    freeAligned(buffer, static_cast<size_t>(pitch) * size.height(), policy);
   }
 }; // struct MemoryStorage
 
@@ -26,6 +26,7 @@
 
 #include <cstdint>
 #include <cmath>
+#include <imp/core/half.hpp>
 #include <imp/core/pixel_enums.hpp>
 #include <ze/common/types.hpp>
 
@@ -316,6 +317,11 @@ typedef Pixel2<float> Pixel32fC2;
 typedef Pixel3<float> Pixel32fC3;
 typedef Pixel4<float> Pixel32fC4;
 
+typedef Pixel1<Half> Pixel16fC1;
+typedef Pixel2<Half> Pixel16fC2;
+typedef Pixel3<Half> Pixel16fC3;
+typedef Pixel4<Half> Pixel16fC4;
+
 
 // vector types (same as pixel)
 template<typename T> using Vec1 = Pixel1<T>;
@@ -381,6 +387,11 @@ template<> struct pixel_type <Pixel32fC2> { static constexpr PixelType type = Pi
 template<> struct pixel_type <Pixel32fC3> { static constexpr PixelType type = PixelType::i32fC3; };
 template<> struct pixel_type <Pixel32fC4> { static constexpr PixelType type = PixelType::i32fC4; };
 
+template<> struct pixel_type <Pixel16fC1> { static constexpr PixelType type = PixelType::i16fC1; };
+template<> struct pixel_type <Pixel16fC2> { static constexpr PixelType type = PixelType::i16fC2; };
+template<> struct pixel_type <Pixel16fC3> { static constexpr PixelType type = PixelType::i16fC3; };
+template<> struct pixel_type <Pixel16fC4> { static constexpr PixelType type = PixelType::i16fC4; };
+
 //------------------------------------------------------------------------------
 // comparison operators
 template<typename T>
@@ -0,0 +1,177 @@
+// Copyright (c) 2015-2016, ETH Zurich, Wyss Zurich, Zurich Eye
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the ETH Zurich, Wyss Zurich, Zurich Eye nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL ETH Zurich, Wyss Zurich, Zurich Eye BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#pragma once
+
+#include <cstddef>
+#include <functional>
+
+#include <imp/core/half.hpp>
+#include <imp/core/image.hpp>
+#include <imp/core/pixel.hpp>
+#include <imp/core/pixel_enums.hpp>
+
+//! @file pixel_conversion.hpp
+//! Bulk conversions between pixel types and formats of CPU images. The kernels
+//! use SIMD instructions where the build enables them (SSE2, SSSE3, AVX2 and
+//! F16C with ZE_USE_AVX2, NEON) and portable code otherwise. All image
+//! functions work on the regions of interest and take an optional thread pool
+//! to process bands of rows in parallel.
+
+namespace ze {
+
+class ThreadPool;
+
+//------------------------------------------------------------------------------
+// Array kernels.
+
+//! Converts \a n half-precision values to float.
+void convertHalfToFloat(const Half* src, float* dst, size_t n);
+
+//! Converts \a n floats to half precision, rounding to nearest even.
+void convertFloatToHalf(const float* src, Half* dst, size_t n);
+
+//! dst[i] = scale * src[i] + offset
+void convert8uTo32f(const uint8_t* src, float* dst, size_t n, float scale, float offset);
+
+//! dst[i] = scale * src[i] + offset
+void convert16uTo32f(const uint16_t* src, float* dst, size_t n, float scale, float offset);
+
+namespace internal {
+
+//! Calls fun(y_begin, y_end) for bands of rows that cover [0, height), in
+//! parallel if a pool is given.
+void forEachRowBand(uint32_t height, ThreadPool* pool,
+                    const std::function<void(uint32_t, uint32_t)>& fun);
+
+//! Applies the array kernel fun(src, dst, n) to all rows, or once to all
+//! pixels if both views are contiguous.
+template<typename SrcPixel, typename DstPixel, typename RowFun>
+void convertRows(ImageView<const SrcPixel> src, ImageView<DstPixel> dst,
+                 ThreadPool* pool, RowFun fun)
+{
+  static_assert(sizeof(SrcPixel) / sizeof(typename SrcPixel::T)
+                == sizeof(DstPixel) / sizeof(typename DstPixel::T),
+                "Pixels must have the same number of channels.");
+  CHECK_EQ(src.size(), dst.size());
+  const size_t channels = sizeof(SrcPixel) / sizeof(typename SrcPixel::T);
+  if (src.isContiguous() && dst.isContiguous() && !pool)
+  {
+    fun(reinterpret_cast<const typename SrcPixel::T*>(src.data()),
+        reinterpret_cast<typename DstPixel::T*>(dst.data()),
+        channels * src.width() * src.height());
+    return;
+  }
+  forEachRowBand(src.height(), pool, [&](uint32_t y_begin, uint32_t y_end)
+  {
+    for (uint32_t y = y_begin; y < y_end; ++y)
+    {
+      fun(reinterpret_cast<const typename SrcPixel::T*>(src.row(y)),
+          reinterpret_cast<typename DstPixel::T*>(dst.row(y)),
+          channels * src.width());
+    }
+  });
+}
+
+} // namespace internal
+
+//------------------------------------------------------------------------------
+// Image conversions (region of interest to region of interest).
+
+/**
+ * @brief convertImage converts the region of interest of a 32f image to the
+ *        region of interest of a 16f image with the same number of channels.
+ */
+template<template<typename> class PixelN>
+void convertImage(const Image<PixelN<float>>& src, Image<PixelN<Half>>& dst,
+                  ThreadPool* pool = nullptr)
+{
+  CHECK_EQ(src.roi().size(), dst.roi().size());
+  internal::convertRows(src.roiView(), dst.roiView(), pool, &convertFloatToHalf);
+}
+
+//! Converts the region of interest of a 16f image to a 32f image.
+template<template<typename> class PixelN>
+void convertImage(const Image<PixelN<Half>>& src, Image<PixelN<float>>& dst,
+                  ThreadPool* pool = nullptr)
+{
+  CHECK_EQ(src.roi().size(), dst.roi().size());
+  internal::convertRows(src.roiView(), dst.roiView(), pool, &convertHalfToFloat);
+}
+
+//! Converts 8u to 32f pixels: dst = scale * src + offset, e.g., scale 1/255
+//! for intensities in [0, 1].
+template<template<typename> class PixelN>
+void convertImage(const Image<PixelN<uint8_t>>& src, Image<PixelN<float>>& dst,
+                  float scale = 1.0f, float offset = 0.0f,
+                  ThreadPool* pool = nullptr)
+{
+  CHECK_EQ(src.roi().size(), dst.roi().size());
+  internal::convertRows(src.roiView(), dst.roiView(), pool,
+                        [scale, offset](const uint8_t* s, float* d, size_t n)
+  { convert8uTo32f(s, d, n, scale, offset); });
+}
+
+//! Converts 16u to 32f pixels: dst = scale * src + offset.
+template<template<typename> class PixelN>
+void convertImage(const Image<PixelN<uint16_t>>& src, Image<PixelN<float>>& dst,
+                  float scale = 1.0f, float offset = 0.0f,
+                  ThreadPool* pool = nullptr)
+{
+  CHECK_EQ(src.roi().size(), dst.roi().size());
+  internal::convertRows(src.roiView(), dst.roiView(), pool,
+                        [scale, offset](const uint16_t* s, float* d, size_t n)
+  { convert16uTo32f(s, d, n, scale, offset); });
+}
+
+/**
+ * @brief convertToGray converts color to gray with the BT.601 weights
+ *        (0.299 R + 0.587 G + 0.114 B, like cv::cvtColor).
+ *
+ * The channel order is taken from the pixel order of \a src: rgb / rgba, all
+ * others are treated as bgr / bgra (the OpenCV default).
+ */
+void convertToGray(const Image8uC3& src, Image8uC1& dst, ThreadPool* pool = nullptr);
+void convertToGray(const Image8uC4& src, Image8uC1& dst, ThreadPool* pool = nullptr);
+
+/**
+ * @brief demosaic interpolates a raw Bayer image bilinearly
+ * @param pattern Colors of the top-left 2x2 block of the region of interest.
+ *
+ * The color output is written in the pixel order of \a dst: rgb, all others
+ * are treated as bgr like in convertToGray(). Borders are mirrored such that the colors of the Bayer
+ * pattern are kept. Width and height must be at least 2.
+ */
+void demosaic(const Image8uC1& src, Image8uC3& dst, BayerPattern pattern,
+              ThreadPool* pool = nullptr);
+
+//! Bilinear demosaicing and conversion to gray in one pass.
+void demosaicToGray(const Image8uC1& src, Image8uC1& dst, BayerPattern pattern,
+                    ThreadPool* pool = nullptr);
+
+//! Extracts the luma of a packed YUV 4:2:2 image.
+void convertYuv422ToGray(const Image8uC2& src, Image8uC1& dst, Yuv422Layout layout,
+                         ThreadPool* pool = nullptr);
+
+} // namespace ze
@@ -55,7 +55,11 @@ enum class PixelType
   i32fC1, //!< interleaved, 32-bit float, 1 channel
   i32fC2, //!< interleaved, 32-bit float, 2 channel
   i32fC3, //!< interleaved, 32-bit float, 3 channel
-  i32fC4  //!< interleaved, 32-bit float, 4 channel
+  i32fC4, //!< interleaved, 32-bit float, 4 channel
+  i16fC1, //!< interleaved, 16-bit float, 1 channel
+  i16fC2, //!< interleaved, 16-bit float, 2 channel
+  i16fC3, //!< interleaved, 16-bit float, 3 channel
+  i16fC4  //!< interleaved, 16-bit float, 4 channel
 };
 
 /**
@@ -71,6 +75,28 @@ enum class PixelOrder
   bgra   //!< 3-channel BGRA
 };
 
+/**
+ * @brief The BayerPattern enum defines the colors of the top-left 2x2 block
+ *        of a raw Bayer image (8-bit, single channel).
+ */
+enum class BayerPattern
+{
+  RGGB,
+  BGGR,
+  GRBG,
+  GBRG
+};
+
+/**
+ * @brief The Yuv422Layout enum defines the byte order of packed YUV 4:2:2
+ *        images (8-bit, 2 channels: luma and alternating chroma).
+ */
+enum class Yuv422Layout
+{
+  YUYV, //!< Y0 U Y1 V (also YUY2)
+  UYVY  //!< U Y0 V Y1 (ROS yuv422)
+};
+
 
 } // namespace ze
 
@@ -0,0 +1,468 @@
+// Copyright (c) 2015-2016, ETH Zurich, Wyss Zurich, Zurich Eye
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the ETH Zurich, Wyss Zurich, Zurich Eye nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL ETH Zurich, Wyss Zurich, Zurich Eye BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <type_traits>
+
+#include <imp/core/image.hpp>
+#include <imp/core/image_view.hpp>
+#include <imp/core/roi.hpp>
+#include <imp/core/types.hpp>
+#include <ze/common/logging.hpp>
+
+namespace ze {
+
+// fwd
+class ThreadPool;
+
+//------------------------------------------------------------------------------
+// Stages
+
+/**
+ * @brief The PointStage class computes each output pixel from the input pixel
+ *        at the same position, out = fun(in).
+ */
+template<typename InPixel, typename OutPixel, typename Fun>
+class PointStage
+{
+public:
+  using in_t = InPixel;
+  using out_t = OutPixel;
+
+  explicit PointStage(Fun fun) : fun_(fun) {}
+
+  inline uint32_t radius() const { return 0u; }
+
+  //! \a in and \a out have the same size.
+  void apply(const ImageView<const InPixel>& in, const ImageView<OutPixel>& out) const
+  {
+    for (uint32_t y = 0u; y < out.height(); ++y)
+    {
+      const InPixel* in_row = in.row(y);
+      OutPixel* out_row = out.row(y);
+      for (uint32_t x = 0u; x < out.width(); ++x)
+      {
+        out_row[x] = fun_(in_row[x]);
+      }
+    }
+  }
+
+private:
+  Fun fun_;
+};
+
+//! Read access to the neighbors of a pixel, n(dx, dy) for |dx|, |dy| <= radius.
+template<typename Pixel>
+class Neighborhood
+{
+public:
+  Neighborhood(const Pixel* center, size_t stride)
+    : center_(center)
+    , stride_(static_cast<ptrdiff_t>(stride))
+  {}
+
+  inline const Pixel& operator()(int dx, int dy) const
+  {
+    return center_[dy * stride_ + dx];
+  }
+
+private:
+  const Pixel* center_;
+  ptrdiff_t stride_;
+};
+
+/**
+ * @brief The StencilStage class computes each output pixel from the input
+ *        pixels within radius, out = fun(Neighborhood<InPixel>).
+ */
+template<typename InPixel, typename OutPixel, typename Fun>
+class StencilStage
+{
+public:
+  using in_t = InPixel;
+  using out_t = OutPixel;
+
+  StencilStage(uint32_t radius, Fun fun) : radius_(radius), fun_(fun) {}
+
+  inline uint32_t radius() const { return radius_; }
+
+  //! \a in is \a out expanded by radius on each side.
+  void apply(const ImageView<const InPixel>& in, const ImageView<OutPixel>& out) const
+  {
+    DEBUG_CHECK_EQ(in.width(), out.width() + 2u * radius_);
+    DEBUG_CHECK_EQ(in.height(), out.height() + 2u * radius_);
+    for (uint32_t y = 0u; y < out.height(); ++y)
+    {
+      const InPixel* center = in.row(y + radius_) + radius_;
+      OutPixel* out_row = out.row(y);
+      for (uint32_t x = 0u; x < out.width(); ++x)
+      {
+        out_row[x] = fun_(Neighborhood<InPixel>(center + x, in.stride()));
+      }
+    }
+  }
+
+private:
+  uint32_t radius_;
+  Fun fun_;
+};
+
+//! Usage: pointStage<Pixel8uC1, Pixel32fC1>([](const Pixel8uC1& p) { ... })
+template<typename InPixel, typename OutPixel, typename Fun>
+PointStage<InPixel, OutPixel, Fun> pointStage(Fun fun)
+{
+  return PointStage<InPixel, OutPixel, Fun>(fun);
+}
+
+//! Usage: stencilStage<Pixel32fC1, Pixel32fC1>(1, [](const Neighborhood<Pixel32fC1>& n) { ... })
+template<typename InPixel, typename OutPixel, typename Fun>
+StencilStage<InPixel, OutPixel, Fun> stencilStage(uint32_t radius, Fun fun)
+{
+  return StencilStage<InPixel, OutPixel, Fun>(radius, fun);
+}
+
+//------------------------------------------------------------------------------
+namespace internal {
+
+//! Half-open rectangle [x0, x1) x [y0, y1), may reach outside of the image.
+struct TileRect
+{
+  int64_t x0, y0, x1, y1;
+
+  inline uint32_t width() const { return static_cast<uint32_t>(x1 - x0); }
+  inline uint32_t height() const { return static_cast<uint32_t>(y1 - y0); }
+
+  inline TileRect expanded(uint32_t r) const
+  {
+    return TileRect{x0 - r, y0 - r, x1 + r, y1 + r};
+  }
+
+  inline TileRect clipped(const Size2u& size) const
+  {
+    return TileRect{std::max<int64_t>(x0, 0), std::max<int64_t>(y0, 0),
+                    std::min<int64_t>(x1, size.width()),
+                    std::min<int64_t>(y1, size.height())};
+  }
+};
+
+//! Maps a coordinate to [0, n), returns -1 for Constant outside of the image.
+inline int64_t borderIndex(int64_t i, uint32_t n, BorderMode border)
+{
+  if (i >= 0 && i < n)
+  {
+    return i;
+  }
+  switch (border)
+  {
+    case BorderMode::Replicate:
+      return i < 0 ? 0 : n - 1;
+    case BorderMode::Reflect:
+    {
+      if (n == 1u)
+      {
+        return 0;
+      }
+      // Reflection is periodic with 2 * (n - 1).
+      const int64_t period = 2 * (static_cast<int64_t>(n) - 1);
+      int64_t j = i % period;
+      j = j < 0 ? j + period : j;
+      return j < n ? j : period - j;
+    }
+    case BorderMode::Constant:
+      return -1;
+  }
+  return -1;
+}
+
+template<typename Pixel>
+inline Pixel borderPixel(double value)
+{
+  return Pixel(static_cast<typename Pixel::T>(value));
+}
+
+//! Thread local scratch memory, 32 byte aligned. Index 0 and 1 are used
+//! alternately by the stages of a tile, the memory stays valid until the
+//! next call with the same index on the same thread.
+uint8_t* tileScratch(int index, size_t bytes);
+
+template<typename Pixel>
+ImageView<Pixel> tileBuffer(int index, uint32_t width, uint32_t height)
+{
+  return ImageView<Pixel>(
+        reinterpret_cast<Pixel*>(tileScratch(index, sizeof(Pixel) * width * height)),
+        width, height, width);
+}
+
+//! Copies the pixels of \a rect (in image coordinates) from \a src to \a dst,
+//! pixels outside of the image are defined by the border mode.
+template<typename Pixel>
+void gatherTile(const ImageView<const Pixel>& src, const TileRect& rect,
+                BorderMode border, double border_value, const ImageView<Pixel>& dst)
+{
+  const TileRect inside = rect.clipped(src.size());
+  const Pixel constant = borderPixel<Pixel>(border_value);
+  for (int64_t y = rect.y0; y < rect.y1; ++y)
+  {
+    Pixel* dst_row = dst.row(static_cast<uint32_t>(y - rect.y0));
+    const int64_t sy = borderIndex(y, src.height(), border);
+    if (sy < 0)
+    {
+      std::fill(dst_row, dst_row + rect.width(), constant);
+      continue;
+    }
+    const Pixel* src_row = src.row(static_cast<uint32_t>(sy));
+    for (int64_t x = rect.x0; x < inside.x0; ++x)
+    {
+      const int64_t sx = borderIndex(x, src.width(), border);
+      dst_row[x - rect.x0] = sx < 0 ? constant : src_row[sx];
+    }
+    std::copy(src_row + inside.x0, src_row + inside.x1, dst_row + (inside.x0 - rect.x0));
+    for (int64_t x = inside.x1; x < rect.x1; ++x)
+    {
+      const int64_t sx = borderIndex(x, src.width(), border);
+      dst_row[x - rect.x0] = sx < 0 ? constant : src_row[sx];
+    }
+  }
+}
+
+//! Fills the pixels of \a buffer (covering \a rect) outside of the image
+//! from the computed pixels inside, such that the next stage sees the same
+//! border as if the stage was run on the whole image.
+template<typename Pixel>
+void fillTileBorder(const ImageView<Pixel>& buffer, const TileRect& rect,
+                    const Size2u& size, BorderMode border, double border_value)
+{
+  const TileRect inside = rect.clipped(size);
+  if (inside.x0 == rect.x0 && inside.y0 == rect.y0
+      && inside.x1 == rect.x1 && inside.y1 == rect.y1)
+  {
+    return;
+  }
+  const Pixel constant = borderPixel<Pixel>(border_value);
+  auto fill = [&](int64_t x, int64_t y)
+  {
+    const int64_t sx = borderIndex(x, size.width(), border);
+    const int64_t sy = borderIndex(y, size.height(), border);
+    Pixel& p = buffer(static_cast<uint32_t>(x - rect.x0),
+                      static_cast<uint32_t>(y - rect.y0));
+    if (sx < 0 || sy < 0)
+    {
+      p = constant;
+      return;
+    }
+    // Reflected coordinates can only leave the buffer if the tile halo is
+    // larger than the image.
+    CHECK(sx >= rect.x0 && sx < rect.x1 && sy >= rect.y0 && sy < rect.y1)
+        << "Tile halo exceeds the image size.";
+    p = buffer(static_cast<uint32_t>(sx - rect.x0), static_cast<uint32_t>(sy - rect.y0));
+  };
+  // Rows inside first, the rows outside then copy complete rows.
+  for (int64_t y = inside.y0; y < inside.y1; ++y)
+  {
+    for (int64_t x = rect.x0; x < inside.x0; ++x) { fill(x, y); }
+    for (int64_t x = inside.x1; x < rect.x1; ++x) { fill(x, y); }
+  }
+  for (int64_t y = rect.y0; y < rect.y1; ++y)
+  {
+    if (y >= inside.y0 && y < inside.y1)
+    {
+      continue;
+    }
+    for (int64_t x = rect.x0; x < rect.x1; ++x) { fill(x, y); }
+  }
+}
+
+inline uint32_t totalRadius()
+{
+  return 0u;
+}
+
+template<typename Stage, typename... Rest>
+uint32_t totalRadius(const Stage& stage, const Rest&... rest)
+{
+  return stage.radius() + totalRadius(rest...);
+}
+
+template<typename Stage, typename... Rest>
+struct LastStage
+{
+  using type = typename LastStage<Rest...>::type;
+};
+
+template<typename Stage>
+struct LastStage<Stage>
+{
+  using type = Stage;
+};
+
+struct TileContext
+{
+  Size2u size;
+  BorderMode border;
+  double border_value;
+};
+
+//! Last stage, writes directly into the destination.
+template<typename Stage>
+void runTileStages(const TileContext& /*ctx*/, const TileRect& tile,
+                   const ImageView<typename Stage::out_t>& dst, int /*buffer_index*/,
+                   const ImageView<const typename Stage::in_t>& in,
+                   const Stage& stage)
+{
+  stage.apply(in, dst.subView(static_cast<uint32_t>(tile.x0),
+                              static_cast<uint32_t>(tile.y0),
+                              tile.width(), tile.height()));
+}
+
+//! Intermediate stage, \a in covers the tile expanded by the radii of this
+//! and all following stages. The output covers the tile expanded by the radii
+//! of the following stages and goes into the other scratch buffer.
+template<typename Stage, typename Next, typename... Rest>
+void runTileStages(const TileContext& ctx, const TileRect& tile,
+                   const ImageView<typename LastStage<Next, Rest...>::type::out_t>& dst,
+                   int buffer_index,
+                   const ImageView<const typename Stage::in_t>& in,
+                   const Stage& stage, const Next& next, const Rest&... rest)
+{
+  static_assert(std::is_same<typename Stage::out_t, typename Next::in_t>::value,
+                "Output pixel type of a stage must be the input of the next one.");
+  using Pixel = typename Stage::out_t;
+  const TileRect out_rect = tile.expanded(totalRadius(next, rest...));
+  const TileRect inside = out_rect.clipped(ctx.size);
+  const uint32_t r = stage.radius();
+  const uint32_t ox = static_cast<uint32_t>(inside.x0 - out_rect.x0);
+  const uint32_t oy = static_cast<uint32_t>(inside.y0 - out_rect.y0);
+
+  ImageView<Pixel> out = tileBuffer<Pixel>(buffer_index, out_rect.width(), out_rect.height());
+  // Only pixels inside the image are computed, the rest is border.
+  stage.apply(in.subView(ox, oy, inside.width() + 2u * r, inside.height() + 2u * r),
+              out.subView(ox, oy, inside.width(), inside.height()));
+  fillTileBorder(out, out_rect, ctx.size, ctx.border, ctx.border_value);
+  runTileStages(ctx, tile, dst, 1 - buffer_index, ImageView<const Pixel>(out),
+                next, rest...);
+}
+
+} // namespace internal
+
+//------------------------------------------------------------------------------
+/**
+ * @brief The TileExecutor class runs a chain of per-pixel and stencil stages
+ *        on an image tile by tile.
+ *
+ * Each tile is read from the source with a halo of the summed stage radii,
+ * then all stages run on the tile with the intermediate results in thread
+ * local buffers, and only the last stage writes to the destination. With the
+ * default 256x64 tiles, the intermediates of 32f stages stay in L2 instead of
+ * making a round trip to memory per stage. Pixels outside of the image are
+ * defined by the border mode, for every stage, such that the result equals
+ * running the stages one after the other on whole images.
+ *
+ * Tiles are processed in parallel if a thread pool is given. The source and
+ * destination must not overlap if any stage has a radius.
+ *
+ * @code
+ * TileExecutor executor(&pool);
+ * executor.run(src, dst,
+ *              pointStage<Pixel8uC1, Pixel32fC1>([](const Pixel8uC1& p)
+ *              { return Pixel32fC1(p.x / 255.0f); }),
+ *              stencilStage<Pixel32fC1, Pixel32fC1>(1, [](const Neighborhood<Pixel32fC1>& n)
+ *              { return Pixel32fC1(n(-1, 0).x + n(0, 0).x + n(1, 0).x); }));
+ * @endcode
+ */
+class TileExecutor
+{
+public:
+  struct Options
+  {
+    //! Tile size in pixels, a width of 0 processes full-width row bands of
+    //! tile_height rows.
+    uint32_t tile_width = 256u;
+    uint32_t tile_height = 64u;
+
+    BorderMode border = BorderMode::Replicate;
+
+    //! Value of all channels outside of the image for BorderMode::Constant.
+    double border_value = 0.0;
+  };
+
+  //! Runs serially if no pool is given.
+  explicit TileExecutor(ThreadPool* pool = nullptr);
+  TileExecutor(ThreadPool* pool, const Options& options);
+
+  inline const Options& options() const { return options_; }
+
+  //! Runs the stages on the views, the borders are the borders of the views.
+  template<typename InPixel, typename OutPixel, typename... Stages>
+  void run(const ImageView<const InPixel>& src, const ImageView<OutPixel>& dst,
+           const Stages&... stages) const
+  {
+    static_assert(sizeof...(Stages) > 0, "At least one stage is required.");
+    static_assert(std::is_same<
+                  typename internal::LastStage<Stages...>::type::out_t, OutPixel>::value,
+                  "Output pixel type of the last stage must match the destination.");
+    CHECK_EQ(src.size(), dst.size());
+    const uint32_t halo = internal::totalRadius(stages...);
+    CHECK(halo == 0u
+          || static_cast<const void*>(src.data()) != static_cast<const void*>(dst.data()))
+        << "Stencil stages can not run in place.";
+
+    const internal::TileContext ctx{src.size(), options_.border, options_.border_value};
+    forEachTile(src.size(), [&](const Roi2u& roi)
+    {
+      const internal::TileRect tile{roi.x(), roi.y(),
+                                    int64_t{roi.x()} + roi.width(),
+                                    int64_t{roi.y()} + roi.height()};
+      const internal::TileRect in_rect = tile.expanded(halo);
+      ImageView<InPixel> in =
+          internal::tileBuffer<InPixel>(0, in_rect.width(), in_rect.height());
+      internal::gatherTile(src, in_rect, ctx.border, ctx.border_value, in);
+      internal::runTileStages(ctx, tile, dst, 1, ImageView<const InPixel>(in),
+                              stages...);
+    });
+  }
+
+  //! Runs the stages on the regions of interest of the images.
+  template<typename InPixel, typename OutPixel, typename... Stages>
+  void run(const Image<InPixel>& src, Image<OutPixel>& dst, const Stages&... stages) const
+  {
+    run(src.roiView(), dst.roiView(), stages...);
+  }
+
+  //! Calls fun for every tile of an image of the given size, in parallel if
+  //! a pool is given. Blocks until all tiles are done, an exception of fun is
+  //! rethrown once all tasks have stopped. Must not be called from a task of
+  //! the same pool, which would wait for tasks queued behind itself.
+  void forEachTile(const Size2u& size, const std::function<void(const Roi2u&)>& fun) const;
+
+private:
+  ThreadPool* pool_ = nullptr;
+  Options options_;
+};
+
+} // namespace ze
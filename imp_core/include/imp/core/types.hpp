@@ -36,6 +36,14 @@ enum class InterpolationMode
   CubicSpline
 };
 
+//! How pixels outside of the image are defined for neighborhood operations.
+enum class BorderMode
+{
+  Replicate, //!< Repeat the edge pixel: aaa|abcd|ddd
+  Reflect,   //!< Mirror without repeating the edge pixel: dcb|abcd|cba
+  Constant   //!< A constant value: kkk|abcd|kkk
+};
+
 enum class MemoryType
 {
   Undefined,
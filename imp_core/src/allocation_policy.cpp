@@ -0,0 +1,187 @@
+// Copyright (c) 2015-2016, ETH Zurich, Wyss Zurich, Zurich Eye
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the ETH Zurich, Wyss Zurich, Zurich Eye nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL ETH Zurich, Wyss Zurich, Zurich Eye BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <imp/core/allocation_policy.hpp>
+
+#include <new>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <ze/common/logging.hpp>
+
+// Avoid a dependency on libnuma for mbind().
+#ifndef MPOL_BIND
+#define MPOL_BIND 2
+#endif
+
+namespace ze {
+
+namespace {
+
+constexpr size_t c_page_size = 4096u;
+constexpr size_t c_huge_page_size = 2u * 1024u * 1024u;
+
+AllocationPolicy g_default_policy;
+
+inline size_t roundUp(size_t bytes, size_t multiple)
+{
+  return (bytes + multiple - 1u) / multiple * multiple;
+}
+
+//! Length of the mapping that backs \a bytes.
+inline size_t mappedLength(size_t bytes, const AllocationPolicy& policy)
+{
+  return roundUp(bytes, policy.huge_pages == HugePages::None
+                 ? c_page_size : c_huge_page_size);
+}
+
+//! Anonymous mapping of \a length bytes aligned to \a alignment.
+void* mapAligned(size_t length, size_t alignment)
+{
+  // Over-allocate and unmap the unaligned head and the tail.
+  const size_t padded_length = length + alignment - c_page_size;
+  void* p = mmap(nullptr, padded_length, PROT_READ | PROT_WRITE,
+                 MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (p == MAP_FAILED)
+  {
+    return nullptr;
+  }
+  uint8_t* begin = static_cast<uint8_t*>(p);
+  uint8_t* aligned = reinterpret_cast<uint8_t*>(
+        roundUp(reinterpret_cast<uintptr_t>(begin), alignment));
+  uint8_t* end = begin + padded_length;
+  if (aligned > begin)
+  {
+    munmap(begin, aligned - begin);
+  }
+  if (end > aligned + length)
+  {
+    munmap(aligned + length, end - (aligned + length));
+  }
+  return aligned;
+}
+
+} // anonymous namespace
+
+//-----------------------------------------------------------------------------
+void setDefaultAllocationPolicy(const AllocationPolicy& policy)
+{
+  g_default_policy = policy;
+}
+
+//-----------------------------------------------------------------------------
+const AllocationPolicy& defaultAllocationPolicy()
+{
+  return g_default_policy;
+}
+
+//-----------------------------------------------------------------------------
+void* allocateAligned(size_t bytes, uint32_t alignment, const AllocationPolicy& policy)
+{
+  CHECK_GT(bytes, 0u);
+  CHECK_LE(alignment, c_page_size);
+
+  if (!policy.isMapped())
+  {
+    void* p = nullptr;
+    if (posix_memalign(&p, alignment, bytes) != 0 || p == nullptr)
+    {
+      throw std::bad_alloc();
+    }
+    return p;
+  }
+
+  const size_t length = mappedLength(bytes, policy);
+  void* p = nullptr;
+  switch (policy.huge_pages)
+  {
+    case HugePages::Explicit:
+      p = mmap(nullptr, length, PROT_READ | PROT_WRITE,
+               MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+      if (p != MAP_FAILED)
+      {
+        break;
+      }
+      LOG_FIRST_N(WARNING, 1)
+          << "No explicit huge pages available (see /proc/sys/vm/nr_hugepages),"
+          << " falling back to transparent huge pages.";
+      // fallthrough
+    case HugePages::Transparent:
+      p = mapAligned(length, c_huge_page_size);
+      if (p && madvise(p, length, MADV_HUGEPAGE) != 0)
+      {
+        LOG_FIRST_N(WARNING, 1) << "madvise(MADV_HUGEPAGE) failed, transparent"
+                                << " huge pages are disabled in this kernel.";
+      }
+      break;
+    case HugePages::None:
+      p = mapAligned(length, c_page_size);
+      break;
+  }
+  if (p == nullptr || p == MAP_FAILED)
+  {
+    throw std::bad_alloc();
+  }
+
+  if (policy.numa_node >= 0)
+  {
+    // Bind before the first touch, the pages are placed when written.
+    const unsigned long max_node = 8u * sizeof(unsigned long);
+    CHECK_LT(static_cast<unsigned long>(policy.numa_node), max_node);
+    const unsigned long node_mask = 1ul << policy.numa_node;
+    if (syscall(SYS_mbind, p, length, MPOL_BIND, &node_mask, max_node, 0) != 0)
+    {
+      LOG_FIRST_N(WARNING, 1) << "Failed to bind image memory to NUMA node "
+                              << policy.numa_node << ", using first touch.";
+    }
+  }
+  return p;
+}
+
+//-----------------------------------------------------------------------------
+void freeAligned(void* p, size_t bytes, const AllocationPolicy& policy)
+{
+  if (!p)
+  {
+    return;
+  }
+  if (policy.isMapped())
+  {
+    munmap(p, mappedLength(bytes, policy));
+  }
+  else
+  {
+    ::free(p);
+  }
+}
+
+//-----------------------------------------------------------------------------
+uint32_t pitchAlignment(const AllocationPolicy& policy, uint32_t default_alignment)
+{
+  return policy.page_aligned_pitch ? c_page_size : default_alignment;
+}
+
+} // namespace ze
@@ -0,0 +1,233 @@
+// Copyright (c) 2015-2016, ETH Zurich, Wyss Zurich, Zurich Eye
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the ETH Zurich, Wyss Zurich, Zurich Eye nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL ETH Zurich, Wyss Zurich, Zurich Eye BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <imp/core/image_pool.hpp>
+
+#include <algorithm>
+#include <mutex>
+#include <vector>
+#include <ze/common/logging.hpp>
+
+namespace ze {
+
+//-----------------------------------------------------------------------------
+struct ImagePool::Impl
+{
+  struct Buffer
+  {
+    Size2u size;
+    PixelType pixel_type;
+    uint32_t pitch;
+    AllocationPolicy policy;
+    void* data;
+    uint64_t last_returned;
+
+    size_t bytes() const { return static_cast<size_t>(pitch) * size.height(); }
+
+    bool matches(const Size2u& s, PixelType t, uint32_t p,
+                 const AllocationPolicy& a) const
+    {
+      return size == s && pixel_type == t && pitch == p && policy == a;
+    }
+  };
+
+  explicit Impl(const Options& opts)
+    : options(opts)
+  {}
+
+  ~Impl()
+  {
+    for (const Buffer& buffer : free_buffers)
+    {
+      freeAligned(buffer.data, buffer.bytes(), buffer.policy);
+    }
+  }
+
+  //! Called with the mutex locked. Releases the least recently returned
+  //! buffers until at most max_bytes are cached.
+  void trimLocked(size_t max_bytes)
+  {
+    while (stats.cached_bytes > max_bytes && !free_buffers.empty())
+    {
+      auto oldest = std::min_element(
+            free_buffers.begin(), free_buffers.end(),
+            [](const Buffer& lhs, const Buffer& rhs)
+      { return lhs.last_returned < rhs.last_returned; });
+      eraseLocked(oldest);
+    }
+  }
+
+  void eraseLocked(std::vector<Buffer>::iterator it)
+  {
+    freeAligned(it->data, it->bytes(), it->policy);
+    stats.cached_bytes -= it->bytes();
+    --stats.num_cached;
+    ++stats.num_released;
+    *it = free_buffers.back();
+    free_buffers.pop_back();
+  }
+
+  void release(const Size2u& size, PixelType pixel_type, uint32_t pitch,
+               const AllocationPolicy& policy, void* data)
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    const Buffer buffer { size, pixel_type, pitch, policy, data, ++clock };
+    if (options.max_cached_per_key == 0u || buffer.bytes() > options.max_cached_bytes)
+    {
+      freeAligned(data, buffer.bytes(), policy);
+      ++stats.num_released;
+      return;
+    }
+
+    uint32_t num_same_key = 0u;
+    auto oldest_same_key = free_buffers.end();
+    for (auto it = free_buffers.begin(); it != free_buffers.end(); ++it)
+    {
+      if (it->matches(size, pixel_type, pitch, policy))
+      {
+        ++num_same_key;
+        if (oldest_same_key == free_buffers.end()
+            || it->last_returned < oldest_same_key->last_returned)
+        {
+          oldest_same_key = it;
+        }
+      }
+    }
+    if (num_same_key >= options.max_cached_per_key)
+    {
+      eraseLocked(oldest_same_key);
+    }
+
+    free_buffers.push_back(buffer);
+    stats.cached_bytes += buffer.bytes();
+    ++stats.num_cached;
+    trimLocked(options.max_cached_bytes);
+  }
+
+  const Options options;
+  mutable std::mutex mutex;
+  std::vector<Buffer> free_buffers;
+  Statistics stats;
+  uint64_t clock = 0u;
+};
+
+//-----------------------------------------------------------------------------
+ImagePool::ImagePool()
+  : ImagePool(Options())
+{}
+
+//-----------------------------------------------------------------------------
+ImagePool::ImagePool(const Options& options)
+  : impl_(std::make_shared<Impl>(options))
+{}
+
+//-----------------------------------------------------------------------------
+ImagePool::~ImagePool() = default;
+
+//-----------------------------------------------------------------------------
+std::shared_ptr<void> ImagePool::acquireBuffer(
+    const Size2u& size, PixelType pixel_type, uint32_t pitch,
+    const AllocationPolicy& policy, Allocator allocator)
+{
+  CHECK_GT(size.width(), 0u);
+  CHECK_GT(size.height(), 0u);
+
+  void* data = nullptr;
+  {
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    // Take the most recently returned buffer, it is most likely still cached.
+    auto best = impl_->free_buffers.end();
+    for (auto it = impl_->free_buffers.begin(); it != impl_->free_buffers.end(); ++it)
+    {
+      if (it->matches(size, pixel_type, pitch, policy)
+          && (best == impl_->free_buffers.end() || it->last_returned > best->last_returned))
+      {
+        best = it;
+      }
+    }
+    if (best != impl_->free_buffers.end())
+    {
+      data = best->data;
+      impl_->stats.cached_bytes -= best->bytes();
+      --impl_->stats.num_cached;
+      ++impl_->stats.num_reuses;
+      *best = impl_->free_buffers.back();
+      impl_->free_buffers.pop_back();
+    }
+    else
+    {
+      ++impl_->stats.num_allocations;
+    }
+  }
+
+  if (!data)
+  {
+    data = allocator(size, policy);
+  }
+
+  // The deleter only keeps a weak reference, such that images may outlive the pool.
+  std::weak_ptr<Impl> weak_impl = impl_;
+  return std::shared_ptr<void>(data, [weak_impl, size, pixel_type, pitch, policy](void* p)
+  {
+    std::shared_ptr<Impl> impl = weak_impl.lock();
+    if (impl)
+    {
+      impl->release(size, pixel_type, pitch, policy, p);
+    }
+    else
+    {
+      freeAligned(p, static_cast<size_t>(pitch) * size.height(), policy);
+    }
+  });
+}
+
+//-----------------------------------------------------------------------------
+void ImagePool::trim(size_t max_cached_bytes)
+{
+  std::lock_guard<std::mutex> lock(impl_->mutex);
+  impl_->trimLocked(max_cached_bytes);
+}
+
+//-----------------------------------------------------------------------------
+ImagePool::Statistics ImagePool::statistics() const
+{
+  std::lock_guard<std::mutex> lock(impl_->mutex);
+  return impl_->stats;
+}
+
+//-----------------------------------------------------------------------------
+const ImagePool::Options& ImagePool::options() const
+{
+  return impl_->options;
+}
+
+//-----------------------------------------------------------------------------
+ImagePool& ImagePool::global()
+{
+  static ImagePool pool;
+  return pool;
+}
+
+} // namespace ze
@@ -32,10 +32,18 @@ namespace ze {
 //-----------------------------------------------------------------------------
 template<typename Pixel>
 ImageRaw<Pixel>::ImageRaw(const ze::Size2u& size, PixelOrder pixel_order)
+  : ImageRaw(size, defaultAllocationPolicy(), pixel_order)
+{
+}
+
+//-----------------------------------------------------------------------------
+template<typename Pixel>
+ImageRaw<Pixel>::ImageRaw(const ze::Size2u& size,
+                          const AllocationPolicy& policy,
+                          PixelOrder pixel_order)
   : Base(size, pixel_order)
 {
-  data_.reset(Memory::alignedAlloc(size, &this->header_.pitch));
-  this->header_.memory_type = MemoryType::CpuAligned;
+  allocate(policy);
 }
 
 //-----------------------------------------------------------------------------
@@ -43,9 +51,9 @@ template<typename Pixel>
 ImageRaw<Pixel>::ImageRaw(const ImageRaw& from)
   : Base(from)
 {
-  data_.reset(Memory::alignedAlloc(this->size(), &this->header_.pitch));
-  this->header_.memory_type = MemoryType::CpuAligned;
-  from.copyTo(*this);
+  allocate(defaultAllocationPolicy());
+  // Copy all pixels, not only the region of interest.
+  copyView(from.view(), this->view());
 }
 
 //-----------------------------------------------------------------------------
@@ -53,9 +61,15 @@ template<typename Pixel>
 ImageRaw<Pixel>::ImageRaw(const Image<Pixel>& from)
   : Base(from)
 {
-  data_.reset(Memory::alignedAlloc(this->size(), &this->header_.pitch));
-  this->header_.memory_type = MemoryType::CpuAligned;
-  from.copyTo(*this);
+  allocate(defaultAllocationPolicy());
+  if (from.isGpuMemory())
+  {
+    from.copyTo(*this);
+  }
+  else
+  {
+    copyView(from.view(), this->view());
+  }
 }
 
 //-----------------------------------------------------------------------------
@@ -78,8 +92,7 @@ ImageRaw<Pixel>
   }
   else
   {
-    data_.reset(Memory::alignedAlloc(this->size(), &this->header_.pitch));
-    this->header_.memory_type = MemoryType::CpuAligned;
+    allocate(defaultAllocationPolicy());
 
     if (this->bytes() == pitch*height)
     {
@@ -87,13 +100,8 @@ ImageRaw<Pixel>
     }
     else
     {
-      for (uint32_t y=0; y<height; ++y)
-      {
-        for (uint32_t x=0; x<width; ++x)
-        {
-          data_.get()[y*this->stride()+x] = data[y*this->stride() + x];
-        }
-      }
+      copyView(ImageView<const Pixel>(data, width, height, pitch/sizeof(Pixel)),
+               this->view());
     }
   }
 }
@@ -118,6 +126,26 @@ ImageRaw<Pixel>::ImageRaw(Pixel* data,
                                  MemoryType::CpuAligned : MemoryType::Cpu;
 }
 
+//-----------------------------------------------------------------------------
+template<typename Pixel>
+void ImageRaw<Pixel>::allocate(const AllocationPolicy& policy)
+{
+  const Size2u size = this->size();
+  Pixel* data = Memory::alignedAlloc(size, &this->header_.pitch, policy);
+  if (policy.isMapped())
+  {
+    const uint32_t pitch = this->header_.pitch;
+    data_ = std::unique_ptr<Pixel, Deallocator>(
+          data, Deallocator([size, pitch, policy](Pixel* p)
+    { Memory::free(p, size, pitch, policy); }));
+  }
+  else
+  {
+    data_.reset(data);
+  }
+  this->header_.memory_type = MemoryType::CpuAligned;
+}
+
 //-----------------------------------------------------------------------------
 template<typename Pixel>
 Pixel* ImageRaw<Pixel>::data(uint32_t ox, uint32_t oy)
@@ -164,4 +192,9 @@ template class ImageRaw<ze::Pixel32fC2>;
 template class ImageRaw<ze::Pixel32fC3>;
 template class ImageRaw<ze::Pixel32fC4>;
 
+template class ImageRaw<ze::Pixel16fC1>;
+template class ImageRaw<ze::Pixel16fC2>;
+template class ImageRaw<ze::Pixel16fC3>;
+template class ImageRaw<ze::Pixel16fC4>;
+
 } // namespace ze
@@ -0,0 +1,679 @@
+// Copyright (c) 2015-2016, ETH Zurich, Wyss Zurich, Zurich Eye
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the ETH Zurich, Wyss Zurich, Zurich Eye nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL ETH Zurich, Wyss Zurich, Zurich Eye BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#include <imp/core/pixel_conversion.hpp>
+
+#include <algorithm>
+#include <future>
+#include <vector>
+
+#include <ze/common/thread_pool.hpp>
+
+#if defined(__SSE2__)
+#  include <immintrin.h>
+#elif defined(__ARM_NEON)
+#  include <arm_neon.h>
+#  define ZE_NEON_CONVERSION
+#  if defined(__aarch64__) || (__ARM_FP & 2)
+#    define ZE_NEON_HALF_CONVERSION
+#  endif
+#endif
+
+namespace ze {
+
+namespace {
+
+//! Fixed point BT.601 weights with 14 fractional bits (sum 1 << 14).
+constexpr int c_gray_r = 4899;
+constexpr int c_gray_g = 9617;
+constexpr int c_gray_b = 1868;
+constexpr int c_gray_shift = 14;
+
+inline uint8_t grayFromRgb(int r, int g, int b)
+{
+  return static_cast<uint8_t>(
+        (c_gray_r * r + c_gray_g * g + c_gray_b * b + (1 << (c_gray_shift - 1)))
+        >> c_gray_shift);
+}
+
+#if defined(__SSSE3__)
+//-----------------------------------------------------------------------------
+// SSSE3 helpers for 16 pixels in planar registers.
+
+inline __m128i shuffle3(__m128i a, __m128i b, __m128i c,
+                        __m128i mask_a, __m128i mask_b, __m128i mask_c)
+{
+  return _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(a, mask_a),
+                                   _mm_shuffle_epi8(b, mask_b)),
+                      _mm_shuffle_epi8(c, mask_c));
+}
+
+//! Splits 16 interleaved 3-channel pixels (48 bytes) into one register per channel.
+inline void deinterleave3(const uint8_t* src, __m128i* c0, __m128i* c1, __m128i* c2)
+{
+  const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+  const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 16));
+  const __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 32));
+  *c0 = shuffle3(a, b, c,
+                 _mm_setr_epi8(0, 3, 6, 9, 12, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1),
+                 _mm_setr_epi8(-1, -1, -1, -1, -1, -1, 2, 5, 8, 11, 14, -1, -1, -1, -1, -1),
+                 _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 1, 4, 7, 10, 13));
+  *c1 = shuffle3(a, b, c,
+                 _mm_setr_epi8(1, 4, 7, 10, 13, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1),
+                 _mm_setr_epi8(-1, -1, -1, -1, -1, 0, 3, 6, 9, 12, 15, -1, -1, -1, -1, -1),
+                 _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 2, 5, 8, 11, 14));
+  *c2 = shuffle3(a, b, c,
+                 _mm_setr_epi8(2, 5, 8, 11, 14, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1),
+                 _mm_setr_epi8(-1, -1, -1, -1, -1, 1, 4, 7, 10, 13, -1, -1, -1, -1, -1, -1),
+                 _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 0, 3, 6, 9, 12, 15));
+}
+
+//! Interleaves 16 pixels given as one register per channel (48 bytes).
+inline void interleave3(__m128i c0, __m128i c1, __m128i c2, uint8_t* dst)
+{
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), shuffle3(c0, c1, c2,
+      _mm_setr_epi8(0, -1, -1, 1, -1, -1, 2, -1, -1, 3, -1, -1, 4, -1, -1, 5),
+      _mm_setr_epi8(-1, 0, -1, -1, 1, -1, -1, 2, -1, -1, 3, -1, -1, 4, -1, -1),
+      _mm_setr_epi8(-1, -1, 0, -1, -1, 1, -1, -1, 2, -1, -1, 3, -1, -1, 4, -1)));
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 16), shuffle3(c0, c1, c2,
+      _mm_setr_epi8(-1, -1, 6, -1, -1, 7, -1, -1, 8, -1, -1, 9, -1, -1, 10, -1),
+      _mm_setr_epi8(5, -1, -1, 6, -1, -1, 7, -1, -1, 8, -1, -1, 9, -1, -1, 10),
+      _mm_setr_epi8(-1, 5, -1, -1, 6, -1, -1, 7, -1, -1, 8, -1, -1, 9, -1, -1)));
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 32), shuffle3(c0, c1, c2,
+      _mm_setr_epi8(-1, 11, -1, -1, 12, -1, -1, 13, -1, -1, 14, -1, -1, 15, -1, -1),
+      _mm_setr_epi8(-1, -1, 11, -1, -1, 12, -1, -1, 13, -1, -1, 14, -1, -1, 15, -1),
+      _mm_setr_epi8(10, -1, -1, 11, -1, -1, 12, -1, -1, 13, -1, -1, 14, -1, -1, 15)));
+}
+
+//! Gray of 16 pixels, bit exact with grayFromRgb().
+inline __m128i grayFromRgb(__m128i r, __m128i g, __m128i b)
+{
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i one = _mm_set1_epi16(1);
+  const __m128i w_rg = _mm_set1_epi32((c_gray_g << 16) | c_gray_r);
+  const __m128i w_b1 = _mm_set1_epi32(((1 << (c_gray_shift - 1)) << 16) | c_gray_b);
+  auto gray8 = [&](__m128i r16, __m128i g16, __m128i b16)
+  {
+    const __m128i lo = _mm_add_epi32(
+          _mm_madd_epi16(_mm_unpacklo_epi16(r16, g16), w_rg),
+          _mm_madd_epi16(_mm_unpacklo_epi16(b16, one), w_b1));
+    const __m128i hi = _mm_add_epi32(
+          _mm_madd_epi16(_mm_unpackhi_epi16(r16, g16), w_rg),
+          _mm_madd_epi16(_mm_unpackhi_epi16(b16, one), w_b1));
+    return _mm_packs_epi32(_mm_srai_epi32(lo, c_gray_shift),
+                           _mm_srai_epi32(hi, c_gray_shift));
+  };
+  return _mm_packus_epi16(
+        gray8(_mm_unpacklo_epi8(r, zero), _mm_unpacklo_epi8(g, zero),
+              _mm_unpacklo_epi8(b, zero)),
+        gray8(_mm_unpackhi_epi8(r, zero), _mm_unpackhi_epi8(g, zero),
+              _mm_unpackhi_epi8(b, zero)));
+}
+
+//! (a + b + c + d + 2) / 4
+inline __m128i average4(__m128i a, __m128i b, __m128i c, __m128i d)
+{
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i two = _mm_set1_epi16(2);
+  const __m128i lo = _mm_add_epi16(
+        _mm_add_epi16(_mm_unpacklo_epi8(a, zero), _mm_unpacklo_epi8(b, zero)),
+        _mm_add_epi16(_mm_unpacklo_epi8(c, zero), _mm_unpacklo_epi8(d, zero)));
+  const __m128i hi = _mm_add_epi16(
+        _mm_add_epi16(_mm_unpackhi_epi8(a, zero), _mm_unpackhi_epi8(b, zero)),
+        _mm_add_epi16(_mm_unpackhi_epi8(c, zero), _mm_unpackhi_epi8(d, zero)));
+  return _mm_packus_epi16(_mm_srli_epi16(_mm_add_epi16(lo, two), 2),
+                          _mm_srli_epi16(_mm_add_epi16(hi, two), 2));
+}
+
+inline __m128i select(__m128i mask, __m128i a, __m128i b)
+{
+  return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+#endif
+
+//! Rows per band, such that a band is processed in a few hundred microseconds.
+constexpr uint32_t c_min_rows_per_band = 32u;
+constexpr uint32_t c_max_bands = 16u;
+
+//-----------------------------------------------------------------------------
+// Color to gray.
+template<int channels>
+void colorRowToGray(const uint8_t* src, uint8_t* dst, uint32_t width,
+                    int r_idx, int b_idx)
+{
+  uint32_t x = 0u;
+#if defined(__SSSE3__)
+  if (channels == 3)
+  {
+    for (; x + 16u <= width; x += 16u)
+    {
+      __m128i c[3];
+      deinterleave3(src + 3u * x, &c[0], &c[1], &c[2]);
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x),
+                       grayFromRgb(c[r_idx], c[1], c[b_idx]));
+    }
+  }
+  else
+  {
+    // Per 4 pixels, madd gives (r*w_r + g*w_g, b*w_b + round) and hadd the sum.
+    const __m128i zero = _mm_setzero_si128();
+    const int16_t w_r = c_gray_r, w_g = c_gray_g, w_b = c_gray_b;
+    const int16_t w_round = 1 << (c_gray_shift - 1);
+    const __m128i w = (r_idx == 0)
+        ? _mm_setr_epi16(w_r, w_g, w_b, 0, w_r, w_g, w_b, 0)
+        : _mm_setr_epi16(w_b, w_g, w_r, 0, w_b, w_g, w_r, 0);
+    // The alpha byte is replaced by 1 to add the rounding term.
+    const __m128i w_alpha = _mm_setr_epi16(0, 0, 0, w_round, 0, 0, 0, w_round);
+    const __m128i one_alpha = _mm_setr_epi16(0, 0, 0, 1, 0, 0, 0, 1);
+    const __m128i keep_rgb = _mm_setr_epi16(-1, -1, -1, 0, -1, -1, -1, 0);
+    auto gray4 = [&](__m128i v)
+    {
+      const __m128i lo = _mm_or_si128(
+            _mm_and_si128(_mm_unpacklo_epi8(v, zero), keep_rgb), one_alpha);
+      const __m128i hi = _mm_or_si128(
+            _mm_and_si128(_mm_unpackhi_epi8(v, zero), keep_rgb), one_alpha);
+      const __m128i weights = _mm_add_epi16(w, w_alpha);
+      return _mm_srai_epi32(_mm_hadd_epi32(_mm_madd_epi16(lo, weights),
+                                           _mm_madd_epi16(hi, weights)),
+                            c_gray_shift);
+    };
+    for (; x + 16u <= width; x += 16u)
+    {
+      const __m128i* in = reinterpret_cast<const __m128i*>(src + 4u * x);
+      const __m128i g0 = _mm_packs_epi32(gray4(_mm_loadu_si128(in)),
+                                         gray4(_mm_loadu_si128(in + 1)));
+      const __m128i g1 = _mm_packs_epi32(gray4(_mm_loadu_si128(in + 2)),
+                                         gray4(_mm_loadu_si128(in + 3)));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x), _mm_packus_epi16(g0, g1));
+    }
+  }
+#elif defined(ZE_NEON_CONVERSION)
+  for (; x + 8u <= width; x += 8u)
+  {
+    uint8x8_t c[4];
+    if (channels == 3)
+    {
+      const uint8x8x3_t v = vld3_u8(src + 3u * x);
+      c[0] = v.val[0]; c[1] = v.val[1]; c[2] = v.val[2];
+    }
+    else
+    {
+      const uint8x8x4_t v = vld4_u8(src + 4u * x);
+      c[0] = v.val[0]; c[1] = v.val[1]; c[2] = v.val[2];
+    }
+    const uint16x8_t r = vmovl_u8(c[r_idx]);
+    const uint16x8_t g = vmovl_u8(c[1]);
+    const uint16x8_t b = vmovl_u8(c[b_idx]);
+    uint32x4_t lo = vmull_n_u16(vget_low_u16(r), c_gray_r);
+    uint32x4_t hi = vmull_n_u16(vget_high_u16(r), c_gray_r);
+    lo = vmlal_n_u16(lo, vget_low_u16(g), c_gray_g);
+    hi = vmlal_n_u16(hi, vget_high_u16(g), c_gray_g);
+    lo = vmlal_n_u16(lo, vget_low_u16(b), c_gray_b);
+    hi = vmlal_n_u16(hi, vget_high_u16(b), c_gray_b);
+    vst1_u8(dst + x, vmovn_u16(vcombine_u16(vrshrn_n_u32(lo, c_gray_shift),
+                                            vrshrn_n_u32(hi, c_gray_shift))));
+  }
+#endif
+  for (; x < width; ++x)
+  {
+    const uint8_t* px = src + channels * x;
+    dst[x] = grayFromRgb(px[r_idx], px[1], px[b_idx]);
+  }
+}
+
+template<int channels, typename Pixel>
+void convertColorToGray(const Image<Pixel>& src, Image8uC1& dst, bool rgb,
+                        ThreadPool* pool)
+{
+  CHECK_EQ(src.roi().size(), dst.roi().size());
+  const ImageView<const Pixel> s = src.roiView();
+  const ImageView<Pixel8uC1> d = dst.roiView();
+  const int r_idx = rgb ? 0 : 2;
+  const int b_idx = rgb ? 2 : 0;
+  internal::forEachRowBand(s.height(), pool, [&](uint32_t y_begin, uint32_t y_end)
+  {
+    for (uint32_t y = y_begin; y < y_end; ++y)
+    {
+      colorRowToGray<channels>(reinterpret_cast<const uint8_t*>(s.row(y)),
+                               reinterpret_cast<uint8_t*>(d.row(y)),
+                               s.width(), r_idx, b_idx);
+    }
+  });
+}
+
+//-----------------------------------------------------------------------------
+// Bilinear demosaicing.
+//
+// In every row of a Bayer image, green alternates with one other color (red
+// or blue), the row color. For each pixel we interpolate the row color, green
+// and the column color (the color of the rows above and below):
+// - green sites: row color from left/right, column color from up/down.
+// - other sites: green from the 4 direct neighbors, column color from the
+//   4 diagonal neighbors.
+
+struct BayerRow
+{
+  bool green_first;  //!< Green at even columns.
+  bool red_row;      //!< Red (instead of blue) is the row color.
+};
+
+BayerRow bayerRow(BayerPattern pattern, uint32_t y)
+{
+  const bool odd = (y & 1u) != 0u;
+  switch (pattern)
+  {
+    case BayerPattern::RGGB: return odd ? BayerRow{true, false} : BayerRow{false, true};
+    case BayerPattern::BGGR: return odd ? BayerRow{true, true} : BayerRow{false, false};
+    case BayerPattern::GRBG: return odd ? BayerRow{false, false} : BayerRow{true, true};
+    case BayerPattern::GBRG: return odd ? BayerRow{false, true} : BayerRow{true, false};
+  }
+  LOG(FATAL) << "Unknown Bayer pattern.";
+  return BayerRow{false, false};
+}
+
+//! Mirrors index -1 to 1 and n to n - 2, which keeps the Bayer color.
+inline uint32_t mirror(int64_t i, uint32_t n)
+{
+  return static_cast<uint32_t>(i < 0 ? -i : (i >= n ? 2 * (n - 1) - i : i));
+}
+
+//! Interpolates one pixel. Returns the row color, green and column color.
+inline void demosaicPixel(const uint8_t* up, const uint8_t* mid, const uint8_t* down,
+                          uint32_t xl, uint32_t x, uint32_t xr, bool green_site,
+                          int* row_c, int* g, int* col_c)
+{
+  if (green_site)
+  {
+    *row_c = (mid[xl] + mid[xr] + 1) >> 1;
+    *g = mid[x];
+    *col_c = (up[x] + down[x] + 1) >> 1;
+  }
+  else
+  {
+    *row_c = mid[x];
+    *g = (up[x] + down[x] + mid[xl] + mid[xr] + 2) >> 2;
+    *col_c = (up[xl] + up[xr] + down[xl] + down[xr] + 2) >> 2;
+  }
+}
+
+//! Demosaics one row into \a out, gray or 3 channels in rgb/bgr order.
+template<bool to_gray>
+void demosaicRow(const uint8_t* up, const uint8_t* mid, const uint8_t* down,
+                 uint32_t width, const BayerRow& row, bool bgr, uint8_t* out)
+{
+  const int r_idx = bgr ? 2 : 0;
+  const int b_idx = bgr ? 0 : 2;
+  auto emit = [&](uint32_t x, int row_c, int g, int col_c)
+  {
+    const int r = row.red_row ? row_c : col_c;
+    const int b = row.red_row ? col_c : row_c;
+    if (to_gray)
+    {
+      out[x] = grayFromRgb(r, g, b);
+    }
+    else
+    {
+      out[3 * x + r_idx] = static_cast<uint8_t>(r);
+      out[3 * x + 1] = static_cast<uint8_t>(g);
+      out[3 * x + b_idx] = static_cast<uint8_t>(b);
+    }
+  };
+  auto border = [&](uint32_t x)
+  {
+    int row_c, g, col_c;
+    demosaicPixel(up, mid, down, mirror(int64_t(x) - 1, width), x,
+                  mirror(int64_t(x) + 1, width), ((x & 1u) == 0u) == row.green_first,
+                  &row_c, &g, &col_c);
+    emit(x, row_c, g, col_c);
+  };
+
+  border(0u);
+  uint32_t x = 1u;
+#if defined(__SSSE3__)
+  // 16 columns starting at an odd one, both site formulas are evaluated and
+  // selected per lane.
+  const __m128i green_lanes =
+      _mm_set1_epi16(row.green_first ? static_cast<int16_t>(0xff00) : 0x00ff);
+  auto load = [](const uint8_t* p)
+  {
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+  };
+  for (; x + 17u <= width; x += 16u)
+  {
+    const __m128i l = load(mid + x - 1u), c = load(mid + x), r = load(mid + x + 1u);
+    const __m128i ul = load(up + x - 1u), uc = load(up + x), ur = load(up + x + 1u);
+    const __m128i dl = load(down + x - 1u), dc = load(down + x), dr = load(down + x + 1u);
+    const __m128i row_c = select(green_lanes, _mm_avg_epu8(l, r), c);
+    const __m128i g = select(green_lanes, c, average4(uc, dc, l, r));
+    const __m128i col_c = select(green_lanes, _mm_avg_epu8(uc, dc),
+                                 average4(ul, ur, dl, dr));
+    const __m128i red = row.red_row ? row_c : col_c;
+    const __m128i blue = row.red_row ? col_c : row_c;
+    if (to_gray)
+    {
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(out + x), grayFromRgb(red, g, blue));
+    }
+    else if (bgr)
+    {
+      interleave3(blue, g, red, out + 3u * x);
+    }
+    else
+    {
+      interleave3(red, g, blue, out + 3u * x);
+    }
+  }
+#endif
+  // Interior in pairs of columns, the site colors alternate.
+  const bool even_green = row.green_first;
+  for (; x + 2u < width; x += 2u)
+  {
+    int row_c, g, col_c;
+    demosaicPixel(up, mid, down, x - 1u, x, x + 1u, !even_green, &row_c, &g, &col_c);
+    emit(x, row_c, g, col_c);
+    demosaicPixel(up, mid, down, x, x + 1u, x + 2u, even_green, &row_c, &g, &col_c);
+    emit(x + 1u, row_c, g, col_c);
+  }
+  for (; x < width; ++x)
+  {
+    border(x);
+  }
+}
+
+template<typename EmitRow>
+void demosaicImage(const Image8uC1& src, const Size2u& dst_size, BayerPattern pattern,
+                   ThreadPool* pool, const EmitRow& emit_row)
+{
+  CHECK_EQ(src.roi().size(), dst_size);
+  const ImageView<const Pixel8uC1> s = src.roiView();
+  CHECK_GE(s.width(), 2u);
+  CHECK_GE(s.height(), 2u);
+  internal::forEachRowBand(s.height(), pool, [&](uint32_t y_begin, uint32_t y_end)
+  {
+    for (uint32_t y = y_begin; y < y_end; ++y)
+    {
+      const uint8_t* up = reinterpret_cast<const uint8_t*>(
+            s.row(mirror(int64_t(y) - 1, s.height())));
+      const uint8_t* mid = reinterpret_cast<const uint8_t*>(s.row(y));
+      const uint8_t* down = reinterpret_cast<const uint8_t*>(
+            s.row(mirror(int64_t(y) + 1, s.height())));
+      emit_row(y, up, mid, down, s.width(), bayerRow(pattern, y));
+    }
+  });
+}
+
+} // anonymous namespace
+
+//-----------------------------------------------------------------------------
+void internal::forEachRowBand(
+    uint32_t height, ThreadPool* pool,
+    const std::function<void(uint32_t, uint32_t)>& fun)
+{
+  const uint32_t num_bands =
+      pool ? std::max(1u, std::min(c_max_bands, height / c_min_rows_per_band)) : 1u;
+  if (num_bands == 1u)
+  {
+    fun(0u, height);
+    return;
+  }
+  std::vector<std::future<void>> futures;
+  futures.reserve(num_bands);
+  for (uint32_t band = 0u; band < num_bands; ++band)
+  {
+    const uint32_t y_begin = height * band / num_bands;
+    const uint32_t y_end = height * (band + 1u) / num_bands;
+    futures.push_back(pool->enqueue(fun, y_begin, y_end));
+  }
+  for (std::future<void>& future : futures)
+  {
+    future.get();
+  }
+}
+
+//-----------------------------------------------------------------------------
+void convertHalfToFloat(const Half* src, float* dst, size_t n)
+{
+  size_t i = 0u;
+#if defined(__F16C__)
+  for (; i + 8u <= n; i += 8u)
+  {
+    const __m128i h = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    _mm256_storeu_ps(dst + i, _mm256_cvtph_ps(h));
+  }
+#elif defined(ZE_NEON_HALF_CONVERSION)
+  for (; i + 4u <= n; i += 4u)
+  {
+    const float16x4_t h = vreinterpret_f16_u16(
+          vld1_u16(reinterpret_cast<const uint16_t*>(src + i)));
+    vst1q_f32(dst + i, vcvt_f32_f16(h));
+  }
+#endif
+  for (; i < n; ++i)
+  {
+    dst[i] = halfBitsToFloat(src[i].bits);
+  }
+}
+
+//-----------------------------------------------------------------------------
+void convertFloatToHalf(const float* src, Half* dst, size_t n)
+{
+  size_t i = 0u;
+#if defined(__F16C__)
+  for (; i + 8u <= n; i += 8u)
+  {
+    const __m128i h = _mm256_cvtps_ph(_mm256_loadu_ps(src + i),
+                                      _MM_FROUND_TO_NEAREST_INT);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), h);
+  }
+#elif defined(ZE_NEON_HALF_CONVERSION)
+  for (; i + 4u <= n; i += 4u)
+  {
+    const float16x4_t h = vcvt_f16_f32(vld1q_f32(src + i));
+    vst1_u16(reinterpret_cast<uint16_t*>(dst + i), vreinterpret_u16_f16(h));
+  }
+#endif
+  for (; i < n; ++i)
+  {
+    dst[i].bits = floatToHalfBits(src[i]);
+  }
+}
+
+//-----------------------------------------------------------------------------
+void convert8uTo32f(const uint8_t* src, float* dst, size_t n, float scale, float offset)
+{
+  size_t i = 0u;
+#if defined(__AVX2__)
+  const __m256 s = _mm256_set1_ps(scale);
+  const __m256 o = _mm256_set1_ps(offset);
+  for (; i + 8u <= n; i += 8u)
+  {
+    const __m256i v = _mm256_cvtepu8_epi32(
+          _mm_loadl_epi64(reinterpret_cast<const __m128i*>(src + i)));
+    _mm256_storeu_ps(dst + i, _mm256_fmadd_ps(_mm256_cvtepi32_ps(v), s, o));
+  }
+#elif defined(__SSE2__)
+  const __m128 s = _mm_set1_ps(scale);
+  const __m128 o = _mm_set1_ps(offset);
+  const __m128i zero = _mm_setzero_si128();
+  for (; i + 16u <= n; i += 16u)
+  {
+    const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    const __m128i lo = _mm_unpacklo_epi8(v, zero);
+    const __m128i hi = _mm_unpackhi_epi8(v, zero);
+    const __m128i w[4] = { _mm_unpacklo_epi16(lo, zero), _mm_unpackhi_epi16(lo, zero),
+                           _mm_unpacklo_epi16(hi, zero), _mm_unpackhi_epi16(hi, zero) };
+    for (int k = 0; k < 4; ++k)
+    {
+      _mm_storeu_ps(dst + i + 4 * k,
+                    _mm_add_ps(_mm_mul_ps(_mm_cvtepi32_ps(w[k]), s), o));
+    }
+  }
+#elif defined(ZE_NEON_CONVERSION)
+  const float32x4_t s = vdupq_n_f32(scale);
+  const float32x4_t o = vdupq_n_f32(offset);
+  for (; i + 8u <= n; i += 8u)
+  {
+    const uint16x8_t v = vmovl_u8(vld1_u8(src + i));
+    vst1q_f32(dst + i, vmlaq_f32(o, vcvtq_f32_u32(vmovl_u16(vget_low_u16(v))), s));
+    vst1q_f32(dst + i + 4, vmlaq_f32(o, vcvtq_f32_u32(vmovl_u16(vget_high_u16(v))), s));
+  }
+#endif
+  for (; i < n; ++i)
+  {
+    dst[i] = scale * src[i] + offset;
+  }
+}
+
+//-----------------------------------------------------------------------------
+void convert16uTo32f(const uint16_t* src, float* dst, size_t n, float scale, float offset)
+{
+  size_t i = 0u;
+#if defined(__AVX2__)
+  const __m256 s = _mm256_set1_ps(scale);
+  const __m256 o = _mm256_set1_ps(offset);
+  for (; i + 8u <= n; i += 8u)
+  {
+    const __m256i v = _mm256_cvtepu16_epi32(
+          _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i)));
+    _mm256_storeu_ps(dst + i, _mm256_fmadd_ps(_mm256_cvtepi32_ps(v), s, o));
+  }
+#elif defined(__SSE2__)
+  const __m128 s = _mm_set1_ps(scale);
+  const __m128 o = _mm_set1_ps(offset);
+  const __m128i zero = _mm_setzero_si128();
+  for (; i + 8u <= n; i += 8u)
+  {
+    const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    _mm_storeu_ps(dst + i, _mm_add_ps(
+                    _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(v, zero)), s), o));
+    _mm_storeu_ps(dst + i + 4, _mm_add_ps(
+                    _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(v, zero)), s), o));
+  }
+#elif defined(ZE_NEON_CONVERSION)
+  const float32x4_t s = vdupq_n_f32(scale);
+  const float32x4_t o = vdupq_n_f32(offset);
+  for (; i + 8u <= n; i += 8u)
+  {
+    const uint16x8_t v = vld1q_u16(src + i);
+    vst1q_f32(dst + i, vmlaq_f32(o, vcvtq_f32_u32(vmovl_u16(vget_low_u16(v))), s));
+    vst1q_f32(dst + i + 4, vmlaq_f32(o, vcvtq_f32_u32(vmovl_u16(vget_high_u16(v))), s));
+  }
+#endif
+  for (; i < n; ++i)
+  {
+    dst[i] = scale * src[i] + offset;
+  }
+}
+
+//-----------------------------------------------------------------------------
+void convertToGray(const Image8uC3& src, Image8uC1& dst, ThreadPool* pool)
+{
+  convertColorToGray<3>(src, dst, src.pixelOrder() == PixelOrder::rgb, pool);
+}
+
+//-----------------------------------------------------------------------------
+void convertToGray(const Image8uC4& src, Image8uC1& dst, ThreadPool* pool)
+{
+  convertColorToGray<4>(src, dst, src.pixelOrder() == PixelOrder::rgba, pool);
+}
+
+//-----------------------------------------------------------------------------
+void demosaic(const Image8uC1& src, Image8uC3& dst, BayerPattern pattern,
+              ThreadPool* pool)
+{
+  const ImageView<Pixel8uC3> d = dst.roiView();
+  // Like convertToGray(), all orders but rgb are bgr.
+  const bool bgr = dst.pixelOrder() != PixelOrder::rgb;
+  demosaicImage(src, d.size(), pattern, pool,
+                [&](uint32_t y, const uint8_t* up, const uint8_t* mid,
+                    const uint8_t* down, uint32_t width, const BayerRow& row)
+  {
+    demosaicRow<false>(up, mid, down, width, row, bgr,
+                       reinterpret_cast<uint8_t*>(d.row(y)));
+  });
+}
+
+//-----------------------------------------------------------------------------
+void demosaicToGray(const Image8uC1& src, Image8uC1& dst, BayerPattern pattern,
+                    ThreadPool* pool)
+{
+  const ImageView<Pixel8uC1> d = dst.roiView();
+  demosaicImage(src, d.size(), pattern, pool,
+                [&](uint32_t y, const uint8_t* up, const uint8_t* mid,
+                    const uint8_t* down, uint32_t width, const BayerRow& row)
+  {
+    demosaicRow<true>(up, mid, down, width, row, false,
+                      reinterpret_cast<uint8_t*>(d.row(y)));
+  });
+}
+
+//-----------------------------------------------------------------------------
+void convertYuv422ToGray(const Image8uC2& src, Image8uC1& dst, Yuv422Layout layout,
+                         ThreadPool* pool)
+{
+  CHECK_EQ(src.roi().size(), dst.roi().size());
+  const ImageView<const Pixel8uC2> s = src.roiView();
+  const ImageView<Pixel8uC1> d = dst.roiView();
+  // Luma is every other byte, starting at 0 (YUYV) or 1 (UYVY).
+  const uint32_t y_offset = (layout == Yuv422Layout::YUYV) ? 0u : 1u;
+  internal::forEachRowBand(s.height(), pool, [&](uint32_t y_begin, uint32_t y_end)
+  {
+    for (uint32_t y = y_begin; y < y_end; ++y)
+    {
+      const uint8_t* in = reinterpret_cast<const uint8_t*>(s.row(y));
+      uint8_t* out = reinterpret_cast<uint8_t*>(d.row(y));
+      uint32_t x = 0u;
+#if defined(__SSE2__)
+      const __m128i mask = _mm_set1_epi16(0x00ff);
+      for (; x + 16u <= s.width(); x += 16u)
+      {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + 2u * x));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + 2u * x + 16u));
+        if (y_offset == 0u)
+        {
+          a = _mm_and_si128(a, mask);
+          b = _mm_and_si128(b, mask);
+        }
+        else
+        {
+          a = _mm_srli_epi16(a, 8);
+          b = _mm_srli_epi16(b, 8);
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + x), _mm_packus_epi16(a, b));
+      }
+#elif defined(ZE_NEON_CONVERSION)
+      for (; x + 16u <= s.width(); x += 16u)
+      {
+        const uint8x16x2_t v = vld2q_u8(in + 2u * x);
+        vst1q_u8(out + x, v.val[y_offset]);
+      }
+#endif
+      for (; x < s.width(); ++x)
+      {
+        out[x] = in[2u * x + y_offset];
+      }
+    }
+  });
+}
+
+} // namespace ze
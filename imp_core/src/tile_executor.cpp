@@ -0,0 +1,152 @@
+// Copyright (c) 2015-2016, ETH Zurich, Wyss Zurich, Zurich Eye
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the ETH Zurich, Wyss Zurich, Zurich Eye nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL ETH Zurich, Wyss Zurich, Zurich Eye BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#include <imp/core/tile_executor.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <future>
+#include <vector>
+
+#include <ze/common/thread_pool.hpp>
+
+namespace ze {
+
+namespace {
+
+constexpr size_t c_scratch_alignment = 32u;
+
+} // anonymous namespace
+
+//-----------------------------------------------------------------------------
+uint8_t* internal::tileScratch(int index, size_t bytes)
+{
+  DEBUG_CHECK(index == 0 || index == 1);
+  // Grows to the largest tile and is then reused for all tiles of the thread.
+  static thread_local std::vector<uint8_t> scratch[2];
+  std::vector<uint8_t>& buffer = scratch[index];
+  if (buffer.size() < bytes + c_scratch_alignment)
+  {
+    buffer.resize(bytes + c_scratch_alignment);
+  }
+  const uintptr_t address = reinterpret_cast<uintptr_t>(buffer.data());
+  return buffer.data()
+      + (c_scratch_alignment - address % c_scratch_alignment) % c_scratch_alignment;
+}
+
+//-----------------------------------------------------------------------------
+TileExecutor::TileExecutor(ThreadPool* pool)
+  : pool_(pool)
+{}
+
+TileExecutor::TileExecutor(ThreadPool* pool, const Options& options)
+  : pool_(pool)
+  , options_(options)
+{}
+
+//-----------------------------------------------------------------------------
+void TileExecutor::forEachTile(
+    const Size2u& size, const std::function<void(const Roi2u&)>& fun) const
+{
+  if (size.area() == 0u)
+  {
+    return;
+  }
+  const uint32_t tile_width = options_.tile_width > 0u
+      ? std::min(options_.tile_width, size.width()) : size.width();
+  const uint32_t tile_height = options_.tile_height > 0u
+      ? std::min(options_.tile_height, size.height()) : size.height();
+  const uint32_t tiles_x = (size.width() + tile_width - 1u) / tile_width;
+  const uint32_t tiles_y = (size.height() + tile_height - 1u) / tile_height;
+  const uint32_t num_tiles = tiles_x * tiles_y;
+
+  auto runTile = [&](uint32_t i)
+  {
+    const uint32_t x = (i % tiles_x) * tile_width;
+    const uint32_t y = (i / tiles_x) * tile_height;
+    fun(Roi2u(x, y, std::min(tile_width, size.width() - x),
+              std::min(tile_height, size.height() - y)));
+  };
+
+  const uint32_t num_tasks = pool_
+      ? std::min(num_tiles, static_cast<uint32_t>(pool_->numThreads())) : 1u;
+  if (num_tasks <= 1u)
+  {
+    for (uint32_t i = 0u; i < num_tiles; ++i)
+    {
+      runTile(i);
+    }
+    return;
+  }
+
+  // Every task takes the next tile until all are done, which balances tiles
+  // of different cost (e.g. at the image border) over the threads.
+  std::atomic<uint32_t> next_tile(0u);
+  auto worker = [&]()
+  {
+    try
+    {
+      for (uint32_t i = next_tile++; i < num_tiles; i = next_tile++)
+      {
+        runTile(i);
+      }
+    }
+    catch (...)
+    {
+      // The other tasks stop after their current tile.
+      next_tile = num_tiles;
+      throw;
+    }
+  };
+  std::vector<std::future<void>> futures;
+  futures.reserve(num_tasks);
+  for (uint32_t task = 0u; task < num_tasks; ++task)
+  {
+    futures.push_back(pool_->enqueue(worker));
+  }
+  // The tasks reference the locals of this function, so all of them have to
+  // finish before the first exception is passed on.
+  std::exception_ptr error;
+  for (std::future<void>& future : futures)
+  {
+    try
+    {
+      future.get();
+    }
+    catch (...)
+    {
+      if (!error)
+      {
+        error = std::current_exception();
+      }
+    }
+  }
+  if (error)
+  {
+    std::rethrow_exception(error);
+  }
+}
+
+} // namespace ze
@@ -0,0 +1,114 @@
+// Copyright (c) 2015-2016, ETH Zurich, Wyss Zurich, Zurich Eye
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the ETH Zurich, Wyss Zurich, Zurich Eye nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL ETH Zurich, Wyss Zurich, Zurich Eye BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <cstdint>
+#include <vector>
+
+#include <ze/common/test_entrypoint.hpp>
+#include <imp/core/allocation_policy.hpp>
+#include <imp/core/image_pool.hpp>
+#include <imp/core/image_raw.hpp>
+
+namespace {
+
+std::vector<ze::AllocationPolicy> testPolicies()
+{
+  using namespace ze;
+  std::vector<AllocationPolicy> policies(6);
+  policies[1].huge_pages = HugePages::Transparent;
+  policies[2].huge_pages = HugePages::Explicit;
+  policies[3].numa_node = 0;
+  policies[4].page_aligned_pitch = true;
+  policies[5].huge_pages = HugePages::Transparent;
+  policies[5].numa_node = 0;
+  policies[5].page_aligned_pitch = true;
+  return policies;
+}
+
+} // anonymous namespace
+
+TEST(AllocationPolicyTest, testImageRaw)
+{
+  using namespace ze;
+
+  for (const AllocationPolicy& policy : testPolicies())
+  {
+    ImageRaw32fC1 img(Size2u(1001, 700), policy);
+    EXPECT_TRUE(MemoryStorage<Pixel32fC1>::isAligned(img.data()));
+    EXPECT_EQ(0u, img.pitch() % 32u);
+    EXPECT_GE(img.pitch(), 1001u * sizeof(Pixel32fC1));
+    if (policy.isMapped())
+    {
+      EXPECT_EQ(0u, reinterpret_cast<std::uintptr_t>(img.data()) % 4096u);
+    }
+    if (policy.page_aligned_pitch)
+    {
+      EXPECT_EQ(0u, img.pitch() % 4096u);
+    }
+
+    img.setValue(Pixel32fC1(3.0f));
+    EXPECT_EQ(Pixel32fC1(3.0f), img(0, 0));
+    EXPECT_EQ(Pixel32fC1(3.0f), img(1000, 699));
+  }
+}
+
+TEST(AllocationPolicyTest, testDefaultPolicy)
+{
+  using namespace ze;
+
+  AllocationPolicy policy;
+  policy.page_aligned_pitch = true;
+  setDefaultAllocationPolicy(policy);
+  ImageRaw8uC1 img(Size2u(100, 100));
+  EXPECT_EQ(4096u, img.pitch());
+
+  setDefaultAllocationPolicy(AllocationPolicy());
+  ImageRaw8uC1 img_default(Size2u(100, 100));
+  EXPECT_EQ(128u, img_default.pitch());
+}
+
+TEST(AllocationPolicyTest, testImagePool)
+{
+  using namespace ze;
+
+  ImagePool pool;
+  AllocationPolicy huge_pages;
+  huge_pages.huge_pages = HugePages::Transparent;
+  const Pixel32fC1* data;
+  {
+    ImageRaw32fC1::Ptr img =
+        pool.acquire<Pixel32fC1>(Size2u(1920, 1080), PixelOrder::gray, huge_pages);
+    data = img->data();
+  }
+
+  // Buffers are only reused for the same policy.
+  ImageRaw32fC1::Ptr img = pool.acquire<Pixel32fC1>(Size2u(1920, 1080));
+  EXPECT_NE(data, img->data());
+  ImageRaw32fC1::Ptr img_huge =
+      pool.acquire<Pixel32fC1>(Size2u(1920, 1080), PixelOrder::gray, huge_pages);
+  EXPECT_EQ(data, img_huge->data());
+}
+
+ZE_UNITTEST_ENTRYPOINT
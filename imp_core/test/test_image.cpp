@@ -31,7 +31,9 @@
 #include <random>
 #include <functional>
 #include <type_traits>
+#include <vector>
 
+#include <ze/common/benchmark.hpp>
 #include <ze/common/random.hpp>
 #include <ze/common/test_entrypoint.hpp>
 #include <ze/common/test_utils.hpp>
@@ -230,4 +232,153 @@ TYPED_TEST(ImageRawTest, CheckRoiValues)
   }
 }
 
+//-----------------------------------------------------------------------------
+TYPED_TEST(ImageRawTest, CheckViewValues)
+{
+  this->setValue();
+  this->setValueRoi();
+
+  const ze::ImageRaw<TypeParam>& image = this->image_511_;
+  ze::ImageView<const TypeParam> view = image;
+  EXPECT_EQ(image.size(), view.size());
+  EXPECT_EQ(image.stride(), view.stride());
+  EXPECT_EQ(image.pitch(), view.pitch());
+  EXPECT_FALSE(view.isContiguous());
+
+  size_t num_pixels = 0u;
+  for (auto it = view.begin(); it != view.end(); ++it)
+  {
+    EXPECT_EQ(image(it.x(), it.y()), *it);
+    EXPECT_EQ(view(it.x(), it.y()), *it);
+    EXPECT_EQ(view.rowSpan(it.y())[it.x()], *it);
+    ++num_pixels;
+  }
+  EXPECT_EQ(image.numel(), num_pixels);
+}
+
+//-----------------------------------------------------------------------------
+TYPED_TEST(ImageRawTest, CheckCopyPaddedImage)
+{
+  this->setValue();
+  this->setValueRoi();
+
+  // Wrap the 511 wide image into a tightly packed one of the same size.
+  this->image_511_.setRoi(ze::Roi2u(this->size_511_));
+  std::vector<TypeParam> buffer(511 * 512);
+  ze::ImageRaw<TypeParam> packed(buffer.data(), 511, 512, 511 * sizeof(TypeParam), true);
+  this->image_511_.copyTo(packed);
+  for (ze::uint32_t y = 0u; y < 512; ++y)
+  {
+    for (ze::uint32_t x = 0u; x < 511; ++x)
+    {
+      EXPECT_EQ(this->image_511_(x, y), buffer[y * 511 + x]);
+    }
+  }
+
+  ze::ImageRaw<TypeParam> copy(buffer.data(), 511, 512, 511 * sizeof(TypeParam));
+  for (ze::uint32_t y = 0u; y < 512; ++y)
+  {
+    ze::ImageRowSpan<TypeParam> row = copy.view().rowSpan(y);
+    EXPECT_TRUE(std::equal(row.begin(), row.end(), this->image_511_[y]));
+  }
+}
+
+//-----------------------------------------------------------------------------
+TYPED_TEST(ImageRawTest, CheckSubImage)
+{
+  using namespace ze;
+  this->setValue();
+
+  typename ImageRaw<TypeParam>::Ptr image =
+      std::make_shared<ImageRaw<TypeParam>>(this->image_511_);
+  typename ImageRaw<TypeParam>::Ptr sub = subImage(image, this->roi_);
+  ASSERT_EQ(this->roi_.size(), sub->size());
+  EXPECT_EQ(Roi2u(sub->size()), sub->roi());
+  EXPECT_EQ(image->pitch(), sub->pitch());
+  EXPECT_EQ(image->data(this->roi_.x(), this->roi_.y()), sub->data());
+
+  // Filling the sub-image must not touch the parent outside the region.
+  sub->setValue(this->random_value2_);
+  for (uint32_t y = 0u; y < image->height(); ++y)
+  {
+    for (uint32_t x = 0u; x < image->width(); ++x)
+    {
+      const bool inside = x >= this->roi_.x() && x < this->roi_.x() + this->roi_.width()
+                       && y >= this->roi_.y() && y < this->roi_.y() + this->roi_.height();
+      EXPECT_EQ(inside ? this->random_value2_ : this->random_value1_, (*image)(x, y));
+    }
+  }
+
+  // The sub-image keeps the parent alive, nested sub-images too.
+  typename ImageRaw<TypeParam>::ConstPtr nested =
+      subImage(std::shared_ptr<const ImageRaw<TypeParam>>(sub), Roi2u(1, 2, 3, 4));
+  image.reset();
+  sub.reset();
+  EXPECT_EQ(this->random_value2_, (*nested)(2, 3));
+
+  // Copies of sub-images are compact.
+  ImageRaw<TypeParam> copy(*nested);
+  EXPECT_EQ(nested->size(), copy.size());
+  EXPECT_EQ(this->random_value2_, copy(2, 3));
+}
+
+//-----------------------------------------------------------------------------
+TYPED_TEST(ImageRawTest, CheckCopyRoi)
+{
+  using namespace ze;
+  this->setValue();
+  this->setValueRoi();
+
+  // Copy the region of interest to a region of the same size at the origin.
+  ImageRaw<TypeParam> dst(this->size_512_);
+  dst.setValue(this->random_value1_);
+  dst.setRoi(Roi2u(0, 0, this->roi_.width(), this->roi_.height()));
+  this->image_511_.copyTo(dst);
+  for (uint32_t y = 0u; y < dst.height(); ++y)
+  {
+    for (uint32_t x = 0u; x < dst.width(); ++x)
+    {
+      const bool inside = x < this->roi_.width() && y < this->roi_.height();
+      EXPECT_EQ(inside ? this->random_value2_ : this->random_value1_, dst(x, y));
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------
+TEST(ImageViewTest, benchmarkPixelAccess)
+{
+  using namespace ze;
+
+  ImageRaw32fC1 image(640, 480);
+  image.setValue(Pixel32fC1(1.0f));
+  float sum = 0.0f;
+
+  auto sumPixelAccessor = [&]()
+  {
+    for (uint32_t y = 0u; y < image.height(); ++y)
+    {
+      for (uint32_t x = 0u; x < image.width(); ++x)
+      {
+        sum += image(x, y);
+      }
+    }
+  };
+  auto sumView = [&]()
+  {
+    const ImageView<const Pixel32fC1> view = image;
+    for (uint32_t y = 0u; y < view.height(); ++y)
+    {
+      const Pixel32fC1* row = view.row(y);
+      for (uint32_t x = 0u; x < view.width(); ++x)
+      {
+        sum += row[x];
+      }
+    }
+  };
+  uint64_t t_accessor = runTimingBenchmark(sumPixelAccessor, 10, 10, "Image::operator()", true);
+  uint64_t t_view = runTimingBenchmark(sumView, 10, 10, "ImageView::row", true);
+  VLOG(1) << "Speedup of the view: " << static_cast<double>(t_accessor) / t_view;
+  EXPECT_GT(sum, 0.0f);
+}
+
 ZE_UNITTEST_ENTRYPOINT
@@ -0,0 +1,127 @@
+// Copyright (c) 2015-2016, ETH Zurich, Wyss Zurich, Zurich Eye
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the ETH Zurich, Wyss Zurich, Zurich Eye nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL ETH Zurich, Wyss Zurich, Zurich Eye BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <vector>
+
+#include <ze/common/benchmark.hpp>
+#include <ze/common/test_entrypoint.hpp>
+#include <imp/core/image_pool.hpp>
+
+TEST(ImagePoolTest, testReuse)
+{
+  using namespace ze;
+
+  ImagePool pool;
+  const Size2u size(752, 480);
+  const Pixel8uC1* data = nullptr;
+  {
+    ImageRaw8uC1::Ptr img = pool.acquire<Pixel8uC1>(size, PixelOrder::gray);
+    EXPECT_EQ(size, img->size());
+    EXPECT_EQ(PixelOrder::gray, img->pixelOrder());
+    EXPECT_EQ(ImageRaw8uC1(size).pitch(), img->pitch());
+    EXPECT_TRUE(MemoryStorage<Pixel8uC1>::isAligned(img->data()));
+    img->setValue(Pixel8uC1(3u));
+    data = img->data();
+  }
+  EXPECT_EQ(1u, pool.statistics().num_cached);
+
+  // Same key: the buffer is reused.
+  ImageRaw8uC1::Ptr img = pool.acquire<Pixel8uC1>(size);
+  EXPECT_EQ(data, img->data());
+  EXPECT_EQ(0u, pool.statistics().num_cached);
+
+  // Different size or pixel type: new buffers.
+  ImageRaw8uC1::Ptr img_small = pool.acquire<Pixel8uC1>(Size2u(376, 240));
+  ImageRaw32fC1::Ptr img_float = pool.acquire<Pixel32fC1>(size);
+  EXPECT_NE(static_cast<const void*>(data), static_cast<const void*>(img_float->data()));
+
+  ImagePool::Statistics stats = pool.statistics();
+  EXPECT_EQ(3u, stats.num_allocations);
+  EXPECT_EQ(1u, stats.num_reuses);
+}
+
+TEST(ImagePoolTest, testLimits)
+{
+  using namespace ze;
+
+  ImagePool::Options options;
+  options.max_cached_per_key = 2u;
+  options.max_cached_bytes = 3u * 640u * 480u;
+  ImagePool pool(options);
+
+  {
+    std::vector<ImageRaw8uC1::Ptr> images;
+    for (int i = 0; i < 4; ++i)
+    {
+      images.push_back(pool.acquire<Pixel8uC1>(Size2u(640, 480)));
+      images.push_back(pool.acquire<Pixel8uC1>(Size2u(320, 480)));
+    }
+  }
+  ImagePool::Statistics stats = pool.statistics();
+  EXPECT_EQ(8u, stats.num_allocations);
+  EXPECT_LE(stats.cached_bytes, options.max_cached_bytes);
+  EXPECT_EQ(stats.num_cached + stats.num_released, 8u);
+  EXPECT_GE(stats.num_released, 4u);
+
+  pool.trim(0u);
+  EXPECT_EQ(0u, pool.statistics().num_cached);
+  EXPECT_EQ(0u, pool.statistics().cached_bytes);
+}
+
+TEST(ImagePoolTest, testImageOutlivesPool)
+{
+  using namespace ze;
+
+  ImageRaw16uC1::Ptr img;
+  {
+    ImagePool pool;
+    img = pool.acquire<Pixel16uC1>(Size2u(100, 100));
+  }
+  img->setValue(Pixel16uC1(7u));
+  EXPECT_EQ(Pixel16uC1(7u), img->pixel(99, 99));
+}
+
+TEST(ImagePoolTest, benchmarkAcquire)
+{
+  using namespace ze;
+
+  const Size2u size(1920, 1080);
+  ImagePool pool;
+  auto allocate = [&]()
+  {
+    ImageRaw32fC1::Ptr img = std::make_shared<ImageRaw32fC1>(size);
+    img->data()[0] = Pixel32fC1(1.0f);
+  };
+  auto acquire = [&]()
+  {
+    ImageRaw32fC1::Ptr img = pool.acquire<Pixel32fC1>(size);
+    img->data()[0] = Pixel32fC1(1.0f);
+  };
+  runTimingBenchmark(allocate, 10, 10, "Allocate 1920x1080 32fC1", true);
+  runTimingBenchmark(acquire, 10, 10, "Acquire 1920x1080 32fC1 from pool", true);
+  EXPECT_EQ(1u, pool.statistics().num_allocations);
+}
+
+ZE_UNITTEST_ENTRYPOINT
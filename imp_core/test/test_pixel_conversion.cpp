@@ -0,0 +1,396 @@
+// Copyright (c) 2015-2016, ETH Zurich, Wyss Zurich, Zurich Eye
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the ETH Zurich, Wyss Zurich, Zurich Eye nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL ETH Zurich, Wyss Zurich, Zurich Eye BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#include <array>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include <ze/common/benchmark.hpp>
+#include <ze/common/random.hpp>
+#include <ze/common/test_entrypoint.hpp>
+#include <ze/common/thread_pool.hpp>
+#include <imp/core/image_raw.hpp>
+#include <imp/core/pixel_conversion.hpp>
+
+TEST(PixelConversionTest, testHalfScalar)
+{
+  using namespace ze;
+
+  EXPECT_EQ(0x0000u, floatToHalfBits(0.0f));
+  EXPECT_EQ(0x8000u, floatToHalfBits(-0.0f));
+  EXPECT_EQ(0x3c00u, floatToHalfBits(1.0f));
+  EXPECT_EQ(0xc000u, floatToHalfBits(-2.0f));
+  EXPECT_EQ(0x3555u, floatToHalfBits(1.0f / 3.0f));
+  EXPECT_EQ(0x7bffu, floatToHalfBits(65504.0f));
+  EXPECT_EQ(0x0001u, floatToHalfBits(std::ldexp(1.0f, -24)));
+  EXPECT_EQ(0x0000u, floatToHalfBits(std::ldexp(1.0f, -26)));
+
+  // Ties round to even, overflow to infinity.
+  EXPECT_EQ(0x3c00u, floatToHalfBits(1.0f + std::ldexp(1.0f, -11)));
+  EXPECT_EQ(0x3c02u, floatToHalfBits(1.0f + 3.0f * std::ldexp(1.0f, -11)));
+  EXPECT_EQ(0x7c00u, floatToHalfBits(65520.0f));
+  EXPECT_EQ(0x7c00u, floatToHalfBits(std::numeric_limits<float>::infinity()));
+  EXPECT_EQ(0x7e00u, floatToHalfBits(std::numeric_limits<float>::quiet_NaN()) & 0x7e00u);
+
+  // Every half is exactly representable as float.
+  for (uint32_t bits = 0u; bits <= 0xffffu; ++bits)
+  {
+    const float value = halfBitsToFloat(static_cast<uint16_t>(bits));
+    if (std::isnan(value))
+    {
+      EXPECT_EQ(0x7c00u, bits & 0x7c00u);
+      continue;
+    }
+    EXPECT_EQ(bits, floatToHalfBits(value)) << "bits " << bits;
+  }
+
+  Half h(0.5f);
+  h += 0.25f;
+  EXPECT_EQ(0.75f, static_cast<float>(h));
+}
+
+TEST(PixelConversionTest, testHalfArrays)
+{
+  using namespace ze;
+
+  // Odd length to exercise the tail after the vectorized part.
+  std::vector<float> values(1001);
+  auto dist = uniformDistribution<float>(ZE_DETERMINISTIC, -1000.0f, 1000.0f);
+  for (float& v : values)
+  {
+    v = dist();
+  }
+  std::vector<Half> halfs(values.size());
+  std::vector<float> back(values.size());
+  convertFloatToHalf(values.data(), halfs.data(), values.size());
+  convertHalfToFloat(halfs.data(), back.data(), halfs.size());
+  for (size_t i = 0u; i < values.size(); ++i)
+  {
+    EXPECT_EQ(floatToHalfBits(values[i]), halfs[i].bits);
+    EXPECT_EQ(halfBitsToFloat(halfs[i].bits), back[i]);
+    EXPECT_LE(std::abs(values[i] - back[i]), std::abs(values[i]) * std::ldexp(1.0f, -11));
+  }
+}
+
+TEST(PixelConversionTest, testHalfImage)
+{
+  using namespace ze;
+
+  // 3 channels and a padded width.
+  ImageRaw32fC3 src(511, 64);
+  auto dist = uniformDistribution<float>(ZE_DETERMINISTIC, 0.0f, 1.0f);
+  src.view().forEach([&](Pixel32fC3& px) { px = Pixel32fC3(dist(), dist(), dist()); });
+
+  ImageRaw16fC3 half(src.size());
+  EXPECT_EQ(PixelType::i16fC3, half.pixelType());
+  EXPECT_EQ(3u, half.nChannels());
+  EXPECT_EQ(6u, sizeof(Pixel16fC3));
+  convertImage(src, half);
+
+  ImageRaw32fC3 dst(src.size());
+  convertImage(half, dst);
+  for (uint32_t y = 0u; y < src.height(); ++y)
+  {
+    for (uint32_t x = 0u; x < src.width(); ++x)
+    {
+      for (int c = 0; c < 3; ++c)
+      {
+        EXPECT_NEAR(src(x, y)[c], dst(x, y)[c], std::ldexp(1.0f, -11));
+        EXPECT_EQ(static_cast<float>(half(x, y)[c]), dst(x, y)[c]);
+      }
+    }
+  }
+
+  // Only the region of interest is converted.
+  ImageRaw32fC1 roi_src(64, 64);
+  roi_src.setValue(Pixel32fC1(2.0f));
+  ImageRaw16fC1 roi_dst(64, 64);
+  roi_dst.setValue(Pixel16fC1(Half(1.0f)));
+  roi_dst.setRoi(Roi2u(0, 0, 32, 32));
+  roi_src.setRoi(Roi2u(32, 32, 32, 32));
+  convertImage(roi_src, roi_dst);
+  EXPECT_EQ(2.0f, static_cast<float>(roi_dst(31, 31).x));
+  EXPECT_EQ(1.0f, static_cast<float>(roi_dst(32, 31).x));
+}
+
+TEST(PixelConversionTest, testIntegerToFloat)
+{
+  using namespace ze;
+
+  ImageRaw8uC1 src8u(333, 17);
+  ImageRaw16uC2 src16u(333, 17);
+  auto dist8u = uniformDistribution<uint8_t>(ZE_DETERMINISTIC);
+  auto dist16u = uniformDistribution<uint16_t>(ZE_DETERMINISTIC);
+  src8u.view().forEach([&](Pixel8uC1& px) { px = dist8u(); });
+  src16u.view().forEach([&](Pixel16uC2& px) { px = Pixel16uC2(dist16u(), dist16u()); });
+
+  ThreadPool pool(2);
+  ImageRaw32fC1 dst8u(src8u.size());
+  ImageRaw32fC2 dst16u(src16u.size());
+  convertImage(src8u, dst8u, 1.0f / 255.0f, -0.5f);
+  convertImage(src16u, dst16u, 2.0f, 1.0f, &pool);
+  for (uint32_t y = 0u; y < src8u.height(); ++y)
+  {
+    for (uint32_t x = 0u; x < src8u.width(); ++x)
+    {
+      EXPECT_NEAR(src8u(x, y).x / 255.0f - 0.5f, dst8u(x, y).x, 1e-6f);
+      EXPECT_FLOAT_EQ(2.0f * src16u(x, y).x + 1.0f, dst16u(x, y).x);
+      EXPECT_FLOAT_EQ(2.0f * src16u(x, y).y + 1.0f, dst16u(x, y).y);
+    }
+  }
+}
+
+TEST(PixelConversionTest, testColorToGray)
+{
+  using namespace ze;
+
+  ImageRaw8uC3 rgb(101, 13, PixelOrder::rgb);
+  ImageRaw8uC4 bgra(101, 13, PixelOrder::bgra);
+  // Undefined is bgr, like in OpenCV.
+  ImageRaw8uC3 undefined(101, 13, PixelOrder::undefined);
+  auto dist = uniformDistribution<uint8_t>(ZE_DETERMINISTIC);
+  for (uint32_t y = 0u; y < rgb.height(); ++y)
+  {
+    for (uint32_t x = 0u; x < rgb.width(); ++x)
+    {
+      rgb(x, y) = Pixel8uC3(dist(), dist(), dist());
+      bgra(x, y) = Pixel8uC4(rgb(x, y).z, rgb(x, y).y, rgb(x, y).x, 255u);
+      undefined(x, y) = Pixel8uC3(rgb(x, y).z, rgb(x, y).y, rgb(x, y).x);
+    }
+  }
+
+  ImageRaw8uC1 gray_rgb(rgb.size());
+  ImageRaw8uC1 gray_bgra(rgb.size());
+  ImageRaw8uC1 gray_undefined(rgb.size());
+  convertToGray(rgb, gray_rgb);
+  convertToGray(bgra, gray_bgra);
+  convertToGray(undefined, gray_undefined);
+  for (uint32_t y = 0u; y < rgb.height(); ++y)
+  {
+    for (uint32_t x = 0u; x < rgb.width(); ++x)
+    {
+      const Pixel8uC3& px = rgb(x, y);
+      const double expected = 0.299 * px.x + 0.587 * px.y + 0.114 * px.z;
+      EXPECT_NEAR(expected, gray_rgb(x, y).x, 0.51);
+      EXPECT_EQ(gray_rgb(x, y).x, gray_bgra(x, y).x);
+      EXPECT_EQ(gray_rgb(x, y).x, gray_undefined(x, y).x);
+    }
+  }
+}
+
+TEST(PixelConversionTest, testDemosaic)
+{
+  using namespace ze;
+
+  // A constant color must be reconstructed exactly, including the borders.
+  const uint8_t r = 200u, g = 100u, b = 50u;
+  const std::vector<std::pair<BayerPattern, std::array<uint8_t, 4>>> patterns = {
+    { BayerPattern::RGGB, {{ r, g, g, b }} },
+    { BayerPattern::BGGR, {{ b, g, g, r }} },
+    { BayerPattern::GRBG, {{ g, r, b, g }} },
+    { BayerPattern::GBRG, {{ g, b, r, g }} } };
+  for (const auto& pattern : patterns)
+  {
+    ImageRaw8uC1 raw(37, 10);
+    for (uint32_t y = 0u; y < raw.height(); ++y)
+    {
+      for (uint32_t x = 0u; x < raw.width(); ++x)
+      {
+        raw(x, y) = pattern.second[2 * (y % 2) + x % 2];
+      }
+    }
+    ImageRaw8uC3 rgb(raw.size(), PixelOrder::rgb);
+    ImageRaw8uC3 bgr(raw.size(), PixelOrder::bgr);
+    ImageRaw8uC3 undefined(raw.size(), PixelOrder::undefined);
+    ImageRaw8uC1 gray(raw.size());
+    ImageRaw8uC1 gray_of_undefined(raw.size());
+    demosaic(raw, rgb, pattern.first);
+    demosaic(raw, bgr, pattern.first);
+    demosaic(raw, undefined, pattern.first);
+    demosaicToGray(raw, gray, pattern.first);
+    // Both treat the undefined order the same.
+    convertToGray(undefined, gray_of_undefined);
+    ImageRaw8uC3 rgb1(1, 1, PixelOrder::rgb);
+    rgb1(0, 0) = Pixel8uC3(r, g, b);
+    ImageRaw8uC1 gray1(1, 1);
+    convertToGray(rgb1, gray1);
+    for (uint32_t y = 0u; y < raw.height(); ++y)
+    {
+      for (uint32_t x = 0u; x < raw.width(); ++x)
+      {
+        EXPECT_EQ(r, rgb(x, y).x);
+        EXPECT_EQ(g, rgb(x, y).y);
+        EXPECT_EQ(b, rgb(x, y).z);
+        EXPECT_EQ(b, bgr(x, y).x);
+        EXPECT_EQ(r, bgr(x, y).z);
+        EXPECT_EQ(b, undefined(x, y).x);
+        EXPECT_EQ(r, undefined(x, y).z);
+        EXPECT_EQ(gray1(0, 0).x, gray(x, y).x);
+        EXPECT_EQ(gray1(0, 0).x, gray_of_undefined(x, y).x);
+      }
+    }
+  }
+
+  // Random values against a direct bilinear interpolation (RGGB).
+  ImageRaw8uC1 raw(640, 480);
+  auto dist = uniformDistribution<uint8_t>(ZE_DETERMINISTIC);
+  raw.view().forEach([&](Pixel8uC1& px) { px = dist(); });
+  {
+    ImageRaw8uC3 rgb(raw.size(), PixelOrder::rgb);
+    demosaic(raw, rgb, BayerPattern::RGGB);
+    auto at = [&](int x, int y)
+    {
+      x = x < 0 ? -x : (x >= int(raw.width()) ? 2 * int(raw.width()) - 2 - x : x);
+      y = y < 0 ? -y : (y >= int(raw.height()) ? 2 * int(raw.height()) - 2 - y : y);
+      return int(raw(x, y).x);
+    };
+    for (int y = 0; y < int(raw.height()); ++y)
+    {
+      for (int x = 0; x < int(raw.width()); ++x)
+      {
+        const int cross = (at(x - 1, y) + at(x + 1, y) + at(x, y - 1) + at(x, y + 1) + 2) / 4;
+        const int diag = (at(x - 1, y - 1) + at(x + 1, y - 1) + at(x - 1, y + 1)
+                          + at(x + 1, y + 1) + 2) / 4;
+        const int horiz = (at(x - 1, y) + at(x + 1, y) + 1) / 2;
+        const int vert = (at(x, y - 1) + at(x, y + 1) + 1) / 2;
+        Pixel8uC3 expected;
+        switch (2 * (y % 2) + x % 2)
+        {
+          case 0: expected = Pixel8uC3(at(x, y), cross, diag); break;
+          case 1: expected = Pixel8uC3(horiz, at(x, y), vert); break;
+          case 2: expected = Pixel8uC3(vert, at(x, y), horiz); break;
+          default: expected = Pixel8uC3(diag, cross, at(x, y)); break;
+        }
+        ASSERT_EQ(expected.x, rgb(x, y).x) << "at " << x << ", " << y;
+        ASSERT_EQ(expected.y, rgb(x, y).y) << "at " << x << ", " << y;
+        ASSERT_EQ(expected.z, rgb(x, y).z) << "at " << x << ", " << y;
+      }
+    }
+
+    // Gray directly from the Bayer image equals gray of the color image.
+    ImageRaw8uC1 gray(raw.size());
+    ImageRaw8uC1 gray_of_rgb(raw.size());
+    demosaicToGray(raw, gray, BayerPattern::RGGB);
+    convertToGray(rgb, gray_of_rgb);
+    for (uint32_t y = 0u; y < raw.height(); ++y)
+    {
+      EXPECT_TRUE(std::equal(gray[y], gray[y] + gray.width(), gray_of_rgb[y],
+                             [](const Pixel8uC1& a, const Pixel8uC1& b)
+      { return a.x == b.x; }));
+    }
+  }
+
+  // Parallel bands give the same result.
+  ImageRaw8uC3 serial(raw.size());
+  ImageRaw8uC3 parallel(raw.size());
+  ThreadPool pool(4);
+  demosaic(raw, serial, BayerPattern::GRBG);
+  demosaic(raw, parallel, BayerPattern::GRBG, &pool);
+  for (uint32_t y = 0u; y < raw.height(); ++y)
+  {
+    EXPECT_TRUE(std::equal(serial[y], serial[y] + serial.width(), parallel[y],
+                           [](const Pixel8uC3& a, const Pixel8uC3& b)
+    { return a.x == b.x && a.y == b.y && a.z == b.z; }));
+  }
+}
+
+TEST(PixelConversionTest, testYuv422ToGray)
+{
+  using namespace ze;
+
+  ImageRaw8uC2 yuyv(75, 9);
+  ImageRaw8uC2 uyvy(75, 9);
+  auto dist = uniformDistribution<uint8_t>(ZE_DETERMINISTIC);
+  for (uint32_t y = 0u; y < yuyv.height(); ++y)
+  {
+    for (uint32_t x = 0u; x < yuyv.width(); ++x)
+    {
+      const uint8_t luma = dist();
+      const uint8_t chroma = dist();
+      yuyv(x, y) = Pixel8uC2(luma, chroma);
+      uyvy(x, y) = Pixel8uC2(chroma, luma);
+    }
+  }
+  ImageRaw8uC1 gray_yuyv(yuyv.size());
+  ImageRaw8uC1 gray_uyvy(yuyv.size());
+  convertYuv422ToGray(yuyv, gray_yuyv, Yuv422Layout::YUYV);
+  convertYuv422ToGray(uyvy, gray_uyvy, Yuv422Layout::UYVY);
+  for (uint32_t y = 0u; y < yuyv.height(); ++y)
+  {
+    for (uint32_t x = 0u; x < yuyv.width(); ++x)
+    {
+      EXPECT_EQ(yuyv(x, y).x, gray_yuyv(x, y).x);
+      EXPECT_EQ(yuyv(x, y).x, gray_uyvy(x, y).x);
+    }
+  }
+}
+
+TEST(PixelConversionTest, benchmarkConversions)
+{
+  using namespace ze;
+
+  ImageRaw8uC1 raw(1280, 960);
+  raw.setValue(Pixel8uC1(128u));
+  ImageRaw32fC1 dst32f(raw.size());
+  ImageRaw8uC3 rgb(raw.size());
+  ImageRaw8uC1 gray(raw.size());
+
+  auto scalar8uTo32f = [&]()
+  {
+    for (uint32_t y = 0u; y < raw.height(); ++y)
+    {
+      for (uint32_t x = 0u; x < raw.width(); ++x)
+      {
+        dst32f(x, y) = raw(x, y).x / 255.0f;
+      }
+    }
+  };
+  auto simd8uTo32f = [&]() { convertImage(raw, dst32f, 1.0f / 255.0f); };
+  auto demosaicRgb = [&]() { demosaic(raw, rgb, BayerPattern::RGGB); };
+  auto demosaicGray = [&]() { demosaicToGray(raw, gray, BayerPattern::RGGB); };
+  runTimingBenchmark(scalar8uTo32f, 10, 10, "8u -> 32f per pixel", true);
+  runTimingBenchmark(simd8uTo32f, 10, 10, "8u -> 32f", true);
+  runTimingBenchmark(demosaicRgb, 10, 10, "Bayer -> RGB", true);
+  runTimingBenchmark(demosaicGray, 10, 10, "Bayer -> gray", true);
+  EXPECT_EQ(128u, gray(5, 5).x);
+}
+
+TEST(PixelConversionTest, benchmarkHalfConversion)
+{
+  using namespace ze;
+
+  ImageRaw32fC1 src(1280, 960);
+  src.setValue(Pixel32fC1(0.5f));
+  ImageRaw16fC1 half(src.size());
+  ImageRaw32fC1 dst(src.size());
+
+  auto toHalf = [&]() { convertImage(src, half); };
+  auto toFloat = [&]() { convertImage(half, dst); };
+  runTimingBenchmark(toHalf, 10, 10, "32f -> 16f", true);
+  runTimingBenchmark(toFloat, 10, 10, "16f -> 32f", true);
+  EXPECT_EQ(0.5f, dst(640, 480).x);
+}
+
+ZE_UNITTEST_ENTRYPOINT
@@ -0,0 +1,290 @@
+// Copyright (c) 2015-2016, ETH Zurich, Wyss Zurich, Zurich Eye
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the ETH Zurich, Wyss Zurich, Zurich Eye nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL ETH Zurich, Wyss Zurich, Zurich Eye BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include <ze/common/benchmark.hpp>
+#include <ze/common/random.hpp>
+#include <ze/common/test_entrypoint.hpp>
+#include <ze/common/thread_pool.hpp>
+#include <imp/core/image_raw.hpp>
+#include <imp/core/tile_executor.hpp>
+
+namespace {
+
+using namespace ze;
+
+// Stages of the tests: 8u to 32f, 3x3 box filter, Laplacian of radius 2, gain and offset.
+auto to_float = pointStage<Pixel8uC1, Pixel32fC1>([](const Pixel8uC1& p)
+{
+  return Pixel32fC1(p.x / 255.0f);
+});
+auto box_3x3 = stencilStage<Pixel32fC1, Pixel32fC1>(1u, [](const Neighborhood<Pixel32fC1>& n)
+{
+  float sum = 0.0f;
+  for (int dy = -1; dy <= 1; ++dy)
+  {
+    for (int dx = -1; dx <= 1; ++dx)
+    {
+      sum += n(dx, dy).x;
+    }
+  }
+  return Pixel32fC1(sum / 9.0f);
+});
+auto laplace_r2 = stencilStage<Pixel32fC1, Pixel32fC1>(2u, [](const Neighborhood<Pixel32fC1>& n)
+{
+  return Pixel32fC1(4.0f * n(0, 0).x - n(-2, 0).x - n(2, 0).x - n(0, -2).x - n(0, 2).x);
+});
+auto gain_offset = pointStage<Pixel32fC1, Pixel32fC1>([](const Pixel32fC1& p)
+{
+  return Pixel32fC1(2.0f * p.x + 1.0f);
+});
+
+// Runs a stage on the whole image, reading outside pixels through the border.
+template<typename Stage>
+ImageRaw<typename Stage::out_t> applyStage(
+    const ImageRaw<typename Stage::in_t>& src, const Stage& stage,
+    BorderMode border, double border_value)
+{
+  using InPixel = typename Stage::in_t;
+  const uint32_t r = stage.radius();
+  ImageRaw<InPixel> padded(src.width() + 2u * r, src.height() + 2u * r);
+  internal::gatherTile(src.roiView(),
+                       internal::TileRect{0, 0, src.width(), src.height()}.expanded(r),
+                       border, border_value, padded.roiView());
+  ImageRaw<typename Stage::out_t> dst(src.size());
+  const ImageView<const InPixel> in = padded.roiView();
+  stage.apply(in, dst.roiView());
+  return dst;
+}
+
+ImageRaw8uC1 randomImage(uint32_t width, uint32_t height)
+{
+  auto dist = uniformDistribution<uint8_t>(ZE_DETERMINISTIC);
+  ImageRaw8uC1 img(width, height);
+  img.roiView().forEach([&](Pixel8uC1& p) { p.x = dist(); });
+  return img;
+}
+
+} // anonymous namespace
+
+TEST(TileExecutorTest, testBorderIndex)
+{
+  using namespace ze;
+  using internal::borderIndex;
+
+  EXPECT_EQ(0, borderIndex(-2, 5, BorderMode::Replicate));
+  EXPECT_EQ(4, borderIndex(7, 5, BorderMode::Replicate));
+  EXPECT_EQ(3, borderIndex(3, 5, BorderMode::Replicate));
+  EXPECT_EQ(2, borderIndex(-2, 5, BorderMode::Reflect));
+  EXPECT_EQ(3, borderIndex(5, 5, BorderMode::Reflect));
+  EXPECT_EQ(1, borderIndex(7, 5, BorderMode::Reflect));
+  EXPECT_EQ(2, borderIndex(10, 5, BorderMode::Reflect));
+  EXPECT_EQ(0, borderIndex(-3, 1, BorderMode::Reflect));
+  EXPECT_EQ(-1, borderIndex(-1, 5, BorderMode::Constant));
+  EXPECT_EQ(-1, borderIndex(5, 5, BorderMode::Constant));
+  EXPECT_EQ(4, borderIndex(4, 5, BorderMode::Constant));
+}
+
+TEST(TileExecutorTest, testBorders)
+{
+  using namespace ze;
+
+  ImageRaw32fC1 ones(8, 6);
+  ones.setValue(Pixel32fC1(1.0f));
+  ImageRaw32fC1 sum(ones.size());
+  auto sum3 = stencilStage<Pixel32fC1, Pixel32fC1>(1u, [](const Neighborhood<Pixel32fC1>& n)
+  {
+    return Pixel32fC1(n(-1, -1).x + n(0, -1).x + n(1, -1).x
+                      + n(-1, 0).x + n(0, 0).x + n(1, 0).x
+                      + n(-1, 1).x + n(0, 1).x + n(1, 1).x);
+  });
+
+  TileExecutor::Options options;
+  options.border = BorderMode::Constant;
+  TileExecutor(nullptr, options).run(ones, sum, sum3);
+  EXPECT_EQ(4.0f, sum(0, 0).x);
+  EXPECT_EQ(6.0f, sum(3, 0).x);
+  EXPECT_EQ(6.0f, sum(0, 3).x);
+  EXPECT_EQ(9.0f, sum(3, 3).x);
+  EXPECT_EQ(4.0f, sum(7, 5).x);
+
+  options.border_value = 2.0;
+  TileExecutor(nullptr, options).run(ones, sum, sum3);
+  EXPECT_EQ(14.0f, sum(0, 0).x);
+  EXPECT_EQ(12.0f, sum(3, 5).x);
+
+  options.border = BorderMode::Replicate;
+  TileExecutor(nullptr, options).run(ones, sum, sum3);
+  EXPECT_EQ(9.0f, sum(0, 0).x);
+  EXPECT_EQ(9.0f, sum(7, 5).x);
+}
+
+TEST(TileExecutorTest, testChainEqualsStageByStage)
+{
+  using namespace ze;
+
+  // Odd sizes such that tiles at the right and bottom are cut.
+  const ImageRaw8uC1 src = randomImage(203, 157);
+  ThreadPool pool(3);
+
+  for (BorderMode border : {BorderMode::Replicate, BorderMode::Reflect, BorderMode::Constant})
+  {
+    const double border_value = 0.25;
+    const ImageRaw32fC1 expected =
+        applyStage(applyStage(applyStage(applyStage(src, to_float, border, border_value),
+                                         box_3x3, border, border_value),
+                              laplace_r2, border, border_value),
+                   gain_offset, border, border_value);
+
+    for (uint32_t tile_width : {0u, 7u, 32u, 256u})
+    {
+      TileExecutor::Options options;
+      options.tile_width = tile_width;
+      options.tile_height = 5u;
+      options.border = border;
+      options.border_value = border_value;
+      for (ThreadPool* p : {static_cast<ThreadPool*>(nullptr), &pool})
+      {
+        ImageRaw32fC1 dst(src.size());
+        TileExecutor(p, options).run(src, dst, to_float, box_3x3, laplace_r2, gain_offset);
+        for (uint32_t y = 0u; y < dst.height(); ++y)
+        {
+          for (uint32_t x = 0u; x < dst.width(); ++x)
+          {
+            ASSERT_NEAR(expected(x, y).x, dst(x, y).x, 1e-5f)
+                << "border " << static_cast<int>(border) << " tile width " << tile_width
+                << " at " << x << ", " << y;
+          }
+        }
+      }
+    }
+  }
+}
+
+TEST(TileExecutorTest, testRoi)
+{
+  using namespace ze;
+
+  const ImageRaw8uC1 src = randomImage(64, 48);
+  ImageRaw8uC1 src_roi(src);
+  src_roi.setRoi(Roi2u(10, 8, 30, 20));
+  ImageRaw8uC1 cropped(30, 20);
+  cropped.copyFrom(src_roi);
+
+  ImageRaw32fC1 expected(30, 20);
+  TileExecutor().run(cropped, expected, to_float, box_3x3);
+
+  // The borders are the borders of the region of interest.
+  ImageRaw32fC1 dst(64, 48);
+  dst.setValue(Pixel32fC1(-1.0f));
+  dst.setRoi(Roi2u(5, 5, 30, 20));
+  TileExecutor().run(src_roi, dst, to_float, box_3x3);
+  for (uint32_t y = 0u; y < 20u; ++y)
+  {
+    for (uint32_t x = 0u; x < 30u; ++x)
+    {
+      EXPECT_EQ(expected(x, y).x, dst(x + 5u, y + 5u).x);
+    }
+  }
+  EXPECT_EQ(-1.0f, dst(4, 5).x);
+  EXPECT_EQ(-1.0f, dst(35, 24).x);
+}
+
+TEST(TileExecutorTest, testExceptionWaitsForAllTiles)
+{
+  using namespace ze;
+
+  ThreadPool pool(4);
+  TileExecutor::Options options;
+  options.tile_width = 8u;
+  options.tile_height = 8u;
+  TileExecutor executor(&pool, options);
+
+  // The first tile throws while the others are still running, all of them
+  // must have returned when the exception arrives.
+  std::atomic<int> running(0);
+  std::atomic<int> started(0);
+  EXPECT_THROW(executor.forEachTile(Size2u(64, 64), [&](const Roi2u& roi)
+  {
+    ++running;
+    ++started;
+    if (roi.x() == 0u && roi.y() == 0u)
+    {
+      --running;
+      throw std::runtime_error("tile failed");
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    --running;
+  }), std::runtime_error);
+  EXPECT_EQ(0, running.load());
+  // Tiles that were not started yet are skipped.
+  EXPECT_LT(started.load(), 64);
+}
+
+TEST(TileExecutorTest, benchmarkScaling)
+{
+  using namespace ze;
+
+  const uint32_t max_threads = std::max(1u, std::thread::hardware_concurrency());
+  // Roughly 1, 3, 6 and 12 megapixels.
+  for (const Size2u& size : {Size2u(1152, 864), Size2u(2048, 1536),
+                             Size2u(2816, 2112), Size2u(4000, 3000)})
+  {
+    const ImageRaw8uC1 src = randomImage(size.width(), size.height());
+    ImageRaw32fC1 dst(size);
+
+    // Reference: every stage is a pass over the whole image.
+    ImageRaw32fC1 tmp0(size), tmp1(size);
+    TileExecutor serial;
+    auto separatePasses = [&]()
+    {
+      serial.run(src, tmp0, to_float);
+      serial.run(tmp0, tmp1, box_3x3);
+      serial.run(tmp1, tmp0, laplace_r2);
+      serial.run(tmp0, dst, gain_offset);
+    };
+    const double mp = size.area() * 1e-6;
+    const uint64_t separate_ns = runTimingBenchmark(separatePasses, 1, 5);
+    VLOG(1) << mp << " MP, separate passes: " << separate_ns * 1e-6 << " ms";
+
+    for (uint32_t n = 1u; n <= max_threads; n *= 2u)
+    {
+      ThreadPool pool(n);
+      TileExecutor executor(&pool);
+      auto chained = [&]() { executor.run(src, dst, to_float, box_3x3, laplace_r2, gain_offset); };
+      const uint64_t ns = runTimingBenchmark(chained, 1, 5);
+      VLOG(1) << mp << " MP, " << n << " threads: " << ns * 1e-6 << " ms, "
+              << mp / (ns * 1e-9) << " MP/s";
+    }
+  }
+}
+
+ZE_UNITTEST_ENTRYPOINT
@@ -110,13 +110,15 @@ public:
 //           uint32_t pitch, bool use_ext_data_pointer = false);
 
   /**
-   * @brief copyTo copies the internal image data to another class instance
+   * @brief copyTo copies the region of interest to the region of interest of
+   *        another class instance
    * @param dst Image class that will receive this image's data.
    */
   virtual void copyTo(Base& dst) const override;
 
   /**
-   * @brief copyFrom copies the image data from another class instance to this image
+   * @brief copyFrom copies the region of interest of another class instance to
+   *        the region of interest of this image
    * @param from Image class providing the image data.
    */
   virtual void copyFrom(const Base& from) override;
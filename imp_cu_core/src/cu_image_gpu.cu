@@ -106,17 +106,40 @@ ImageGpu<Pixel>::~ImageGpu()
 {
 }
 
+//-----------------------------------------------------------------------------
+namespace {
+
+//! Start of the region of interest. Offsetting the base pointer works for host
+//! and device memory alike, as ImageGpu::data() refuses offsets.
+template<typename Pixel>
+const uint8_t* roiData(const ze::Image<Pixel>& img)
+{
+  return reinterpret_cast<const uint8_t*>(img.data())
+      + static_cast<size_t>(img.roi().y()) * img.pitch()
+      + static_cast<size_t>(img.roi().x()) * sizeof(Pixel);
+}
+
+template<typename Pixel>
+uint8_t* roiData(ze::Image<Pixel>& img)
+{
+  return reinterpret_cast<uint8_t*>(img.data())
+      + static_cast<size_t>(img.roi().y()) * img.pitch()
+      + static_cast<size_t>(img.roi().x()) * sizeof(Pixel);
+}
+
+} // anonymous namespace
+
 //-----------------------------------------------------------------------------
 template<typename Pixel>
 void ImageGpu<Pixel>::copyTo(ze::Image<Pixel>& dst) const
 {
-  CHECK_EQ(this->size(), dst.size());
+  CHECK_EQ(this->roi().size(), dst.roi().size());
   cudaMemcpyKind memcpy_kind = dst.isGpuMemory() ? cudaMemcpyDeviceToDevice :
                                                    cudaMemcpyDeviceToHost;
-  const cudaError cu_err = cudaMemcpy2D(dst.data(), dst.pitch(),
-                                        this->data(), this->pitch(),
-                                        this->rowBytes(),
-                                        this->height(), memcpy_kind);
+  const cudaError cu_err = cudaMemcpy2D(roiData(dst), dst.pitch(),
+                                        roiData(*this), this->pitch(),
+                                        this->roi().width() * sizeof(Pixel),
+                                        this->roi().height(), memcpy_kind);
   CHECK_EQ(cu_err, ::cudaSuccess);
 }
 
@@ -124,13 +147,13 @@ void ImageGpu<Pixel>::copyTo(ze::Image<Pixel>& dst) const
 template<typename Pixel>
 void ImageGpu<Pixel>::copyFrom(const Image<Pixel>& from)
 {
-  CHECK_EQ(this->size(), from.size());
+  CHECK_EQ(this->roi().size(), from.roi().size());
   cudaMemcpyKind memcpy_kind = from.isGpuMemory() ? cudaMemcpyDeviceToDevice :
                                                     cudaMemcpyHostToDevice;
-  const cudaError cu_err = cudaMemcpy2D(this->data(), this->pitch(),
-                                        from.data(), from.pitch(),
-                                        this->rowBytes(),
-                                        this->height(), memcpy_kind);
+  const cudaError cu_err = cudaMemcpy2D(roiData(*this), this->pitch(),
+                                        roiData(from), from.pitch(),
+                                        this->roi().width() * sizeof(Pixel),
+                                        this->roi().height(), memcpy_kind);
   CHECK_EQ(cu_err, ::cudaSuccess);
 }
 
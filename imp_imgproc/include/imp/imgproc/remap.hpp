@@ -0,0 +1,106 @@
+// Copyright (c) 2015-2016, ETH Zurich, Wyss Zurich, Zurich Eye
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the ETH Zurich, Wyss Zurich, Zurich Eye nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL ETH Zurich, Wyss Zurich, Zurich Eye BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <imp/core/image.hpp>
+#include <imp/core/size.hpp>
+#include <ze/common/types.hpp>
+
+namespace ze {
+
+// fwd
+class ThreadPool;
+
+//! Source footprint of one destination pixel in a RemapMap: the top-left
+//! source pixel of the 2x2 bilinear neighbourhood and the sub-pixel weights
+//! in fixed-point (Q7) format.
+struct RemapEntry
+{
+  int16_t x;
+  int16_t y;
+  uint8_t wx;
+  uint8_t wy;
+};
+
+//! \brief Compact fixed-point version of a (2-channels) float remapping map.
+//!
+//! Source positions are clamped to the image border when the map is built,
+//! which reproduces the clamp addressing of the GPU texture fetch. Hence the
+//! 2x2 neighbourhood of every entry is inside the source image and remapping
+//! needs no bounds checks. 6 bytes per pixel instead of 8 for Pixel32fC2.
+class RemapMap
+{
+public:
+  static constexpr int c_frac_bits = 7;
+  static constexpr int c_frac_one = 1 << c_frac_bits;
+
+  RemapMap() = default;
+
+  //! \brief RemapMap
+  //! \param map Source position [x, y] for every destination pixel.
+  //! \param src_size Size of the images that will be remapped.
+  RemapMap(const Image32fC2& map, const Size2u& src_size);
+
+  ~RemapMap() = default;
+
+  //! Size of the destination image.
+  inline const Size2u& size() const { return size_; }
+
+  //! Size of the source image.
+  inline const Size2u& sourceSize() const { return src_size_; }
+
+  inline const RemapEntry* row(uint32_t y) const
+  {
+    return entries_.data() + y * size_.width();
+  }
+
+  //! Source position that is interpolated for destination pixel (x, y).
+  Vector2 sourcePosition(uint32_t x, uint32_t y) const;
+
+  inline size_t bytes() const { return entries_.size() * sizeof(RemapEntry); }
+
+private:
+  Size2u size_{0, 0};
+  Size2u src_size_{0, 0};
+  std::vector<RemapEntry> entries_;
+};
+
+//! \brief Remap src to dst with bilinear interpolation.
+//! \param dst Destination image, must have the size of the map.
+//! \param src Source image, must have the source size of the map.
+//! \param map Fixed-point remapping map.
+//! \param pool If set, rows are split in bands that run on the pool. Must not
+//! be called from a task of the same pool.
+template<typename Pixel>
+void remap(
+    Image<Pixel>& dst,
+    const Image<Pixel>& src,
+    const RemapMap& map,
+    ThreadPool* pool = nullptr);
+
+} // namespace ze
@@ -0,0 +1,100 @@
+// Copyright (c) 2015-2016, ETH Zurich, Wyss Zurich, Zurich Eye
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the ETH Zurich, Wyss Zurich, Zurich Eye nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL ETH Zurich, Wyss Zurich, Zurich Eye BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#pragma once
+
+#include <memory>
+
+#include <imp/core/image_raw.hpp>
+#include <imp/imgproc/remap.hpp>
+#include <ze/cameras/camera_models.hpp>
+
+namespace ze {
+
+//! \brief Compute the undistortion-rectification map on the CPU, same as the
+//! GPU kernel.
+//! \param map Output source position for every pixel, defines the size.
+//! \param camera_params The camera parameters [fx, fy, cx, cy]^T.
+//! \param transformed_camera_params The camera parameters
+//! [fx, fy, cx, cy]^T in the rectified reference frame.
+//! \param dist_coeffs Camera distortion coefficients.
+//! \param inv_H Inverse of the rectifying homography.
+template<typename CameraModel,
+         typename DistortionModel>
+void computeUndistortRectifyMap(
+    Image32fC2& map,
+    const Vector4& camera_params,
+    const Vector4& transformed_camera_params,
+    const Vector4& dist_coeffs,
+    const Matrix3& inv_H);
+
+//! \brief A StereoRectifier can rectify images using the CPU, counterpart of
+//! cu::StereoRectifier.
+template<typename CameraModel,
+         typename DistortionModel,
+         typename Pixel>
+class StereoRectifier
+{
+public:
+  //! \brief StereoRectifier
+  //! \param img_size The size of the images to rectify.
+  //! \param camera_params The camera parameters [fx, fy, cx, cy]^T.
+  //! \param transformed_camera_params The camera parameters
+  //! [fx, fy, cx, cy]^T in the rectified reference frame.
+  //! \param dist_coeffs Camera distortion coefficients.
+  //! \param inv_H Inverse of the rectifying homography.
+  StereoRectifier(const Size2u& img_size,
+                  const Vector4& camera_params,
+                  const Vector4& transformed_camera_params,
+                  const Vector4& dist_coeffs,
+                  const Matrix3& inv_H);
+
+  ~StereoRectifier() = default;
+
+  //! \brief Rectify
+  //! \param dst Destination image to store rectification result.
+  //! \param src The image to rectify.
+  void rectify(Image<Pixel>& dst,
+               const Image<Pixel>& src) const;
+
+  //! \brief Retrieves the computed undistortion-rectification map
+  const RemapMap& getUndistortRectifyMap() const;
+
+  //! Run rectify() on the given pool, nullptr uses the calling thread.
+  inline void setThreadPool(const std::shared_ptr<ThreadPool>& pool)
+  {
+    pool_ = pool;
+  }
+
+private:
+  RemapMap undistort_rectify_map_;   //!< Fixed-point undistortion-rectification map
+  std::shared_ptr<ThreadPool> pool_;
+};
+
+using EquidistStereoRectifier8uC1 = StereoRectifier<PinholeGeometry, EquidistantDistortion, Pixel8uC1>;
+using EquidistStereoRectifier32fC1 = StereoRectifier<PinholeGeometry, EquidistantDistortion, Pixel32fC1>;
+using RadTanStereoRectifier8uC1 = StereoRectifier<PinholeGeometry, RadialTangentialDistortion, Pixel8uC1>;
+using RadTanStereoRectifier32fC1 = StereoRectifier<PinholeGeometry, RadialTangentialDistortion, Pixel32fC1>;
+
+} // ze namespace
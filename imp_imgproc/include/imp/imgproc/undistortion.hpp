@@ -0,0 +1,85 @@
+// Copyright (c) 2015-2016, ETH Zurich, Wyss Zurich, Zurich Eye
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the ETH Zurich, Wyss Zurich, Zurich Eye nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL ETH Zurich, Wyss Zurich, Zurich Eye BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#pragma once
+
+#include <memory>
+
+#include <imp/core/image_raw.hpp>
+#include <imp/imgproc/remap.hpp>
+#include <ze/cameras/camera_models.hpp>
+
+namespace ze {
+
+//! \brief Compute the undistortion map on the CPU, same as the GPU kernel.
+//! \param map Output source position for every pixel, defines the size.
+//! \param camera_params The camera parameters [fx, fy, cx, cy]^T.
+//! \param dist_coeffs Camera distortion coefficients.
+template<typename CameraModel,
+         typename DistortionModel>
+void computeUndistortionMap(
+    Image32fC2& map,
+    const VectorX& camera_params,
+    const VectorX& dist_coeffs);
+
+//! \brief CPU counterpart of cu::ImageUndistorter.
+//!
+//! The map is computed once and stored in fixed-point format. Undistortion
+//! is a bilinear remap, optionally split in row bands on a thread pool.
+template<typename CameraModel,
+         typename DistortionModel,
+         typename Pixel>
+class ImageUndistorter
+{
+public:
+  ImageUndistorter(
+      const Size2u& img_size,
+      const VectorX& camera_params,
+      const VectorX& dist_coeffs);
+
+  ~ImageUndistorter() = default;
+
+  void undistort(
+      Image<Pixel>& dst,
+      const Image<Pixel>& src) const;
+
+  const RemapMap& getUndistortionMap() const;
+
+  //! Run undistort() on the given pool, nullptr uses the calling thread.
+  inline void setThreadPool(const std::shared_ptr<ThreadPool>& pool)
+  {
+    pool_ = pool;
+  }
+
+private:
+  RemapMap undistortion_map_;
+  std::shared_ptr<ThreadPool> pool_;
+};
+
+using EquidistUndistort8uC1 = ImageUndistorter<PinholeGeometry, EquidistantDistortion, Pixel8uC1>;
+using EquidistUndistort32fC1 = ImageUndistorter<PinholeGeometry, EquidistantDistortion, Pixel32fC1>;
+using RadTanUndistort8uC1 = ImageUndistorter<PinholeGeometry, RadialTangentialDistortion, Pixel8uC1>;
+using RadTanUndistort32fC1 = ImageUndistorter<PinholeGeometry, RadialTangentialDistortion, Pixel32fC1>;
+
+} // ze namespace
@@ -0,0 +1,204 @@
+// Copyright (c) 2015-2016, ETH Zurich, Wyss Zurich, Zurich Eye
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the ETH Zurich, Wyss Zurich, Zurich Eye nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL ETH Zurich, Wyss Zurich, Zurich Eye BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#include <imp/imgproc/remap.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <future>
+
+#include <Eigen/Core>
+#include <ze/common/logging.hpp>
+#include <ze/common/thread_pool.hpp>
+
+namespace ze {
+
+namespace {
+
+//! Number of pixels that are gathered before interpolating them with SIMD.
+constexpr uint32_t c_remap_block_size = 64u;
+
+//! Number of rows per task when remapping on a thread pool.
+constexpr uint32_t c_remap_band_height = 32u;
+
+using RemapBlock = Eigen::Array<float, c_remap_block_size, 1>;
+
+template<typename T>
+inline T castInterpolated(float val)
+{
+  return static_cast<T>(val + 0.5f);
+}
+
+template<>
+inline float castInterpolated<float>(float val)
+{
+  return val;
+}
+
+template<typename Pixel>
+void remapRows(
+    Image<Pixel>& dst,
+    const Image<Pixel>& src,
+    const RemapMap& map,
+    uint32_t y_begin,
+    uint32_t y_end)
+{
+  using T = typename Pixel::T;
+  static_assert(sizeof(Pixel) == sizeof(T), "Only single-channel images.");
+  const ImageView<const Pixel> src_view = src.view();
+  const ImageView<Pixel> dst_view = dst.view();
+  const T* src_data = reinterpret_cast<const T*>(src_view.data());
+  const size_t src_stride = src_view.stride();
+  const uint32_t width = dst.width();
+  const float c_frac_scale = 1.0f / RemapMap::c_frac_one;
+
+  RemapBlock p00, p01, p10, p11, wx, wy;
+  p00.setZero(); p01.setZero(); p10.setZero(); p11.setZero();
+  wx.setZero(); wy.setZero();
+  for (uint32_t y = y_begin; y < y_end; ++y)
+  {
+    const RemapEntry* entries = map.row(y);
+    T* dst_row = reinterpret_cast<T*>(dst_view.row(y));
+    for (uint32_t x = 0u; x < width; x += c_remap_block_size)
+    {
+      const uint32_t n = std::min(c_remap_block_size, width - x);
+
+      // Gather the 2x2 neighbourhoods, the map guarantees they are inside.
+      for (uint32_t i = 0u; i < n; ++i)
+      {
+        const RemapEntry& e = entries[x + i];
+        const T* r0 = src_data + e.y * src_stride + e.x;
+        const T* r1 = r0 + src_stride;
+        p00(i) = r0[0];
+        p01(i) = r0[1];
+        p10(i) = r1[0];
+        p11(i) = r1[1];
+        wx(i) = e.wx;
+        wy(i) = e.wy;
+      }
+
+      // Interpolate the block. Written as convex combinations such that
+      // integer source positions reproduce the source pixel exactly.
+      const RemapBlock fx = wx * c_frac_scale;
+      const RemapBlock fy = wy * c_frac_scale;
+      const RemapBlock top = p00 * (1.0f - fx) + p01 * fx;
+      const RemapBlock bottom = p10 * (1.0f - fx) + p11 * fx;
+      const RemapBlock val = top * (1.0f - fy) + bottom * fy;
+      for (uint32_t i = 0u; i < n; ++i)
+      {
+        dst_row[x + i] = castInterpolated<T>(val(i));
+      }
+    }
+  }
+}
+
+} // anonymous namespace
+
+//------------------------------------------------------------------------------
+RemapMap::RemapMap(const Image32fC2& map, const Size2u& src_size)
+  : size_(map.size())
+  , src_size_(src_size)
+  , entries_(map.size().area())
+{
+  CHECK_GE(src_size.width(), 2u);
+  CHECK_GE(src_size.height(), 2u);
+  CHECK_LE(src_size.width(), static_cast<uint32_t>(INT16_MAX));
+  CHECK_LE(src_size.height(), static_cast<uint32_t>(INT16_MAX));
+
+  const float max_x = src_size.width() - 1;
+  const float max_y = src_size.height() - 1;
+  const int max_x0 = src_size.width() - 2;
+  const int max_y0 = src_size.height() - 2;
+  const ImageView<const Pixel32fC2> map_view = map.view();
+  for (uint32_t y = 0u; y < size_.height(); ++y)
+  {
+    const Pixel32fC2* map_row = map_view.row(y);
+    RemapEntry* entries = entries_.data() + y * size_.width();
+    for (uint32_t x = 0u; x < size_.width(); ++x)
+    {
+      // Clamping the position is equivalent to clamping the four taps.
+      const float px = std::isfinite(map_row[x][0])
+          ? std::min(std::max(map_row[x][0], 0.0f), max_x) : 0.0f;
+      const float py = std::isfinite(map_row[x][1])
+          ? std::min(std::max(map_row[x][1], 0.0f), max_y) : 0.0f;
+      const int x0 = std::min(static_cast<int>(px), max_x0);
+      const int y0 = std::min(static_cast<int>(py), max_y0);
+      RemapEntry& e = entries[x];
+      e.x = static_cast<int16_t>(x0);
+      e.y = static_cast<int16_t>(y0);
+      e.wx = static_cast<uint8_t>(std::lround((px - x0) * c_frac_one));
+      e.wy = static_cast<uint8_t>(std::lround((py - y0) * c_frac_one));
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+Vector2 RemapMap::sourcePosition(uint32_t x, uint32_t y) const
+{
+  DCHECK_LT(x, size_.width());
+  DCHECK_LT(y, size_.height());
+  const RemapEntry& e = row(y)[x];
+  return Vector2(e.x + static_cast<real_t>(e.wx) / c_frac_one,
+                 e.y + static_cast<real_t>(e.wy) / c_frac_one);
+}
+
+//------------------------------------------------------------------------------
+template<typename Pixel>
+void remap(
+    Image<Pixel>& dst,
+    const Image<Pixel>& src,
+    const RemapMap& map,
+    ThreadPool* pool)
+{
+  CHECK_EQ(dst.size(), map.size());
+  CHECK_EQ(src.size(), map.sourceSize());
+
+  const uint32_t height = dst.height();
+  if (!pool || height <= c_remap_band_height)
+  {
+    remapRows(dst, src, map, 0u, height);
+    return;
+  }
+
+  std::vector<std::future<void>> bands;
+  for (uint32_t y = 0u; y < height; y += c_remap_band_height)
+  {
+    const uint32_t y_end = std::min(y + c_remap_band_height, height);
+    bands.push_back(pool->enqueue([&dst, &src, &map, y, y_end]()
+    {
+      remapRows(dst, src, map, y, y_end);
+    }));
+  }
+  for (std::future<void>& band : bands)
+  {
+    band.get();
+  }
+}
+
+// Explicit template instantiations
+template void remap(Image8uC1&, const Image8uC1&, const RemapMap&, ThreadPool*);
+template void remap(Image16uC1&, const Image16uC1&, const RemapMap&, ThreadPool*);
+template void remap(Image32fC1&, const Image32fC1&, const RemapMap&, ThreadPool*);
+
+} // namespace ze
@@ -0,0 +1,108 @@
+// Copyright (c) 2015-2016, ETH Zurich, Wyss Zurich, Zurich Eye
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the ETH Zurich, Wyss Zurich, Zurich Eye nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL ETH Zurich, Wyss Zurich, Zurich Eye BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#include <imp/imgproc/stereo_rectification.hpp>
+
+#include <ze/common/logging.hpp>
+
+namespace ze {
+
+template<typename CameraModel,
+         typename DistortionModel>
+void computeUndistortRectifyMap(
+    Image32fC2& map,
+    const Vector4& camera_params,
+    const Vector4& transformed_camera_params,
+    const Vector4& dist_coeffs,
+    const Matrix3& inv_H)
+{
+  const Eigen::Vector4f cp_flt = camera_params.cast<float>();
+  const Eigen::Vector4f tcp_flt = transformed_camera_params.cast<float>();
+  const Eigen::Vector4f dist_flt = dist_coeffs.cast<float>();
+  const Eigen::Matrix3f inv_H_flt = inv_H.cast<float>();
+  const ImageView<Pixel32fC2> map_view = map.view();
+  for (uint32_t v = 0; v < map.height(); ++v)
+  {
+    Pixel32fC2* map_row = map_view.row(v);
+    for (uint32_t u = 0; u < map.width(); ++u)
+    {
+      float px[2]{static_cast<float>(u), static_cast<float>(v)};
+      CameraModel::backProject(tcp_flt.data(), px);
+      const Eigen::Vector3f p = inv_H_flt * Eigen::Vector3f(px[0], px[1], 1.0f);
+      px[0] = p(0) / p(2);
+      px[1] = p(1) / p(2);
+      DistortionModel::distort(dist_flt.data(), px);
+      CameraModel::project(cp_flt.data(), px);
+      map_row[u][0] = px[0];
+      map_row[u][1] = px[1];
+    }
+  }
+}
+
+template <typename CameraModel,
+          typename DistortionModel,
+          typename Pixel>
+StereoRectifier<CameraModel, DistortionModel, Pixel>::StereoRectifier(
+    const Size2u& img_size,
+    const Vector4& camera_params,
+    const Vector4& transformed_camera_params,
+    const Vector4& dist_coeffs,
+    const Matrix3& inv_H)
+{
+  ImageRaw32fC2 map(img_size);
+  computeUndistortRectifyMap<CameraModel, DistortionModel>(
+        map, camera_params, transformed_camera_params, dist_coeffs, inv_H);
+  undistort_rectify_map_ = RemapMap(map, img_size);
+}
+
+template <typename CameraModel,
+          typename DistortionModel,
+          typename Pixel>
+void StereoRectifier<CameraModel, DistortionModel, Pixel>::rectify(
+    Image<Pixel>& dst,
+    const Image<Pixel>& src) const
+{
+  CHECK_EQ(src.size(), dst.size());
+  remap(dst, src, undistort_rectify_map_, pool_.get());
+}
+
+template <typename CameraModel,
+          typename DistortionModel,
+          typename Pixel>
+const RemapMap& StereoRectifier<CameraModel, DistortionModel, Pixel>::getUndistortRectifyMap() const
+{
+  return undistort_rectify_map_;
+}
+
+// Explicit template instantiations
+template void computeUndistortRectifyMap<PinholeGeometry, EquidistantDistortion>(
+    Image32fC2&, const Vector4&, const Vector4&, const Vector4&, const Matrix3&);
+template void computeUndistortRectifyMap<PinholeGeometry, RadialTangentialDistortion>(
+    Image32fC2&, const Vector4&, const Vector4&, const Vector4&, const Matrix3&);
+template class StereoRectifier<PinholeGeometry, EquidistantDistortion, Pixel8uC1>;
+template class StereoRectifier<PinholeGeometry, EquidistantDistortion, Pixel32fC1>;
+template class StereoRectifier<PinholeGeometry, RadialTangentialDistortion, Pixel8uC1>;
+template class StereoRectifier<PinholeGeometry, RadialTangentialDistortion, Pixel32fC1>;
+
+} // ze namespace
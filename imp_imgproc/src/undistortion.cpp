@@ -0,0 +1,99 @@
+// Copyright (c) 2015-2016, ETH Zurich, Wyss Zurich, Zurich Eye
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the ETH Zurich, Wyss Zurich, Zurich Eye nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL ETH Zurich, Wyss Zurich, Zurich Eye BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#include <imp/imgproc/undistortion.hpp>
+
+#include <ze/common/logging.hpp>
+
+namespace ze {
+
+template<typename CameraModel,
+         typename DistortionModel>
+void computeUndistortionMap(
+    Image32fC2& map,
+    const VectorX& camera_params,
+    const VectorX& dist_coeffs)
+{
+  const Eigen::VectorXf cp_flt = camera_params.cast<float>();
+  const Eigen::VectorXf dist_flt = dist_coeffs.cast<float>();
+  const ImageView<Pixel32fC2> map_view = map.view();
+  for (uint32_t y = 0; y < map.height(); ++y)
+  {
+    Pixel32fC2* map_row = map_view.row(y);
+    for (uint32_t x = 0; x < map.width(); ++x)
+    {
+      float px[2]{static_cast<float>(x), static_cast<float>(y)};
+      CameraModel::backProject(cp_flt.data(), px);
+      DistortionModel::distort(dist_flt.data(), px);
+      CameraModel::project(cp_flt.data(), px);
+      map_row[x][0] = px[0];
+      map_row[x][1] = px[1];
+    }
+  }
+}
+
+template <typename CameraModel,
+          typename DistortionModel,
+          typename Pixel>
+ImageUndistorter<CameraModel, DistortionModel, Pixel>::ImageUndistorter(
+    const Size2u& img_size,
+    const VectorX& camera_params,
+    const VectorX& dist_coeffs)
+{
+  ImageRaw32fC2 map(img_size);
+  computeUndistortionMap<CameraModel, DistortionModel>(
+        map, camera_params, dist_coeffs);
+  undistortion_map_ = RemapMap(map, img_size);
+}
+
+template <typename CameraModel,
+          typename DistortionModel,
+          typename Pixel>
+void ImageUndistorter<CameraModel, DistortionModel, Pixel>::undistort(
+    Image<Pixel>& dst,
+    const Image<Pixel>& src) const
+{
+  CHECK_EQ(src.size(), dst.size());
+  remap(dst, src, undistortion_map_, pool_.get());
+}
+
+template <typename CameraModel,
+          typename DistortionModel,
+          typename Pixel>
+const RemapMap& ImageUndistorter<CameraModel, DistortionModel, Pixel>::getUndistortionMap() const
+{
+  return undistortion_map_;
+}
+
+// Explicit template instantiations
+template void computeUndistortionMap<PinholeGeometry, EquidistantDistortion>(
+    Image32fC2&, const VectorX&, const VectorX&);
+template void computeUndistortionMap<PinholeGeometry, RadialTangentialDistortion>(
+    Image32fC2&, const VectorX&, const VectorX&);
+template class ImageUndistorter<PinholeGeometry, EquidistantDistortion, Pixel8uC1>;
+template class ImageUndistorter<PinholeGeometry, EquidistantDistortion, Pixel32fC1>;
+template class ImageUndistorter<PinholeGeometry, RadialTangentialDistortion, Pixel8uC1>;
+template class ImageUndistorter<PinholeGeometry, RadialTangentialDistortion, Pixel32fC1>;
+
+} // ze namespace
@@ -0,0 +1,230 @@
+// Copyright (c) 2015-2016, ETH Zurich, Wyss Zurich, Zurich Eye
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the ETH Zurich, Wyss Zurich, Zurich Eye nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL ETH Zurich, Wyss Zurich, Zurich Eye BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#include <fstream>
+
+#include <imp/core/image_raw.hpp>
+#include <imp/imgproc/horizontal_stereo_pair_rectifier.hpp>
+#include <imp/imgproc/stereo_rectification.hpp>
+#include <ze/cameras/camera_rig.hpp>
+#include <ze/common/file_utils.hpp>
+#include <ze/common/test_entrypoint.hpp>
+#include <ze/common/test_utils.hpp>
+
+namespace ze {
+
+void testRectificationMapAgainstFile(
+    const Image32fC2& map,
+    const RemapMap& fixed_point_map,
+    const std::string& map_x_file_path,
+    const std::string& map_y_file_path,
+    float tolerance)
+{
+  CHECK(fileExists(map_x_file_path));
+  CHECK(fileExists(map_y_file_path));
+
+  std::ifstream map_x_file(map_x_file_path, std::ofstream::binary);
+  std::ifstream map_y_file(map_y_file_path, std::ofstream::binary);
+  CHECK(map_x_file.is_open());
+  CHECK(map_y_file.is_open());
+
+  const size_t map_width = map.width();
+  const size_t map_height = map.height();
+  const size_t map_n_elems = map_width * map_height;
+
+  std::unique_ptr<float[]> gt_map_x(new float[map_n_elems]);
+  std::unique_ptr<float[]> gt_map_y(new float[map_n_elems]);
+
+  map_x_file.read(
+        reinterpret_cast<char*>(gt_map_x.get()), map_n_elems*sizeof(float));
+  map_y_file.read(
+        reinterpret_cast<char*>(gt_map_y.get()), map_n_elems*sizeof(float));
+
+  // Compare computed map with ground-truth map. The fixed-point map is
+  // clamped to the image, compare it only inside.
+  const float fixed_point_tolerance = tolerance + 0.5f / RemapMap::c_frac_one;
+  for (uint32_t y = 0; y < map_height; ++y)
+  {
+    for (uint32_t x = 0; x < map_width; ++x)
+    {
+      const float gt_x = gt_map_x.get()[y*map_width+x];
+      const float gt_y = gt_map_y.get()[y*map_width+x];
+      EXPECT_NEAR(gt_x, map(x, y)[0], tolerance);
+      EXPECT_NEAR(gt_y, map(x, y)[1], tolerance);
+      if (gt_x >= 0.0f && gt_x <= map_width - 1
+          && gt_y >= 0.0f && gt_y <= map_height - 1)
+      {
+        const Vector2 src_px = fixed_point_map.sourcePosition(x, y);
+        EXPECT_NEAR(gt_x, src_px(0), fixed_point_tolerance);
+        EXPECT_NEAR(gt_y, src_px(1), fixed_point_tolerance);
+      }
+    }
+  }
+}
+
+} // ze namespace
+
+using namespace ze;
+
+TEST(impStereoRectifier, radTan32fC1)
+{
+  constexpr float c_map_tolerance{0.001};
+  const std::string test_folder =
+      ze::joinPath(ze::getTestDataDir("imp_cu_imgproc"), "stereo_rectifier");
+  const std::string calib_file =
+      ze::joinPath(test_folder, "stereo_parameters.yaml");
+
+  ze::CameraRig::Ptr rig = ze::cameraRigFromYaml(calib_file);
+  VLOG(2) << "loaded camera rig from yaml file " << calib_file;
+
+  // use 3x3 submatrix returned in left_P, right_P
+  Vector4 left_intrinsics;
+  left_intrinsics << 972.2670826175212, 972.2670826175212, 654.0978851318359, 482.1916770935059;
+
+  Vector4 original_left_intrinsics =
+      rig->at(0).projectionParameters();
+  Vector4 left_distortion =
+      rig->at(0).distortionParameters();
+
+  Matrix3 left_H;
+  left_H << 0.9999716948470486, 0.002684020348481424, -0.007028907417937792,
+      -0.002697713727894102, 0.9999944805267602, -0.001939395951741348,
+      0.007023663243873155, 0.00195830303687577, 0.9999734162485783;
+
+  const Size2u img_size = rig->at(0).size();
+  Matrix3 left_H_inv = left_H.inverse();
+
+  // Allocate rectifier
+  RadTanStereoRectifier32fC1 left_rectifier(
+        img_size, original_left_intrinsics, left_intrinsics,
+        left_distortion, left_H_inv);
+  ImageRaw32fC2 left_map(img_size);
+  computeUndistortRectifyMap<PinholeGeometry, RadialTangentialDistortion>(
+        left_map, original_left_intrinsics, left_intrinsics,
+        left_distortion, left_H_inv);
+  CHECK_EQ(img_size, left_rectifier.getUndistortRectifyMap().size());
+
+  // Test against ground-truth maps
+  const std::string gt_left_map_x_path =
+      joinPath(test_folder, "map_x_left.bin");
+  const std::string gt_left_map_y_path =
+      joinPath(test_folder, "map_y_left.bin");
+  testRectificationMapAgainstFile(left_map,
+                                  left_rectifier.getUndistortRectifyMap(),
+                                  gt_left_map_x_path,
+                                  gt_left_map_y_path,
+                                  c_map_tolerance);
+
+  // Rectifying a constant image must preserve it.
+  ImageRaw32fC1 src(img_size);
+  src.setValue(Pixel32fC1(0.25f));
+  ImageRaw32fC1 dst(img_size);
+  left_rectifier.rectify(dst, src);
+  for (uint32_t y = 0; y < dst.height(); ++y)
+  {
+    for (uint32_t x = 0; x < dst.width(); ++x)
+    {
+      EXPECT_FLOAT_EQ(0.25f, dst(x, y));
+    }
+  }
+}
+
+TEST(impStereoRectifier, horizontalStereoPairRadTan32fC1)
+{
+  constexpr float c_map_tolerance{1.0f};
+  const std::string test_folder =
+      ze::joinPath(ze::getTestDataDir("imp_cu_imgproc"), "stereo_rectifier");
+  const std::string calib_file =
+      ze::joinPath(test_folder, "stereo_parameters.yaml");
+
+  ze::CameraRig::Ptr rig = ze::cameraRigFromYaml(calib_file);
+  VLOG(2) << "loaded camera rig from yaml file " << calib_file;
+
+  Vector4 left_cam_params =
+      rig->at(0).projectionParameters();
+  Vector4 left_distortion =
+      rig->at(0).distortionParameters();
+  Vector4 right_cam_params =
+      rig->at(1).projectionParameters();
+  Vector4 right_distortion =
+      rig->at(1).distortionParameters();
+
+  ze::Transformation T_C0_B = rig->T_C_B(0);
+  ze::Transformation T_C1_B = rig->T_C_B(1);
+  ze::Transformation T_C0_C1 = T_C0_B * T_C1_B.inverse();
+
+  // Allocate rectifier
+  const Size2u img_size = rig->at(0).size();
+  Vector4 transformed_left_cam_params;
+  Vector4 transformed_right_cam_params;
+  real_t horizontal_offset;
+  HorizontalStereoPairRectifierRadTan32fC1 rectifier(
+        transformed_left_cam_params,
+        transformed_right_cam_params,
+        horizontal_offset,
+        img_size,
+        left_cam_params,
+        left_distortion,
+        right_cam_params,
+        right_distortion,
+        T_C0_C1);
+
+  // Recompute the float maps for the comparison with ground-truth.
+  Matrix3 left_H, right_H;
+  std::tie(left_H, right_H, std::ignore, std::ignore, std::ignore) =
+      computeHorizontalStereoParameters<PinholeGeometry, RadialTangentialDistortion>(
+        img_size, left_cam_params, left_distortion,
+        right_cam_params, right_distortion, T_C0_C1);
+  ImageRaw32fC2 left_map(img_size);
+  ImageRaw32fC2 right_map(img_size);
+  computeUndistortRectifyMap<PinholeGeometry, RadialTangentialDistortion>(
+        left_map, left_cam_params, transformed_left_cam_params,
+        left_distortion, left_H.inverse());
+  computeUndistortRectifyMap<PinholeGeometry, RadialTangentialDistortion>(
+        right_map, right_cam_params, transformed_right_cam_params,
+        right_distortion, right_H.inverse());
+
+  // Test against ground-truth maps
+  const std::string gt_left_map_x_path =
+      joinPath(test_folder, "map_x_left.bin");
+  const std::string gt_left_map_y_path =
+      joinPath(test_folder, "map_y_left.bin");
+  const std::string gt_right_map_x_path =
+      joinPath(test_folder, "map_x_right.bin");
+  const std::string gt_right_map_y_path =
+      joinPath(test_folder, "map_y_right.bin");
+
+  testRectificationMapAgainstFile(left_map,
+                                  rectifier.getUndistortRectifyMap(0),
+                                  gt_left_map_x_path,
+                                  gt_left_map_y_path,
+                                  c_map_tolerance);
+  testRectificationMapAgainstFile(right_map,
+                                  rectifier.getUndistortRectifyMap(1),
+                                  gt_right_map_x_path,
+                                  gt_right_map_y_path,
+                                  c_map_tolerance);
+}
+
+ZE_UNITTEST_ENTRYPOINT
@@ -0,0 +1,251 @@
+// Copyright (c) 2015-2016, ETH Zurich, Wyss Zurich, Zurich Eye
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the ETH Zurich, Wyss Zurich, Zurich Eye nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL ETH Zurich, Wyss Zurich, Zurich Eye BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#include <cmath>
+
+#include <imp/core/image_raw.hpp>
+#include <imp/imgproc/remap.hpp>
+#include <imp/imgproc/undistortion.hpp>
+#include <ze/common/benchmark.hpp>
+#include <ze/common/random.hpp>
+#include <ze/common/test_entrypoint.hpp>
+#include <ze/common/thread_pool.hpp>
+
+namespace ze {
+
+template<typename Pixel>
+void fillRandom(Image<Pixel>& img, typename Pixel::T max_val)
+{
+  using T = typename Pixel::T;
+  auto random_val = uniformDistribution<T>(true, T(0), max_val);
+  for (uint32_t y = 0; y < img.height(); ++y)
+  {
+    for (uint32_t x = 0; x < img.width(); ++x)
+    {
+      img(x, y) = random_val();
+    }
+  }
+}
+
+//! Reference remapping with the float map and clamped bilinear
+//! interpolation, i.e., what the GPU texture fetch computes.
+template<typename Pixel>
+real_t referenceRemap(
+    const Image<Pixel>& src, const Image32fC2& map, uint32_t x, uint32_t y)
+{
+  const real_t px = map(x, y)[0];
+  const real_t py = map(x, y)[1];
+  const int x0 = std::floor(px);
+  const int y0 = std::floor(py);
+  const real_t fx = px - x0;
+  const real_t fy = py - y0;
+  auto at = [&](int u, int v) -> real_t
+  {
+    u = std::min(std::max(u, 0), static_cast<int>(src.width()) - 1);
+    v = std::min(std::max(v, 0), static_cast<int>(src.height()) - 1);
+    return src(u, v);
+  };
+  return (1.0 - fy) * ((1.0 - fx) * at(x0, y0) + fx * at(x0 + 1, y0))
+      + fy * ((1.0 - fx) * at(x0, y0 + 1) + fx * at(x0 + 1, y0 + 1));
+}
+
+} // ze namespace
+
+using namespace ze;
+
+TEST(impUndistortion, radTan32fC1_zeroDistortion)
+{
+  VectorX cam_params(4);
+  cam_params << 471.690643292, 471.765601046, 371.087464172, 228.63874151;
+  VectorX dist_coeffs(4);
+  dist_coeffs << 0.0, 0.0, 0.0, 0.0;
+
+  ImageRaw32fC1 src(752, 480);
+  fillRandom(src, 1.0f);
+  ImageRaw32fC1 dst(src.size());
+
+  RadTanUndistort32fC1 undistorter(src.size(), cam_params, dist_coeffs);
+  undistorter.undistort(dst, src);
+  for (uint32_t y = 0; y < dst.height(); ++y)
+  {
+    for (uint32_t x = 0; x < dst.width(); ++x)
+    {
+      EXPECT_FLOAT_EQ(src(x, y), dst(x, y));
+    }
+  }
+}
+
+TEST(impUndistortion, equidist32fC1_testMap)
+{
+  VectorX cam_params(4);
+  cam_params << 471.690643292, 471.765601046, 371.087464172, 228.63874151;
+  VectorX dist_coeffs(4);
+  dist_coeffs << 0.00676530475436, -0.000811126898338, 0.0166458761987, -0.0172655346139;
+
+  const Size2u size(752, 480);
+  EquidistUndistort32fC1 undistorter(size, cam_params, dist_coeffs);
+  const RemapMap& map = undistorter.getUndistortionMap();
+  EXPECT_EQ(map.bytes(), size.area() * 6u);
+
+  // Compare the fixed-point map with the float map inside the image.
+  const real_t tolerance = 0.5 / RemapMap::c_frac_one + 1e-4;
+  Eigen::VectorXf cp_flt = cam_params.cast<float>();
+  Eigen::VectorXf dist_flt = dist_coeffs.cast<float>();
+  for (uint32_t y = 0; y < size.height(); ++y)
+  {
+    for (uint32_t x = 0; x < size.width(); ++x)
+    {
+      float px[2];
+      px[0] = x;
+      px[1] = y;
+      PinholeGeometry::backProject(cp_flt.data(), px);
+      EquidistantDistortion::distort(dist_flt.data(), px);
+      PinholeGeometry::project(cp_flt.data(), px);
+      if (px[0] < 0 || px[1] < 0
+          || px[0] > size.width() - 1 || px[1] > size.height() - 1)
+      {
+        continue;
+      }
+      const Vector2 src_px = map.sourcePosition(x, y);
+      EXPECT_NEAR(px[0], src_px(0), tolerance);
+      EXPECT_NEAR(px[1], src_px(1), tolerance);
+    }
+  }
+}
+
+TEST(impUndistortion, radTan32fC1_againstFloatMap)
+{
+  VectorX cam_params(4);
+  cam_params << 471.690643292, 471.765601046, 371.087464172, 228.63874151;
+  VectorX dist_coeffs(4);
+  dist_coeffs << -0.28340811, 0.07395907, 0.00019359, 1.76187114e-05;
+
+  ImageRaw32fC1 src(752, 480);
+  fillRandom(src, 1.0f);
+  ImageRaw32fC1 dst(src.size());
+  ImageRaw32fC2 float_map(src.size());
+  computeUndistortionMap<PinholeGeometry, RadialTangentialDistortion>(
+        float_map, cam_params, dist_coeffs);
+
+  RadTanUndistort32fC1 undistorter(src.size(), cam_params, dist_coeffs);
+  undistorter.undistort(dst, src);
+  auto undistortLambda = [&](){
+    undistorter.undistort(dst, src);
+  };
+  runTimingBenchmark(
+        undistortLambda, 10, 20, "CPU undistortion, single thread", true);
+
+  // Fixed-point weights are exact to half a weight step.
+  const real_t tolerance = 1.0 / RemapMap::c_frac_one;
+  for (uint32_t y = 0; y < dst.height(); ++y)
+  {
+    for (uint32_t x = 0; x < dst.width(); ++x)
+    {
+      EXPECT_NEAR(referenceRemap(src, float_map, x, y), dst(x, y), tolerance);
+    }
+  }
+
+  // Row bands on a thread pool give the same result.
+  ImageRaw32fC1 dst_parallel(src.size());
+  undistorter.setThreadPool(std::make_shared<ThreadPool>(4));
+  undistorter.undistort(dst_parallel, src);
+  runTimingBenchmark(
+        undistortLambda, 10, 20, "CPU undistortion, 4 threads", true);
+  for (uint32_t y = 0; y < dst.height(); ++y)
+  {
+    for (uint32_t x = 0; x < dst.width(); ++x)
+    {
+      EXPECT_EQ(dst(x, y), dst_parallel(x, y));
+    }
+  }
+}
+
+TEST(impUndistortion, equidist8uC1_againstFloatMap)
+{
+  VectorX cam_params(4);
+  cam_params << 471.690643292, 471.765601046, 371.087464172, 228.63874151;
+  VectorX dist_coeffs(4);
+  dist_coeffs << 0.00676530475436, -0.000811126898338, 0.0166458761987, -0.0172655346139;
+
+  ImageRaw8uC1 src(752, 480);
+  fillRandom(src, uint8_t{255});
+  ImageRaw8uC1 dst(src.size());
+  ImageRaw32fC2 float_map(src.size());
+  computeUndistortionMap<PinholeGeometry, EquidistantDistortion>(
+        float_map, cam_params, dist_coeffs);
+
+  EquidistUndistort8uC1 undistorter(src.size(), cam_params, dist_coeffs);
+  undistorter.undistort(dst, src);
+
+  // Rounding to integers adds half a grey level.
+  const real_t tolerance = 255.0 / RemapMap::c_frac_one + 0.5;
+  for (uint32_t y = 0; y < dst.height(); ++y)
+  {
+    for (uint32_t x = 0; x < dst.width(); ++x)
+    {
+      EXPECT_NEAR(referenceRemap(src, float_map, x, y), dst(x, y), tolerance);
+    }
+  }
+}
+
+TEST(impUndistortion, radTan16uC1_remap)
+{
+  VectorX cam_params(4);
+  cam_params << 471.690643292, 471.765601046, 371.087464172, 228.63874151;
+  VectorX dist_coeffs(4);
+  dist_coeffs << -0.28340811, 0.07395907, 0.00019359, 1.76187114e-05;
+
+  ImageRaw16uC1 src(752, 480);
+  fillRandom(src, uint16_t{65535});
+  ImageRaw16uC1 dst(src.size());
+  ImageRaw32fC2 float_map(src.size());
+  computeUndistortionMap<PinholeGeometry, RadialTangentialDistortion>(
+        float_map, cam_params, dist_coeffs);
+  RemapMap map(float_map, src.size());
+  remap(dst, src, map);
+
+  // Rounding to integers adds half a level.
+  const real_t tolerance = 65535.0 / RemapMap::c_frac_one + 0.5;
+  for (uint32_t y = 0; y < dst.height(); ++y)
+  {
+    for (uint32_t x = 0; x < dst.width(); ++x)
+    {
+      EXPECT_NEAR(referenceRemap(src, float_map, x, y), dst(x, y), tolerance);
+    }
+  }
+
+  // Row bands on a thread pool give the same result.
+  ImageRaw16uC1 dst_parallel(src.size());
+  ThreadPool pool(4);
+  remap(dst_parallel, src, map, &pool);
+  for (uint32_t y = 0; y < dst.height(); ++y)
+  {
+    for (uint32_t x = 0; x < dst.width(); ++x)
+    {
+      EXPECT_EQ(dst(x, y), dst_parallel(x, y));
+    }
+  }
+}
+
+ZE_UNITTEST_ENTRYPOINT
@@ -0,0 +1,96 @@
+// Copyright (c) 2015-2016, ETH Zurich, Wyss Zurich, Zurich Eye
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the ETH Zurich, Wyss Zurich, Zurich Eye nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL ETH Zurich, Wyss Zurich, Zurich Eye BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include <imp/core/image.hpp>
+#include <imp/core/image_pool.hpp>
+#include <imp/core/image_raw.hpp>
+
+//! @file image_decoder.hpp
+//! Decodes image files directly into the rows of ImageRaw buffers, without an
+//! intermediate cv::Mat. Supported are PNG (libpng), binary PGM/PPM (P5/P6)
+//! and headerless raw files. Rows are converted into the destination pixel
+//! type while they are decoded, when the file already has the destination
+//! layout libpng and fread write into the destination rows directly.
+//!
+//! Destination pixel types:
+//! - Pixel8uC1: gray files, color files are converted to gray (BT.601).
+//! - Pixel8uC3/8uC4: any file, in rgb(a) or bgr(a) order.
+//! - Pixel16uC1: 16 bit gray files.
+//! - Pixel32fC1/16fC1: gray or color (to gray) files, scaled to [0, 1].
+
+namespace ze {
+
+enum class ImageFileFormat
+{
+  Png,
+  Pnm  //!< Binary PGM (P5) or PPM (P6).
+};
+
+struct ImageFileInfo
+{
+  ImageFileFormat format = ImageFileFormat::Png;
+  Size2u size;
+  uint32_t channels = 0u;   //!< Including alpha.
+  uint32_t bit_depth = 0u;  //!< Bits per channel.
+};
+
+//! Reads the header of a PNG, PGM or PPM file. The info is empty (zero size
+//! and channels) if the header is corrupt or the format unsupported.
+ImageFileInfo readImageFileInfo(const std::string& filename);
+
+//! Decodes the file into the ROI of \a dst, the sizes must match. The channel
+//! order follows dst.pixelOrder(), bgr(a) or otherwise rgb(a).
+//! @return false if the file is truncated or corrupt, dst is then partially
+//!         written.
+template<typename Pixel>
+bool decodeImage(const std::string& filename, Image<Pixel>& dst);
+
+//! Decodes the file into an image taken from \a pool, nullptr if the file is
+//! truncated or corrupt.
+template<typename Pixel>
+ImageRawPtr<Pixel> loadImage(const std::string& filename,
+                             PixelOrder pixel_order = PixelOrder::undefined,
+                             ImagePool& pool = ImagePool::global());
+
+//! Reads a headerless file of tightly packed rows, \a header_bytes are
+//! skipped at the start. Multi-byte values are read in host byte order.
+//! @return false if the file is too short.
+template<typename Pixel>
+bool decodeRawImage(const std::string& filename, Image<Pixel>& dst,
+                    size_t header_bytes = 0u);
+
+//! Reads a headerless file into an image taken from \a pool, nullptr if the
+//! file is too short.
+template<typename Pixel>
+ImageRawPtr<Pixel> loadRawImage(const std::string& filename, const Size2u& size,
+                                PixelOrder pixel_order = PixelOrder::undefined,
+                                size_t header_bytes = 0u,
+                                ImagePool& pool = ImagePool::global());
+
+} // namespace ze
@@ -0,0 +1,814 @@
+// Copyright (c) 2015-2016, ETH Zurich, Wyss Zurich, Zurich Eye
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the ETH Zurich, Wyss Zurich, Zurich Eye nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL ETH Zurich, Wyss Zurich, Zurich Eye BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#include <imp/io/image_decoder.hpp>
+
+#include <cctype>
+#include <csetjmp>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include <png.h>
+
+#include <imp/core/pixel_conversion.hpp>
+#include <ze/common/logging.hpp>
+
+namespace ze {
+
+namespace {
+
+//! Layout of a decoded row, 16 bit values in host byte order.
+enum class RowFormat
+{
+  Gray8,
+  Gray16,
+  Rgb8,
+  Bgr8,
+  Rgba8,
+  Bgra8
+};
+
+uint32_t bytesPerPixel(RowFormat format)
+{
+  switch (format)
+  {
+    case RowFormat::Gray8: return 1u;
+    case RowFormat::Gray16: return 2u;
+    case RowFormat::Rgb8:
+    case RowFormat::Bgr8: return 3u;
+    case RowFormat::Rgba8:
+    case RowFormat::Bgra8: return 4u;
+  }
+  return 0u;
+}
+
+inline bool isBgr(PixelOrder pixel_order)
+{
+  return pixel_order == PixelOrder::bgr || pixel_order == PixelOrder::bgra;
+}
+
+inline bool hostIsLittleEndian()
+{
+  const uint16_t one = 1u;
+  return *reinterpret_cast<const uint8_t*>(&one) == 1u;
+}
+
+void swapBytes16(uint8_t* data, size_t num_values)
+{
+  for (size_t i = 0u; i < num_values; ++i)
+  {
+    std::swap(data[2u * i], data[2u * i + 1u]);
+  }
+}
+
+using File = std::unique_ptr<std::FILE, int(*)(std::FILE*)>;
+
+File openFile(const std::string& filename)
+{
+  File file(std::fopen(filename.c_str(), "rb"), &std::fclose);
+  CHECK(file) << "Failed to open " << filename;
+  return file;
+}
+
+//-----------------------------------------------------------------------------
+// Row conversion into the destination pixel types.
+
+//! Gray of a row in any format.
+void grayRow(const uint8_t* src, RowFormat format, uint32_t width, uint8_t* dst)
+{
+  switch (format)
+  {
+    case RowFormat::Gray8:
+      std::memcpy(dst, src, width);
+      break;
+    case RowFormat::Gray16:
+    {
+      const uint16_t* src16 = reinterpret_cast<const uint16_t*>(src);
+      for (uint32_t x = 0u; x < width; ++x)
+      {
+        dst[x] = static_cast<uint8_t>(src16[x] >> 8);
+      }
+      break;
+    }
+    case RowFormat::Rgb8:
+    case RowFormat::Bgr8:
+    {
+      const ImageRaw8uC3 color(
+            reinterpret_cast<Pixel8uC3*>(const_cast<uint8_t*>(src)), width, 1u,
+            3u * width, true,
+            format == RowFormat::Rgb8 ? PixelOrder::rgb : PixelOrder::bgr);
+      ImageRaw8uC1 gray(reinterpret_cast<Pixel8uC1*>(dst), width, 1u, width, true);
+      convertToGray(color, gray);
+      break;
+    }
+    case RowFormat::Rgba8:
+    case RowFormat::Bgra8:
+    {
+      const ImageRaw8uC4 color(
+            reinterpret_cast<Pixel8uC4*>(const_cast<uint8_t*>(src)), width, 1u,
+            4u * width, true,
+            format == RowFormat::Rgba8 ? PixelOrder::rgba : PixelOrder::bgra);
+      ImageRaw8uC1 gray(reinterpret_cast<Pixel8uC1*>(dst), width, 1u, width, true);
+      convertToGray(color, gray);
+      break;
+    }
+  }
+}
+
+//! Row scaled to float, color is converted to gray.
+void floatRow(const uint8_t* src, RowFormat format, uint32_t width, float scale,
+              float* dst)
+{
+  if (format == RowFormat::Gray16)
+  {
+    convert16uTo32f(reinterpret_cast<const uint16_t*>(src), dst, width, scale, 0.0f);
+  }
+  else if (format == RowFormat::Gray8)
+  {
+    convert8uTo32f(src, dst, width, scale, 0.0f);
+  }
+  else
+  {
+    static thread_local std::vector<uint8_t> gray;
+    gray.resize(width);
+    grayRow(src, format, width, gray.data());
+    convert8uTo32f(gray.data(), dst, width, scale, 0.0f);
+  }
+}
+
+//! Row in rgb(a) or bgr(a) order, missing alpha is set to 255.
+void colorRow(const uint8_t* src, RowFormat format, uint32_t width,
+              uint32_t dst_channels, bool dst_bgr, uint8_t* dst)
+{
+  const uint32_t src_channels = bytesPerPixel(format);
+  const bool src_bgr = format == RowFormat::Bgr8 || format == RowFormat::Bgra8;
+  CHECK(format != RowFormat::Gray16) << "16 bit gray to color is not supported.";
+  for (uint32_t x = 0u; x < width; ++x)
+  {
+    const uint8_t* in = src + src_channels * x;
+    uint8_t* out = dst + dst_channels * x;
+    uint8_t r, g, b;
+    if (src_channels == 1u)
+    {
+      r = g = b = in[0];
+    }
+    else
+    {
+      r = in[src_bgr ? 2 : 0];
+      g = in[1];
+      b = in[src_bgr ? 0 : 2];
+    }
+    out[dst_bgr ? 2 : 0] = r;
+    out[1] = g;
+    out[dst_bgr ? 0 : 2] = b;
+    if (dst_channels == 4u)
+    {
+      out[3] = (src_channels == 4u) ? in[3] : 255u;
+    }
+  }
+}
+
+// Whether rows of the format have the layout of the destination and can be
+// decoded into it directly.
+inline bool isDirect(RowFormat format, bool, const Pixel8uC1*)
+{
+  return format == RowFormat::Gray8;
+}
+
+inline bool isDirect(RowFormat format, bool bgr, const Pixel8uC3*)
+{
+  return format == (bgr ? RowFormat::Bgr8 : RowFormat::Rgb8);
+}
+
+inline bool isDirect(RowFormat format, bool bgr, const Pixel8uC4*)
+{
+  return format == (bgr ? RowFormat::Bgra8 : RowFormat::Rgba8);
+}
+
+inline bool isDirect(RowFormat format, bool, const Pixel16uC1*)
+{
+  return format == RowFormat::Gray16;
+}
+
+inline bool isDirect(RowFormat, bool, const Pixel32fC1*)
+{
+  return false;
+}
+
+inline bool isDirect(RowFormat, bool, const Pixel16fC1*)
+{
+  return false;
+}
+
+void convertRow(const uint8_t* src, RowFormat format, uint32_t width, bool,
+                float, Pixel8uC1* dst)
+{
+  grayRow(src, format, width, reinterpret_cast<uint8_t*>(dst));
+}
+
+void convertRow(const uint8_t* src, RowFormat format, uint32_t width, bool bgr,
+                float, Pixel8uC3* dst)
+{
+  colorRow(src, format, width, 3u, bgr, reinterpret_cast<uint8_t*>(dst));
+}
+
+void convertRow(const uint8_t* src, RowFormat format, uint32_t width, bool bgr,
+                float, Pixel8uC4* dst)
+{
+  colorRow(src, format, width, 4u, bgr, reinterpret_cast<uint8_t*>(dst));
+}
+
+void convertRow(const uint8_t*, RowFormat, uint32_t, bool, float, Pixel16uC1*)
+{
+  LOG(FATAL) << "16 bit images can only be decoded from 16 bit gray files.";
+}
+
+void convertRow(const uint8_t* src, RowFormat format, uint32_t width, bool,
+                float scale, Pixel32fC1* dst)
+{
+  floatRow(src, format, width, scale, reinterpret_cast<float*>(dst));
+}
+
+void convertRow(const uint8_t* src, RowFormat format, uint32_t width, bool,
+                float scale, Pixel16fC1* dst)
+{
+  static thread_local std::vector<float> row;
+  row.resize(width);
+  floatRow(src, format, width, scale, row.data());
+  convertFloatToHalf(row.data(), reinterpret_cast<Half*>(dst), width);
+}
+
+//-----------------------------------------------------------------------------
+/**
+ * @brief The RowWriter class hands out the buffers the decoders write rows to
+ *
+ * If the decoded rows have the destination layout, these are the destination
+ * rows. Otherwise the rows are decoded into a scratch buffer and converted by
+ * finishRow().
+ */
+template<typename Pixel>
+class RowWriter
+{
+public:
+  //! @param max_value Value of the decoded rows that maps to 1 for float images.
+  //! @param buffer_all_rows Keep all decoded rows, for interlaced files.
+  RowWriter(const ImageView<Pixel>& dst, RowFormat format, bool bgr,
+            uint32_t max_value, bool buffer_all_rows)
+    : dst_(dst)
+    , format_(format)
+    , bgr_(bgr)
+    , scale_(1.0f / static_cast<float>(max_value))
+    , direct_(isDirect(format, bgr, static_cast<const Pixel*>(nullptr)))
+    , row_bytes_(dst.width() * bytesPerPixel(format))
+    , buffer_all_rows_(buffer_all_rows)
+  {
+    if (!direct_)
+    {
+      scratch().resize(buffer_all_rows_ ? size_t(row_bytes_) * dst.height() : row_bytes_);
+    }
+  }
+
+  inline bool direct() const { return direct_; }
+
+  inline size_t rowBytes() const { return row_bytes_; }
+
+  inline uint8_t* rowBuffer(uint32_t y)
+  {
+    if (direct_)
+    {
+      return reinterpret_cast<uint8_t*>(dst_.row(y));
+    }
+    return scratch().data() + (buffer_all_rows_ ? size_t(row_bytes_) * y : 0u);
+  }
+
+  //! Converts row y into the destination, called once it is decoded completely.
+  inline void finishRow(uint32_t y)
+  {
+    if (!direct_)
+    {
+      convertRow(rowBuffer(y), format_, dst_.width(), bgr_, scale_, dst_.row(y));
+    }
+  }
+
+private:
+  static std::vector<uint8_t>& scratch()
+  {
+    static thread_local std::vector<uint8_t> buffer;
+    return buffer;
+  }
+
+  ImageView<Pixel> dst_;
+  RowFormat format_;
+  bool bgr_;
+  float scale_;
+  bool direct_;
+  uint32_t row_bytes_;
+  bool buffer_all_rows_;
+};
+
+template<typename Pixel>
+using DestinationFn = std::function<Image<Pixel>&(const Size2u&)>;
+
+//-----------------------------------------------------------------------------
+// PNG through libpng.
+
+// libpng reports errors by a longjmp to png_jmpbuf(). The libpng calls that
+// may fail are wrapped in the png* functions below, which set the jump target
+// and hold no objects with destructors.
+
+void pngError(png_structp png, png_const_charp message)
+{
+  LOG(WARNING) << "libpng: " << message;
+  png_longjmp(png, 1);
+}
+
+void pngWarning(png_structp, png_const_charp message)
+{
+  LOG(WARNING) << "libpng: " << message;
+}
+
+struct PngReader
+{
+  png_structp png = nullptr;
+  png_infop info = nullptr;
+
+  explicit PngReader(std::FILE* file)
+  {
+    png = png_create_read_struct(PNG_LIBPNG_VER_STRING, nullptr, &pngError, &pngWarning);
+    CHECK(png);
+    info = png_create_info_struct(png);
+    CHECK(info);
+    png_init_io(png, file);
+  }
+
+  //! Reads the header, false if the file is not a valid PNG.
+  bool readInfo()
+  {
+    if (setjmp(png_jmpbuf(png)))
+    {
+      return false;
+    }
+    png_read_info(png, info);
+    return true;
+  }
+
+  ~PngReader()
+  {
+    png_destroy_read_struct(&png, &info, nullptr);
+  }
+};
+
+//! Sets up libpng to deliver rows as close to the destination as possible.
+template<typename Pixel>
+void setPngTransforms(const PngReader& reader, bool bgr)
+{
+  constexpr uint32_t channels = sizeof(Pixel) / sizeof(typename Pixel::T);
+  // 16 bit gray is kept for 16 bit and float destinations.
+  constexpr bool keep_16 = channels == 1u && sizeof(typename Pixel::T) >= 2u;
+  png_structp png = reader.png;
+  const bool color = (png_get_color_type(png, reader.info) & PNG_COLOR_MASK_COLOR) != 0;
+
+  // Palette to rgb, gray below 8 bit to 8 bit, transparency to alpha.
+  png_set_expand(png);
+  if (png_get_bit_depth(png, reader.info) == 16)
+  {
+    if (keep_16 && !color)
+    {
+      if (hostIsLittleEndian())
+      {
+        png_set_swap(png);
+      }
+    }
+    else
+    {
+      png_set_strip_16(png);
+    }
+  }
+  if (channels < 4u)
+  {
+    png_set_strip_alpha(png);
+  }
+  if (channels >= 3u && !color)
+  {
+    png_set_gray_to_rgb(png);
+  }
+  if (channels == 4u)
+  {
+    png_set_add_alpha(png, 0xff, PNG_FILLER_AFTER);
+  }
+  if (channels >= 3u && bgr)
+  {
+    png_set_bgr(png);
+  }
+}
+
+template<typename Pixel>
+bool pngUpdateInfo(const PngReader& reader, bool bgr, int* passes)
+{
+  if (setjmp(png_jmpbuf(reader.png)))
+  {
+    return false;
+  }
+  setPngTransforms<Pixel>(reader, bgr);
+  *passes = png_set_interlace_handling(reader.png);
+  png_read_update_info(reader.png, reader.info);
+  return true;
+}
+
+bool pngReadRow(const PngReader& reader, uint8_t* row)
+{
+  if (setjmp(png_jmpbuf(reader.png)))
+  {
+    return false;
+  }
+  png_read_row(reader.png, row, nullptr);
+  return true;
+}
+
+bool pngReadEnd(const PngReader& reader)
+{
+  if (setjmp(png_jmpbuf(reader.png)))
+  {
+    return false;
+  }
+  png_read_end(reader.png, nullptr);
+  return true;
+}
+
+RowFormat pngRowFormat(const PngReader& reader, bool bgr)
+{
+  const int bit_depth = png_get_bit_depth(reader.png, reader.info);
+  switch (png_get_color_type(reader.png, reader.info))
+  {
+    case PNG_COLOR_TYPE_GRAY:
+      return bit_depth == 16 ? RowFormat::Gray16 : RowFormat::Gray8;
+    case PNG_COLOR_TYPE_RGB:
+      return bgr ? RowFormat::Bgr8 : RowFormat::Rgb8;
+    case PNG_COLOR_TYPE_RGB_ALPHA:
+      return bgr ? RowFormat::Bgra8 : RowFormat::Rgba8;
+    default:
+      LOG(FATAL) << "Unexpected PNG row format.";
+      return RowFormat::Gray8;
+  }
+}
+
+template<typename Pixel>
+bool decodePng(std::FILE* file, const DestinationFn<Pixel>& get_destination)
+{
+  PngReader reader(file);
+  if (!reader.readInfo())
+  {
+    return false;
+  }
+  const Size2u size(png_get_image_width(reader.png, reader.info),
+                    png_get_image_height(reader.png, reader.info));
+  Image<Pixel>& dst = get_destination(size);
+  const bool bgr = isBgr(dst.pixelOrder());
+
+  int passes = 1;
+  if (!pngUpdateInfo<Pixel>(reader, bgr, &passes))
+  {
+    return false;
+  }
+  const RowFormat format = pngRowFormat(reader, bgr);
+
+  RowWriter<Pixel> writer(dst.roiView(), format, bgr,
+                          format == RowFormat::Gray16 ? 65535u : 255u, passes > 1);
+  CHECK_EQ(png_get_rowbytes(reader.png, reader.info), writer.rowBytes());
+  if (passes == 1)
+  {
+    for (uint32_t y = 0u; y < size.height(); ++y)
+    {
+      if (!pngReadRow(reader, writer.rowBuffer(y)))
+      {
+        return false;
+      }
+      writer.finishRow(y);
+    }
+  }
+  else
+  {
+    // Interlaced images are refined over all rows in every pass.
+    for (int pass = 0; pass < passes; ++pass)
+    {
+      for (uint32_t y = 0u; y < size.height(); ++y)
+      {
+        if (!pngReadRow(reader, writer.rowBuffer(y)))
+        {
+          return false;
+        }
+      }
+    }
+    for (uint32_t y = 0u; y < size.height(); ++y)
+    {
+      writer.finishRow(y);
+    }
+  }
+  return pngReadEnd(reader);
+}
+
+//-----------------------------------------------------------------------------
+// Binary PGM (P5) and PPM (P6).
+
+struct PnmHeader
+{
+  uint32_t channels;
+  Size2u size;
+  uint32_t max_value;
+};
+
+//! Reads a header number, skipping whitespace and comments before it and
+//! exactly one whitespace character after it. False if the header is malformed.
+bool readPnmNumber(std::FILE* file, uint32_t* value)
+{
+  int c = std::fgetc(file);
+  while (c == '#' || std::isspace(c))
+  {
+    if (c == '#')
+    {
+      while (c != EOF && c != '\n')
+      {
+        c = std::fgetc(file);
+      }
+    }
+    c = std::fgetc(file);
+  }
+  if (!std::isdigit(c))
+  {
+    return false;
+  }
+  *value = 0u;
+  while (std::isdigit(c))
+  {
+    // Neither sizes nor the maximum value need more than 7 digits.
+    if (*value >= 1000000u)
+    {
+      return false;
+    }
+    *value = 10u * *value + static_cast<uint32_t>(c - '0');
+    c = std::fgetc(file);
+  }
+  return c != EOF && std::isspace(c);
+}
+
+//! False if the file is not a binary PGM or PPM file or the header is malformed.
+bool readPnmHeader(std::FILE* file, PnmHeader* header)
+{
+  char magic[2];
+  if (std::fread(magic, 1u, 2u, file) != 2u
+      || magic[0] != 'P' || (magic[1] != '5' && magic[1] != '6'))
+  {
+    LOG(WARNING) << "Only PNG, binary PGM (P5) and PPM (P6) files are supported.";
+    return false;
+  }
+  header->channels = (magic[1] == '5') ? 1u : 3u;
+  uint32_t width, height;
+  if (!readPnmNumber(file, &width) || !readPnmNumber(file, &height)
+      || !readPnmNumber(file, &header->max_value)
+      || width == 0u || height == 0u
+      || header->max_value == 0u || header->max_value > 65535u)
+  {
+    LOG(WARNING) << "Malformed PNM header.";
+    return false;
+  }
+  header->size = Size2u(width, height);
+  return true;
+}
+
+template<typename Pixel>
+bool decodePnm(std::FILE* file, const DestinationFn<Pixel>& get_destination)
+{
+  PnmHeader header;
+  if (!readPnmHeader(file, &header))
+  {
+    return false;
+  }
+  const bool wide = header.max_value > 255u;
+  if (wide && header.channels != 1u)
+  {
+    LOG(WARNING) << "16 bit PPM files are not supported.";
+    return false;
+  }
+  const RowFormat format = (header.channels == 3u)
+      ? RowFormat::Rgb8 : (wide ? RowFormat::Gray16 : RowFormat::Gray8);
+
+  Image<Pixel>& dst = get_destination(header.size);
+  RowWriter<Pixel> writer(dst.roiView(), format, isBgr(dst.pixelOrder()),
+                          header.max_value, false);
+  const bool swap = wide && hostIsLittleEndian();
+  for (uint32_t y = 0u; y < header.size.height(); ++y)
+  {
+    uint8_t* row = writer.rowBuffer(y);
+    if (std::fread(row, 1u, writer.rowBytes(), file) != writer.rowBytes())
+    {
+      LOG(WARNING) << "Truncated PNM file.";
+      return false;
+    }
+    if (swap)
+    {
+      // PNM stores 16 bit values most significant byte first.
+      swapBytes16(row, header.size.width());
+    }
+    writer.finishRow(y);
+  }
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+bool isPng(std::FILE* file)
+{
+  png_byte signature[8];
+  const bool png = std::fread(signature, 1u, 8u, file) == 8u
+      && png_sig_cmp(signature, 0, 8) == 0;
+  std::rewind(file);
+  return png;
+}
+
+template<typename Pixel>
+bool decode(const std::string& filename, const DestinationFn<Pixel>& get_destination)
+{
+  File file = openFile(filename);
+  const bool ok = isPng(file.get()) ? decodePng<Pixel>(file.get(), get_destination)
+                                    : decodePnm<Pixel>(file.get(), get_destination);
+  LOG_IF(WARNING, !ok) << "Failed to decode " << filename;
+  return ok;
+}
+
+} // anonymous namespace
+
+//-----------------------------------------------------------------------------
+ImageFileInfo readImageFileInfo(const std::string& filename)
+{
+  File file = openFile(filename);
+  ImageFileInfo info;
+  if (isPng(file.get()))
+  {
+    PngReader reader(file.get());
+    if (!reader.readInfo())
+    {
+      LOG(WARNING) << "Failed to read the header of " << filename;
+      return ImageFileInfo();
+    }
+    info.format = ImageFileFormat::Png;
+    info.size = Size2u(png_get_image_width(reader.png, reader.info),
+                       png_get_image_height(reader.png, reader.info));
+    info.channels = png_get_channels(reader.png, reader.info);
+    info.bit_depth = png_get_bit_depth(reader.png, reader.info);
+    if (png_get_color_type(reader.png, reader.info) == PNG_COLOR_TYPE_PALETTE)
+    {
+      info.channels = png_get_valid(reader.png, reader.info, PNG_INFO_tRNS) ? 4u : 3u;
+      info.bit_depth = 8u;
+    }
+  }
+  else
+  {
+    PnmHeader header;
+    if (!readPnmHeader(file.get(), &header))
+    {
+      LOG(WARNING) << "Failed to read the header of " << filename;
+      return ImageFileInfo();
+    }
+    info.format = ImageFileFormat::Pnm;
+    info.size = header.size;
+    info.channels = header.channels;
+    info.bit_depth = header.max_value > 255u ? 16u : 8u;
+  }
+  return info;
+}
+
+//-----------------------------------------------------------------------------
+template<typename Pixel>
+bool decodeImage(const std::string& filename, Image<Pixel>& dst)
+{
+  CHECK(!dst.isGpuMemory());
+  return decode<Pixel>(filename, [&](const Size2u& size) -> Image<Pixel>&
+  {
+    CHECK_EQ(size, dst.roi().size()) << "Size of " << filename;
+    return dst;
+  });
+}
+
+//-----------------------------------------------------------------------------
+template<typename Pixel>
+ImageRawPtr<Pixel> loadImage(const std::string& filename, PixelOrder pixel_order,
+                             ImagePool& pool)
+{
+  ImageRawPtr<Pixel> img;
+  if (!decode<Pixel>(filename, [&](const Size2u& size) -> Image<Pixel>&
+  {
+    img = pool.acquire<Pixel>(size, pixel_order);
+    return *img;
+  }))
+  {
+    return nullptr;
+  }
+  return img;
+}
+
+//-----------------------------------------------------------------------------
+template<typename Pixel>
+bool decodeRawImage(const std::string& filename, Image<Pixel>& dst,
+                    size_t header_bytes)
+{
+  CHECK(!dst.isGpuMemory());
+  File file = openFile(filename);
+  if (std::fseek(file.get(), static_cast<long>(header_bytes), SEEK_SET) != 0)
+  {
+    LOG(WARNING) << "Failed to skip the header of raw file " << filename;
+    return false;
+  }
+  const ImageView<Pixel> view = dst.roiView();
+  const size_t row_bytes = view.width() * sizeof(Pixel);
+  for (uint32_t y = 0u; y < view.height(); ++y)
+  {
+    if (std::fread(view.row(y), 1u, row_bytes, file.get()) != row_bytes)
+    {
+      LOG(WARNING) << "Truncated raw file " << filename;
+      return false;
+    }
+  }
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+template<typename Pixel>
+ImageRawPtr<Pixel> loadRawImage(const std::string& filename, const Size2u& size,
+                                PixelOrder pixel_order, size_t header_bytes,
+                                ImagePool& pool)
+{
+  ImageRawPtr<Pixel> img = pool.acquire<Pixel>(size, pixel_order);
+  if (!decodeRawImage(filename, *img, header_bytes))
+  {
+    return nullptr;
+  }
+  return img;
+}
+
+//=============================================================================
+// Explicitely instantiate the supported destination pixel types
+// (sync with the list in the hpp file)
+template bool decodeImage(const std::string&, Image<Pixel8uC1>&);
+template bool decodeImage(const std::string&, Image<Pixel8uC3>&);
+template bool decodeImage(const std::string&, Image<Pixel8uC4>&);
+template bool decodeImage(const std::string&, Image<Pixel16uC1>&);
+template bool decodeImage(const std::string&, Image<Pixel32fC1>&);
+template bool decodeImage(const std::string&, Image<Pixel16fC1>&);
+
+template ImageRawPtr<Pixel8uC1> loadImage<Pixel8uC1>(
+    const std::string&, PixelOrder, ImagePool&);
+template ImageRawPtr<Pixel8uC3> loadImage<Pixel8uC3>(
+    const std::string&, PixelOrder, ImagePool&);
+template ImageRawPtr<Pixel8uC4> loadImage<Pixel8uC4>(
+    const std::string&, PixelOrder, ImagePool&);
+template ImageRawPtr<Pixel16uC1> loadImage<Pixel16uC1>(
+    const std::string&, PixelOrder, ImagePool&);
+template ImageRawPtr<Pixel32fC1> loadImage<Pixel32fC1>(
+    const std::string&, PixelOrder, ImagePool&);
+template ImageRawPtr<Pixel16fC1> loadImage<Pixel16fC1>(
+    const std::string&, PixelOrder, ImagePool&);
+
+template bool decodeRawImage(const std::string&, Image<Pixel8uC1>&, size_t);
+template bool decodeRawImage(const std::string&, Image<Pixel8uC3>&, size_t);
+template bool decodeRawImage(const std::string&, Image<Pixel8uC4>&, size_t);
+template bool decodeRawImage(const std::string&, Image<Pixel16uC1>&, size_t);
+template bool decodeRawImage(const std::string&, Image<Pixel32fC1>&, size_t);
+template bool decodeRawImage(const std::string&, Image<Pixel16fC1>&, size_t);
+
+template ImageRawPtr<Pixel8uC1> loadRawImage<Pixel8uC1>(
+    const std::string&, const Size2u&, PixelOrder, size_t, ImagePool&);
+template ImageRawPtr<Pixel8uC3> loadRawImage<Pixel8uC3>(
+    const std::string&, const Size2u&, PixelOrder, size_t, ImagePool&);
+template ImageRawPtr<Pixel8uC4> loadRawImage<Pixel8uC4>(
+    const std::string&, const Size2u&, PixelOrder, size_t, ImagePool&);
+template ImageRawPtr<Pixel16uC1> loadRawImage<Pixel16uC1>(
+    const std::string&, const Size2u&, PixelOrder, size_t, ImagePool&);
+template ImageRawPtr<Pixel32fC1> loadRawImage<Pixel32fC1>(
+    const std::string&, const Size2u&, PixelOrder, size_t, ImagePool&);
+template ImageRawPtr<Pixel16fC1> loadRawImage<Pixel16fC1>(
+    const std::string&, const Size2u&, PixelOrder, size_t, ImagePool&);
+
+} // namespace ze
@@ -0,0 +1,379 @@
+// Copyright (c) 2015-2016, ETH Zurich, Wyss Zurich, Zurich Eye
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the ETH Zurich, Wyss Zurich, Zurich Eye nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL ETH Zurich, Wyss Zurich, Zurich Eye BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include <png.h>
+
+#include <imp/core/image_raw.hpp>
+#include <imp/core/pixel_conversion.hpp>
+#include <imp/io/image_decoder.hpp>
+#include <ze/common/random.hpp>
+#include <ze/common/test_entrypoint.hpp>
+
+namespace {
+
+//! Random bytes with \a channels values per pixel.
+std::vector<uint8_t> randomData(uint32_t width, uint32_t height, uint32_t bytes_per_pixel)
+{
+  auto dist = ze::uniformDistribution<uint8_t>(ZE_DETERMINISTIC);
+  std::vector<uint8_t> data(size_t(width) * height * bytes_per_pixel);
+  for (uint8_t& value : data)
+  {
+    value = dist();
+  }
+  return data;
+}
+
+//! Writes tightly packed rows, 16 bit values in host order.
+void writePng(const std::string& filename, uint32_t width, uint32_t height,
+              int color_type, int bit_depth, const std::vector<uint8_t>& data,
+              bool interlaced = false)
+{
+  std::FILE* file = std::fopen(filename.c_str(), "wb");
+  CHECK(file);
+  png_structp png = png_create_write_struct(PNG_LIBPNG_VER_STRING, nullptr, nullptr, nullptr);
+  png_infop info = png_create_info_struct(png);
+  png_init_io(png, file);
+  png_set_IHDR(png, info, width, height, bit_depth, color_type,
+               interlaced ? PNG_INTERLACE_ADAM7 : PNG_INTERLACE_NONE,
+               PNG_COMPRESSION_TYPE_DEFAULT, PNG_FILTER_TYPE_DEFAULT);
+  png_write_info(png, info);
+  if (bit_depth == 16)
+  {
+    png_set_swap(png);
+  }
+  const size_t row_bytes = data.size() / height;
+  std::vector<png_bytep> rows(height);
+  for (uint32_t y = 0u; y < height; ++y)
+  {
+    rows[y] = const_cast<png_bytep>(&data[y * row_bytes]);
+  }
+  png_write_image(png, rows.data());
+  png_write_end(png, nullptr);
+  png_destroy_write_struct(&png, &info);
+  std::fclose(file);
+}
+
+void writePnm(const std::string& filename, char type, uint32_t width, uint32_t height,
+              uint32_t max_value, const std::vector<uint8_t>& data)
+{
+  std::ofstream fs(filename, std::ios::binary);
+  fs << 'P' << type << "\n# comment\n" << width << " " << height << "\n"
+     << max_value << "\n";
+  fs.write(reinterpret_cast<const char*>(data.data()), data.size());
+}
+
+template<typename Pixel>
+bool samePixel(const Pixel& lhs, const Pixel& rhs)
+{
+  return std::memcmp(&lhs, &rhs, sizeof(Pixel)) == 0;
+}
+
+} // unnamed namespace
+
+TEST(ImageDecoderTest, testPngGray)
+{
+  using namespace ze;
+  const uint32_t width = 101u, height = 37u;
+  const std::vector<uint8_t> data = randomData(width, height, 1u);
+  const std::string filename = "/tmp/test_image_decoder_gray.png";
+  writePng(filename, width, height, PNG_COLOR_TYPE_GRAY, 8, data);
+
+  ImageFileInfo info = readImageFileInfo(filename);
+  EXPECT_TRUE(info.format == ImageFileFormat::Png);
+  EXPECT_EQ(Size2u(width, height), info.size);
+  EXPECT_EQ(1u, info.channels);
+  EXPECT_EQ(8u, info.bit_depth);
+
+  ImageRaw8uC1::Ptr gray = loadImage<Pixel8uC1>(filename, PixelOrder::gray);
+  ImageRaw32fC1::Ptr gray_f = loadImage<Pixel32fC1>(filename);
+  ImageRaw8uC3::Ptr bgr = loadImage<Pixel8uC3>(filename, PixelOrder::bgr);
+  ASSERT_EQ(Size2u(width, height), gray->size());
+  for (uint32_t y = 0u; y < height; ++y)
+  {
+    for (uint32_t x = 0u; x < width; ++x)
+    {
+      const uint8_t value = data[y * width + x];
+      EXPECT_EQ(value, (*gray)(x, y).x);
+      EXPECT_FLOAT_EQ(value / 255.0f, (*gray_f)(x, y).x);
+      EXPECT_EQ(value, (*bgr)(x, y).x);
+      EXPECT_EQ(value, (*bgr)(x, y).z);
+    }
+  }
+
+  // Into a caller-provided image with a region of interest.
+  ImageRaw8uC1 padded(width + 10u, height + 4u);
+  padded.setValue(Pixel8uC1(7u));
+  padded.setRoi(Roi2u(5u, 2u, width, height));
+  decodeImage(filename, padded);
+  EXPECT_EQ(7u, padded(4u, 2u).x);
+  EXPECT_EQ(data[0], padded(5u, 2u).x);
+  EXPECT_EQ(data[width * height - 1u], padded(width + 4u, height + 1u).x);
+  EXPECT_EQ(7u, padded(width + 5u, height + 1u).x);
+}
+
+TEST(ImageDecoderTest, testPngColor)
+{
+  using namespace ze;
+  const uint32_t width = 64u, height = 20u;
+  const std::vector<uint8_t> data = randomData(width, height, 3u);
+  const std::string filename = "/tmp/test_image_decoder_rgb.png";
+  const std::string filename_interlaced = "/tmp/test_image_decoder_rgb_interlaced.png";
+  writePng(filename, width, height, PNG_COLOR_TYPE_RGB, 8, data);
+  writePng(filename_interlaced, width, height, PNG_COLOR_TYPE_RGB, 8, data, true);
+
+  ImageRaw8uC3 expected(reinterpret_cast<Pixel8uC3*>(const_cast<uint8_t*>(data.data())),
+                        width, height, 3u * width, true, PixelOrder::rgb);
+  ImageRaw8uC1 expected_gray(width, height);
+  convertToGray(expected, expected_gray);
+
+  for (const std::string& name : { filename, filename_interlaced })
+  {
+    ImageRaw8uC3::Ptr rgb = loadImage<Pixel8uC3>(name, PixelOrder::rgb);
+    ImageRaw8uC3::Ptr bgr = loadImage<Pixel8uC3>(name, PixelOrder::bgr);
+    ImageRaw8uC4::Ptr rgba = loadImage<Pixel8uC4>(name, PixelOrder::rgba);
+    ImageRaw8uC1::Ptr gray = loadImage<Pixel8uC1>(name, PixelOrder::gray);
+    ImageRaw32fC1::Ptr gray_f = loadImage<Pixel32fC1>(name);
+    ImageRaw16fC1::Ptr gray_h = loadImage<Pixel16fC1>(name);
+    for (uint32_t y = 0u; y < height; ++y)
+    {
+      for (uint32_t x = 0u; x < width; ++x)
+      {
+        const Pixel8uC3& px = expected(x, y);
+        EXPECT_TRUE(samePixel((*rgb)(x, y), px));
+        EXPECT_TRUE(samePixel((*bgr)(x, y), Pixel8uC3(px.z, px.y, px.x)));
+        EXPECT_TRUE(samePixel((*rgba)(x, y), Pixel8uC4(px.x, px.y, px.z, 255u)));
+        EXPECT_EQ(expected_gray(x, y).x, (*gray)(x, y).x);
+        EXPECT_FLOAT_EQ(expected_gray(x, y).x / 255.0f, (*gray_f)(x, y).x);
+        EXPECT_NEAR(expected_gray(x, y).x / 255.0f, static_cast<float>((*gray_h)(x, y).x),
+                    1e-3f);
+      }
+    }
+  }
+}
+
+TEST(ImageDecoderTest, testPng16)
+{
+  using namespace ze;
+  const uint32_t width = 33u, height = 9u;
+  const std::vector<uint8_t> data = randomData(width, height, 2u);
+  const uint16_t* values = reinterpret_cast<const uint16_t*>(data.data());
+  const std::string filename = "/tmp/test_image_decoder_gray16.png";
+  writePng(filename, width, height, PNG_COLOR_TYPE_GRAY, 16, data);
+  EXPECT_EQ(16u, readImageFileInfo(filename).bit_depth);
+
+  ImageRaw16uC1::Ptr img = loadImage<Pixel16uC1>(filename);
+  ImageRaw32fC1::Ptr img_f = loadImage<Pixel32fC1>(filename);
+  ImageRaw8uC1::Ptr img_8 = loadImage<Pixel8uC1>(filename);
+  for (uint32_t y = 0u; y < height; ++y)
+  {
+    for (uint32_t x = 0u; x < width; ++x)
+    {
+      const uint16_t value = values[y * width + x];
+      EXPECT_EQ(value, (*img)(x, y).x);
+      EXPECT_FLOAT_EQ(value / 65535.0f, (*img_f)(x, y).x);
+      EXPECT_NEAR(value / 257.0, (*img_8)(x, y).x, 1.0);
+    }
+  }
+}
+
+TEST(ImageDecoderTest, testPnm)
+{
+  using namespace ze;
+  const uint32_t width = 41u, height = 11u;
+
+  const std::vector<uint8_t> gray = randomData(width, height, 1u);
+  writePnm("/tmp/test_image_decoder.pgm", '5', width, height, 255u, gray);
+  const std::vector<uint8_t> gray16 = randomData(width, height, 2u);
+  writePnm("/tmp/test_image_decoder_16.pgm", '5', width, height, 65535u, gray16);
+  const std::vector<uint8_t> rgb = randomData(width, height, 3u);
+  writePnm("/tmp/test_image_decoder.ppm", '6', width, height, 255u, rgb);
+
+  ImageFileInfo info = readImageFileInfo("/tmp/test_image_decoder.ppm");
+  EXPECT_TRUE(info.format == ImageFileFormat::Pnm);
+  EXPECT_EQ(Size2u(width, height), info.size);
+  EXPECT_EQ(3u, info.channels);
+
+  ImageRaw8uC1::Ptr img = loadImage<Pixel8uC1>("/tmp/test_image_decoder.pgm");
+  ImageRaw16uC1::Ptr img16 = loadImage<Pixel16uC1>("/tmp/test_image_decoder_16.pgm");
+  ImageRaw8uC3::Ptr bgr = loadImage<Pixel8uC3>("/tmp/test_image_decoder.ppm",
+                                               PixelOrder::bgr);
+  for (uint32_t y = 0u; y < height; ++y)
+  {
+    for (uint32_t x = 0u; x < width; ++x)
+    {
+      const size_t i = y * width + x;
+      EXPECT_EQ(gray[i], (*img)(x, y).x);
+      // Most significant byte first.
+      EXPECT_EQ((gray16[2 * i] << 8) | gray16[2 * i + 1], (*img16)(x, y).x);
+      EXPECT_TRUE(samePixel((*bgr)(x, y),
+                            Pixel8uC3(rgb[3 * i + 2], rgb[3 * i + 1], rgb[3 * i])));
+    }
+  }
+}
+
+TEST(ImageDecoderTest, testTruncated)
+{
+  using namespace ze;
+  const uint32_t width = 64u, height = 48u;
+  const std::vector<uint8_t> data = randomData(width, height, 3u);
+  writePng("/tmp/test_image_decoder_full.png", width, height, PNG_COLOR_TYPE_RGB, 8, data);
+  writePnm("/tmp/test_image_decoder_full.ppm", '6', width, height, 255u, data);
+
+  // Copies of the files cut off after half of their bytes.
+  auto truncate = [](const std::string& from, const std::string& to)
+  {
+    std::ifstream in(from, std::ios::binary);
+    const std::vector<char> bytes((std::istreambuf_iterator<char>(in)),
+                                  std::istreambuf_iterator<char>());
+    std::ofstream out(to, std::ios::binary);
+    out.write(bytes.data(), bytes.size() / 2u);
+  };
+  truncate("/tmp/test_image_decoder_full.png", "/tmp/test_image_decoder_truncated.png");
+  truncate("/tmp/test_image_decoder_full.ppm", "/tmp/test_image_decoder_truncated.ppm");
+
+  for (const std::string filename : { "/tmp/test_image_decoder_truncated.png",
+                                      "/tmp/test_image_decoder_truncated.ppm" })
+  {
+    EXPECT_EQ(nullptr, loadImage<Pixel8uC3>(filename)) << filename;
+    EXPECT_EQ(nullptr, loadImage<Pixel8uC1>(filename)) << filename;
+    ImageRaw8uC3 img(width, height);
+    EXPECT_FALSE(decodeImage(filename, img)) << filename;
+  }
+
+  // Valid signature followed by garbage.
+  {
+    std::ofstream out("/tmp/test_image_decoder_corrupt.png", std::ios::binary);
+    const char signature[8] = { '\x89', 'P', 'N', 'G', '\r', '\n', '\x1a', '\n' };
+    out.write(signature, 8);
+    out << "not a png";
+  }
+  EXPECT_EQ(nullptr, loadImage<Pixel8uC1>("/tmp/test_image_decoder_corrupt.png"));
+
+  // The decoder is still usable after a failure.
+  ImageRaw8uC3::Ptr img = loadImage<Pixel8uC3>("/tmp/test_image_decoder_full.png",
+                                               PixelOrder::rgb);
+  ASSERT_NE(nullptr, img);
+  EXPECT_TRUE(samePixel((*img)(width - 1u, height - 1u),
+                        Pixel8uC3(data[data.size() - 3u], data[data.size() - 2u],
+                                  data[data.size() - 1u])));
+}
+
+TEST(ImageDecoderTest, testCorruptHeaders)
+{
+  using namespace ze;
+  const uint32_t width = 16u, height = 8u;
+  const std::vector<uint8_t> data = randomData(width, height, 1u);
+  writePng("/tmp/test_image_decoder_header.png", width, height, PNG_COLOR_TYPE_GRAY, 8, data);
+  std::vector<char> png;
+  {
+    std::ifstream in("/tmp/test_image_decoder_header.png", std::ios::binary);
+    png.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+  }
+  auto write = [](const std::string& filename, const std::vector<char>& bytes)
+  {
+    std::ofstream out(filename, std::ios::binary);
+    out.write(bytes.data(), bytes.size());
+  };
+
+  std::vector<std::string> corrupt_files;
+  // Damaged signature.
+  std::vector<char> bytes = png;
+  bytes[1] = 'X';
+  corrupt_files.push_back("/tmp/test_image_decoder_signature.png");
+  write(corrupt_files.back(), bytes);
+  // Damaged width in the IHDR chunk, which fails its CRC.
+  bytes = png;
+  bytes[16] ^= 0x55;
+  corrupt_files.push_back("/tmp/test_image_decoder_ihdr.png");
+  write(corrupt_files.back(), bytes);
+  // PNG cut inside the IHDR chunk.
+  bytes.assign(png.begin(), png.begin() + 20);
+  corrupt_files.push_back("/tmp/test_image_decoder_short_ihdr.png");
+  write(corrupt_files.back(), bytes);
+
+  // PNM headers: truncated, not a number, zero size, maximum value out of
+  // range and 16 bit color.
+  const std::vector<std::string> pnm_headers = {
+    "P5\n16 ", "P5\n16 x\n255\n", "P5\n0 8\n255\n", "P5\n16 8\n70000\n",
+    "P6\n16 8\n65535\n" };
+  for (size_t i = 0u; i < pnm_headers.size(); ++i)
+  {
+    corrupt_files.push_back("/tmp/test_image_decoder_header_" + std::to_string(i) + ".pgm");
+    std::vector<char> pnm(pnm_headers[i].begin(), pnm_headers[i].end());
+    pnm.insert(pnm.end(), data.begin(), data.end());
+    write(corrupt_files.back(), pnm);
+  }
+
+  for (const std::string& filename : corrupt_files)
+  {
+    EXPECT_EQ(nullptr, loadImage<Pixel8uC1>(filename)) << filename;
+    ImageRaw8uC1 img(width, height);
+    EXPECT_FALSE(decodeImage(filename, img)) << filename;
+    // The 16 bit PPM header itself is valid.
+    if (filename.find("header_4") == std::string::npos)
+    {
+      const ImageFileInfo info = readImageFileInfo(filename);
+      EXPECT_EQ(0u, info.channels) << filename;
+      EXPECT_EQ(0u, info.size.area()) << filename;
+    }
+  }
+
+  // Raw files that are too short.
+  write("/tmp/test_image_decoder_short.raw", std::vector<char>(100u, 0));
+  EXPECT_EQ(nullptr, loadRawImage<Pixel8uC1>("/tmp/test_image_decoder_short.raw",
+                                             Size2u(width, height)));
+  EXPECT_EQ(nullptr, loadRawImage<Pixel8uC1>("/tmp/test_image_decoder_short.raw",
+                                             Size2u(10u, 1u), PixelOrder::undefined, 95u));
+}
+
+TEST(ImageDecoderTest, testRaw)
+{
+  using namespace ze;
+  const uint32_t width = 17u, height = 5u;
+  const std::vector<uint8_t> data = randomData(width, height, 2u);
+  {
+    std::ofstream fs("/tmp/test_image_decoder.raw", std::ios::binary);
+    fs << "head";
+    fs.write(reinterpret_cast<const char*>(data.data()), data.size());
+  }
+  ImageRaw16uC1::Ptr img = loadRawImage<Pixel16uC1>(
+        "/tmp/test_image_decoder.raw", Size2u(width, height), PixelOrder::gray, 4u);
+  const uint16_t* values = reinterpret_cast<const uint16_t*>(data.data());
+  for (uint32_t y = 0u; y < height; ++y)
+  {
+    for (uint32_t x = 0u; x < width; ++x)
+    {
+      EXPECT_EQ(values[y * width + x], (*img)(x, y).x);
+    }
+  }
+}
+
+ZE_UNITTEST_ENTRYPOINT
@@ -0,0 +1,124 @@
+// Copyright (c) 2015-2016, ETH Zurich, Wyss Zurich, Zurich Eye
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the ETH Zurich, Wyss Zurich, Zurich Eye nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL ETH Zurich, Wyss Zurich, Zurich Eye BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#pragma once
+
+#include <string>
+
+#include <imp/core/size.hpp>
+#include <ze/cameras/camera.hpp>
+#include <ze/common/macros.hpp>
+#include <ze/common/types.hpp>
+
+namespace ze {
+
+// fwd
+class ThreadPool;
+
+//! Precomputed unit bearing vectors of a camera on a regular pixel grid.
+//! Back-projection then is a bilinear interpolation instead of the iterative
+//! undistortion of the camera model. Grid nodes are every subsampling-th
+//! pixel, the last node row and column may lie just outside the image.
+class BearingLookupTable
+{
+public:
+  ZE_POINTER_TYPEDEFS(BearingLookupTable);
+
+  //! Back-project all grid nodes with the camera model, in blocks on the
+  //! pool if one is given.
+  BearingLookupTable(const Camera& cam, uint32_t subsampling = 1u,
+                     ThreadPool* pool = nullptr);
+
+  //! Interpolated unit bearing. Pixels outside the image are clamped.
+  Bearing backProject(const Eigen::Ref<const Keypoint>& px) const;
+
+  Bearings backProjectVectorized(const Eigen::Ref<const Keypoints>& px_vec) const;
+
+  //! Exact bearing of grid node (x, y), i.e., of pixel (x, y) * subsampling.
+  inline Eigen::Map<const Bearing> node(uint32_t x, uint32_t y) const
+  {
+    DCHECK_LT(x, grid_size_.width());
+    DCHECK_LT(y, grid_size_.height());
+    return Eigen::Map<const Bearing>(
+          bearings_.col(y * grid_size_.width() + x).data());
+  }
+
+  //! True if px is inside the image, i.e., not clamped by backProject().
+  inline bool contains(const Eigen::Ref<const Keypoint>& px) const
+  {
+    return px(0) >= 0.0 && px(1) >= 0.0
+        && px(0) <= image_size_.width() - 1u
+        && px(1) <= image_size_.height() - 1u;
+  }
+
+  //! Largest angle [rad] between interpolated and exact bearing, evaluated
+  //! at the corners, edge midpoints and centers of all cells.
+  inline real_t maxErrorRad() const { return max_error_rad_; }
+
+  inline uint32_t subsampling() const { return subsampling_; }
+  inline Size2u imageSize() const { return image_size_; }
+  inline Size2u gridSize() const { return grid_size_; }
+
+  //! True if the table was computed for a camera with this geometry.
+  bool matches(const Camera& cam) const;
+
+  //! Binary dump of the table. Returns false on failure.
+  bool save(const std::string& filename) const;
+
+  //! Returns nullptr if the file does not exist, is invalid or was computed
+  //! for another camera geometry.
+  static BearingLookupTable::Ptr load(const std::string& filename,
+                                      const Camera& cam);
+
+private:
+  BearingLookupTable() = default;
+
+  real_t computeMaxError(const Camera& cam, ThreadPool* pool) const;
+
+  Size2u image_size_;
+  Size2u grid_size_;
+  uint32_t subsampling_ = 1u;
+  CameraType camera_type_ = CameraType::Pinhole;
+  VectorX projection_params_;
+  VectorX distortion_params_;
+  real_t max_error_rad_ = 0.0;
+  Bearings bearings_; //!< Row-major grid of nodes.
+};
+
+//! Coarsest table with max error below max_error_rad, subsampling <= 16.
+BearingLookupTable::Ptr createBearingLookupTable(
+    const Camera& cam, const real_t max_error_rad, ThreadPool* pool = nullptr);
+
+//! Load the table from cache_file if it matches the camera and error bound.
+//! Otherwise create it and write it to cache_file for the next start.
+BearingLookupTable::Ptr loadOrCreateBearingLookupTable(
+    const Camera& cam, const std::string& cache_file,
+    const real_t max_error_rad, ThreadPool* pool = nullptr);
+
+//! Cache file next to the calibration, e.g. calib_cam0.bearings for calib.yaml.
+std::string bearingLookupTableFilename(
+    const std::string& calib_filename, uint32_t camera_index);
+
+} // namespace ze
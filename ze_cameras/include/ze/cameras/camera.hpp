@@ -27,6 +27,7 @@
 
 #include <string>
 #include <memory>
+#include <vector>
 #include <ze/common/logging.hpp>
 #pragma diagnostic push
 #pragma GCC diagnostic ignored "-Wdeprecated-declarations"
@@ -42,6 +43,9 @@
 
 namespace ze {
 
+// fwd
+class BearingLookupTable;
+
 enum class CameraType {
   Pinhole = 0,
   PinholeFov = 1,
@@ -83,8 +87,12 @@ public:
 
   //! @name: Projection and back-projection operations. The main use of the camera.
   //! @{
-  //! Bearing vector from pixel coordinates. Z-component of return value is 1.0.
-  virtual Bearing backProject(const Eigen::Ref<const Keypoint>& px) const = 0;
+  //! Unit bearing vector from pixel coordinates. Interpolated in the bearing
+  //! lookup table for pixels inside the image if a table is set.
+  Bearing backProject(const Eigen::Ref<const Keypoint>& px) const;
+
+  //! Unit bearing vector from the camera model, ignoring the lookup table.
+  virtual Bearing backProjectExact(const Eigen::Ref<const Keypoint>& px) const = 0;
 
   //! Computes pixel coordinates from 3D-point.
   virtual Keypoint project(const Eigen::Ref<const Position>& pos) const = 0;
@@ -122,9 +130,25 @@ public:
 
   //! @name Block projection and back-projection. Always prefer to avoid cache misses.
   //! @{
-  virtual Bearings backProjectVectorized(const Eigen::Ref<const Keypoints>& px_vec) const;
+  Bearings backProjectVectorized(const Eigen::Ref<const Keypoints>& px_vec) const;
+  virtual Bearings backProjectVectorizedExact(const Eigen::Ref<const Keypoints>& px_vec) const;
   virtual Keypoints projectVectorized(const Eigen::Ref<const Bearings>& bearing_vec) const;
   virtual Matrix6X dProject_dLandmarkVectorized(const Positions& pos_vec) const;
+
+  //! Pixel coordinates and Jacobians (layout of dProject_dLandmarkVectorized).
+  virtual std::pair<Keypoints, Matrix6X> projectWithJacobianVectorized(
+      const Positions& pos_vec) const;
+  //! @}
+
+  //! @name Single precision block projection and back-projection. Twice the
+  //! throughput of the real_t versions where float accuracy suffices, e.g.,
+  //! for feature prediction and visibility tests. See camera_models_batch.hpp
+  //! for the error bounds.
+  //! @{
+  virtual Bearings32f backProjectVectorized32f(
+      const Eigen::Ref<const Keypoints32f>& px_vec) const;
+  virtual Keypoints32f projectVectorized32f(
+      const Eigen::Ref<const Positions32f>& pos_vec) const;
   //! @}
 
   //! @name Image dimension.
@@ -158,12 +182,35 @@ public:
 
   virtual real_t getApproxBearingAngleFromPixelDifference(real_t px_diff) const = 0;
 
-  //! Set mask: 0 = masked, >0 = unmasked.
+  //! Set mask: 0 = masked, >0 = unmasked. The mask is converted to a
+  //! bit-packed lookup, later changes to the image are not seen by isMasked().
   void setMask(const Image8uC1::Ptr& mask);
 
   //! Get mask.
   inline Image8uC1::ConstPtr mask() const { return mask_; }
 
+  //! Returns true if pixel (x, y) is masked. Always false without a mask.
+  inline bool isMasked(uint32_t x, uint32_t y) const
+  {
+    if (mask_bits_.empty())
+    {
+      return false;
+    }
+    DCHECK_LT(x, size_.width());
+    DCHECK_LT(y, size_.height());
+    return !((mask_bits_[y * mask_words_per_row_ + (x >> 6)] >> (x & 63u)) & 1u);
+  }
+
+  //! Set precomputed bearings for fast approximate back-projection, used by
+  //! backProject() and backProjectVectorized().
+  void setBearingLookupTable(const std::shared_ptr<const BearingLookupTable>& lut);
+
+  //! Precomputed bearings, nullptr if not set.
+  inline const std::shared_ptr<const BearingLookupTable>& bearingLookupTable() const
+  {
+    return bearing_lut_;
+  }
+
 protected:
   Size2u size_;
 
@@ -176,6 +223,12 @@ protected:
   std::string label_;
   CameraType type_;
   Image8uC1::Ptr mask_ = nullptr;
+
+  //! Bit-packed mask, one bit per pixel, set if unmasked. Rows start at a word.
+  std::vector<uint64_t> mask_bits_;
+  uint32_t mask_words_per_row_ = 0u;
+
+  std::shared_ptr<const BearingLookupTable> bearing_lut_ = nullptr;
 };
 
 //! Load a camera rig form a yaml file. Returns a nullptr if the loading fails.
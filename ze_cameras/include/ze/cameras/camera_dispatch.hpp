@@ -0,0 +1,68 @@
+// Copyright (c) 2015-2016, ETH Zurich, Wyss Zurich, Zurich Eye
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the ETH Zurich, Wyss Zurich, Zurich Eye nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL ETH Zurich, Wyss Zurich, Zurich Eye BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#pragma once
+
+#include <type_traits>
+#include <utility>
+
+#include <ze/cameras/camera_impl.hpp>
+#include <ze/common/logging.hpp>
+
+namespace ze {
+
+//! Cast to the concrete camera model, e.g. RadTanCamera.
+template<typename CameraModel>
+inline const CameraModel& cameraModelCast(const Camera& cam)
+{
+  DEBUG_CHECK(dynamic_cast<const CameraModel*>(&cam) != nullptr)
+      << "Camera " << cam.label() << " is not a " << cam.typeAsString();
+  return static_cast<const CameraModel&>(cam);
+}
+
+//! Calls visitor(cam) with cam cast to its concrete camera model. The models
+//! are final classes, hence templated code in the visitor gets project() and
+//! dProject_dLandmark() inlined instead of a virtual call per point. Dispatch
+//! once around a loop over many points.
+template<typename Visitor>
+typename std::result_of<Visitor(const PinholeCamera&)>::type visitCamera(
+    const Camera& cam, Visitor&& visitor)
+{
+  switch (cam.type())
+  {
+    case CameraType::PinholeFov:
+      return visitor(cameraModelCast<FovCamera>(cam));
+    case CameraType::PinholeRadialTangential:
+      return visitor(cameraModelCast<RadTanCamera>(cam));
+    case CameraType::PinholeEquidistant:
+      return visitor(cameraModelCast<EquidistantCamera>(cam));
+    default:
+      break;
+  }
+  CHECK(cam.type() == CameraType::Pinhole) << "Camera type not known.";
+  return visitor(cameraModelCast<PinholeCamera>(cam));
+}
+
+} // namespace ze
@@ -27,12 +27,14 @@
 
 #include <ze/cameras/camera.hpp>
 #include <ze/cameras/camera_models.hpp>
+#include <ze/cameras/camera_models_batch.hpp>
 #include <ze/cameras/camera_utils.hpp>
 
 namespace ze {
 
+//! Final, such that calls on the concrete type are not virtual (visitCamera).
 template<class Distortion>
-class PinholeProjection : public Camera
+class PinholeProjection final : public Camera
 {
 public:
 
@@ -65,7 +67,7 @@ public:
     return std::make_pair(px, isVisibleWithMargin(size(), px, border_margin));
   }
 
-  virtual Bearing backProject(
+  virtual Bearing backProjectExact(
       const Eigen::Ref<const Keypoint>& px) const override
   {
     Bearing bearing;
@@ -105,6 +107,66 @@ public:
     return std::make_pair(px, J);
   }
 
+  virtual Bearings backProjectVectorizedExact(
+      const Eigen::Ref<const Keypoints>& px_vec) const override
+  {
+    Bearings bearings;
+    PinholeBatch<Distortion>::backProject(
+          this->projection_params_.data(), this->distortion_params_.data(),
+          px_vec, &bearings);
+    return bearings;
+  }
+
+  virtual Keypoints projectVectorized(
+      const Eigen::Ref<const Bearings>& bearing_vec) const override
+  {
+    Keypoints px_vec;
+    PinholeBatch<Distortion>::project(
+          this->projection_params_.data(), this->distortion_params_.data(),
+          bearing_vec, &px_vec);
+    return px_vec;
+  }
+
+  virtual Matrix6X dProject_dLandmarkVectorized(
+      const Positions& pos_vec) const override
+  {
+    Matrix6X J_vec;
+    PinholeBatch<Distortion>::project(
+          this->projection_params_.data(), this->distortion_params_.data(),
+          pos_vec, nullptr, &J_vec);
+    return J_vec;
+  }
+
+  virtual std::pair<Keypoints, Matrix6X> projectWithJacobianVectorized(
+      const Positions& pos_vec) const override
+  {
+    std::pair<Keypoints, Matrix6X> res;
+    PinholeBatch<Distortion>::project(
+          this->projection_params_.data(), this->distortion_params_.data(),
+          pos_vec, &res.first, &res.second);
+    return res;
+  }
+
+  virtual Bearings32f backProjectVectorized32f(
+      const Eigen::Ref<const Keypoints32f>& px_vec) const override
+  {
+    Bearings32f bearings;
+    PinholeBatch<Distortion, float>::backProject(
+          projectionParameters32f().data(), distortionParameters32f().data(),
+          px_vec, &bearings);
+    return bearings;
+  }
+
+  virtual Keypoints32f projectVectorized32f(
+      const Eigen::Ref<const Positions32f>& pos_vec) const override
+  {
+    Keypoints32f px_vec;
+    PinholeBatch<Distortion, float>::project(
+          projectionParameters32f().data(), distortionParameters32f().data(),
+          pos_vec, &px_vec);
+    return px_vec;
+  }
+
   virtual real_t getApproxAnglePerPixel() const override
   {
     //! @todo: Is this correct? And if yes, this is costlty to compute often!
@@ -122,6 +184,22 @@ public:
     return std::atan(px_diff / (2.0 * std::abs(this->projection_params_[0])))
          + std::atan(px_diff / (2.0 * std::abs(this->projection_params_[1])));
   }
+
+private:
+  //! Parameters cast to float, fixed size to avoid heap allocations.
+  inline Eigen::Vector4f projectionParameters32f() const
+  {
+    return projection_params_.head<4>().cast<float>();
+  }
+
+  //! Zero-padded to c_batch_max_distortion_params entries.
+  inline Eigen::Matrix<float, c_batch_max_distortion_params, 1> distortionParameters32f() const
+  {
+    Eigen::Matrix<float, c_batch_max_distortion_params, 1> params;
+    params.setZero();
+    params.head(distortion_params_.size()) = distortion_params_.cast<float>();
+    return params;
+  }
 };
 
 //-----------------------------------------------------------------------------
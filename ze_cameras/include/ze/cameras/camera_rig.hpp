@@ -25,6 +25,7 @@
 
 #pragma once
 
+#include <limits>
 #include <string>
 #include <vector>
 #include <gflags/gflags.h>
@@ -40,6 +41,7 @@ DECLARE_string(mask_cam1);
 DECLARE_string(mask_cam2);
 DECLARE_string(mask_cam3);
 DECLARE_bool(calib_use_single_camera);
+DECLARE_double(calib_bearing_lut_max_error_deg);
 
 namespace ze {
 
@@ -158,6 +160,52 @@ CameraRig::Ptr cameraRigFromGflags();
 std::ostream& operator<<(std::ostream& out, const CameraRig& rig);
 std::ostream& operator<<(std::ostream& out, const StereoIndexPairs& stereo_pairs);
 
+//! Conditions for a point to be visible in a camera.
+struct VisibilityOptions
+{
+  real_t min_depth { 0.0 };
+  real_t max_depth { std::numeric_limits<real_t>::max() };
+  real_t border_margin { 0.0 }; //!< Minimum distance in pixels to the border.
+  bool use_mask { true };       //!< Reject points on masked pixels.
+};
+
+//! Visibility of a set of points in one camera.
+struct CameraVisibility
+{
+  //! Pixel coordinates of all points, only meaningful for visible points.
+  Keypoints px;
+
+  //! Bit i is set if point i is visible.
+  std::vector<uint64_t> visible;
+
+  uint32_t num_visible { 0u };
+
+  inline bool isVisible(uint32_t i) const
+  {
+    return (visible[i >> 6] >> (i & 63u)) & 1u;
+  }
+
+  //! Indices of the visible points in increasing order.
+  std::vector<uint32_t> visibleIndices() const;
+};
+
+using RigVisibility = std::vector<CameraVisibility>;
+
+//! Project points (W)orld into camera (C) and check depth range, border
+//! margin and mask in one pass.
+CameraVisibility computeCameraVisibility(
+    const Camera& cam,
+    const Transformation& T_C_W,
+    const Eigen::Ref<const Positions>& p_W,
+    const VisibilityOptions& options = VisibilityOptions());
+
+//! Visibility of points (W)orld in all cameras of the rig at body pose T_W_B.
+RigVisibility computeRigVisibility(
+    const CameraRig& rig,
+    const Transformation& T_W_B,
+    const Eigen::Ref<const Positions>& p_W,
+    const VisibilityOptions& options = VisibilityOptions());
+
 //! Compute overlapping field of view and baseline for all stereo pairs
 StereoIndexPairs identifyStereoPairsInRig(
     const CameraRig& rig,
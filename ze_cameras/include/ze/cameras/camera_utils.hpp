@@ -25,6 +25,8 @@
 
 #pragma once
 
+#include <memory>
+#include <random>
 #include <tuple>
 
 #include <ze/common/types.hpp>
@@ -35,6 +37,7 @@ namespace ze {
 // fwd
 class Camera;
 class CameraRig;
+class ThreadPool;
 
 // -----------------------------------------------------------------------------
 // Generate visible keypoints and landmarks.
@@ -59,9 +62,45 @@ std::tuple<Keypoints, Bearings, Positions> generateRandomVisible3dPoints(
     const real_t min_depth = 1.0,
     const real_t max_depth = 3.0);
 
+//! Generate random visible keypoints, drawn from generator.
+Keypoints generateRandomKeypoints(
+    const Size2u image_size,
+    const uint32_t margin,
+    const uint32_t num_keypoints,
+    std::mt19937& generator);
+
+//! Generate random visible 3d points, drawn from generator.
+std::tuple<Keypoints, Bearings, Positions> generateRandomVisible3dPoints(
+    const Camera& cam,
+    const uint32_t num_points,
+    const uint32_t margin,
+    const real_t min_depth,
+    const real_t max_depth,
+    std::mt19937& generator);
+
 // -----------------------------------------------------------------------------
 // Check overlapping field of view.
 
+//! Sampled field of view of a camera: Bearings of a uniform keypoint grid and
+//! the cone (axis, half opening angle) enclosing them for quick rejection.
+struct CameraFieldOfView
+{
+  Bearings f;
+  Bearing axis;
+  real_t half_angle;
+};
+
+//! Hash over camera type, image size, projection and distortion parameters.
+size_t calibrationHash(const Camera& cam);
+
+//! Field of view of the camera, back-projected only once per calibration.
+//! Cameras with equal type, size and parameters share the cached result. The
+//! cache holds up to 64 calibrations and is cleared when full.
+std::shared_ptr<const CameraFieldOfView> cameraFieldOfView(const Camera& cam);
+
+//! Clear the cached fields of view and overlaps.
+void clearFieldOfViewCache();
+
 //! Check if two cameras in a rig have an overlapping field of view.
 //! @return Approximate percentage of overlapping field of view between cameras.
 real_t overlappingFieldOfView(
@@ -69,6 +108,16 @@ real_t overlappingFieldOfView(
     const uint32_t cam_a,
     const uint32_t cam_b);
 
+//! Overlapping field of view of all camera pairs in one pass. Entry (a,b) is
+//! the percentage of the field of view of camera a that is visible in b.
+//! Results are cached by the calibrations and the relative rotation, so
+//! reloading a rig or creating sub-rigs does not recompute them. The cache
+//! holds up to 1024 camera pairs and is cleared when full.
+//! @param pool Optional thread pool to distribute the rows of the matrix.
+MatrixX overlappingFieldOfViewMatrix(
+    const CameraRig& rig,
+    ThreadPool* pool = nullptr);
+
 // -----------------------------------------------------------------------------
 // Check landmark visiblity.
 
@@ -0,0 +1,358 @@
+// Copyright (c) 2015-2016, ETH Zurich, Wyss Zurich, Zurich Eye
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the ETH Zurich, Wyss Zurich, Zurich Eye nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL ETH Zurich, Wyss Zurich, Zurich Eye BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <ze/cameras/bearing_lookup_table.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <future>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+
+#include <Eigen/Geometry>
+
+#include <ze/common/logging.hpp>
+#include <ze/common/thread_pool.hpp>
+
+namespace ze {
+
+namespace {
+
+const char c_file_magic[] = "ZE_BEARING_LUT_1";
+constexpr int c_block_size = 4096;
+
+template<typename T>
+void writeBinary(std::ostream& out, const T& value)
+{
+  out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template<typename T>
+bool readBinary(std::istream& in, T* value)
+{
+  in.read(reinterpret_cast<char*>(value), sizeof(T));
+  return static_cast<bool>(in);
+}
+
+//! Grid nodes up to the last pixel.
+uint32_t gridDimension(uint32_t image_dimension, uint32_t subsampling)
+{
+  return (image_dimension - 1u + subsampling - 1u) / subsampling + 1u;
+}
+
+//! Coordinates every half cell up to the last pixel, which is always included.
+std::vector<real_t> halfCellCoordinates(uint32_t image_dimension, uint32_t subsampling)
+{
+  std::vector<real_t> coords;
+  const real_t last = image_dimension - 1u;
+  for (uint32_t i = 0u; i * subsampling < 2u * (image_dimension - 1u); ++i)
+  {
+    coords.push_back(i * subsampling * real_t(0.5));
+  }
+  coords.push_back(last);
+  return coords;
+}
+
+//! Exact back-projection in blocks on the pool, in this thread without pool.
+Bearings backProjectParallel(
+    const Camera& cam, const Keypoints& px, ThreadPool* pool)
+{
+  if (!pool || px.cols() <= c_block_size)
+  {
+    return cam.backProjectVectorizedExact(px);
+  }
+  Bearings bearings(3, px.cols());
+  std::vector<std::future<void>> blocks;
+  for (int start = 0; start < px.cols(); start += c_block_size)
+  {
+    blocks.push_back(pool->enqueue([&cam, &px, &bearings, start]()
+    {
+      const int n = std::min<int>(c_block_size, px.cols() - start);
+      bearings.middleCols(start, n) =
+          cam.backProjectVectorizedExact(px.middleCols(start, n));
+    }));
+  }
+  for (std::future<void>& block : blocks)
+  {
+    block.get();
+  }
+  return bearings;
+}
+
+} // anonymous namespace
+
+// -----------------------------------------------------------------------------
+BearingLookupTable::BearingLookupTable(
+    const Camera& cam, uint32_t subsampling, ThreadPool* pool)
+  : image_size_(cam.size())
+  , grid_size_(gridDimension(cam.width(), subsampling),
+               gridDimension(cam.height(), subsampling))
+  , subsampling_(subsampling)
+  , camera_type_(cam.type())
+  , projection_params_(cam.projectionParameters())
+  , distortion_params_(cam.distortionParameters())
+{
+  CHECK_GT(subsampling_, 0u);
+  CHECK_GE(grid_size_.width(), 2u);
+  CHECK_GE(grid_size_.height(), 2u);
+
+  Keypoints px(2, grid_size_.area());
+  for (uint32_t y = 0u; y < grid_size_.height(); ++y)
+  {
+    for (uint32_t x = 0u; x < grid_size_.width(); ++x)
+    {
+      px.col(y * grid_size_.width() + x) =
+          Keypoint(x * subsampling_, y * subsampling_);
+    }
+  }
+  bearings_ = backProjectParallel(cam, px, pool);
+  max_error_rad_ = computeMaxError(cam, pool);
+  VLOG(1) << "Bearing lookup table " << grid_size_.width() << "x"
+          << grid_size_.height() << " (subsampling " << subsampling_
+          << "), max error = " << max_error_rad_ << " rad.";
+}
+
+// -----------------------------------------------------------------------------
+Bearing BearingLookupTable::backProject(
+    const Eigen::Ref<const Keypoint>& px) const
+{
+  const real_t s_inv = real_t(1.0) / subsampling_;
+  const real_t u = std::min(std::max(px(0), real_t(0.0)),
+                            static_cast<real_t>(image_size_.width() - 1u)) * s_inv;
+  const real_t v = std::min(std::max(px(1), real_t(0.0)),
+                            static_cast<real_t>(image_size_.height() - 1u)) * s_inv;
+  const uint32_t x = std::min(static_cast<uint32_t>(u), grid_size_.width() - 2u);
+  const uint32_t y = std::min(static_cast<uint32_t>(v), grid_size_.height() - 2u);
+  const real_t a = u - x;
+  const real_t b = v - y;
+  const Bearing f = (1.0 - b) * ((1.0 - a) * node(x, y) + a * node(x + 1u, y))
+                  + b * ((1.0 - a) * node(x, y + 1u) + a * node(x + 1u, y + 1u));
+  return f.normalized();
+}
+
+Bearings BearingLookupTable::backProjectVectorized(
+    const Eigen::Ref<const Keypoints>& px_vec) const
+{
+  Bearings bearings(3, px_vec.cols());
+  for (int i = 0; i < px_vec.cols(); ++i)
+  {
+    bearings.col(i) = backProject(px_vec.col(i));
+  }
+  return bearings;
+}
+
+// -----------------------------------------------------------------------------
+real_t BearingLookupTable::computeMaxError(const Camera& cam, ThreadPool* pool) const
+{
+  // Corners, edge midpoints and centers of all cells, and the last pixel row
+  // and column, where cells are cut by the image border.
+  const std::vector<real_t> xs =
+      halfCellCoordinates(image_size_.width(), subsampling_);
+  const std::vector<real_t> ys =
+      halfCellCoordinates(image_size_.height(), subsampling_);
+  Keypoints px(2, xs.size() * ys.size());
+  for (size_t y = 0u; y < ys.size(); ++y)
+  {
+    for (size_t x = 0u; x < xs.size(); ++x)
+    {
+      px.col(y * xs.size() + x) = Keypoint(xs[x], ys[y]);
+    }
+  }
+  const Bearings exact = backProjectParallel(cam, px, pool);
+  real_t max_error = 0.0;
+  for (int i = 0; i < px.cols(); ++i)
+  {
+    const Bearing f = backProject(px.col(i));
+    const real_t error =
+        std::atan2(f.cross(exact.col(i)).norm(), f.dot(exact.col(i)));
+    max_error = std::max(max_error, error);
+  }
+  return max_error;
+}
+
+// -----------------------------------------------------------------------------
+bool BearingLookupTable::matches(const Camera& cam) const
+{
+  return image_size_ == cam.size()
+      && camera_type_ == cam.type()
+      && projection_params_.size() == cam.projectionParameters().size()
+      && distortion_params_.size() == cam.distortionParameters().size()
+      && projection_params_ == cam.projectionParameters()
+      && distortion_params_ == cam.distortionParameters();
+}
+
+// -----------------------------------------------------------------------------
+bool BearingLookupTable::save(const std::string& filename) const
+{
+  // Write to a unique file and rename, such that processes that start
+  // concurrently never read a partially written table.
+  const std::string tmp_filename = filename + ".tmp" + std::to_string(getpid())
+      + "_" + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id()));
+  {
+    std::ofstream fs(tmp_filename.c_str(), std::ios::out | std::ios::binary);
+    if (!fs.is_open())
+    {
+      LOG(WARNING) << "Could not write bearing lookup table " << filename;
+      return false;
+    }
+    fs.write(c_file_magic, sizeof(c_file_magic));
+    writeBinary(fs, static_cast<uint32_t>(sizeof(real_t)));
+    writeBinary(fs, image_size_.width());
+    writeBinary(fs, image_size_.height());
+    writeBinary(fs, subsampling_);
+    writeBinary(fs, static_cast<uint32_t>(camera_type_));
+    writeBinary(fs, static_cast<uint32_t>(projection_params_.size()));
+    writeBinary(fs, static_cast<uint32_t>(distortion_params_.size()));
+    fs.write(reinterpret_cast<const char*>(projection_params_.data()),
+             projection_params_.size() * sizeof(real_t));
+    fs.write(reinterpret_cast<const char*>(distortion_params_.data()),
+             distortion_params_.size() * sizeof(real_t));
+    writeBinary(fs, max_error_rad_);
+    fs.write(reinterpret_cast<const char*>(bearings_.data()),
+             bearings_.size() * sizeof(real_t));
+    if (!fs)
+    {
+      LOG(WARNING) << "Could not write bearing lookup table " << filename;
+      std::remove(tmp_filename.c_str());
+      return false;
+    }
+  }
+  if (std::rename(tmp_filename.c_str(), filename.c_str()) != 0)
+  {
+    LOG(WARNING) << "Could not write bearing lookup table " << filename;
+    std::remove(tmp_filename.c_str());
+    return false;
+  }
+  VLOG(1) << "Wrote bearing lookup table " << filename;
+  return true;
+}
+
+// -----------------------------------------------------------------------------
+BearingLookupTable::Ptr BearingLookupTable::load(
+    const std::string& filename, const Camera& cam)
+{
+  std::ifstream fs(filename.c_str(), std::ios::in | std::ios::binary);
+  if (!fs.is_open())
+  {
+    return nullptr;
+  }
+
+  char magic[sizeof(c_file_magic)];
+  fs.read(magic, sizeof(magic));
+  uint32_t real_size, width, height, subsampling, type, num_proj, num_dist;
+  if (!fs || !std::equal(magic, magic + sizeof(magic), c_file_magic)
+      || !readBinary(fs, &real_size) || real_size != sizeof(real_t)
+      || !readBinary(fs, &width) || !readBinary(fs, &height)
+      || !readBinary(fs, &subsampling) || !readBinary(fs, &type)
+      || !readBinary(fs, &num_proj) || !readBinary(fs, &num_dist)
+      || subsampling == 0u || width < 2u || height < 2u
+      || num_proj > 16u || num_dist > 16u)
+  {
+    LOG(WARNING) << "Invalid bearing lookup table " << filename;
+    return nullptr;
+  }
+
+  Ptr lut(new BearingLookupTable());
+  lut->image_size_ = Size2u(width, height);
+  lut->grid_size_ = Size2u(gridDimension(width, subsampling),
+                           gridDimension(height, subsampling));
+  lut->subsampling_ = subsampling;
+  lut->camera_type_ = static_cast<CameraType>(type);
+  lut->projection_params_.resize(num_proj);
+  lut->distortion_params_.resize(num_dist);
+  fs.read(reinterpret_cast<char*>(lut->projection_params_.data()),
+          num_proj * sizeof(real_t));
+  fs.read(reinterpret_cast<char*>(lut->distortion_params_.data()),
+          num_dist * sizeof(real_t));
+  if (!fs || !lut->matches(cam))
+  {
+    VLOG(1) << "Bearing lookup table " << filename << " is for another camera.";
+    return nullptr;
+  }
+
+  readBinary(fs, &lut->max_error_rad_);
+  lut->bearings_.resize(3, lut->grid_size_.area());
+  fs.read(reinterpret_cast<char*>(lut->bearings_.data()),
+          lut->bearings_.size() * sizeof(real_t));
+  if (!fs)
+  {
+    LOG(WARNING) << "Truncated bearing lookup table " << filename;
+    return nullptr;
+  }
+  return lut;
+}
+
+// -----------------------------------------------------------------------------
+BearingLookupTable::Ptr createBearingLookupTable(
+    const Camera& cam, const real_t max_error_rad, ThreadPool* pool)
+{
+  for (uint32_t subsampling = 16u; subsampling > 1u; subsampling /= 2u)
+  {
+    if (gridDimension(std::min(cam.width(), cam.height()), subsampling) < 2u)
+    {
+      continue;
+    }
+    BearingLookupTable::Ptr lut =
+        std::make_shared<BearingLookupTable>(cam, subsampling, pool);
+    if (lut->maxErrorRad() <= max_error_rad)
+    {
+      return lut;
+    }
+  }
+  return std::make_shared<BearingLookupTable>(cam, 1u, pool);
+}
+
+BearingLookupTable::Ptr loadOrCreateBearingLookupTable(
+    const Camera& cam, const std::string& cache_file,
+    const real_t max_error_rad, ThreadPool* pool)
+{
+  BearingLookupTable::Ptr lut = BearingLookupTable::load(cache_file, cam);
+  if (lut && lut->maxErrorRad() <= max_error_rad)
+  {
+    VLOG(1) << "Loaded bearing lookup table " << cache_file;
+    return lut;
+  }
+  lut = createBearingLookupTable(cam, max_error_rad, pool);
+  lut->save(cache_file);
+  return lut;
+}
+
+std::string bearingLookupTableFilename(
+    const std::string& calib_filename, uint32_t camera_index)
+{
+  std::string basename = calib_filename;
+  const size_t dot = basename.find_last_of('.');
+  if (dot != std::string::npos && basename.find('/', dot) == std::string::npos)
+  {
+    basename = basename.substr(0, dot);
+  }
+  return basename + "_cam" + std::to_string(camera_index) + ".bearings";
+}
+
+} // namespace ze
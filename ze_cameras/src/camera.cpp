@@ -26,6 +26,7 @@
 #include <ze/cameras/camera.hpp>
 
 #include <string>
+#include <ze/cameras/bearing_lookup_table.hpp>
 #include <ze/cameras/camera_yaml_serialization.hpp>
 
 namespace ze {
@@ -114,12 +115,37 @@ std::pair<Keypoint, Matrix24> Camera::projectHomogeneousWithJacobian(
                         dProjectHomogeneous_dLandmark(pos_h));
 }
 
+Bearing Camera::backProject(const Eigen::Ref<const Keypoint>& px) const
+{
+  if (bearing_lut_ && bearing_lut_->contains(px))
+  {
+    return bearing_lut_->backProject(px);
+  }
+  return this->backProjectExact(px);
+}
+
 Bearings Camera::backProjectVectorized(const Eigen::Ref<const Keypoints>& px_vec) const
 {
+  if (!bearing_lut_)
+  {
+    return this->backProjectVectorizedExact(px_vec);
+  }
   Bearings bearings(3, px_vec.cols());
   for(int i = 0; i < px_vec.cols(); ++i)
   {
-    bearings.col(i) = this->backProject(px_vec.col(i));
+    bearings.col(i) = bearing_lut_->contains(px_vec.col(i))
+        ? bearing_lut_->backProject(px_vec.col(i))
+        : this->backProjectExact(px_vec.col(i));
+  }
+  return bearings;
+}
+
+Bearings Camera::backProjectVectorizedExact(const Eigen::Ref<const Keypoints>& px_vec) const
+{
+  Bearings bearings(3, px_vec.cols());
+  for(int i = 0; i < px_vec.cols(); ++i)
+  {
+    bearings.col(i) = this->backProjectExact(px_vec.col(i));
   }
   return bearings;
 }
@@ -145,6 +171,25 @@ Matrix6X Camera::dProject_dLandmarkVectorized(const Positions& pos_vec) const
   return J_vec;
 }
 
+std::pair<Keypoints, Matrix6X> Camera::projectWithJacobianVectorized(
+    const Positions& pos_vec) const
+{
+  return std::make_pair(projectVectorized(pos_vec),
+                        dProject_dLandmarkVectorized(pos_vec));
+}
+
+Bearings32f Camera::backProjectVectorized32f(
+    const Eigen::Ref<const Keypoints32f>& px_vec) const
+{
+  return backProjectVectorizedExact(px_vec.cast<real_t>()).cast<float>();
+}
+
+Keypoints32f Camera::projectVectorized32f(
+    const Eigen::Ref<const Positions32f>& pos_vec) const
+{
+  return projectVectorized(pos_vec.cast<real_t>()).cast<float>();
+}
+
 std::string Camera::typeAsString() const
 {
   switch (type_)
@@ -164,6 +209,30 @@ void Camera::setMask(const Image8uC1::Ptr& mask)
   CHECK_NOTNULL(mask.get());
   CHECK_EQ(mask->size(), size_);
   mask_ = mask;
+
+  mask_words_per_row_ = (size_.width() + 63u) / 64u;
+  mask_bits_.assign(mask_words_per_row_ * size_.height(), 0u);
+  const ImageView<const Pixel8uC1> mask_view = mask->view();
+  for (uint32_t y = 0u; y < size_.height(); ++y)
+  {
+    const Pixel8uC1* mask_row = mask_view.row(y);
+    uint64_t* bits_row = mask_bits_.data() + y * mask_words_per_row_;
+    for (uint32_t x = 0u; x < size_.width(); ++x)
+    {
+      if (mask_row[x] > 0)
+      {
+        bits_row[x >> 6] |= uint64_t{1} << (x & 63u);
+      }
+    }
+  }
+}
+
+void Camera::setBearingLookupTable(
+    const std::shared_ptr<const BearingLookupTable>& lut)
+{
+  CHECK_NOTNULL(lut.get());
+  CHECK(lut->matches(*this));
+  bearing_lut_ = lut;
 }
 
 Camera::Ptr cameraFromYaml(const std::string& path)
@@ -189,6 +258,11 @@ std::ostream& operator<<(std::ostream& out, const Camera& cam)
       << "    Proj. parameters = " << cam.projectionParameters().transpose() << "\n"
       << "    Dist. parameters = " << cam.distortionParameters().transpose() << "\n"
       << "    Masked = " << (cam.mask() ? "True" : "False");
+  if (cam.bearingLookupTable())
+  {
+    out << "\n    Bearing lookup table subsampling = "
+        << cam.bearingLookupTable()->subsampling();
+  }
   return out;
 }
 
@@ -25,11 +25,17 @@
 
 #include <ze/cameras/camera_rig.hpp>
 
+#include <algorithm>
+#include <thread>
+
 #include <imp/bridge/opencv/cv_bridge.hpp>
 #include <imp/core/image_raw.hpp>
+#include <ze/cameras/bearing_lookup_table.hpp>
 #include <ze/cameras/camera_utils.hpp>
 #include <ze/cameras/camera_yaml_serialization.hpp>
+#include <ze/common/math.hpp>
 #include <ze/common/path_utils.hpp>
+#include <ze/common/thread_pool.hpp>
 
 DEFINE_string(calib_filename, "", "Camera calibration file.");
 DEFINE_string(mask_cam0, "", "Mask for camera 0");
@@ -37,6 +43,8 @@ DEFINE_string(mask_cam1, "", "Mask for camera 1");
 DEFINE_string(mask_cam2, "", "Mask for camera 2");
 DEFINE_string(mask_cam3, "", "Mask for camera 3");
 DEFINE_bool(calib_use_single_camera, false, "");
+DEFINE_double(calib_bearing_lut_max_error_deg, 0.0,
+              "Max error of the cached bearing lookup tables, 0 disables them.");
 
 namespace ze {
 
@@ -148,6 +156,18 @@ CameraRig::Ptr cameraRigFromGflags()
     rig->atShared(3)->setMask(mask);
   }
 
+  if (FLAGS_calib_bearing_lut_max_error_deg > 0.0)
+  {
+    ThreadPool pool(std::max(1u, std::thread::hardware_concurrency()));
+    for (size_t i = 0u; i < rig->size(); ++i)
+    {
+      rig->atShared(i)->setBearingLookupTable(
+            loadOrCreateBearingLookupTable(
+              rig->at(i), bearingLookupTableFilename(FLAGS_calib_filename, i),
+              degToRad(FLAGS_calib_bearing_lut_max_error_deg), &pool));
+    }
+  }
+
   return rig;
 }
 
@@ -177,6 +197,81 @@ std::ostream& operator<<(std::ostream& out, const StereoIndexPairs& stereo_pairs
   return out;
 }
 
+// -----------------------------------------------------------------------------
+std::vector<uint32_t> CameraVisibility::visibleIndices() const
+{
+  std::vector<uint32_t> indices;
+  indices.reserve(num_visible);
+  for (uint32_t w = 0u; w < visible.size(); ++w)
+  {
+    uint64_t bits = visible[w];
+    while (bits)
+    {
+      indices.push_back(w * 64u + __builtin_ctzll(bits));
+      bits &= bits - 1u;
+    }
+  }
+  return indices;
+}
+
+// -----------------------------------------------------------------------------
+CameraVisibility computeCameraVisibility(
+    const Camera& cam,
+    const Transformation& T_C_W,
+    const Eigen::Ref<const Positions>& p_W,
+    const VisibilityOptions& options)
+{
+  CHECK_GE(options.border_margin, 0.0);
+  const uint32_t n = p_W.cols();
+  const Positions p_C = T_C_W.transformVectorized(p_W);
+
+  CameraVisibility vis;
+  vis.px = cam.projectVectorized(p_C);
+  vis.visible.assign((n + 63u) / 64u, 0u);
+  const real_t min_x = options.border_margin;
+  const real_t min_y = options.border_margin;
+  const real_t max_x = static_cast<real_t>(cam.width()) - options.border_margin;
+  const real_t max_y = static_cast<real_t>(cam.height()) - options.border_margin;
+  const bool use_mask = options.use_mask && cam.mask();
+  for (uint32_t i = 0u; i < n; ++i)
+  {
+    const real_t depth = p_C(2, i);
+    const real_t x = vis.px(0, i);
+    const real_t y = vis.px(1, i);
+    if (depth < options.min_depth || depth > options.max_depth
+        || !(x >= min_x && y >= min_y && x < max_x && y < max_y))
+    {
+      continue;
+    }
+    if (use_mask
+        && cam.isMasked(static_cast<uint32_t>(x), static_cast<uint32_t>(y)))
+    {
+      continue;
+    }
+    vis.visible[i >> 6] |= uint64_t{1} << (i & 63u);
+    ++vis.num_visible;
+  }
+  return vis;
+}
+
+// -----------------------------------------------------------------------------
+RigVisibility computeRigVisibility(
+    const CameraRig& rig,
+    const Transformation& T_W_B,
+    const Eigen::Ref<const Positions>& p_W,
+    const VisibilityOptions& options)
+{
+  const Transformation T_B_W = T_W_B.inverse();
+  RigVisibility vis;
+  vis.reserve(rig.size());
+  for (size_t cam_idx = 0u; cam_idx < rig.size(); ++cam_idx)
+  {
+    vis.push_back(computeCameraVisibility(
+                    rig.at(cam_idx), rig.T_C_B(cam_idx) * T_B_W, p_W, options));
+  }
+  return vis;
+}
+
 // -----------------------------------------------------------------------------
 StereoIndexPairs identifyStereoPairsInRig(
     const CameraRig& rig,
@@ -184,11 +279,12 @@ StereoIndexPairs identifyStereoPairsInRig(
     const real_t& min_baseline)
 {
   StereoIndexPairs pairs;
+  const MatrixX overlaps = overlappingFieldOfViewMatrix(rig);
   for (uint32_t cam_A = 0u; cam_A < rig.size(); ++cam_A)
   {
     for (uint32_t cam_B = cam_A + 1u; cam_B < rig.size(); ++cam_B)
     {
-      real_t overlap = overlappingFieldOfView(rig, cam_A, cam_B);
+      real_t overlap = overlaps(cam_A, cam_B);
       real_t baseline = (rig.T_C_B(cam_B) * rig.T_C_B(cam_A).inverse()).getPosition().norm();
 
 
@@ -25,31 +25,39 @@
 
 #include <ze/cameras/camera_utils.hpp>
 
+#include <functional>
+#include <mutex>
 #include <random>
+#include <unordered_map>
+#include <utility>
 #include <ze/common/config.hpp>
 #include <ze/common/logging.hpp>
 #include <ze/common/random_matrix.hpp>
+#include <ze/common/thread_pool.hpp>
 
 #include <ze/cameras/camera_rig.hpp>
 
 namespace ze {
 
+namespace {
+
+//! Generator of the overloads without one, seeded once per process like the
+//! ones of sampleUniformRealDistribution().
+std::mt19937& defaultGenerator()
+{
+  static std::mt19937 generator(std::random_device{}());
+  return generator;
+}
+
+} // anonymous namespace
+
 // -----------------------------------------------------------------------------
 Keypoints generateRandomKeypoints(
     const Size2u size,
     const uint32_t margin,
     const uint32_t num_keypoints)
 {
-  DEBUG_CHECK_GT(size.width(), margin + 1u);
-  DEBUG_CHECK_GT(size.height(), margin + 1u);
-
-  Keypoints kp(2, num_keypoints);
-  for(uint32_t i = 0u; i < num_keypoints; ++i)
-  {
-    kp(0,i) = sampleUniformRealDistribution<real_t>(false, margin, size.width() - 1 - margin);
-    kp(1,i) = sampleUniformRealDistribution<real_t>(false, margin, size.height() - 1 - margin);
-  }
-  return kp;
+  return generateRandomKeypoints(size, margin, num_keypoints, defaultGenerator());
 }
 
 // -----------------------------------------------------------------------------
@@ -88,38 +96,192 @@ std::tuple<Keypoints, Bearings, Positions> generateRandomVisible3dPoints(
     const real_t min_depth,
     const real_t max_depth)
 {
-  Keypoints px = generateRandomKeypoints(cam.size(), margin, num_points);
+  return generateRandomVisible3dPoints(cam, num_points, margin, min_depth,
+                                       max_depth, defaultGenerator());
+}
+
+// -----------------------------------------------------------------------------
+Keypoints generateRandomKeypoints(
+    const Size2u size,
+    const uint32_t margin,
+    const uint32_t num_keypoints,
+    std::mt19937& generator)
+{
+  DEBUG_CHECK_GT(size.width(), margin + 1u);
+  DEBUG_CHECK_GT(size.height(), margin + 1u);
+
+  std::uniform_real_distribution<real_t> u(margin, size.width() - 1 - margin);
+  std::uniform_real_distribution<real_t> v(margin, size.height() - 1 - margin);
+  Keypoints kp(2, num_keypoints);
+  for(uint32_t i = 0u; i < num_keypoints; ++i)
+  {
+    kp(0,i) = u(generator);
+    kp(1,i) = v(generator);
+  }
+  return kp;
+}
+
+// -----------------------------------------------------------------------------
+std::tuple<Keypoints, Bearings, Positions> generateRandomVisible3dPoints(
+    const Camera& cam,
+    const uint32_t num_points,
+    const uint32_t margin,
+    const real_t min_depth,
+    const real_t max_depth,
+    std::mt19937& generator)
+{
+  Keypoints px = generateRandomKeypoints(cam.size(), margin, num_points, generator);
   Bearings f = cam.backProjectVectorized(px);
   Positions pos = f;
+  std::uniform_real_distribution<real_t> depth(min_depth, max_depth);
   for(uint32_t i = 0u; i < num_points; ++i)
   {
-    pos.col(i) *= sampleUniformRealDistribution<real_t>(false, min_depth, max_depth);
+    pos.col(i) *= depth(generator);
   }
   return std::make_tuple(px, f, pos);
 }
 
 // -----------------------------------------------------------------------------
-real_t overlappingFieldOfView(
-    const CameraRig& rig,
-    const uint32_t cam_A,
-    const uint32_t cam_B)
+namespace {
+
+//! Cameras whose cones are further apart than the sum of their half opening
+//! angles plus this margin do not overlap. The margin accounts for the image
+//! border between the sampled keypoints.
+constexpr real_t c_fov_cone_margin = 0.02;
+
+//! The caches are cleared when they reach this size, such that processes that
+//! load many calibrations do not grow without bound.
+constexpr size_t c_max_cached_fields_of_view = 64u;
+constexpr size_t c_max_cached_overlaps = 1024u;
+
+inline void hashCombine(size_t& seed, const size_t value)
 {
-  DEBUG_CHECK_LT(cam_A, rig.size());
-  DEBUG_CHECK_LT(cam_B, rig.size());
+  seed ^= value + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+}
+
+template<typename Derived>
+void hashCombineMatrix(size_t& seed, const Eigen::MatrixBase<Derived>& m)
+{
+  std::hash<typename Derived::Scalar> hasher;
+  for (int i = 0; i < m.size(); ++i)
+  {
+    hashCombine(seed, hasher(m(i)));
+  }
+}
+
+//! Everything the field of view depends on. Cache hits compare the full key,
+//! the hash only selects the bucket.
+struct CalibrationKey
+{
+  CameraType type;
+  Size2u size;
+  VectorX projection_params;
+  VectorX distortion_params;
+
+  explicit CalibrationKey(const Camera& cam)
+    : type(cam.type())
+    , size(cam.size())
+    , projection_params(cam.projectionParameters())
+    , distortion_params(cam.distortionParameters())
+  {}
+
+  bool operator==(const CalibrationKey& other) const
+  {
+    return type == other.type
+        && size == other.size
+        && projection_params.size() == other.projection_params.size()
+        && distortion_params.size() == other.distortion_params.size()
+        && projection_params == other.projection_params
+        && distortion_params == other.distortion_params;
+  }
+};
+
+size_t hashValue(const CalibrationKey& key)
+{
+  size_t seed = std::hash<int>()(static_cast<int>(key.type));
+  hashCombine(seed, key.size.width());
+  hashCombine(seed, key.size.height());
+  hashCombineMatrix(seed, key.projection_params);
+  hashCombineMatrix(seed, key.distortion_params);
+  return seed;
+}
+
+struct OverlapKey
+{
+  CalibrationKey cam_A;
+  CalibrationKey cam_B;
+  Matrix3 R_B_A;
+
+  bool operator==(const OverlapKey& other) const
+  {
+    return cam_A == other.cam_A && cam_B == other.cam_B && R_B_A == other.R_B_A;
+  }
+};
+
+struct KeyHash
+{
+  size_t operator()(const CalibrationKey& key) const
+  {
+    return hashValue(key);
+  }
+
+  size_t operator()(const OverlapKey& key) const
+  {
+    size_t seed = hashValue(key.cam_A);
+    hashCombine(seed, hashValue(key.cam_B));
+    hashCombineMatrix(seed, key.R_B_A);
+    return seed;
+  }
+};
 
-  // We sample uniformly keypoints in camera a and project them into camera b,
-  // assuming the landmark is at infinity (i.e. only rotate).
-  Keypoints px_A = generateUniformKeypoints(rig.at(cam_A).size(), 0u, 20u);
-  Bearings f_A = rig.at(cam_A).backProjectVectorized(px_A);
-  Transformation T_B_A = rig.T_C_B(cam_B) * rig.T_C_B(cam_A).inverse();
-  Positions p_B = T_B_A.getRotation().rotateVectorized(f_A);
-  Keypoints px_B = rig.at(cam_B).projectVectorized(p_B);
+std::mutex g_fov_cache_mutex;
+std::unordered_map<CalibrationKey, std::shared_ptr<const CameraFieldOfView>, KeyHash>
+g_fov_cache;
+std::unordered_map<OverlapKey, real_t, KeyHash> g_overlap_cache;
+
+CameraFieldOfView computeFieldOfView(const Camera& cam)
+{
+  CameraFieldOfView fov;
+  fov.f = cam.backProjectVectorized(
+            generateUniformKeypoints(cam.size(), 0u, 20u));
+  const Bearing mean = fov.f.rowwise().sum();
+  if (mean.norm() < 1e-6 * fov.f.cols())
+  {
+    // Omnidirectional, no cone to reject with.
+    fov.axis = Bearing::UnitZ();
+    fov.half_angle = M_PI;
+    return fov;
+  }
+  fov.axis = mean.normalized();
+  const real_t min_cos = (fov.axis.transpose() * fov.f).minCoeff();
+  fov.half_angle = std::acos(std::max(real_t{-1.0}, std::min(real_t{1.0}, min_cos)));
+  return fov;
+}
+
+real_t computeOverlap(
+    const CameraFieldOfView& fov_A,
+    const CameraFieldOfView& fov_B,
+    const Camera& cam_B,
+    const Matrix3& R_B_A)
+{
+  // Cones do not intersect.
+  const real_t cos_axes = (R_B_A * fov_A.axis).dot(fov_B.axis);
+  const real_t angle = std::acos(std::max(real_t{-1.0}, std::min(real_t{1.0}, cos_axes)));
+  if (angle > fov_A.half_angle + fov_B.half_angle + c_fov_cone_margin)
+  {
+    return 0.0;
+  }
+
+  // We project the bearings of camera a into camera b, assuming the landmark
+  // is at infinity (i.e. only rotate).
+  const Positions p_B = R_B_A * fov_A.f;
+  const Keypoints px_B = cam_B.projectVectorized(p_B);
 
   uint32_t num_visible = 0u;
   for (int i = 0; i < px_B.cols(); ++i)
   {
     //! @todo: Omnidirectional cameras: Improve check.
-    if (p_B.col(i)(2) > 0 && isVisible(rig.at(cam_B).size(), px_B.col(i)))
+    if (p_B.col(i)(2) > 0 && isVisible(cam_B.size(), px_B.col(i)))
     {
       ++num_visible;
     }
@@ -128,4 +290,139 @@ real_t overlappingFieldOfView(
   return static_cast<real_t>(num_visible) / px_B.cols();
 }
 
+real_t cachedOverlap(
+    const CameraRig& rig,
+    const uint32_t cam_A,
+    const uint32_t cam_B,
+    const CameraFieldOfView& fov_A,
+    const CameraFieldOfView& fov_B)
+{
+  const Matrix3 R_B_A =
+      (rig.T_C_B(cam_B) * rig.T_C_B(cam_A).inverse()).getRotationMatrix();
+  OverlapKey key = {
+    CalibrationKey(rig.at(cam_A)), CalibrationKey(rig.at(cam_B)), R_B_A };
+  {
+    std::lock_guard<std::mutex> lock(g_fov_cache_mutex);
+    auto it = g_overlap_cache.find(key);
+    if (it != g_overlap_cache.end())
+    {
+      return it->second;
+    }
+  }
+
+  const real_t overlap = computeOverlap(fov_A, fov_B, rig.at(cam_B), R_B_A);
+  std::lock_guard<std::mutex> lock(g_fov_cache_mutex);
+  if (g_overlap_cache.size() >= c_max_cached_overlaps)
+  {
+    g_overlap_cache.clear();
+  }
+  g_overlap_cache.emplace(std::move(key), overlap);
+  return overlap;
+}
+
+//! Runs fun(i) for i in [0, n), distributed on the pool if there is one.
+void forEachIndex(
+    const uint32_t n,
+    ThreadPool* pool,
+    const std::function<void(uint32_t)>& fun)
+{
+  if (!pool)
+  {
+    for (uint32_t i = 0u; i < n; ++i)
+    {
+      fun(i);
+    }
+    return;
+  }
+  std::vector<std::future<void>> futures;
+  futures.reserve(n);
+  for (uint32_t i = 0u; i < n; ++i)
+  {
+    futures.push_back(pool->enqueue(fun, i));
+  }
+  for (std::future<void>& future : futures)
+  {
+    future.get();
+  }
+}
+
+} // anonymous namespace
+
+// -----------------------------------------------------------------------------
+size_t calibrationHash(const Camera& cam)
+{
+  return hashValue(CalibrationKey(cam));
+}
+
+// -----------------------------------------------------------------------------
+std::shared_ptr<const CameraFieldOfView> cameraFieldOfView(const Camera& cam)
+{
+  CalibrationKey key(cam);
+  {
+    std::lock_guard<std::mutex> lock(g_fov_cache_mutex);
+    auto it = g_fov_cache.find(key);
+    if (it != g_fov_cache.end())
+    {
+      return it->second;
+    }
+  }
+
+  // Computed without holding the lock. Concurrent misses compute it twice.
+  std::shared_ptr<const CameraFieldOfView> fov =
+      std::make_shared<CameraFieldOfView>(computeFieldOfView(cam));
+  std::lock_guard<std::mutex> lock(g_fov_cache_mutex);
+  if (g_fov_cache.size() >= c_max_cached_fields_of_view)
+  {
+    g_fov_cache.clear();
+  }
+  return g_fov_cache.emplace(std::move(key), fov).first->second;
+}
+
+// -----------------------------------------------------------------------------
+void clearFieldOfViewCache()
+{
+  std::lock_guard<std::mutex> lock(g_fov_cache_mutex);
+  g_fov_cache.clear();
+  g_overlap_cache.clear();
+}
+
+// -----------------------------------------------------------------------------
+real_t overlappingFieldOfView(
+    const CameraRig& rig,
+    const uint32_t cam_A,
+    const uint32_t cam_B)
+{
+  DEBUG_CHECK_LT(cam_A, rig.size());
+  DEBUG_CHECK_LT(cam_B, rig.size());
+  return cachedOverlap(rig, cam_A, cam_B,
+                       *cameraFieldOfView(rig.at(cam_A)),
+                       *cameraFieldOfView(rig.at(cam_B)));
+}
+
+// -----------------------------------------------------------------------------
+MatrixX overlappingFieldOfViewMatrix(
+    const CameraRig& rig,
+    ThreadPool* pool)
+{
+  const uint32_t n = rig.size();
+
+  // Back-project the sampled keypoints once per camera.
+  std::vector<std::shared_ptr<const CameraFieldOfView>> fov(n);
+  forEachIndex(n, pool, [&](uint32_t i) { fov[i] = cameraFieldOfView(rig.at(i)); });
+
+  MatrixX overlap = MatrixX::Identity(n, n);
+  forEachIndex(n, pool, [&](uint32_t cam_A)
+  {
+    for (uint32_t cam_B = 0u; cam_B < n; ++cam_B)
+    {
+      if (cam_A != cam_B)
+      {
+        overlap(cam_A, cam_B) =
+            cachedOverlap(rig, cam_A, cam_B, *fov[cam_A], *fov[cam_B]);
+      }
+    }
+  });
+  return overlap;
+}
+
 } // namespace ze
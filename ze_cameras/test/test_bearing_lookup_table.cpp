@@ -0,0 +1,177 @@
+// Copyright (c) 2015-2016, ETH Zurich, Wyss Zurich, Zurich Eye
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the ETH Zurich, Wyss Zurich, Zurich Eye nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL ETH Zurich, Wyss Zurich, Zurich Eye BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+#include <Eigen/Geometry>
+
+#include <ze/common/test_entrypoint.hpp>
+#include <ze/common/test_utils.hpp>
+#include <ze/common/thread_pool.hpp>
+#include <ze/cameras/bearing_lookup_table.hpp>
+#include <ze/cameras/camera_impl.hpp>
+#include <ze/cameras/camera_utils.hpp>
+
+namespace {
+
+ze::real_t maxAngle(const ze::Bearings& a, const ze::Bearings& b)
+{
+  ze::real_t max_angle = 0.0;
+  for (int i = 0; i < a.cols(); ++i)
+  {
+    ze::Vector3 f_a = a.col(i);
+    ze::Vector3 f_b = b.col(i);
+    max_angle = std::max(max_angle,
+                         std::atan2(f_a.cross(f_b).norm(), f_a.dot(f_b)));
+  }
+  return max_angle;
+}
+
+} // anonymous namespace
+
+TEST(BearingLookupTableTest, testExactAtNodes)
+{
+  using namespace ze;
+  RadTanCamera cam = createRadTanCamera(752, 480, 310, 320, 376.0, 240.0,
+                                        -0.2834, 0.0739, 0.00019, 1.76e-05);
+  ThreadPool pool(2);
+  BearingLookupTable lut(cam, 4u, &pool);
+  EXPECT_EQ(lut.gridSize().width(), 189u);
+  EXPECT_EQ(lut.gridSize().height(), 121u);
+  for (uint32_t y = 0u; y < 480u; y += 20u)
+  {
+    for (uint32_t x = 0u; x < 752u; x += 16u)
+    {
+      Keypoint px(x, y);
+      EXPECT_TRUE(EIGEN_MATRIX_NEAR(lut.backProject(px), cam.backProject(px), 1e-6));
+    }
+  }
+}
+
+TEST(BearingLookupTableTest, testErrorBound)
+{
+  using namespace ze;
+  EquidistantCamera cam = createEquidistantCamera(752, 480, 310, 320, 376.0, 240.0,
+                                                  -0.00279, 0.02414, -0.04304, 0.03118);
+  const real_t max_error = 1e-4;
+  BearingLookupTable::Ptr lut = createBearingLookupTable(cam, max_error);
+  ASSERT_TRUE(lut != nullptr);
+  EXPECT_LE(lut->maxErrorRad(), max_error);
+  EXPECT_GT(lut->subsampling(), 1u);
+
+  // The bound holds on the cell corners and edges.
+  const uint32_t s = lut->subsampling();
+  std::vector<Keypoint> on_edges;
+  for (uint32_t y = 0u; y < cam.height(); y += s)
+  {
+    for (uint32_t x = 0u; x < cam.width(); x += s)
+    {
+      for (real_t t : {0.0, 0.25, 0.5, 0.75})
+      {
+        on_edges.push_back(Keypoint(std::min<real_t>(x + t * s, cam.width() - 1u), y));
+        on_edges.push_back(Keypoint(x, std::min<real_t>(y + t * s, cam.height() - 1u)));
+      }
+    }
+  }
+  Keypoints px(2, on_edges.size());
+  for (size_t i = 0u; i < on_edges.size(); ++i)
+  {
+    px.col(i) = on_edges[i];
+  }
+  EXPECT_LE(maxAngle(lut->backProjectVectorized(px), cam.backProjectVectorizedExact(px)),
+            1.01 * max_error);
+
+  // Inside the cells it is evaluated at the centers only, allow some slack.
+  px = generateRandomKeypoints(cam.size(), 0u, 1000u);
+  EXPECT_LE(maxAngle(lut->backProjectVectorized(px), cam.backProjectVectorizedExact(px)),
+            1.5 * max_error);
+}
+
+TEST(BearingLookupTableTest, testCameraUsesTable)
+{
+  using namespace ze;
+  RadTanCamera cam = createRadTanCamera(752, 480, 310, 320, 376.0, 240.0,
+                                        -0.2834, 0.0739, 0.00019, 1.76e-05);
+  BearingLookupTable::Ptr lut = std::make_shared<BearingLookupTable>(cam, 8u);
+  cam.setBearingLookupTable(lut);
+
+  // Inside the image the camera interpolates in the table.
+  Keypoints px = generateRandomKeypoints(cam.size(), 0u, 100u);
+  EXPECT_TRUE(EIGEN_MATRIX_NEAR(cam.backProjectVectorized(px),
+                                lut->backProjectVectorized(px), 1e-12));
+  EXPECT_FALSE(EIGEN_MATRIX_NEAR(cam.backProjectVectorized(px),
+                                 cam.backProjectVectorizedExact(px), 1e-12));
+  for (int i = 0; i < px.cols(); ++i)
+  {
+    EXPECT_TRUE(EIGEN_MATRIX_NEAR(cam.backProject(px.col(i)),
+                                  lut->backProject(px.col(i)), 1e-12));
+  }
+
+  // Outside it uses the camera model, the table would clamp.
+  Keypoints outside(2, 2);
+  outside << -10.0, 800.0,
+             -10.0, 500.0;
+  EXPECT_TRUE(EIGEN_MATRIX_NEAR(cam.backProjectVectorized(outside),
+                                cam.backProjectVectorizedExact(outside), 1e-12));
+  EXPECT_TRUE(EIGEN_MATRIX_NEAR(cam.backProject(outside.col(0)),
+                                cam.backProjectExact(outside.col(0)), 1e-12));
+
+  // A new table is computed from the camera model, not from the set table.
+  BearingLookupTable other(cam, 4u);
+  EXPECT_TRUE(EIGEN_MATRIX_NEAR(other.node(1u, 1u),
+                                cam.backProjectExact(Keypoint(4.0, 4.0)), 1e-9));
+}
+
+TEST(BearingLookupTableTest, testSaveLoad)
+{
+  using namespace ze;
+  FovCamera cam = createFovCamera(752, 480, 310, 320, 376.0, 240.0, 0.947367);
+  const std::string filename = bearingLookupTableFilename("/tmp/calib.yaml", 1u);
+  EXPECT_EQ(filename, "/tmp/calib_cam1.bearings");
+  std::remove(filename.c_str());
+  EXPECT_TRUE(BearingLookupTable::load(filename, cam) == nullptr);
+
+  BearingLookupTable::Ptr lut =
+      loadOrCreateBearingLookupTable(cam, filename, 1e-3);
+  BearingLookupTable::Ptr loaded = BearingLookupTable::load(filename, cam);
+  ASSERT_TRUE(loaded != nullptr);
+  EXPECT_EQ(loaded->subsampling(), lut->subsampling());
+  EXPECT_EQ(loaded->maxErrorRad(), lut->maxErrorRad());
+  Keypoints px = generateRandomKeypoints(cam.size(), 0u, 100u);
+  EXPECT_TRUE(EIGEN_MATRIX_NEAR(loaded->backProjectVectorized(px),
+                                lut->backProjectVectorized(px), 1e-12));
+
+  cam.setBearingLookupTable(loaded);
+  EXPECT_EQ(cam.bearingLookupTable(), loaded);
+
+  // A table of another calibration is not used.
+  FovCamera other = createFovCamera(752, 480, 311, 320, 376.0, 240.0, 0.947367);
+  EXPECT_TRUE(BearingLookupTable::load(filename, other) == nullptr);
+  std::remove(filename.c_str());
+}
+
+ZE_UNITTEST_ENTRYPOINT
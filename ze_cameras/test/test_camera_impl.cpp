@@ -68,6 +68,37 @@ public:
     real_t bp = (p2 - backProjectVectorized()) / p2;
     VLOG(1) << "[" << test_name_ << "]" << "Vectorized back projection " << bp * 100 << "% faster." << "\n"
             << "[" << test_name_ << "]" << "Vectorized projection " << p * 100 << "% faster.";
+
+    real_t p3 = projectVectorized();
+    real_t p_32f = (p3 - projectVectorized32f()) / p3;
+    real_t p4 = backProjectVectorized();
+    real_t bp_32f = (p4 - backProjectVectorized32f()) / p4;
+    VLOG(1) << "[" << test_name_ << "]" << "Float back projection " << bp_32f * 100 << "% faster." << "\n"
+            << "[" << test_name_ << "]" << "Float projection " << p_32f * 100 << "% faster.";
+  }
+
+  real_t backProjectVectorized32f()
+  {
+    const Keypoints32f px_32f = px_.cast<float>();
+    Bearings32f f(3, sample_size_);
+    auto backProjectVectorizedLambda = [&]()
+    {
+      f = cam_.backProjectVectorized32f(px_32f);
+    };
+    return runTimingBenchmark(backProjectVectorizedLambda, 10, 20,
+                       test_name_ + ": Back-project vectorized float", true);
+  }
+
+  real_t projectVectorized32f()
+  {
+    const Positions32f f_32f = f_.cast<float>();
+    Keypoints32f px(2, sample_size_);
+    auto projectVectorizedLambda = [&]()
+    {
+      px = cam_.projectVectorized32f(f_32f);
+    };
+    return runTimingBenchmark(projectVectorizedLambda, 10, 20,
+                       test_name_ + ": Project vectorized float", true);
   }
 
   real_t backProjectVectorized()
@@ -222,6 +253,53 @@ public:
     EXPECT_TRUE(EIGEN_MATRIX_NEAR(H, H_numerical, 1e-6));
   }
 
+  void testVectorized()
+  {
+    Keypoints px = generateRandomKeypoints(cam_.size(), 10u, sample_size_);
+    Bearings f = cam_.backProjectVectorized(px);
+    Positions pos = f * 3.0;
+#ifndef ZE_SINGLE_PRECISION_FLOAT
+    const real_t tol = 1e-6;
+#else
+    const real_t tol = 1e-3;
+#endif
+    Keypoints px_vec = cam_.projectVectorized(pos);
+    Matrix6X J_vec = cam_.dProject_dLandmarkVectorized(pos);
+    std::pair<Keypoints, Matrix6X> res = cam_.projectWithJacobianVectorized(pos);
+    ASSERT_EQ(f.cols(), px.cols());
+    ASSERT_EQ(px_vec.cols(), px.cols());
+    ASSERT_EQ(J_vec.cols(), px.cols());
+    for (int i = 0; i < px.cols(); ++i)
+    {
+      Matrix23 J = cam_.dProject_dLandmark(pos.col(i));
+      Matrix61 J_col = Eigen::Map<Matrix61>(J.data());
+      EXPECT_TRUE(EIGEN_MATRIX_NEAR(f.col(i), cam_.backProject(px.col(i)), tol));
+      EXPECT_TRUE(EIGEN_MATRIX_NEAR(px_vec.col(i), cam_.project(pos.col(i)), tol));
+      EXPECT_TRUE(EIGEN_MATRIX_NEAR(J_vec.col(i), J_col, tol));
+      EXPECT_TRUE(EIGEN_MATRIX_NEAR(res.first.col(i), px_vec.col(i), tol));
+      EXPECT_TRUE(EIGEN_MATRIX_NEAR(res.second.col(i), J_col, tol));
+    }
+  }
+
+  void testVectorized32f()
+  {
+    Keypoints px = generateRandomKeypoints(cam_.size(), 10u, sample_size_);
+    Positions pos = cam_.backProjectVectorized(px) * 3.0;
+    Bearings32f f_32f = cam_.backProjectVectorized32f(px.cast<float>());
+    Keypoints32f px_32f = cam_.projectVectorized32f(pos.cast<float>());
+    ASSERT_EQ(f_32f.cols(), px.cols());
+    ASSERT_EQ(px_32f.cols(), px.cols());
+    // Error bounds documented in camera_models_batch.hpp.
+    const real_t px_tol = 2e-4;
+    const real_t f_tol = 1e-6;
+    for (int i = 0; i < px.cols(); ++i)
+    {
+      EXPECT_TRUE(EIGEN_MATRIX_NEAR(px_32f.col(i).cast<real_t>(), px.col(i), px_tol));
+      EXPECT_TRUE(EIGEN_MATRIX_NEAR(f_32f.col(i).cast<real_t>(),
+                                    pos.col(i).normalized(), f_tol));
+    }
+  }
+
   void testAll()
   {
     {
@@ -244,6 +322,14 @@ public:
       SCOPED_TRACE("HomogeneousJacobian");
       testHomogeneousJacobian();
     }
+    {
+      SCOPED_TRACE("Vectorized");
+      testVectorized();
+    }
+    {
+      SCOPED_TRACE("Vectorized32f");
+      testVectorized32f();
+    }
   }
 
 private:
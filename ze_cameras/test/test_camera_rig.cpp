@@ -27,8 +27,11 @@
 #include <ze/common/test_entrypoint.hpp>
 #include <ze/common/test_utils.hpp>
 #include <ze/common/path_utils.hpp>
+#include <imp/core/image_raw.hpp>
 #include <ze/cameras/camera.hpp>
+#include <ze/cameras/camera_impl.hpp>
 #include <ze/cameras/camera_rig.hpp>
+#include <ze/cameras/camera_utils.hpp>
 
 TEST(CameraRigTests, testYamlLoading)
 {
@@ -69,4 +72,64 @@ TEST(CameraRigTests, testStereoPairIdentification)
 
 }
 
+TEST(CameraRigTests, testVisibility)
+{
+  using namespace ze;
+
+  Camera::Ptr cam = std::make_shared<PinholeCamera>(
+        createPinholeCamera(640, 480, 329.11, 329.11, 320.0, 240.0));
+  ImageRaw8uC1::Ptr mask = std::make_shared<ImageRaw8uC1>(cam->size());
+  for (uint32_t y = 0; y < mask->height(); ++y)
+  {
+    for (uint32_t x = 0; x < mask->width(); ++x)
+    {
+      (*mask)(x, y) = (x < 200 && y < 100) ? 0 : 255;
+    }
+  }
+  cam->setMask(mask);
+  EXPECT_TRUE(cam->isMasked(10, 10));
+  EXPECT_FALSE(cam->isMasked(200, 10));
+
+  Transformation T_C_B, T_W_B;
+  T_C_B.setRandom(0.1);
+  T_W_B.setRandom(1.0);
+  CameraRig rig({ T_C_B }, { cam }, "rig");
+
+  // Points slightly outside the image and at depths out of range.
+  const uint32_t n = 1000;
+  Keypoints px = generateRandomKeypoints(Size2u(700, 540), 0, n);
+  px.array() -= 30.0;
+  Positions p_C = cam->backProjectVectorized(px);
+  for (uint32_t i = 0; i < n; ++i)
+  {
+    p_C.col(i) *= (i % 2 == 0 ? -1.0 : 1.0) * (0.5 + 0.01 * (i % 500));
+  }
+  const Positions p_W = (T_W_B * T_C_B.inverse()).transformVectorized(p_C);
+
+  VisibilityOptions options;
+  options.min_depth = 1.0;
+  options.max_depth = 4.0;
+  options.border_margin = 10.0;
+  RigVisibility vis = computeRigVisibility(rig, T_W_B, p_W, options);
+  ASSERT_EQ(vis.size(), 1u);
+
+  uint32_t num_visible = 0u;
+  for (uint32_t i = 0; i < n; ++i)
+  {
+    const bool visible =
+        p_C(2, i) >= options.min_depth && p_C(2, i) <= options.max_depth
+        && isVisibleWithMargin(cam->size(), px.col(i), options.border_margin)
+        && (*mask)(px(0, i), px(1, i)) > 0;
+    EXPECT_EQ(visible, vis[0].isVisible(i));
+    if (visible)
+    {
+      EXPECT_TRUE(EIGEN_MATRIX_NEAR(px.col(i), vis[0].px.col(i), 1e-6));
+      ++num_visible;
+    }
+  }
+  EXPECT_GT(num_visible, 0u);
+  EXPECT_EQ(num_visible, vis[0].num_visible);
+  EXPECT_EQ(num_visible, vis[0].visibleIndices().size());
+}
+
 ZE_UNITTEST_ENTRYPOINT
@@ -25,11 +25,13 @@
 
 #include <iostream>
 #include <ze/common/test_entrypoint.hpp>
+#include <ze/cameras/camera_impl.hpp>
 #include <ze/cameras/camera_utils.hpp>
 #include <ze/cameras/camera_rig.hpp>
 #include <ze/common/test_utils.hpp>
 #include <ze/common/path_utils.hpp>
 #include <ze/common/config.hpp>
+#include <ze/common/thread_pool.hpp>
 #ifdef ZE_USE_OPENCV
 #include <opencv2/highgui/highgui.hpp>
 #endif
@@ -101,5 +103,74 @@ TEST(CameraUtilsTest, overlappingFieldOfView)
   EXPECT_NEAR(overlap1, overlap2, 0.1);
 }
 
+TEST(CameraUtilsTest, overlappingFieldOfViewMatrix)
+{
+  using namespace ze;
+
+  Camera::Ptr cam = std::make_shared<PinholeCamera>(
+        createPinholeCamera(640, 480, 329.11, 329.11, 320.0, 240.0));
+  Camera::Ptr cam_other = std::make_shared<PinholeCamera>(
+        createPinholeCamera(640, 480, 300.0, 300.0, 320.0, 240.0));
+  EXPECT_NE(calibrationHash(*cam), calibrationHash(*cam_other));
+  EXPECT_EQ(cameraFieldOfView(*cam).get(), cameraFieldOfView(*cam).get());
+
+  // Cameras rotated about the y-axis, the last one looks backwards.
+  TransformationVector T_C_B;
+  for (real_t angle : { 0.0, 0.2, 1.0, M_PI })
+  {
+    T_C_B.push_back(Transformation(Quaternion(Vector3(0.0, angle, 0.0)),
+                                   Vector3(angle, 0.0, 0.0)));
+  }
+  CameraRig rig(T_C_B, { cam, cam_other, cam, cam }, "rig", 1.1, 0.0);
+
+  clearFieldOfViewCache();
+  ThreadPool pool(2);
+  const MatrixX overlaps = overlappingFieldOfViewMatrix(rig, &pool);
+  ASSERT_EQ(overlaps.rows(), 4);
+  ASSERT_EQ(overlaps.cols(), 4);
+  EXPECT_GT(overlaps(0, 1), 0.5);
+  EXPECT_LT(overlaps(0, 1), 1.0);
+  EXPECT_EQ(overlaps(0, 3), 0.0);
+  EXPECT_EQ(overlaps(3, 0), 0.0);
+
+  // Cached and uncached results agree with the pairwise computation.
+  EXPECT_TRUE(EIGEN_MATRIX_EQUAL(overlaps, overlappingFieldOfViewMatrix(rig)));
+  clearFieldOfViewCache();
+  for (uint32_t a = 0u; a < rig.size(); ++a)
+  {
+    for (uint32_t b = 0u; b < rig.size(); ++b)
+    {
+      if (a != b)
+      {
+        EXPECT_EQ(overlaps(a, b), overlappingFieldOfView(rig, a, b));
+      }
+    }
+  }
+}
+
+TEST(CameraUtilsTest, fieldOfViewCacheIsBounded)
+{
+  using namespace ze;
+
+  clearFieldOfViewCache();
+  PinholeCamera cam = createPinholeCamera(640, 480, 329.11, 329.11, 320.0, 240.0);
+  std::shared_ptr<const CameraFieldOfView> fov = cameraFieldOfView(cam);
+  EXPECT_EQ(fov.get(), cameraFieldOfView(cam).get());
+
+  // Many other calibrations evict the cached result, which is then recomputed.
+  for (int i = 1; i <= 100; ++i)
+  {
+    PinholeCamera other =
+        createPinholeCamera(640, 480, 329.11 + i, 329.11 + i, 320.0, 240.0);
+    std::shared_ptr<const CameraFieldOfView> fov_other = cameraFieldOfView(other);
+    EXPECT_NE(fov_other.get(), fov.get());
+    EXPECT_LT(fov_other->half_angle, fov->half_angle);
+  }
+  std::shared_ptr<const CameraFieldOfView> fov_recomputed = cameraFieldOfView(cam);
+  EXPECT_NE(fov_recomputed.get(), fov.get());
+  EXPECT_TRUE(EIGEN_MATRIX_EQUAL(fov_recomputed->f, fov->f));
+  EXPECT_EQ(fov_recomputed->half_angle, fov->half_angle);
+}
+
 ZE_UNITTEST_ENTRYPOINT
 
@@ -5,3 +5,4 @@ option(ZE_USE_GTSAM "Compile with GTSAM" ON)
 option(ZE_USE_ARRAYFIRE "Compile ArrayFire and IMP wrapper" OFF)
 option(ZE_DETERMINISTIC "Use deterministic random numbers" ON)
 option(ZE_VIO_LIMITED "Limited functionality in VIO" OFF)
+option(ZE_USE_AVX2 "Compile with AVX2, FMA and F16C instructions (x86 only)" OFF)
@@ -22,6 +22,9 @@ if(DEFINED ENV{ARM_ARCHITECTURE})
   add_definitions(-DHAVE_FAST_NEON)
 else()
   set(CMAKE_CXX_FLAGS "${CMAKE_CXX_FLAGS} -mmmx -msse -msse -msse2 -msse3 -mssse3")
+  if(ZE_USE_AVX2)
+    set(CMAKE_CXX_FLAGS "${CMAKE_CXX_FLAGS} -mavx2 -mfma -mf16c")
+  endif()
 endif()
 
 # c++11
@@ -25,6 +25,8 @@
 
 #pragma once
 
+#include <memory>
+#include <random>
 #include <ze/common/random.hpp>
 #include <ze/common/types.hpp>
 #include <ze/common/macros.hpp>
@@ -54,11 +56,26 @@ public:
     for (size_t i = 0; i < DIM; ++i)
     {
       // The gaussian takes a standard deviation as input.
-      noise(i) = sampleNormalDistribution<real_t>(deterministic_, 0.0, sigma_(i));
+      if (generator_)
+      {
+        noise(i) = std::normal_distribution<real_t>(0.0, sigma_(i))(*generator_);
+      }
+      else
+      {
+        noise(i) = sampleNormalDistribution<real_t>(deterministic_, 0.0, sigma_(i));
+      }
     }
     return noise;
   }
 
+  //! Draw the samples from an own generator seeded with seed instead of the
+  //! generator shared by all samplers. The samples are then reproducible,
+  //! independent of the random numbers drawn elsewhere in the process.
+  void setSeed(uint32_t seed)
+  {
+    generator_.reset(new std::mt19937(seed));
+  }
+
   static Ptr sigmas(const sigma_vector_t& sigmas, bool deterministic = false)
   {
     Ptr noise(new RandomVectorSampler(deterministic));
@@ -81,6 +98,7 @@ protected:
 private:
   const bool deterministic_;
   sigma_vector_t sigma_;
+  std::unique_ptr<std::mt19937> generator_;
 };
 
 //------------------------------------------------------------------------------
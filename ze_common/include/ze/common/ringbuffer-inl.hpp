@@ -131,16 +131,29 @@ Ringbuffer<Scalar, ValueDim, Size>::getBetweenValuesInterpolated(
     time_t stamp_from,
     time_t stamp_to)
 {
-  CHECK_GE(stamp_from, 0u);
-  CHECK_LT(stamp_from, stamp_to);
+  // Empty storage is resized to exactly the requested range.
   times_dynamic_t stamps;
   data_dynamic_t values;
+  getBetweenValuesInterpolated<Interpolator>(stamp_from, stamp_to, stamps, values);
+  return std::make_pair(stamps, values);
+}
+
+template <typename Scalar, size_t ValueDim, size_t Size>
+template <typename Interpolator>
+size_t Ringbuffer<Scalar, ValueDim, Size>::getBetweenValuesInterpolated(
+    time_t stamp_from,
+    time_t stamp_to,
+    times_dynamic_t& stamps,
+    data_dynamic_t& values)
+{
+  CHECK_GE(stamp_from, 0u);
+  CHECK_LT(stamp_from, stamp_to);
 
   std::lock_guard<std::mutex> lock(mutex_);
   if(times_.size() < 2)
   {
     LOG(WARNING) << "Buffer has less than 2 entries.";
-    return std::make_pair(stamps, values); // return empty means unsuccessful.
+    return 0u;
   }
 
   const time_t oldest_stamp = times_.front();
@@ -148,12 +161,12 @@ Ringbuffer<Scalar, ValueDim, Size>::getBetweenValuesInterpolated(
   if(stamp_from < oldest_stamp)
   {
     LOG(WARNING) << "Requests older timestamp than in buffer.";
-    return std::make_pair(stamps, values); // return empty means unsuccessful.
+    return 0u;
   }
   if(stamp_to > newest_stamp)
   {
     LOG(WARNING) << "Requests newer timestamp than in buffer.";
-    return std::make_pair(stamps, values); // return empty means unsuccessful.
+    return 0u;
   }
 
   auto it_from_before = iterator_equal_or_before(stamp_from);
@@ -165,13 +178,16 @@ Ringbuffer<Scalar, ValueDim, Size>::getBetweenValuesInterpolated(
   if(it_from_after == it_to_before)
   {
     LOG(WARNING) << "Not enough data for interpolation";
-    return std::make_pair(stamps, values); // return empty means unsuccessful.
+    return 0u;
   }
 
-  // resize containers
+  // grow containers if necessary
   size_t range = it_to_before.index() - it_from_after.index() + 3;
-  stamps.resize(range);
-  values.resize(ValueDim, range);
+  if(static_cast<size_t>(stamps.size()) < range)
+  {
+    stamps.resize(range);
+    values.resize(ValueDim, range);
+  }
 
   // first element interpolated:
   stamps(0) = stamp_from;
@@ -218,7 +234,7 @@ Ringbuffer<Scalar, ValueDim, Size>::getBetweenValuesInterpolated(
 
   values.col(range - 1) = Interpolator::interpolate(this, stamp_to, it_to_before);
 
-  return std::make_pair(stamps, values);
+  return range;
 }
 
 template <typename Scalar, size_t ValueDim, size_t Size>
@@ -199,6 +199,17 @@ public:
   TimeDataRangePair
   getBetweenValuesInterpolated(time_t stamp_from, time_t stamp_to);
 
+  /*! @brief Get Values between timestamps into caller-owned storage.
+   *
+   * Same as above, but fills the first N entries of stamps and values in
+   * place and returns N. The storage is only resized if it is too small,
+   * hence reusing it does not allocate. Returns 0 if not successful.
+   */
+  template <typename Interpolator = DefaultInterpolator>
+  size_t getBetweenValuesInterpolated(time_t stamp_from, time_t stamp_to,
+                                      times_dynamic_t& stamps,
+                                      data_dynamic_t& values);
+
   //! Get the values of the container at the given timestamps
   //! The requested timestamps are expected to be in order!
   template <typename Interpolator = DefaultInterpolator>
@@ -226,6 +237,12 @@ public:
     return times_.empty();
   }
 
+  //! Maximum number of entries, older entries are overwritten.
+  static constexpr size_t capacity()
+  {
+    return Size;
+  }
+
   //! technically does not remove but only moves the beginning of the ring
   inline void removeDataBeforeTimestamp(time_t stamp)
   {
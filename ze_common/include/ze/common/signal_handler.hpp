@@ -30,12 +30,19 @@
 namespace ze {
 
 //! RAII-style signal handler that simply clears a flag when receiving SIGHUP,
-//! SIGINT or SIGTERM.
+//! SIGINT or SIGTERM. Several handlers may be alive at the same time (e.g. one
+//! per data provider), a signal then clears all registered flags.
 class SimpleSigtermHandler : Noncopyable
 {
 public:
+  //! Maximum number of handlers alive at the same time.
+  static constexpr int c_max_num_flags = 64;
+
   SimpleSigtermHandler(volatile bool& flag);
   ~SimpleSigtermHandler();
+
+private:
+  int slot_;
 };
 
 } // namespace ze
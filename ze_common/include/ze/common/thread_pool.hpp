@@ -55,6 +55,12 @@ public:
   //! Launches the amount of specified worker threads.
   void startThreads(size_t n_threads);
 
+  //! Number of started worker threads.
+  inline size_t numThreads() const
+  {
+    return workers_.size();
+  }
+
   //! Add task to threadpool. See for example usage in unit-test.
   template<class F, class... Args>
   auto enqueue(F&& f, Args&&... args)
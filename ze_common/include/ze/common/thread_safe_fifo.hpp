@@ -193,8 +193,8 @@ private:
   bool _notFull() const;
 
   mutable Mutex mutex_;
-  ConditionVariable read_cond_;
-  ConditionVariable write_cond_;
+  mutable ConditionVariable read_cond_;
+  mutable ConditionVariable write_cond_;
 
   std::array<T, Capacity> buf_;
   unsigned tail_; // writer end
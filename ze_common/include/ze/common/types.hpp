@@ -118,6 +118,10 @@ using Seeds       = Matrix4X;
 //! Normal vector on line end-points bearings, as explained in
 //! ze_geometry/doc/line_parametrization.pdf
 using LineMeasurements = Matrix3X;
+//! Single precision containers, e.g., for the float camera batch interface.
+using Keypoints32f = Eigen::Matrix<float, 2, Eigen::Dynamic>;
+using Bearings32f  = Eigen::Matrix<float, 3, Eigen::Dynamic>;
+using Positions32f = Eigen::Matrix<float, 3, Eigen::Dynamic>;
 using KeypointLevel = int8_t;
 using KeypointType  = int8_t;
 using KeypointIndex = uint16_t;
@@ -25,9 +25,11 @@
 
 #include <ze/common/signal_handler.hpp>
 
+#include <atomic>
 #include <cstdint>
 #include <cstring>
 #include <iostream>
+#include <mutex>
 #include <signal.h>
 #include <sys/wait.h>
 #include <unistd.h>
@@ -39,12 +41,22 @@ namespace ze {
 // enforce local linkage
 namespace {
 
-volatile bool* s_simple_flag = nullptr;
+// The slots are atomic as they are read from the signal handler.
+std::atomic<volatile bool*> s_simple_flags[SimpleSigtermHandler::c_max_num_flags];
+int s_num_simple_flags = 0;
+std::mutex s_simple_flags_mutex;
 
 void handleSignalSimple(int signal)
 {
   LOG(WARNING) << "Signal handler was called with signal " << signal;
-  *s_simple_flag = false;
+  for (std::atomic<volatile bool*>& slot : s_simple_flags)
+  {
+    volatile bool* flag = slot.load();
+    if (flag)
+    {
+      *flag = false;
+    }
+  }
 }
 
 void installSignalHandlerSimple(int sig)
@@ -76,25 +88,42 @@ void clearSignalHandlerSimple(int sig)
 } // unnamed namespace
 
 SimpleSigtermHandler::SimpleSigtermHandler(volatile bool &flag)
+  : slot_(-1)
 {
-  CHECK(s_simple_flag == nullptr) << "Signal handler already installed";
-  s_simple_flag = &flag;
+  std::lock_guard<std::mutex> lock(s_simple_flags_mutex);
+  for (int i = 0; i < c_max_num_flags; ++i)
+  {
+    if (s_simple_flags[i].load() == nullptr)
+    {
+      slot_ = i;
+      break;
+    }
+  }
+  CHECK_GE(slot_, 0) << "Too many signal handlers installed";
+  s_simple_flags[slot_].store(&flag);
 
   // note: if one of the functions below throws,
-  // s_simple_flag will remain set since the destructor will not be called
+  // the flag will remain set since the destructor will not be called
   // however, an error here will lead to process termination anyway
-  installSignalHandlerSimple(SIGHUP);
-  installSignalHandlerSimple(SIGTERM);
-  installSignalHandlerSimple(SIGINT);
+  if (s_num_simple_flags++ == 0)
+  {
+    installSignalHandlerSimple(SIGHUP);
+    installSignalHandlerSimple(SIGTERM);
+    installSignalHandlerSimple(SIGINT);
+  }
 }
 
 SimpleSigtermHandler::~SimpleSigtermHandler()
 {
-  clearSignalHandlerSimple(SIGINT);
-  clearSignalHandlerSimple(SIGTERM);
-  clearSignalHandlerSimple(SIGHUP);
+  std::lock_guard<std::mutex> lock(s_simple_flags_mutex);
+  if (--s_num_simple_flags == 0)
+  {
+    clearSignalHandlerSimple(SIGINT);
+    clearSignalHandlerSimple(SIGTERM);
+    clearSignalHandlerSimple(SIGHUP);
+  }
 
-  s_simple_flag = nullptr;
+  s_simple_flags[slot_].store(nullptr);
 }
 
 } // namespace ze
@@ -41,6 +41,29 @@ TEST(RandomMatrixTests, testRandomVectorSampler)
   Vector3 sample2 = sampler2->sample();
 }
 
+TEST(RandomMatrixTests, testRandomVectorSamplerSeed)
+{
+  using namespace ze;
+
+  auto sampler = [](uint32_t seed)
+  {
+    RandomVectorSampler<3>::Ptr s = RandomVectorSampler<3>::sigmas(Vector3(1, 2, 3));
+    s->setSeed(seed);
+    return s;
+  };
+  RandomVectorSampler<3>::Ptr a = sampler(7u);
+  RandomVectorSampler<3>::Ptr b = sampler(7u);
+  RandomVectorSampler<3>::Ptr c = sampler(8u);
+  for (int i = 0; i < 10; ++i)
+  {
+    // Draws from the shared generator in between do not change the sequence.
+    sampleNormalDistribution<real_t>(true);
+    const Vector3 sample_a = a->sample();
+    EXPECT_TRUE(sample_a == b->sample());
+    EXPECT_FALSE(sample_a == c->sample());
+  }
+}
+
 TEST(RandomMatrixTests, testRandomVector)
 {
   using namespace ze;
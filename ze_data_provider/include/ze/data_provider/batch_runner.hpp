@@ -0,0 +1,149 @@
+// Copyright (c) 2015-2016, ETH Zurich, Wyss Zurich, Zurich Eye
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the ETH Zurich, Wyss Zurich, Zurich Eye nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL ETH Zurich, Wyss Zurich, Zurich Eye BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#pragma once
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <ze/common/macros.hpp>
+#include <ze/common/noncopyable.hpp>
+#include <ze/common/types.hpp>
+#include <ze/data_provider/data_provider_factory.hpp>
+
+namespace ze {
+
+// fwd
+class CameraImuSynchronizer;
+class CameraRig;
+class ThreadPool;
+
+//! A dataset to replay in a batch run.
+struct BatchSequence
+{
+  std::string name;       //!< Name of the output directory of the sequence.
+  DataProviderSpec spec;
+};
+
+//! Read-only resources shared by all pipelines of a batch run.
+class BatchResources : Noncopyable
+{
+public:
+  BatchResources(uint32_t num_decode_threads);
+
+  //! Camera rig parsed once per YAML file, shared by all pipelines.
+  std::shared_ptr<const CameraRig> cameraRig(const std::string& yaml_file);
+
+  //! Pool that decodes the images of all pipelines, nullptr if disabled.
+  inline const std::shared_ptr<ThreadPool>& decodePool() const
+  {
+    return decode_pool_;
+  }
+
+private:
+  std::mutex mutex_;
+  std::map<std::string, std::shared_ptr<const CameraRig>> rigs_;
+  std::shared_ptr<ThreadPool> decode_pool_;
+};
+
+struct BatchRunnerOptions
+{
+  //! Number of pipelines that run concurrently.
+  uint32_t num_parallel { 1u };
+
+  //! Threads of the shared decode pool, 0 decodes on the pipeline threads.
+  uint32_t num_decode_threads { 2u };
+
+  //! CPUs the pipeline workers are pinned to, worker i uses set
+  //! i % cpu_sets.size(). No pinning if empty. See numaNodeCpuSets().
+  std::vector<std::vector<int>> cpu_sets;
+
+  //! Results of a sequence go to output_dir/<name>/, the summary of all
+  //! sequences to output_dir/batch_summary.csv. Nothing is written if empty.
+  std::string output_dir;
+};
+
+struct BatchSequenceResult
+{
+  std::string name;
+  uint32_t worker { 0u };
+  real_t wall_time_s { 0.0 };   //!< From provider creation to end of spin.
+  real_t spin_time_s { 0.0 };   //!< Spinning only.
+};
+
+//! Set up the consumer of a pipeline, e.g. register the synchronized callback.
+//! Called on the worker thread of the pipeline, before spinning. Results
+//! should be written to output_dir, which exists if not empty.
+using BatchPipelineSetup =
+  std::function<void (const BatchSequence& /*sequence*/,
+                      CameraImuSynchronizer& /*synchronizer*/,
+                      BatchResources& /*resources*/,
+                      const std::string& /*output_dir*/)>;
+
+//! Runs many sequences in one process. Every pipeline gets its own data
+//! provider, synchronizer and consumer and runs on one of num_parallel
+//! worker threads, while the decode pool and parsed camera rigs are shared.
+class BatchRunner : Noncopyable
+{
+public:
+  BatchRunner(const BatchRunnerOptions& options);
+
+  //! Run all sequences, blocks until all are done. Results are in the order
+  //! of the sequences.
+  std::vector<BatchSequenceResult> run(
+      const std::vector<BatchSequence>& sequences,
+      const BatchPipelineSetup& setup);
+
+  inline BatchResources& resources()
+  {
+    return resources_;
+  }
+
+private:
+  BatchSequenceResult runSequence(
+      const BatchSequence& sequence,
+      const BatchPipelineSetup& setup,
+      uint32_t worker);
+
+  void writeSummary(const std::vector<BatchSequenceResult>& results) const;
+
+  BatchRunnerOptions options_;
+  BatchResources resources_;
+};
+
+//! Parse a Linux cpu list such as "0-3,8,10-11".
+std::vector<int> parseCpuList(const std::string& cpu_list);
+
+//! CPUs of every NUMA node, read from sysfs. Empty if not available.
+std::vector<std::vector<int>> numaNodeCpuSets();
+
+//! Pin the calling thread to the given CPUs. Returns false if not supported.
+bool pinThreadToCpus(const std::vector<int>& cpus);
+
+} // namespace ze
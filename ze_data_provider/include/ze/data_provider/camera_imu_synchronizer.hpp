@@ -25,7 +25,9 @@
 
 #pragma once
 
+#include <atomic>
 #include <memory>
+#include <vector>
 #include <imp/core/image_base.hpp>
 #include <ze/common/ringbuffer.hpp>
 #include <ze/common/time_conversions.hpp>
@@ -49,6 +51,8 @@ public:
   //! Default constructor.
   CameraImuSynchronizer(DataProviderBase& data_provider);
 
+  virtual ~CameraImuSynchronizer();
+
   //! Add IMU measurement to the frame synchronizer.
   void addImuData(
       int64_t stamp,
@@ -63,6 +67,10 @@ private:
   //! IMU buffer stores all imu measurements, size of imu_count_.
   ImuBufferVector imu_buffers_;
 
+  //! Measurements inserted per IMU buffer, such that the fill statistics need
+  //! not lock the buffers. Only counted with statistics enabled.
+  std::vector<std::atomic<uint64_t>> imu_inserted_;
+
   //! Initialize the image and imu buffers
   void initBuffers();
 
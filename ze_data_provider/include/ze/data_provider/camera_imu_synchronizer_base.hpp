@@ -29,17 +29,34 @@
 #include <imp/core/image_base.hpp>
 #include <ze/common/types.hpp>
 #include <ze/common/time_conversions.hpp>
+#include <ze/data_provider/data_provider_base.hpp>
+#include <ze/data_provider/ingest_statistics.hpp>
+#include <ze/data_provider/measurement_queue.hpp>
 #include <ze/imu/imu_buffer.hpp>
 
 namespace ze {
 
-class DataProviderBase;
-
 // convenience typedefs
-using ImuStampsVector = std::vector<ImuStamps>;
-using ImuAccGyrVector = std::vector<ImuAccGyrContainer>;
+
+//! Views onto the IMU measurements of a synchronized bundle. They point into
+//! storage of the synchronizer that is overwritten by the next bundle, hence
+//! they are only valid during the SynchronizedCameraImuCallback. Use
+//! copyImuStamps() and copyImuAccGyr() to keep the measurements.
+using ImuStampsView = Eigen::Map<const ImuStamps>;
+using ImuAccGyrView = Eigen::Map<const ImuAccGyrContainer>;
+using ImuStampsVector = std::vector<ImuStampsView>;
+using ImuAccGyrVector = std::vector<ImuAccGyrView>;
+
+//! Owning copies of the IMU measurements of a bundle, one entry per IMU.
+using ImuStampsContainerVector = std::vector<ImuStamps>;
+using ImuAccGyrContainerVector = std::vector<ImuAccGyrContainer>;
+
+ImuStampsContainerVector copyImuStamps(const ImuStampsVector& imu_stamps);
+ImuAccGyrContainerVector copyImuAccGyr(const ImuAccGyrVector& imu_acc_gyr);
 
 // callback typedefs
+
+//! The images are shared, the IMU views are only valid during the call.
 using SynchronizedCameraImuCallback =
   std::function<void (const StampedImages& /*images*/,
                       const ImuStampsVector& /*imu_timestamps*/,
@@ -52,6 +69,7 @@ struct ImageBufferItem
   int64_t stamp        { -1 };
   ImageBasePtr img     { nullptr };
   int32_t camera_idx   { -1 };
+  int64_t arrival_ns   { -1 }; //!< Wall time, only set with --data_provider_stats.
   inline bool empty()
   {
     return stamp == -1;
@@ -62,16 +80,41 @@ struct ImageBufferItem
     stamp = -1;
     img.reset();
     camera_idx = -1;
+    arrival_ns = -1;
   }
 };
 using ImgBuffer = std::vector<ImageBufferItem>;
 
+// -----------------------------------------------------------------------------
+//! Reusable storage for the IMU measurements of a synchronized bundle. The
+//! IMU buffers fill the storage in place and the callback receives views onto
+//! the valid part of it. The storage only grows, hence once it is large enough
+//! for the camera and IMU rates, synchronizing a bundle does not allocate.
+struct ImuBundle
+{
+  //! Storage, one entry per IMU.
+  std::vector<ImuStamps> stamps_storage;
+  std::vector<ImuAccGyrContainer> acc_gyr_storage;
+
+  //! Views onto the valid part of the storage, passed to the callback.
+  ImuStampsVector stamps;
+  ImuAccGyrVector acc_gyr;
+
+  //! Allocate storage for num_imus IMUs with capacity measurements each.
+  void reserve(uint32_t num_imus, int capacity);
+
+  //! Point the views of IMU imu_idx to the first num_values measurements.
+  void setSize(uint32_t imu_idx, int num_values);
+};
+
 class CameraImuSynchronizerBase
 {
 public:
   //! Default constructor.
   CameraImuSynchronizerBase(DataProviderBase& data_provider);
 
+  virtual ~CameraImuSynchronizerBase() = default;
+
   void registerCameraImuCallback(const SynchronizedCameraImuCallback& callback);
 
   //! Add Image to the frame synchronizer.
@@ -80,7 +123,41 @@ public:
       const ImageBase::Ptr& img,
       uint32_t camera_idx);
 
+  //! True if the synchronizer runs on its own thread, fed by a queue.
+  inline bool decoupled() const { return queue_ != nullptr; }
+
+  //! In decoupled mode, block until all queued measurements are processed.
+  void flush();
+
+  //! Depth and drop counters of the queue, all zero if not decoupled.
+  MeasurementQueueStats queueStats() const;
+
+  //! Bundle latency, callback duration and IMU buffer fill levels. Only
+  //! collected with --data_provider_stats.
+  inline const SynchronizerStatistics& synchronizerStatistics() const
+  {
+    return sync_stats_;
+  }
+
 protected:
+  //! Register callbacks in the data provider. In decoupled mode the data
+  //! provider only enqueues and the callbacks are called from the queue.
+  void subscribeCamera(DataProviderBase& data_provider,
+                       const CameraCallback& callback);
+  void subscribeImu(DataProviderBase& data_provider,
+                    const ImuCallback& callback);
+  void subscribeGyro(DataProviderBase& data_provider,
+                     const GyroCallback& callback);
+  void subscribeAccel(DataProviderBase& data_provider,
+                      const AccelCallback& callback);
+
+  //! Stop the queue thread. Must be called by derived classes in their
+  //! destructor, as the thread calls their member functions.
+  void shutdownQueue();
+
+  //! Queue between the data provider and the synchronizer in decoupled mode.
+  std::unique_ptr<MeasurementQueue> queue_;
+
   //! Allowed time differences of images in bundle.
   static constexpr real_t c_camera_bundle_time_accuracy_ns = millisecToNanosec(2.0);
 
@@ -108,6 +185,20 @@ protected:
       const int64_t& max_stamp,
       const std::vector<std::tuple<int64_t, int64_t, bool>>& oldest_newest_stamp_vector);
 
+  //! Call the callback with the ready image bundle and imu_bundle_, then
+  //! release the images of the bundle from the image buffer.
+  void processCallbackAndResetBuffer();
+
+  //! Expected number of IMU measurements per bundle derived from the
+  //! configured camera and IMU rates, used to size imu_bundle_.
+  static int imuBundleCapacity();
+
+  //! Oldest and newest stamp of every IMU buffer, reused for every bundle.
+  std::vector<std::tuple<int64_t, int64_t, bool>> imu_oldest_newest_stamps_;
+
+  //! IMU measurements of the bundle that is ready to process.
+  ImuBundle imu_bundle_;
+
   //! Max time difference of images in a bundle
   int64_t img_bundle_max_dt_nsec_ = millisecToNanosec(2.0);
 
@@ -116,6 +207,24 @@ protected:
 
   //! Registered callback for synchronized measurements.
   SynchronizedCameraImuCallback cam_imu_callback_;
+
+  //! Record the fill level of an IMU buffer, called once per bundle.
+  inline void recordImuBufferFill(uint32_t imu_idx, size_t size, size_t capacity)
+  {
+    if (stats_enabled_ && imu_idx < sync_stats_.imu_fill.size())
+    {
+      sync_stats_.imu_fill[imu_idx].record(size, capacity);
+    }
+  }
+
+  const bool stats_enabled_;
+  SynchronizerStatistics sync_stats_;
+
+  //! Arrival of the last image of the bundle that is ready to process.
+  int64_t sync_imgs_ready_arrival_ns_ { -1 };
+
+  //! Next time the statistics are logged, see --data_provider_stats_dump_period_s.
+  int64_t next_stats_dump_ns_ { -1 };
 };
 
 } // namespace ze
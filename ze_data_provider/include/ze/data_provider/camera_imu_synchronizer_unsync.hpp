@@ -25,7 +25,9 @@
 
 #pragma once
 
+#include <atomic>
 #include <memory>
+#include <vector>
 #include <imp/core/image_base.hpp>
 #include <ze/common/time_conversions.hpp>
 #include <ze/common/types.hpp>
@@ -52,6 +54,8 @@ public:
   CameraImuSynchronizerUnsync(DataProviderBase& data_provider,
                               const std::vector<ImuModel::Ptr>& imu_models);
 
+  virtual ~CameraImuSynchronizerUnsync();
+
   //! Add a Gyroscope measurement to the frame synchronizer.
   void addGyroData(
       int64_t stamp,
@@ -68,6 +72,12 @@ private:
   //! IMU buffer stores all imu measurements, size of imu_count_.
   ImuBufferVector imu_buffers_;
 
+  //! Accelerometer and gyroscope measurements inserted per IMU buffer, such
+  //! that the fill statistics need not lock the buffers. Only counted with
+  //! statistics enabled.
+  std::vector<std::atomic<uint64_t>> acc_inserted_;
+  std::vector<std::atomic<uint64_t>> gyr_inserted_;
+
   //! Register callbacks in data provider to this class' addImgData, addGyroData
   //! and addAccelData.
   void subscribeDataProvider(DataProviderBase& data_provider);
@@ -33,6 +33,7 @@
 #include <ze/common/noncopyable.hpp>
 #include <ze/common/signal_handler.hpp>
 #include <ze/common/types.hpp>
+#include <ze/data_provider/ingest_statistics.hpp>
 
 // fwd
 namespace cv {
@@ -43,6 +44,7 @@ namespace ze {
 
 // fwd
 class ImageBase;
+class ThreadPool;
 
 using ImuCallback =
   std::function<void (int64_t /*timestamp*/,
@@ -67,7 +69,9 @@ using CameraCallback =
 enum class DataProviderType {
   Csv,
   Rosbag,
-  Rostopic
+  Rostopic,
+  Sim,
+  Recording
 };
 
 //! A data provider registers to a data source and triggers callbacks when
@@ -114,6 +118,22 @@ public:
   //! Register callback function to call when new Accelerometer message is available.
   void registerAccelCallback(const AccelCallback& accel_callback);
 
+  //! Decode images on a pool shared with other data providers, if supported.
+  //! The default implementation decodes on the spinning thread.
+  virtual void setDecodePool(const std::shared_ptr<ThreadPool>& /*pool*/) {}
+
+  //! Per-stream rates, inter-arrival times and callback durations. Only
+  //! collected with --data_provider_stats for callbacks registered afterwards.
+  inline const IngestStatistics& ingestStatistics() const
+  {
+    return ingest_stats_;
+  }
+
+  inline void resetIngestStatistics()
+  {
+    ingest_stats_.reset();
+  }
+
 protected:
   DataProviderType type_;
   ImuCallback imu_callback_;
@@ -121,6 +141,7 @@ protected:
   GyroCallback gyro_callback_;
   AccelCallback accel_callback_;
   volatile bool running_ = true;
+  IngestStatistics ingest_stats_;
 
 private:
   SimpleSigtermHandler signal_handler_; //!< Sets running_ to false when Ctrl-C is pressed.
@@ -25,6 +25,8 @@
 
 #pragma once
 
+#include <deque>
+#include <future>
 #include <map>
 #include <memory>
 #include <string>
@@ -40,6 +42,7 @@ namespace ze {
 //fwd
 namespace internal {
 struct MeasurementBase;
+struct CsvIndex;
 }
 
 class DataProviderCsv : public DataProviderBase
@@ -70,16 +73,57 @@ public:
     return buffer_.size();
   }
 
+  //! Reload only the measurements whose playback stamp is in
+  //! [start_ns, stop_ns]. For a bounded window, uses the offset index of each
+  //! data.csv to start reading close to start_ns. The index is built on first
+  //! use and cached in data_source_csv_index_dir.
+  void setTimeWindow(int64_t start_ns, int64_t stop_ns);
+
+  //! Continue playback at the first measurement with playback stamp
+  //! >= stamp_ns. Reloads the data if the stamp is before the loaded window,
+  //! past its stop playback ends and the stop is kept.
+  void seek(int64_t stamp_ns);
+
+  //! Decode the next c_num_prefetched_images images on the pool.
+  virtual void setDecodePool(const std::shared_ptr<ThreadPool>& pool) override;
+
+  //! Earliest playback stamp of all files, -1 if they are empty.
+  inline int64_t beginStamp() const
+  {
+    return begin_stamp_;
+  }
+
 private:
   void loadImuData(
       const std::string data_dir,
       const size_t imu_index,
-      const int64_t playback_delay);
+      const int64_t playback_delay,
+      const int64_t start_ns,
+      const int64_t stop_ns);
 
   void loadCameraData(
       const std::string& data_dir,
       const size_t camera_index,
-      int64_t playback_delay);
+      int64_t playback_delay,
+      const int64_t start_ns,
+      const int64_t stop_ns);
+
+  //! Get the offset index of the data.csv file in data_dir, build it if needed.
+  const internal::CsvIndex& csvIndex(
+      const std::string& data_dir,
+      const std::string& header);
+
+  //! Offset index to load [start_ns, stop_ns], nullptr for the full file.
+  const internal::CsvIndex* windowIndex(
+      const std::string& data_dir,
+      const std::string& header,
+      int64_t start_ns,
+      int64_t stop_ns);
+
+  //! Get the decoded image of buffer_it_ and enqueue the next decodes.
+  std::shared_ptr<ImageBase> prefetchedImage();
+
+  std::string csv_directory_;
 
   //! Buffer to chronologically sort the data.
   DataBuffer buffer_;
@@ -91,6 +135,22 @@ private:
   std::map<std::string, size_t> camera_topics_;
 
   size_t imu_count_ = 0u;
+
+  //! Sparse offset index of every loaded data.csv file.
+  std::map<std::string, std::shared_ptr<internal::CsvIndex>> csv_indices_;
+  int64_t begin_stamp_ = -1;
+
+  //! Images decoded ahead of playback on the shared pool.
+  static constexpr size_t c_num_prefetched_images = 8u;
+  std::shared_ptr<ThreadPool> decode_pool_;
+  using PrefetchedImage = std::pair<DataBuffer::const_iterator,
+                                    std::future<std::shared_ptr<ImageBase>>>;
+  std::deque<PrefetchedImage> prefetched_;
+  DataBuffer::const_iterator prefetch_it_;
+
+  //! Currently loaded window of playback stamps.
+  int64_t window_start_ns_;
+  int64_t window_stop_ns_;
 };
 
 } // namespace ze
@@ -25,6 +25,9 @@
 
 #pragma once
 
+#include <map>
+#include <string>
+
 #include <gflags/gflags.h>
 #include <ze/data_provider/data_provider_base.hpp>
 
@@ -32,6 +35,26 @@ DECLARE_uint64(num_imus);
 
 namespace ze {
 
+//! Everything needed to create a data provider, mirrors the gflags below.
+struct DataProviderSpec
+{
+  int32_t data_source { 1 };  //!< 0: CSV, 1: Rosbag, 2: Rostopic, 3: Simulation, 4: Recording
+  std::string bag_filename;   //!< Rosbag only.
+  std::string data_dir;       //!< CSV only.
+  std::string recording_filename; //!< Recording only.
+  uint32_t sim_scenario { 1u };   //!< Simulation only, see createViSimulationScenario().
+  int64_t sim_seed { 0 };         //!< Simulation only, negative for a random seed.
+  std::map<std::string, size_t> cam_topics;
+  std::map<std::string, size_t> imu_topics;
+  std::map<std::string, size_t> acc_topics; //!< Split IMU if acc and gyr are set.
+  std::map<std::string, size_t> gyr_topics;
+};
+
+//! Fill a spec from the data source and topic gflags.
+DataProviderSpec dataProviderSpecFromGflags(const std::uint32_t num_cams);
+
+DataProviderBase::Ptr loadDataProvider(const DataProviderSpec& spec);
+
 DataProviderBase::Ptr loadDataProviderFromGflags(const std::uint32_t num_cams);
 
 } // namespace ze
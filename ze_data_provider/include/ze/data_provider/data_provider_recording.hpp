@@ -0,0 +1,120 @@
+// Copyright (c) 2015-2016, ETH Zurich, Wyss Zurich, Zurich Eye
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the ETH Zurich, Wyss Zurich, Zurich Eye nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL ETH Zurich, Wyss Zurich, Zurich Eye BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#pragma once
+
+#include <future>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <ze/common/macros.hpp>
+#include <ze/common/types.hpp>
+#include <ze/data_provider/data_provider_base.hpp>
+#include <ze/data_provider/recording_file.hpp>
+
+namespace ze {
+
+//! Replays a file written by the Recorder. Camera and IMU chunks are read
+//! side by side and their measurements replayed in stamp order, each stream
+//! in recording order. Images are decoded into buffers of the global ImagePool.
+class DataProviderRecording : public DataProviderBase
+{
+public:
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+  explicit DataProviderRecording(const std::string& filename);
+
+  virtual ~DataProviderRecording() = default;
+
+  virtual bool spinOnce() override;
+
+  virtual bool ok() const override;
+
+  virtual size_t imuCount() const override;
+
+  virtual size_t cameraCount() const override;
+
+  //! Read and decompress the next chunk on the pool while the current one
+  //! is replayed.
+  virtual void setDecodePool(const std::shared_ptr<ThreadPool>& pool) override;
+
+  //! Continue playback at the first measurement with stamp >= stamp_ns.
+  void seek(int64_t stamp_ns);
+
+  //! Earliest measurement stamp of the recording.
+  int64_t beginStamp() const;
+
+  inline const RecordingReader& reader() const
+  {
+    return *reader_;
+  }
+
+private:
+  //! Position in the chunks of either camera or IMU measurements.
+  struct Cursor
+  {
+    bool imu_chunks = false;
+
+    //! Payload of the chunk that is replayed and the offset of the next record.
+    std::vector<uint8_t> payload;
+    size_t offset = 0u;
+    size_t next_chunk = 0u;
+
+    //! Next record in the window, valid until the next chunk is loaded.
+    RecordView record;
+    bool has_record = false;
+    bool finished = false;
+
+    size_t prefetched_chunk = 0u;
+    std::future<std::vector<uint8_t>> prefetched;
+  };
+
+  //! Parse the next record of the cursor in [start_ns_, stop_ns_], false if
+  //! the stream is finished.
+  bool peek(Cursor& cursor);
+
+  //! Load the payload of cursor.next_chunk, false if there is none.
+  bool loadNextChunk(Cursor& cursor);
+
+  //! First chunk of the cursor's stream from \a chunk on with measurements
+  //! in [start_ns_, stop_ns_].
+  size_t nextChunkInWindow(const Cursor& cursor, size_t chunk) const;
+
+  void resetCursor(Cursor& cursor);
+
+  std::shared_ptr<const RecordingReader> reader_;
+
+  Cursor camera_cursor_;
+  Cursor imu_cursor_;
+
+  //! Measurements outside of [start_ns_, stop_ns_] are skipped.
+  int64_t start_ns_;
+  int64_t stop_ns_;
+  bool finished_ = false;
+
+  std::shared_ptr<ThreadPool> decode_pool_;
+};
+
+} // namespace ze
@@ -25,9 +25,11 @@
 
 #pragma once
 
+#include <atomic>
 #include <map>
 #include <string>
 #include <memory>
+#include <thread>
 #include <vector>
 
 #include <rosbag/bag.h>
@@ -38,6 +40,7 @@
 #include <ze_ros_msg/bmx055_acc.h>
 #include <ze_ros_msg/bmx055_gyr.h>
 
+#include <ze/common/thread_safe_fifo.hpp>
 #include <ze/data_provider/data_provider_base.hpp>
 
 namespace ze {
@@ -58,7 +61,7 @@ public:
       const std::map<std::string, size_t>& accel_topics,
       const std::map<std::string, size_t>& camera_topics);
 
-  virtual ~DataProviderRosbag() = default;
+  virtual ~DataProviderRosbag();
 
   virtual bool spinOnce() override;
 
@@ -71,17 +74,36 @@ public:
   size_t size() const;
 
 private:
+  //! A deserialized and converted bag message, ready to be dispatched.
+  struct DecodedMessage
+  {
+    enum class Type { Unknown, Camera, Imu, Accel, Gyro, EndOfBag };
+    Type type { Type::Unknown };
+    int64_t stamp { -1 };
+    size_t idx { 0u };
+    Vector3 acc;
+    Vector3 gyr;
+    std::shared_ptr<ImageBase> img;
+  };
+
+  //! Capacity of the read-ahead queue.
+  static constexpr unsigned c_read_ahead_queue_size = 64u;
+  using ReadAheadQueue = ThreadSafeFifo<DecodedMessage, c_read_ahead_queue_size>;
+
   void loadRosbag(const std::string& bag_filename);
   void initBagView(const std::vector<std::string>& topics);
 
-  inline bool cameraSpin(const sensor_msgs::ImageConstPtr m_img,
-                         const rosbag::MessageInstance& m);
-  inline bool imuSpin(const sensor_msgs::ImuConstPtr m_imu,
-                      const rosbag::MessageInstance& m);
-  inline bool accelSpin(const ze_ros_msg::bmx055_accConstPtr m_acc,
-                        const rosbag::MessageInstance& m);
-  inline bool gyroSpin(const ze_ros_msg::bmx055_gyrConstPtr m_gyr,
-                       const rosbag::MessageInstance& m);
+  //! Deserialize the message and convert images. Does not call callbacks.
+  DecodedMessage decode(const rosbag::MessageInstance& m) const;
+
+  //! Call the callback of the message, false if the data provider must stop.
+  bool dispatch(const DecodedMessage& msg);
+
+  //! Read-ahead thread: decodes the messages of the view into the queue.
+  void readAhead();
+
+  //! Stop and join the read-ahead thread.
+  void stopReadAhead();
 
   std::unique_ptr<rosbag::Bag> bag_;
   std::unique_ptr<rosbag::View> bag_view_;
@@ -101,6 +123,16 @@ private:
   int64_t last_imu_stamp_ = -1;
   int64_t last_acc_stamp_ = -1;
   int64_t last_gyr_stamp_ = -1;
+
+  //! FLAGS_data_source_rosbag_read_ahead at construction.
+  const bool read_ahead_;
+
+  //! Read-ahead state, only used with read_ahead_.
+  //! The reader thread owns bag_view_it_ while it runs.
+  std::unique_ptr<ReadAheadQueue> read_ahead_queue_;
+  std::thread read_ahead_thread_;
+  std::atomic<bool> read_ahead_stop_ { false };
+  bool end_of_bag_ = false;
 };
 
 } // namespace ze
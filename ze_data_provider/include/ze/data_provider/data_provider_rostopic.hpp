@@ -73,6 +73,7 @@ public:
 
   virtual size_t cameraCount() const;
 
+  //! Copies the image, as the message may be shared with other subscribers.
   void imgCallback(
       const sensor_msgs::ImageConstPtr& m_img,
       uint32_t cam_idx);
@@ -0,0 +1,130 @@
+// Copyright (c) 2015-2016, ETH Zurich, Wyss Zurich, Zurich Eye
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the ETH Zurich, Wyss Zurich, Zurich Eye nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL ETH Zurich, Wyss Zurich, Zurich Eye BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#pragma once
+
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include <ze/common/macros.hpp>
+#include <ze/common/types.hpp>
+#include <ze/data_provider/data_provider_base.hpp>
+#include <ze/vi_simulation/camera_simulator_types.hpp>
+#include <ze/vi_simulation/vi_simulator.hpp>
+
+namespace ze {
+
+using FeatureTrackCallback =
+  std::function<void (int64_t /*timestamp*/,
+                      const CameraMeasurements& /*tracks*/,
+                      uint32_t /*camera-idx*/)>;
+
+struct DataProviderSimOptions
+{
+  //! Number of frames simulated and kept in memory before the first spin.
+  //! The run then replays the buffer and the simulation cost is not part of
+  //! the measured pipeline. 0 simulates every frame on demand.
+  uint32_t num_buffered_frames { 0u };
+
+  //! Replay the buffered frames again once the buffer is exhausted. Timestamps
+  //! are shifted such that they keep increasing.
+  bool loop { false };
+
+  //! Stop after this many frames. 0 runs until the simulation ends.
+  uint64_t max_num_frames { 0u };
+
+  //! Render an 8-bit image per camera with the keypoints as bright blobs and
+  //! call the camera callback with it.
+  bool render_images { false };
+
+  //! Playback speed relative to the simulated time. 0 runs as fast as possible.
+  real_t real_time_factor { 0.0 };
+};
+
+//! Data provider that emits measurements of a ViSimulator without any disk I/O.
+//! Each spin publishes the IMU measurements up to the next camera frame and
+//! then the feature tracks (and optional images) of all cameras.
+class DataProviderSim : public DataProviderBase
+{
+public:
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+  DataProviderSim(
+      const ViSimulator::Ptr& simulator,
+      const DataProviderSimOptions& options = DataProviderSimOptions());
+
+  virtual ~DataProviderSim() = default;
+
+  virtual bool spinOnce() override;
+
+  virtual bool ok() const override;
+
+  virtual size_t imuCount() const override;
+
+  virtual size_t cameraCount() const override;
+
+  //! Register callback function to call when new feature tracks are available.
+  void registerFeatureTrackCallback(const FeatureTrackCallback& callback);
+
+  //! Number of frames published so far.
+  inline uint64_t numFrames() const
+  {
+    return num_frames_;
+  }
+
+private:
+  //! Get the next frame, either from the simulator or from the buffer.
+  bool nextFrame(ViSensorData& data);
+
+  void publish(const ViSensorData& data);
+
+  std::shared_ptr<ImageBase> renderImage(
+      const CameraMeasurements& measurements, uint32_t cam_idx) const;
+
+  void waitUntil(int64_t stamp);
+
+  ViSimulator::Ptr simulator_;
+  DataProviderSimOptions options_;
+  FeatureTrackCallback feature_track_callback_;
+
+  //! Buffered frames and the index of the next one to publish.
+  std::vector<ViSensorData, Eigen::aligned_allocator<ViSensorData>> buffer_;
+  size_t buffer_idx_ = 0u;
+
+  //! Added to all buffered stamps in the current loop.
+  int64_t stamp_offset_ = 0;
+
+  bool finished_ = false;
+  uint64_t num_frames_ = 0u;
+  int64_t last_imu_stamp_ = -1;
+
+  //! Wall clock and stamp of the first frame, for real-time playback.
+  std::chrono::steady_clock::time_point wall_start_;
+  int64_t first_stamp_ = -1;
+};
+
+} // namespace ze
@@ -0,0 +1,257 @@
+// Copyright (c) 2015-2016, ETH Zurich, Wyss Zurich, Zurich Eye
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the ETH Zurich, Wyss Zurich, Zurich Eye nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL ETH Zurich, Wyss Zurich, Zurich Eye BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+#include <ze/common/noncopyable.hpp>
+#include <ze/common/types.hpp>
+
+namespace ze {
+
+//! Monotonic wall clock in nanoseconds, used for all ingest statistics.
+inline int64_t ingestClockNs()
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// -----------------------------------------------------------------------------
+//! Histogram of durations with power-of-two bins: bin i counts the samples in
+//! [2^i, 2^(i+1)) nanoseconds. Only uses relaxed atomics, hence samples can be
+//! added from the callback path while other threads read the histogram.
+class DurationHistogram : Noncopyable
+{
+public:
+  static constexpr int c_num_bins = 40; //!< Last bin collects everything >9min.
+
+  DurationHistogram() { reset(); }
+
+  inline void addSample(int64_t duration_ns)
+  {
+    int bin = 0;
+    for (int64_t d = duration_ns; d > 1 && bin < c_num_bins - 1; d >>= 1)
+    {
+      ++bin;
+    }
+    bins_[bin].fetch_add(1u, std::memory_order_relaxed);
+    count_.fetch_add(1u, std::memory_order_relaxed);
+    sum_ns_.fetch_add(duration_ns, std::memory_order_relaxed);
+    int64_t max = max_ns_.load(std::memory_order_relaxed);
+    while (duration_ns > max
+           && !max_ns_.compare_exchange_weak(max, duration_ns,
+                                             std::memory_order_relaxed))
+    {}
+  }
+
+  inline uint64_t count() const
+  {
+    return count_.load(std::memory_order_relaxed);
+  }
+
+  inline uint64_t binCount(int bin) const
+  {
+    return bins_[bin].load(std::memory_order_relaxed);
+  }
+
+  real_t meanMs() const;
+
+  real_t maxMs() const;
+
+  //! Upper bound of the bin that contains the quantile q in [0, 1].
+  real_t quantileMs(real_t q) const;
+
+  void reset();
+
+private:
+  std::array<std::atomic<uint64_t>, c_num_bins> bins_;
+  std::atomic<uint64_t> count_;
+  std::atomic<int64_t> sum_ns_;
+  std::atomic<int64_t> max_ns_;
+};
+
+std::ostream& operator<<(std::ostream& out, const DurationHistogram& hist);
+
+// -----------------------------------------------------------------------------
+//! Arrival and callback statistics of a single input stream.
+class StreamStatistics : Noncopyable
+{
+public:
+  StreamStatistics() { reset(); }
+
+  //! Record the arrival of a message, before its callback is called.
+  inline void addArrival(int64_t now_ns)
+  {
+    const int64_t last = last_arrival_ns_.exchange(now_ns, std::memory_order_relaxed);
+    if (last < 0)
+    {
+      first_arrival_ns_.store(now_ns, std::memory_order_relaxed);
+    }
+    else
+    {
+      inter_arrival.addSample(now_ns - last);
+    }
+    num_messages_.fetch_add(1u, std::memory_order_relaxed);
+  }
+
+  inline uint64_t numMessages() const
+  {
+    return num_messages_.load(std::memory_order_relaxed);
+  }
+
+  //! Average message rate between the first and the last arrival.
+  real_t rateHz() const;
+
+  void reset();
+
+  //! Wall time between consecutive messages.
+  DurationHistogram inter_arrival;
+
+  //! Execution time of the registered callback.
+  DurationHistogram callback_duration;
+
+private:
+  std::atomic<uint64_t> num_messages_;
+  std::atomic<int64_t> first_arrival_ns_;
+  std::atomic<int64_t> last_arrival_ns_;
+};
+
+std::ostream& operator<<(std::ostream& out, const StreamStatistics& stats);
+
+//! Records the arrival of a message on construction and the callback duration
+//! on destruction. Does nothing for a nullptr.
+class StreamCallbackScope : Noncopyable
+{
+public:
+  explicit StreamCallbackScope(StreamStatistics* stats)
+    : stats_(stats)
+    , start_ns_(stats ? ingestClockNs() : 0)
+  {
+    if (stats_)
+    {
+      stats_->addArrival(start_ns_);
+    }
+  }
+
+  ~StreamCallbackScope()
+  {
+    if (stats_)
+    {
+      stats_->callback_duration.addSample(ingestClockNs() - start_ns_);
+    }
+  }
+
+private:
+  StreamStatistics* stats_;
+  const int64_t start_ns_;
+};
+
+// -----------------------------------------------------------------------------
+enum class IngestStreamType { Imu, Camera, Gyro, Accel };
+
+//! Statistics of all input streams of a data provider, one per sensor type
+//! and index.
+class IngestStatistics : Noncopyable
+{
+public:
+  static constexpr uint32_t c_max_streams_per_type = 8u;
+
+  //! nullptr if the index exceeds c_max_streams_per_type.
+  inline StreamStatistics* stream(IngestStreamType type, uint32_t idx)
+  {
+    return idx < c_max_streams_per_type
+        ? &streams_[static_cast<size_t>(type)][idx] : nullptr;
+  }
+
+  inline const StreamStatistics* stream(IngestStreamType type, uint32_t idx) const
+  {
+    return idx < c_max_streams_per_type
+        ? &streams_[static_cast<size_t>(type)][idx] : nullptr;
+  }
+
+  void reset();
+
+private:
+  std::array<std::array<StreamStatistics, c_max_streams_per_type>, 4> streams_;
+};
+
+//! Prints all streams that received messages.
+std::ostream& operator<<(std::ostream& out, const IngestStatistics& stats);
+
+// -----------------------------------------------------------------------------
+//! Number of measurements in an IMU buffer, last and highest seen value.
+class FillLevel : Noncopyable
+{
+public:
+  FillLevel() { reset(); }
+
+  inline void record(uint32_t size, uint32_t capacity)
+  {
+    capacity_.store(capacity, std::memory_order_relaxed);
+    last_.store(size, std::memory_order_relaxed);
+    uint32_t max = max_.load(std::memory_order_relaxed);
+    while (size > max
+           && !max_.compare_exchange_weak(max, size, std::memory_order_relaxed))
+    {}
+  }
+
+  inline uint32_t last() const { return last_.load(std::memory_order_relaxed); }
+  inline uint32_t max() const { return max_.load(std::memory_order_relaxed); }
+  inline uint32_t capacity() const { return capacity_.load(std::memory_order_relaxed); }
+
+  void reset();
+
+private:
+  std::atomic<uint32_t> last_;
+  std::atomic<uint32_t> max_;
+  std::atomic<uint32_t> capacity_;
+};
+
+//! Statistics of a camera-IMU synchronizer.
+class SynchronizerStatistics : Noncopyable
+{
+public:
+  //! Wall time from the arrival of the last image of a bundle to the
+  //! synchronized callback firing.
+  DurationHistogram bundle_latency;
+
+  //! Execution time of the synchronized callback.
+  DurationHistogram callback_duration;
+
+  //! Fill level of every IMU buffer, sampled once per bundle.
+  std::array<FillLevel, IngestStatistics::c_max_streams_per_type> imu_fill;
+
+  void reset();
+};
+
+std::ostream& operator<<(std::ostream& out, const SynchronizerStatistics& stats);
+
+} // namespace ze
@@ -0,0 +1,131 @@
+// Copyright (c) 2015-2016, ETH Zurich, Wyss Zurich, Zurich Eye
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the ETH Zurich, Wyss Zurich, Zurich Eye nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL ETH Zurich, Wyss Zurich, Zurich Eye BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <ze/common/noncopyable.hpp>
+#include <ze/common/types.hpp>
+#include <ze/data_provider/data_provider_base.hpp>
+
+namespace ze {
+
+//! What to do when a measurement arrives and the queue is full.
+enum class QueueOverflowPolicy {
+  Block,          //!< Block the data provider until there is space.
+  DropOldest,     //!< Drop the oldest queued measurement.
+  CoalesceImages  //!< Replace the oldest queued image of the same camera,
+                  //!< block if there is none or for IMU measurements.
+};
+
+//! Snapshot of the queue counters.
+struct MeasurementQueueStats
+{
+  size_t depth { 0u };           //!< Currently queued measurements.
+  size_t max_depth { 0u };       //!< Highest depth observed so far.
+  uint64_t num_enqueued { 0u };  //!< Measurements received from the provider.
+  uint64_t num_dropped { 0u };   //!< Measurements dropped (DropOldest).
+  uint64_t num_coalesced { 0u }; //!< Images replaced by newer ones (CoalesceImages).
+};
+
+//! Bounded queue that decouples the data provider thread from the consumer.
+//! The wrapped callbacks enqueue the measurements on the calling thread and
+//! a worker thread owned by the queue dispatches them in order to the
+//! original callbacks.
+class MeasurementQueue : Noncopyable
+{
+public:
+  MeasurementQueue(size_t capacity, QueueOverflowPolicy policy);
+  ~MeasurementQueue();
+
+  //! Return callbacks that enqueue the measurement; the given callback is
+  //! then called on the worker thread.
+  ImuCallback wrapImuCallback(const ImuCallback& callback);
+  GyroCallback wrapGyroCallback(const GyroCallback& callback);
+  AccelCallback wrapAccelCallback(const AccelCallback& callback);
+  CameraCallback wrapCameraCallback(const CameraCallback& callback);
+
+  //! Block until all queued measurements are processed.
+  void flush();
+
+  //! Stop the worker thread, measurements still in the queue are discarded.
+  void shutdown();
+
+  MeasurementQueueStats stats() const;
+
+private:
+  enum class MeasurementType { Imu, Gyro, Accel, Camera };
+
+  struct Measurement
+  {
+    MeasurementType type { MeasurementType::Imu };
+    int64_t stamp { -1 };
+    Vector3 acc;
+    Vector3 gyr;
+    std::shared_ptr<ImageBase> img;
+    uint32_t idx { 0u };
+  };
+
+  //! Add measurement to the queue, applies the overflow policy if full.
+  void push(Measurement&& measurement);
+
+  //! Index of the oldest queued image of camera cam_idx, -1 if there is none.
+  int findQueuedImage(uint32_t cam_idx) const;
+
+  //! Remove the i-th oldest element of the queue.
+  void erase(size_t i);
+
+  //! Worker thread loop.
+  void process();
+
+  // Callbacks called from the worker thread.
+  ImuCallback imu_callback_;
+  GyroCallback gyro_callback_;
+  AccelCallback accel_callback_;
+  CameraCallback camera_callback_;
+
+  // Fixed size ring buffer, such that queuing does not allocate.
+  std::vector<Measurement> buffer_;
+  size_t head_ { 0u };
+  size_t size_ { 0u };
+  QueueOverflowPolicy policy_;
+
+  MeasurementQueueStats stats_;
+  bool processing_ { false };
+  bool running_ { true };
+
+  mutable std::mutex mutex_;
+  std::condition_variable not_empty_;
+  std::condition_variable not_full_;
+  std::condition_variable idle_;
+  std::thread worker_;
+};
+
+} // namespace ze
@@ -0,0 +1,233 @@
+// Copyright (c) 2015-2016, ETH Zurich, Wyss Zurich, Zurich Eye
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the ETH Zurich, Wyss Zurich, Zurich Eye nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL ETH Zurich, Wyss Zurich, Zurich Eye BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <ze/common/noncopyable.hpp>
+#include <ze/common/thread_pool.hpp>
+#include <ze/common/types.hpp>
+#include <ze/data_provider/camera_imu_synchronizer_base.hpp>
+#include <ze/data_provider/data_provider_base.hpp>
+#include <ze/data_provider/recording_file.hpp>
+
+namespace ze {
+
+//! Snapshot of the recorder counters.
+struct RecorderStats
+{
+  uint64_t num_images { 0u };          //!< Images added to a chunk.
+  uint64_t num_dropped_images { 0u };  //!< Images dropped, the backlog was full.
+  uint64_t num_imu { 0u };             //!< IMU, gyro and accel measurements added.
+  uint64_t num_dropped_imu { 0u };     //!< IMU measurements dropped.
+  uint64_t num_chunks { 0u };          //!< Chunks written to the file.
+  uint64_t raw_bytes { 0u };           //!< Payload of the written chunks.
+  uint64_t file_bytes { 0u };          //!< Bytes written to the file.
+  size_t pending_bytes { 0u };         //!< Payload not yet written.
+  size_t max_pending_bytes { 0u };     //!< Highest backlog observed so far.
+};
+
+/**
+ * @brief The Recorder class writes camera and IMU streams to a recording
+ *        file (see recording_file.hpp) without blocking the caller
+ *
+ * The calling thread only copies the measurement into the current chunk of
+ * its stream. Images and IMU measurements go to separate chunks with separate
+ * locks, such that an IMU measurement never waits for an image copy. Full
+ * chunks are filtered, compressed and written in order on the recorder's own
+ * threads, IMU chunks on a thread of their own.
+ *
+ * The chunks are allocated up front and recycled, the calling thread never
+ * allocates nor waits for compression. If no chunk is free or the backlog of
+ * chunks not yet written exceeds max_pending_bytes, e.g. because compression
+ * or the disk is too slow, new measurements are dropped and counted instead.
+ * Images larger than chunk_bytes get a chunk of their own, which is allocated
+ * before taking the lock.
+ *
+ * Use subscribe() to only record a data provider, or the wrap functions to
+ * record in front of other callbacks, e.g.
+ * @code
+ * Recorder recorder("session.zrec");
+ * data_provider.registerCameraCallback(recorder.wrapCameraCallback(callback));
+ * synchronizer.registerCameraImuCallback(recorder.wrapCameraImuCallback(callback));
+ * @endcode
+ * Replay the file with DataProviderRecording.
+ */
+class Recorder : Noncopyable
+{
+public:
+  struct Options
+  {
+    RecordingCodec codec = RecordingCodec::Lz4;
+    //! Zstd compression level.
+    int compression_level = 1;
+    RecordingFilter filter = RecordingFilter::None;
+    //! A chunk is compressed once its payload reaches this size.
+    size_t chunk_bytes = 4u * 1024u * 1024u;
+    //! ... or once it spans this many seconds of measurements, which bounds
+    //! the data lost on a crash for low rate streams.
+    double max_chunk_duration_s = 1.0;
+    //! Backlog of payload not yet written, beyond which measurements are dropped.
+    size_t max_pending_bytes = 256u * 1024u * 1024u;
+    //! Compression threads for images, 2 * num_threads + 2 image chunks of
+    //! chunk_bytes are allocated.
+    uint32_t num_threads = 2u;
+  };
+
+  explicit Recorder(const std::string& filename);
+  Recorder(const std::string& filename, const Options& options);
+
+  //! Calls close().
+  ~Recorder();
+
+  //! Register callbacks in the data provider that only record.
+  void subscribe(DataProviderBase& data_provider);
+
+  //! Return callbacks that record the measurement and then call the given
+  //! callback, if any.
+  ImuCallback wrapImuCallback(const ImuCallback& callback);
+  GyroCallback wrapGyroCallback(const GyroCallback& callback);
+  AccelCallback wrapAccelCallback(const AccelCallback& callback);
+  CameraCallback wrapCameraCallback(const CameraCallback& callback);
+
+  //! Records the images of a bundle with their index in the bundle as camera
+  //! index, and the IMU measurements newer than the ones already recorded.
+  SynchronizedCameraImuCallback wrapCameraImuCallback(
+      const SynchronizedCameraImuCallback& callback);
+
+  //! Record a measurement, returns false if it was dropped.
+  bool addImage(int64_t stamp, const ImageBase& img, uint32_t camera_idx);
+  bool addImu(int64_t stamp, const Vector3& acc, const Vector3& gyr, uint32_t imu_idx);
+  bool addGyro(int64_t stamp, const Vector3& gyr, uint32_t imu_idx);
+  bool addAccel(int64_t stamp, const Vector3& acc, uint32_t imu_idx);
+
+  //! Compress the current chunk and block until all chunks are written.
+  void flush();
+
+  //! Flush and write the index. Measurements added afterwards are dropped.
+  void close();
+
+  RecorderStats stats() const;
+
+  inline const Options& options() const { return options_; }
+
+private:
+  struct Chunk
+  {
+    uint64_t sequence { 0u };
+    RecordingChunkInfo info;
+    std::vector<uint8_t> payload;
+  };
+  using ChunkPtr = std::shared_ptr<Chunk>;
+
+  //! Chunks of either images or IMU measurements.
+  struct Stream
+  {
+    //! Guards current and free.
+    std::mutex mutex;
+    //! Chunk that records are appended to, nullptr until one is needed.
+    ChunkPtr current;
+    //! Preallocated chunks, reserved to their number such that returning a
+    //! chunk never allocates.
+    std::vector<ChunkPtr> free;
+    std::unique_ptr<ThreadPool> pool;
+  };
+
+  //! Allocate the chunks of a stream and start its compression threads.
+  void initStream(Stream& stream, uint32_t num_threads);
+
+  //! Reserve the backlog for a record of the given size, false if full.
+  bool reserve(size_t bytes);
+
+  bool addImuRecord(RecordType type, int64_t stamp, const Vector3& acc,
+                    const Vector3& gyr, uint32_t imu_idx);
+
+  //! Images larger than a chunk are recorded in a chunk of their own.
+  bool addLargeImage(int64_t stamp, const ImageBase& img, uint32_t camera_idx);
+
+  //! Make sure the current chunk of the stream fits a record of the given
+  //! size and stamp, false if no chunk is free. A chunk that is full is
+  //! returned in sealed. Requires stream.mutex.
+  bool prepareChunk(Stream& stream, size_t bytes, int64_t stamp, ChunkPtr* sealed);
+
+  //! Take the current chunk of the stream for compression, nullptr if there
+  //! is none. Requires stream.mutex.
+  ChunkPtr sealChunk(Stream& stream);
+
+  //! Hand a sealed chunk to the compression threads of the stream. Called
+  //! without lock since it allocates the task.
+  void enqueue(Stream& stream, const ChunkPtr& chunk);
+
+  //! Runs on the compression threads.
+  void compressAndWrite(Stream& stream, const ChunkPtr& chunk);
+
+  //! Seal the current chunks and block until all chunks are written.
+  void flushStreams();
+
+  //! Block until all chunks before the given sequence number are written.
+  void waitUntilWritten(uint64_t sequence);
+
+  Options options_;
+
+  std::atomic<bool> closed_ { false };
+  //! Sequence number of the next sealed chunk, chunks are written in this order.
+  std::atomic<uint64_t> next_sequence_ { 0u };
+
+  //! Newest recorded stamp per IMU of wrapCameraImuCallback.
+  std::vector<int64_t> last_bundle_imu_stamps_;
+
+  //! Recycled compressed buffers, only used by the compression threads.
+  std::mutex buffers_mutex_;
+  std::vector<std::vector<uint8_t>> free_buffers_;
+
+  //! Compressed chunks waiting for their predecessors, guarded by write_mutex_.
+  mutable std::mutex write_mutex_;
+  std::condition_variable written_;
+  std::map<uint64_t, std::pair<RecordingChunkInfo, std::vector<uint8_t>>> ready_;
+  uint64_t next_write_sequence_ { 0u };
+  uint64_t written_raw_bytes_ { 0u };
+  RecordingWriter writer_;
+
+  std::atomic<size_t> pending_bytes_ { 0u };
+  std::atomic<size_t> max_pending_bytes_ { 0u };
+  std::atomic<uint64_t> num_images_ { 0u };
+  std::atomic<uint64_t> num_dropped_images_ { 0u };
+  std::atomic<uint64_t> num_imu_ { 0u };
+  std::atomic<uint64_t> num_dropped_imu_ { 0u };
+
+  //! Last members, such that their threads are joined first.
+  Stream images_;
+  Stream imu_;
+};
+
+} // namespace ze
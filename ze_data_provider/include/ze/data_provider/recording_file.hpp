@@ -0,0 +1,209 @@
+// Copyright (c) 2015-2016, ETH Zurich, Wyss Zurich, Zurich Eye
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the ETH Zurich, Wyss Zurich, Zurich Eye nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL ETH Zurich, Wyss Zurich, Zurich Eye BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <imp/core/image_base.hpp>
+#include <ze/common/noncopyable.hpp>
+#include <ze/common/types.hpp>
+
+//! @file recording_file.hpp
+//! Chunked, indexed container for recorded camera and IMU streams.
+//!
+//! Layout (native byte order):
+//!   file header | chunk 0 | chunk 1 | ... | index | footer
+//!
+//! A chunk is a header followed by the compressed payload. The payload is a
+//! sequence of records in arrival order: a record header followed by the IMU
+//! values or by an image header and the rows of the image. The index holds
+//! the offset, stamp range and streams of every chunk. Files without index,
+//! e.g. of a recording that was killed, are indexed by scanning the chunk
+//! headers, a chunk cut off at the end of the file is ignored.
+
+namespace ze {
+
+//! Lossless compression of the chunk payloads.
+enum class RecordingCodec : uint8_t
+{
+  None,
+  Lz4,  //!< Fast, for recording at high frame rates.
+  Zstd  //!< Smaller files, compresses slower than Lz4, more so at higher levels.
+};
+
+//! Filter applied to the rows of images before compression (as in PNG). It
+//! turns smooth image content into small differences which compress better.
+enum class RecordingFilter : uint8_t
+{
+  None,
+  Sub,   //!< Difference to the left pixel.
+  Paeth  //!< Difference to the Paeth predictor of left, up and upper left.
+};
+
+enum class RecordType : uint8_t
+{
+  Imu,
+  Gyro,
+  Accel,
+  Camera
+};
+
+struct RecordingChunkInfo
+{
+  uint64_t offset = 0u;           //!< Of the chunk header in the file.
+  RecordingCodec codec = RecordingCodec::None;
+  uint32_t num_records = 0u;
+  uint64_t raw_bytes = 0u;        //!< Uncompressed payload.
+  uint64_t compressed_bytes = 0u; //!< Payload in the file.
+  int64_t min_stamp = 0;
+  int64_t max_stamp = 0;
+  uint32_t camera_mask = 0u;      //!< Bit i is set if camera i has records.
+  uint32_t imu_mask = 0u;         //!< Bit i is set if IMU i has records.
+
+  //! Account for a record of stream idx.
+  void addRecord(RecordType type, int64_t stamp, uint32_t idx);
+};
+
+//! A parsed record, points into the payload for images.
+struct RecordView
+{
+  RecordType type = RecordType::Imu;
+  int64_t stamp = 0;
+  uint32_t index = 0u;       //!< Camera or IMU index.
+  Vector3 acc = Vector3::Zero();
+  Vector3 gyr = Vector3::Zero();
+
+  // Images only.
+  PixelType pixel_type = PixelType::undefined;
+  PixelOrder pixel_order = PixelOrder::undefined;
+  RecordingFilter filter = RecordingFilter::None;
+  uint32_t width = 0u;
+  uint32_t height = 0u;
+  uint32_t pixel_size = 0u;
+  const uint8_t* pixels = nullptr;  //!< height rows of width * pixel_size bytes.
+};
+
+//------------------------------------------------------------------------------
+// Payload (de)serialization.
+
+//! Bytes appendImageRecord adds for the region of interest of img.
+size_t imageRecordBytes(const ImageBase& img);
+
+//! Appends the region of interest of img. The filter is only noted, it is
+//! applied by filterImageRecords().
+void appendImageRecord(
+    int64_t stamp, const ImageBase& img, uint32_t camera_idx,
+    RecordingFilter filter, std::vector<uint8_t>* payload);
+
+//! Appends an IMU record. Gyro records only store gyr, Accel records only acc.
+void appendImuRecord(
+    RecordType type, int64_t stamp, const Vector3& acc, const Vector3& gyr,
+    uint32_t imu_idx, std::vector<uint8_t>* payload);
+
+//! Applies the noted filters to all image records of the payload in place.
+void filterImageRecords(std::vector<uint8_t>* payload);
+
+//! Parses the record at *offset and advances it. Returns false at the end of
+//! the payload.
+bool parseRecord(const std::vector<uint8_t>& payload, size_t* offset,
+                 RecordView* record);
+
+//! Copies an image record into an image of the global ImagePool and reverts
+//! the filter.
+ImageBase::Ptr decodeImageRecord(const RecordView& record);
+
+//------------------------------------------------------------------------------
+// Compression.
+
+void compressPayload(
+    RecordingCodec codec, int level, const std::vector<uint8_t>& raw,
+    std::vector<uint8_t>* compressed);
+
+void decompressPayload(
+    RecordingCodec codec, const std::vector<uint8_t>& compressed,
+    size_t raw_bytes, std::vector<uint8_t>* raw);
+
+//------------------------------------------------------------------------------
+//! Appends chunks to a new file, close() writes the index.
+class RecordingWriter : Noncopyable
+{
+public:
+  explicit RecordingWriter(const std::string& filename);
+  ~RecordingWriter();
+
+  //! Writes the chunk and flushes the file, info.offset is set here.
+  void writeChunk(const RecordingChunkInfo& info,
+                  const std::vector<uint8_t>& compressed);
+
+  //! Writes the index. No chunks may be written afterwards.
+  void close();
+
+  inline uint64_t bytesWritten() const { return offset_; }
+  inline const std::vector<RecordingChunkInfo>& chunks() const { return chunks_; }
+
+private:
+  std::ofstream file_;
+  uint64_t offset_ = 0u;
+  std::vector<RecordingChunkInfo> chunks_;
+  bool closed_ = false;
+};
+
+//------------------------------------------------------------------------------
+//! Reads chunks of a file written by RecordingWriter. Thread-safe.
+class RecordingReader : Noncopyable
+{
+public:
+  explicit RecordingReader(const std::string& filename);
+
+  inline const std::vector<RecordingChunkInfo>& chunks() const { return chunks_; }
+
+  //! False if the index was rebuilt by scanning the chunks.
+  inline bool hasIndex() const { return has_index_; }
+
+  //! One more than the highest camera / IMU index with records.
+  uint32_t cameraCount() const;
+  uint32_t imuCount() const;
+
+  //! Reads and decompresses the payload of chunk i.
+  void readChunk(size_t i, std::vector<uint8_t>* payload) const;
+
+private:
+  //! Loads the index at the end of the file, false if there is none.
+  bool loadIndex(uint64_t file_size);
+
+  //! Builds the index from the chunk headers.
+  void scanChunks(uint64_t file_size);
+
+  mutable std::ifstream file_;
+  mutable std::mutex file_mutex_;
+  std::vector<RecordingChunkInfo> chunks_;
+  bool has_index_ = false;
+};
+
+} // namespace ze
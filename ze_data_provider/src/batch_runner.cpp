@@ -0,0 +1,262 @@
+// Copyright (c) 2015-2016, ETH Zurich, Wyss Zurich, Zurich Eye
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the ETH Zurich, Wyss Zurich, Zurich Eye nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL ETH Zurich, Wyss Zurich, Zurich Eye BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <ze/data_provider/batch_runner.hpp>
+
+#include <atomic>
+#include <cerrno>
+#include <fstream>
+#include <thread>
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+#include <sys/stat.h>
+
+#include <ze/cameras/camera_rig.hpp>
+#include <ze/common/file_utils.hpp>
+#include <ze/common/logging.hpp>
+#include <ze/common/path_utils.hpp>
+#include <ze/common/string_utils.hpp>
+#include <ze/common/thread_pool.hpp>
+#include <ze/common/timer.hpp>
+#include <ze/data_provider/camera_imu_synchronizer.hpp>
+
+namespace ze {
+
+namespace {
+
+void createDirectory(const std::string& dir)
+{
+  if (::mkdir(dir.c_str(), 0755) != 0 && errno != EEXIST)
+  {
+    LOG(FATAL) << "Could not create directory " << dir;
+  }
+}
+
+} // anonymous namespace
+
+// -----------------------------------------------------------------------------
+BatchResources::BatchResources(uint32_t num_decode_threads)
+{
+  if (num_decode_threads > 0u)
+  {
+    decode_pool_ = std::make_shared<ThreadPool>(num_decode_threads);
+  }
+}
+
+std::shared_ptr<const CameraRig> BatchResources::cameraRig(
+    const std::string& yaml_file)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = rigs_.find(yaml_file);
+  if (it != rigs_.end())
+  {
+    return it->second;
+  }
+  std::shared_ptr<const CameraRig> rig = cameraRigFromYaml(yaml_file);
+  CHECK(rig) << "Could not load camera rig " << yaml_file;
+  rigs_[yaml_file] = rig;
+  return rig;
+}
+
+// -----------------------------------------------------------------------------
+BatchRunner::BatchRunner(const BatchRunnerOptions& options)
+  : options_(options)
+  , resources_(options.num_decode_threads)
+{
+  CHECK_GT(options_.num_parallel, 0u);
+  if (!options_.output_dir.empty())
+  {
+    createDirectory(options_.output_dir);
+  }
+}
+
+std::vector<BatchSequenceResult> BatchRunner::run(
+    const std::vector<BatchSequence>& sequences,
+    const BatchPipelineSetup& setup)
+{
+  std::vector<BatchSequenceResult> results(sequences.size());
+  std::atomic<size_t> next_sequence { 0u };
+
+  auto worker_loop = [&](uint32_t worker)
+  {
+    if (!options_.cpu_sets.empty())
+    {
+      const std::vector<int>& cpus =
+          options_.cpu_sets[worker % options_.cpu_sets.size()];
+      if (!pinThreadToCpus(cpus))
+      {
+        LOG(WARNING) << "Could not pin batch worker " << worker;
+      }
+    }
+    for (size_t i = next_sequence++; i < sequences.size(); i = next_sequence++)
+    {
+      results[i] = runSequence(sequences[i], setup, worker);
+    }
+  };
+
+  const uint32_t num_workers = std::min<size_t>(options_.num_parallel,
+                                                sequences.size());
+  std::vector<std::thread> workers;
+  for (uint32_t worker = 0u; worker < num_workers; ++worker)
+  {
+    workers.emplace_back(worker_loop, worker);
+  }
+  for (std::thread& worker : workers)
+  {
+    worker.join();
+  }
+
+  writeSummary(results);
+  return results;
+}
+
+BatchSequenceResult BatchRunner::runSequence(
+    const BatchSequence& sequence,
+    const BatchPipelineSetup& setup,
+    uint32_t worker)
+{
+  VLOG(1) << "Worker " << worker << " runs sequence " << sequence.name;
+  BatchSequenceResult result;
+  result.name = sequence.name;
+  result.worker = worker;
+
+  std::string output_dir;
+  if (!options_.output_dir.empty())
+  {
+    output_dir = joinPath(options_.output_dir, sequence.name);
+    createDirectory(output_dir);
+  }
+
+  Timer timer;
+  DataProviderBase::Ptr data_provider = loadDataProvider(sequence.spec);
+  CHECK(data_provider) << "Could not create data provider for " << sequence.name;
+  data_provider->setDecodePool(resources_.decodePool());
+  CameraImuSynchronizer sync(*data_provider);
+  if (setup)
+  {
+    setup(sequence, sync, resources_, output_dir);
+  }
+
+  Timer spin_timer;
+  data_provider->spin();
+  sync.flush();
+  result.spin_time_s = spin_timer.stopAndGetSeconds();
+  result.wall_time_s = timer.stopAndGetSeconds();
+
+  if (!output_dir.empty())
+  {
+    std::ofstream fs;
+    openOutputFileStream(joinPath(output_dir, "timing.yaml"), &fs);
+    fs << "wall_time_s: " << result.wall_time_s << "\n"
+       << "spin_time_s: " << result.spin_time_s << "\n"
+       << "worker: " << worker << "\n";
+    fs << data_provider->ingestStatistics();
+    fs << sync.synchronizerStatistics();
+  }
+  VLOG(1) << "Finished sequence " << sequence.name << " in "
+          << result.wall_time_s << "s.";
+  return result;
+}
+
+void BatchRunner::writeSummary(
+    const std::vector<BatchSequenceResult>& results) const
+{
+  if (options_.output_dir.empty())
+  {
+    return;
+  }
+  std::ofstream fs;
+  openOutputFileStream(joinPath(options_.output_dir, "batch_summary.csv"), &fs);
+  fs << "# name, worker, wall_time_s, spin_time_s\n";
+  for (const BatchSequenceResult& result : results)
+  {
+    fs << result.name << ", " << result.worker << ", "
+       << result.wall_time_s << ", " << result.spin_time_s << "\n";
+  }
+}
+
+// -----------------------------------------------------------------------------
+std::vector<int> parseCpuList(const std::string& cpu_list)
+{
+  std::vector<int> cpus;
+  for (const std::string& range : splitString(cpu_list, ','))
+  {
+    if (range.empty())
+    {
+      continue;
+    }
+    const size_t dash = range.find('-');
+    const int first = std::stoi(range.substr(0, dash));
+    const int last = dash == std::string::npos
+                     ? first : std::stoi(range.substr(dash + 1));
+    for (int cpu = first; cpu <= last; ++cpu)
+    {
+      cpus.push_back(cpu);
+    }
+  }
+  return cpus;
+}
+
+std::vector<std::vector<int>> numaNodeCpuSets()
+{
+  std::vector<std::vector<int>> cpu_sets;
+  for (int node = 0; ; ++node)
+  {
+    const std::string filename =
+        "/sys/devices/system/node/node" + std::to_string(node) + "/cpulist";
+    if (!fileExists(filename))
+    {
+      break;
+    }
+    std::ifstream fs(filename);
+    std::string line;
+    std::getline(fs, line);
+    std::vector<int> cpus = parseCpuList(line);
+    if (!cpus.empty())
+    {
+      cpu_sets.push_back(cpus);
+    }
+  }
+  return cpu_sets;
+}
+
+bool pinThreadToCpus(const std::vector<int>& cpus)
+{
+#ifdef __linux__
+  cpu_set_t cpu_set;
+  CPU_ZERO(&cpu_set);
+  for (int cpu : cpus)
+  {
+    CPU_SET(cpu, &cpu_set);
+  }
+  return pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpu_set) == 0;
+#else
+  return false;
+#endif
+}
+
+} // namespace ze
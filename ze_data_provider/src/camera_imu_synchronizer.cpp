@@ -25,6 +25,7 @@
 
 #include <ze/data_provider/camera_imu_synchronizer.hpp>
 
+#include <algorithm>
 #include <functional>
 #include <gflags/gflags.h>
 
@@ -40,6 +41,12 @@ CameraImuSynchronizer::CameraImuSynchronizer(DataProviderBase& data_provider)
   initBuffers();
 }
 
+CameraImuSynchronizer::~CameraImuSynchronizer()
+{
+  // The queue thread calls into this object.
+  shutdownQueue();
+}
+
 void CameraImuSynchronizer::subscribeDataProvider(DataProviderBase& data_provider)
 {
   using namespace std::placeholders;
@@ -47,12 +54,14 @@ void CameraImuSynchronizer::subscribeDataProvider(DataProviderBase& data_provide
   {
     LOG(ERROR) << "DataProvider must at least expose a single camera topic.";
   }
-  data_provider.registerCameraCallback(
+  subscribeCamera(
+        data_provider,
         std::bind(&CameraImuSynchronizer::addImgData, this, _1, _2, _3));
 
   if (num_imus_ > 0u)
   {
-    data_provider.registerImuCallback(
+    subscribeImu(
+          data_provider,
           std::bind(&CameraImuSynchronizer::addImuData, this, _1, _2, _3, _4));
   }
 }
@@ -61,6 +70,7 @@ void CameraImuSynchronizer::initBuffers()
 {
   img_buffer_.resize(2 * num_cameras_);
   imu_buffers_ = ImuBufferVector(num_imus_);
+  std::vector<std::atomic<uint64_t>>(num_imus_).swap(imu_inserted_);
 }
 
 void CameraImuSynchronizer::addImuData(
@@ -70,6 +80,10 @@ void CameraImuSynchronizer::addImuData(
   acc_gyr.head<3>() = acc;
   acc_gyr.tail<3>() = gyr;
   imu_buffers_[imu_idx].insert(stamp, acc_gyr);
+  if (stats_enabled_)
+  {
+    imu_inserted_[imu_idx].fetch_add(1u, std::memory_order_relaxed);
+  }
   checkImuDataAndCallback();
 }
 
@@ -81,17 +95,13 @@ void CameraImuSynchronizer::checkImuDataAndCallback()
   }
 
   // always provide imu structures in the callback (empty if no imu present)
-  ImuStampsVector imu_timestamps(num_imus_);
-  ImuAccGyrVector imu_measurements(num_imus_);
-
   if (num_imus_ != 0)
   {
     // get oldest / newest stamp for all imu buffers
-    std::vector<std::tuple<int64_t, int64_t, bool>> oldest_newest_stamp_vector(num_imus_);
     std::transform(
           imu_buffers_.begin(),
           imu_buffers_.end(),
-          oldest_newest_stamp_vector.begin(),
+          imu_oldest_newest_stamps_.begin(),
           [](const ImuSyncBuffer& imu_buffer) {
             return imu_buffer.getOldestAndNewestStamp();
           });
@@ -100,7 +110,7 @@ void CameraImuSynchronizer::checkImuDataAndCallback()
     if (!validateImuBuffers(
           sync_imgs_ready_to_process_stamp_,
           sync_imgs_ready_to_process_stamp_,
-          oldest_newest_stamp_vector))
+          imu_oldest_newest_stamps_))
     {
       return;
     }
@@ -110,40 +120,29 @@ void CameraImuSynchronizer::checkImuDataAndCallback()
     // that we have received in between.
     for (size_t i = 0; i < num_imus_; ++i)
     {
-      if(last_img_bundle_min_stamp_ < 0)
+      const int64_t stamp_from =
+          last_img_bundle_min_stamp_ < 0
+          ? std::get<0>(imu_oldest_newest_stamps_[i])
+          : last_img_bundle_min_stamp_;
+      const size_t num_values =
+          imu_buffers_[i].getBetweenValuesInterpolated(
+            stamp_from,
+            sync_imgs_ready_to_process_stamp_,
+            imu_bundle_.stamps_storage[i],
+            imu_bundle_.acc_gyr_storage[i]);
+      imu_bundle_.setSize(i, num_values);
+      if (stats_enabled_)
       {
-        int64_t oldest_stamp = std::get<0>(oldest_newest_stamp_vector[i]);
-        std::tie(imu_timestamps[i], imu_measurements[i]) =
-            imu_buffers_[i].getBetweenValuesInterpolated(
-              oldest_stamp,
-              sync_imgs_ready_to_process_stamp_);
-      }
-      else
-      {
-        std::tie(imu_timestamps[i], imu_measurements[i]) =
-            imu_buffers_[i].getBetweenValuesInterpolated(
-              last_img_bundle_min_stamp_,
-              sync_imgs_ready_to_process_stamp_);
+        // The buffer only drops its oldest measurements once full.
+        recordImuBufferFill(
+              i, std::min<uint64_t>(imu_inserted_[i].load(std::memory_order_relaxed),
+                                    ImuSyncBuffer::capacity()),
+              ImuSyncBuffer::capacity());
       }
     }
   }
 
-  // Let's process the callback.
-  cam_imu_callback_(sync_imgs_ready_to_process_, imu_timestamps, imu_measurements);
-
-  // Reset Buffer:
-  for (size_t i = 0; i <= img_buffer_.size(); ++i)
-  {
-    ImageBufferItem& item = img_buffer_[i];
-    if (std::abs(sync_imgs_ready_to_process_stamp_ - item.stamp)
-        < c_camera_bundle_time_accuracy_ns)
-    {
-      item.reset();
-    }
-  }
-  last_img_bundle_min_stamp_ = sync_imgs_ready_to_process_stamp_;
-  sync_imgs_ready_to_process_stamp_ = -1;
-  sync_imgs_ready_to_process_.clear();
+  processCallbackAndResetBuffer();
 }
 
 } // namespace ze
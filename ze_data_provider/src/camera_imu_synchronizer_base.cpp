@@ -25,21 +25,158 @@
 
 #include <ze/data_provider/camera_imu_synchronizer_base.hpp>
 
+#include <cmath>
+#include <gflags/gflags.h>
+
+#include <ze/common/logging.hpp>
 #include <ze/data_provider/data_provider_base.hpp>
 
 namespace ze {
 
+DECLARE_bool(data_provider_stats);
+DECLARE_double(data_provider_stats_dump_period_s);
+
 DEFINE_int32(data_sync_init_skip_n_frames, 0,
              "How many frames should be skipped at the beginning.");
 
 DEFINE_int32(data_sync_stop_after_n_frames, -1,
              "How many frames should be processed?");
 
+DEFINE_double(data_sync_camera_rate_hz, 20.0,
+              "Expected camera rate, used to pre-allocate the IMU bundle.");
+
+DEFINE_double(data_sync_imu_rate_hz, 200.0,
+              "Expected IMU rate, used to pre-allocate the IMU bundle.");
+
+DEFINE_bool(data_sync_decoupled, false,
+            "Run the synchronizer and its callback on a separate thread, fed "
+            "by a bounded queue from the data provider.");
+
+DEFINE_int32(data_sync_queue_size, 100,
+             "Capacity of the queue in decoupled mode.");
+
+DEFINE_int32(data_sync_queue_overflow_policy, 0,
+             "Policy if the queue is full in decoupled mode. 0: Block, "
+             "1: Drop oldest, 2: Coalesce images.");
+
+ImuStampsContainerVector copyImuStamps(const ImuStampsVector& imu_stamps)
+{
+  return ImuStampsContainerVector(imu_stamps.begin(), imu_stamps.end());
+}
+
+ImuAccGyrContainerVector copyImuAccGyr(const ImuAccGyrVector& imu_acc_gyr)
+{
+  return ImuAccGyrContainerVector(imu_acc_gyr.begin(), imu_acc_gyr.end());
+}
+
+//------------------------------------------------------------------------------
+void ImuBundle::reserve(uint32_t num_imus, int capacity)
+{
+  stamps_storage.assign(num_imus, ImuStamps(capacity));
+  acc_gyr_storage.assign(num_imus, ImuAccGyrContainer(6, capacity));
+  stamps.clear();
+  acc_gyr.clear();
+  stamps.reserve(num_imus);
+  acc_gyr.reserve(num_imus);
+  for (uint32_t i = 0u; i < num_imus; ++i)
+  {
+    stamps.emplace_back(stamps_storage[i].data(), 0);
+    acc_gyr.emplace_back(acc_gyr_storage[i].data(), 6, 0);
+  }
+}
+
+void ImuBundle::setSize(uint32_t imu_idx, int num_values)
+{
+  DEBUG_CHECK_LT(imu_idx, stamps.size());
+  DEBUG_CHECK_LE(num_values, stamps_storage[imu_idx].size());
+  // Eigen::Map can't be re-assigned, placement new is the documented way to
+  // change the mapped array.
+  new (&stamps[imu_idx]) ImuStampsView(
+        stamps_storage[imu_idx].data(), num_values);
+  new (&acc_gyr[imu_idx]) ImuAccGyrView(
+        acc_gyr_storage[imu_idx].data(), 6, num_values);
+}
+
 CameraImuSynchronizerBase::CameraImuSynchronizerBase(
     DataProviderBase& data_provider)
   : num_cameras_(data_provider.cameraCount())
   , num_imus_(data_provider.imuCount())
+  , stats_enabled_(FLAGS_data_provider_stats)
+{
+  imu_oldest_newest_stamps_.resize(num_imus_);
+  imu_bundle_.reserve(num_imus_, imuBundleCapacity());
+  sync_imgs_ready_to_process_.reserve(num_cameras_);
+
+  if (FLAGS_data_sync_decoupled)
+  {
+    CHECK_GT(FLAGS_data_sync_queue_size, 0);
+    CHECK_GE(FLAGS_data_sync_queue_overflow_policy, 0);
+    CHECK_LE(FLAGS_data_sync_queue_overflow_policy, 2);
+    queue_.reset(new MeasurementQueue(
+                   FLAGS_data_sync_queue_size,
+                   static_cast<QueueOverflowPolicy>(
+                     FLAGS_data_sync_queue_overflow_policy)));
+  }
+}
+
+void CameraImuSynchronizerBase::subscribeCamera(
+    DataProviderBase& data_provider, const CameraCallback& callback)
+{
+  data_provider.registerCameraCallback(
+        queue_ ? queue_->wrapCameraCallback(callback) : callback);
+}
+
+void CameraImuSynchronizerBase::subscribeImu(
+    DataProviderBase& data_provider, const ImuCallback& callback)
+{
+  data_provider.registerImuCallback(
+        queue_ ? queue_->wrapImuCallback(callback) : callback);
+}
+
+void CameraImuSynchronizerBase::subscribeGyro(
+    DataProviderBase& data_provider, const GyroCallback& callback)
 {
+  data_provider.registerGyroCallback(
+        queue_ ? queue_->wrapGyroCallback(callback) : callback);
+}
+
+void CameraImuSynchronizerBase::subscribeAccel(
+    DataProviderBase& data_provider, const AccelCallback& callback)
+{
+  data_provider.registerAccelCallback(
+        queue_ ? queue_->wrapAccelCallback(callback) : callback);
+}
+
+void CameraImuSynchronizerBase::flush()
+{
+  if (queue_)
+  {
+    queue_->flush();
+  }
+}
+
+MeasurementQueueStats CameraImuSynchronizerBase::queueStats() const
+{
+  return queue_ ? queue_->stats() : MeasurementQueueStats();
+}
+
+void CameraImuSynchronizerBase::shutdownQueue()
+{
+  if (queue_)
+  {
+    queue_->shutdown();
+  }
+}
+
+int CameraImuSynchronizerBase::imuBundleCapacity()
+{
+  CHECK_GT(FLAGS_data_sync_camera_rate_hz, 0.0);
+  CHECK_GT(FLAGS_data_sync_imu_rate_hz, 0.0);
+  // Measurements between two frames plus the two interpolated boundary values.
+  // Leave room for one dropped frame before the storage has to grow.
+  const int per_frame = static_cast<int>(
+        std::ceil(FLAGS_data_sync_imu_rate_hz / FLAGS_data_sync_camera_rate_hz));
+  return 2 * per_frame + 2;
 }
 
 void CameraImuSynchronizerBase::registerCameraImuCallback(
@@ -92,10 +229,11 @@ void CameraImuSynchronizerBase::addImgData(
   img_buffer_[slot].stamp = stamp;
   img_buffer_[slot].img = img;
   img_buffer_[slot].camera_idx = camera_idx;
+  img_buffer_[slot].arrival_ns = stats_enabled_ ? ingestClockNs() : -1;
 
   // Now check, if we have all images from this bundle:
   uint32_t num_imgs = 0u;
-  for (size_t i = 0; i <= img_buffer_.size(); ++i)
+  for (size_t i = 0; i < img_buffer_.size(); ++i)
   {
     if (std::abs(stamp - img_buffer_[i].stamp) < millisecToNanosec(2))
     {
@@ -111,7 +249,8 @@ void CameraImuSynchronizerBase::addImgData(
   // We have frames with very close timestamps. Put them together in a vector.
   sync_imgs_ready_to_process_.clear();
   sync_imgs_ready_to_process_.resize(num_imgs, {-1, nullptr});
-  for (size_t i = 0; i <= img_buffer_.size(); ++i)
+  sync_imgs_ready_arrival_ns_ = -1;
+  for (size_t i = 0; i < img_buffer_.size(); ++i)
   {
     ImageBufferItem& item = img_buffer_[i];
     if (std::abs(stamp - item.stamp) < c_camera_bundle_time_accuracy_ns)
@@ -119,6 +258,8 @@ void CameraImuSynchronizerBase::addImgData(
       DEBUG_CHECK_GT(item.stamp, 0);
       DEBUG_CHECK(item.img);
       sync_imgs_ready_to_process_.at(item.camera_idx) = { item.stamp, item.img };
+      sync_imgs_ready_arrival_ns_ =
+          std::max(sync_imgs_ready_arrival_ns_, item.arrival_ns);
     }
   }
 
@@ -195,4 +336,52 @@ bool CameraImuSynchronizerBase::validateImuBuffers(
   return true;
 }
 
+void CameraImuSynchronizerBase::processCallbackAndResetBuffer()
+{
+  // Let's process the callback.
+  if (stats_enabled_)
+  {
+    const int64_t start = ingestClockNs();
+    sync_stats_.bundle_latency.addSample(start - sync_imgs_ready_arrival_ns_);
+    cam_imu_callback_(sync_imgs_ready_to_process_,
+                      imu_bundle_.stamps,
+                      imu_bundle_.acc_gyr);
+    const int64_t end = ingestClockNs();
+    sync_stats_.callback_duration.addSample(end - start);
+
+    if (FLAGS_data_provider_stats_dump_period_s > 0.0)
+    {
+      if (next_stats_dump_ns_ < 0)
+      {
+        next_stats_dump_ns_ = start;
+      }
+      if (end > next_stats_dump_ns_)
+      {
+        LOG(INFO) << "Synchronizer statistics:\n" << sync_stats_;
+        next_stats_dump_ns_ += secToNanosec(FLAGS_data_provider_stats_dump_period_s);
+      }
+    }
+  }
+  else
+  {
+    cam_imu_callback_(sync_imgs_ready_to_process_,
+                      imu_bundle_.stamps,
+                      imu_bundle_.acc_gyr);
+  }
+
+  // Reset Buffer:
+  for (size_t i = 0; i < img_buffer_.size(); ++i)
+  {
+    ImageBufferItem& item = img_buffer_[i];
+    if (std::abs(sync_imgs_ready_to_process_stamp_ - item.stamp)
+        < c_camera_bundle_time_accuracy_ns)
+    {
+      item.reset();
+    }
+  }
+  last_img_bundle_min_stamp_ = sync_imgs_ready_to_process_stamp_;
+  sync_imgs_ready_to_process_stamp_ = -1;
+  sync_imgs_ready_to_process_.clear();
+}
+
 } // namespace ze
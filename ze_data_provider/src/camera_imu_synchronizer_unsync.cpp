@@ -25,6 +25,7 @@
 
 #include <ze/data_provider/camera_imu_synchronizer_unsync.hpp>
 
+#include <algorithm>
 #include <functional>
 #include <gflags/gflags.h>
 
@@ -42,6 +43,12 @@ CameraImuSynchronizerUnsync::CameraImuSynchronizerUnsync(
   initBuffers(imu_models);
 }
 
+CameraImuSynchronizerUnsync::~CameraImuSynchronizerUnsync()
+{
+  // The queue thread calls into this object.
+  shutdownQueue();
+}
+
 void CameraImuSynchronizerUnsync::subscribeDataProvider(
     DataProviderBase& data_provider)
 {
@@ -50,14 +57,17 @@ void CameraImuSynchronizerUnsync::subscribeDataProvider(
   {
     LOG(ERROR) << "DataProvider must at least expose a single camera topic.";
   }
-  data_provider.registerCameraCallback(
+  subscribeCamera(
+        data_provider,
         std::bind(&CameraImuSynchronizerUnsync::addImgData, this, _1, _2, _3));
 
   if (num_imus_ > 0u)
   {
-    data_provider.registerAccelCallback(
+    subscribeAccel(
+          data_provider,
           std::bind(&CameraImuSynchronizerUnsync::addAccelData, this, _1, _2, _3));
-    data_provider.registerGyroCallback(
+    subscribeGyro(
+          data_provider,
           std::bind(&CameraImuSynchronizerUnsync::addGyroData, this, _1, _2, _3));
   }
 }
@@ -70,12 +80,18 @@ void CameraImuSynchronizerUnsync::initBuffers(
   {
     imu_buffers_.push_back(std::make_shared<ImuSyncBuffer>(imu_model));
   }
+  std::vector<std::atomic<uint64_t>>(imu_buffers_.size()).swap(acc_inserted_);
+  std::vector<std::atomic<uint64_t>>(imu_buffers_.size()).swap(gyr_inserted_);
 }
 
 void CameraImuSynchronizerUnsync::addAccelData(
     int64_t stamp, const Vector3& acc, const uint32_t imu_idx)
 {
   imu_buffers_[imu_idx]->insertAccelerometerMeasurement(stamp, acc);
+  if (stats_enabled_)
+  {
+    acc_inserted_[imu_idx].fetch_add(1u, std::memory_order_relaxed);
+  }
   checkImuDataAndCallback();
 }
 
@@ -83,6 +99,10 @@ void CameraImuSynchronizerUnsync::addGyroData(
     int64_t stamp, const Vector3& gyr, const uint32_t imu_idx)
 {
   imu_buffers_[imu_idx]->insertGyroscopeMeasurement(stamp, gyr);
+  if (stats_enabled_)
+  {
+    gyr_inserted_[imu_idx].fetch_add(1u, std::memory_order_relaxed);
+  }
   checkImuDataAndCallback();
 }
 
@@ -94,18 +114,14 @@ void CameraImuSynchronizerUnsync::checkImuDataAndCallback()
   }
 
   // always provide imu structures in the callback (empty if no imu present)
-  ImuStampsVector imu_timestamps(num_imus_);
-  ImuAccGyrVector imu_measurements(num_imus_);
-
   if (num_imus_ != 0)
   {
     // get oldest / newest stamp for all imu buffers
-    std::vector<std::tuple<int64_t, int64_t, bool>> oldest_newest_stamp_vector(num_imus_);
     std::transform(
           imu_buffers_.begin(),
           imu_buffers_.end(),
-          oldest_newest_stamp_vector.begin(),
-          [](const ImuSyncBuffer::Ptr imu_buffer) {
+          imu_oldest_newest_stamps_.begin(),
+          [](const ImuSyncBuffer::Ptr& imu_buffer) {
             return imu_buffer->getOldestAndNewestStamp();
           });
 
@@ -113,7 +129,7 @@ void CameraImuSynchronizerUnsync::checkImuDataAndCallback()
     if (!validateImuBuffers(
           sync_imgs_ready_to_process_stamp_,
           sync_imgs_ready_to_process_stamp_,
-          oldest_newest_stamp_vector))
+          imu_oldest_newest_stamps_))
     {
       return;
     }
@@ -123,40 +139,32 @@ void CameraImuSynchronizerUnsync::checkImuDataAndCallback()
     // that we have received in between.
     for (size_t i = 0; i < num_imus_; ++i)
     {
-      if(last_img_bundle_min_stamp_ < 0)
+      const int64_t stamp_from =
+          last_img_bundle_min_stamp_ < 0
+          ? std::get<0>(imu_oldest_newest_stamps_[i])
+          : last_img_bundle_min_stamp_;
+      const size_t num_values =
+          imu_buffers_[i]->getBetweenValuesInterpolated(
+            stamp_from,
+            sync_imgs_ready_to_process_stamp_,
+            imu_bundle_.stamps_storage[i],
+            imu_bundle_.acc_gyr_storage[i]);
+      imu_bundle_.setSize(i, num_values);
+      if (stats_enabled_)
       {
-        int64_t oldest_stamp = std::get<0>(oldest_newest_stamp_vector[i]);
-        std::tie(imu_timestamps[i], imu_measurements[i]) =
-            imu_buffers_[i]->getBetweenValuesInterpolated(
-              oldest_stamp,
-              sync_imgs_ready_to_process_stamp_);
-      }
-      else
-      {
-        std::tie(imu_timestamps[i], imu_measurements[i]) =
-            imu_buffers_[i]->getBetweenValuesInterpolated(
-              last_img_bundle_min_stamp_,
-              sync_imgs_ready_to_process_stamp_);
+        // Like ImuBuffer::size(), the fuller of both buffers, which only drop
+        // their oldest measurements once full.
+        const uint64_t inserted =
+            std::max(acc_inserted_[i].load(std::memory_order_relaxed),
+                     gyr_inserted_[i].load(std::memory_order_relaxed));
+        recordImuBufferFill(
+              i, std::min<uint64_t>(inserted, ImuSyncBuffer::capacity()),
+              ImuSyncBuffer::capacity());
       }
     }
   }
 
-  // Let's process the callback.
-  cam_imu_callback_(sync_imgs_ready_to_process_, imu_timestamps, imu_measurements);
-
-  // Reset Buffer:
-  for (size_t i = 0; i <= img_buffer_.size(); ++i)
-  {
-    ImageBufferItem& item = img_buffer_[i];
-    if (std::abs(sync_imgs_ready_to_process_stamp_ - item.stamp)
-        < c_camera_bundle_time_accuracy_ns)
-    {
-      item.reset();
-    }
-  }
-  last_img_bundle_min_stamp_ = sync_imgs_ready_to_process_stamp_;
-  sync_imgs_ready_to_process_stamp_ = -1;
-  sync_imgs_ready_to_process_.clear();
+  processCallbackAndResetBuffer();
 }
 
 } // namespace ze
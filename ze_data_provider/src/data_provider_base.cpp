@@ -25,8 +25,20 @@
 
 #include <ze/data_provider/data_provider_base.hpp>
 
+#include <gflags/gflags.h>
+#include <ze/common/logging.hpp>
+#include <ze/common/time_conversions.hpp>
+
 namespace ze {
 
+DEFINE_bool(data_provider_stats, false,
+            "Collect per-stream ingest statistics of the data provider and "
+            "the synchronizers.");
+
+DEFINE_double(data_provider_stats_dump_period_s, 0.0,
+              "Log the ingest statistics with this period while spinning. "
+              "0 disables the dump.");
+
 DataProviderBase::DataProviderBase(DataProviderType type)
   : type_(type)
   , signal_handler_(running_)
@@ -34,9 +46,17 @@ DataProviderBase::DataProviderBase(DataProviderType type)
 
 void DataProviderBase::spin()
 {
+  const int64_t dump_period_ns =
+      FLAGS_data_provider_stats ? secToNanosec(FLAGS_data_provider_stats_dump_period_s) : 0;
+  int64_t next_dump_ns = ingestClockNs() + dump_period_ns;
   while (ok())
   {
     spinOnce();
+    if (dump_period_ns > 0 && ingestClockNs() > next_dump_ns)
+    {
+      LOG(INFO) << "Ingest statistics:\n" << ingest_stats_;
+      next_dump_ns += dump_period_ns;
+    }
   }
 }
 
@@ -53,21 +73,61 @@ void DataProviderBase::shutdown()
 void DataProviderBase::registerImuCallback(const ImuCallback& imu_callback)
 {
   imu_callback_ = imu_callback;
+  if (FLAGS_data_provider_stats && imu_callback)
+  {
+    IngestStatistics* stats = &ingest_stats_;
+    imu_callback_ = [imu_callback, stats](
+        int64_t stamp, const Vector3& acc, const Vector3& gyr, uint32_t imu_idx)
+    {
+      StreamCallbackScope scope(stats->stream(IngestStreamType::Imu, imu_idx));
+      imu_callback(stamp, acc, gyr, imu_idx);
+    };
+  }
 }
 
 void DataProviderBase::registerGyroCallback(const GyroCallback& gyro_callback)
 {
   gyro_callback_ = gyro_callback;
+  if (FLAGS_data_provider_stats && gyro_callback)
+  {
+    IngestStatistics* stats = &ingest_stats_;
+    gyro_callback_ = [gyro_callback, stats](
+        int64_t stamp, const Vector3& gyr, uint32_t imu_idx)
+    {
+      StreamCallbackScope scope(stats->stream(IngestStreamType::Gyro, imu_idx));
+      gyro_callback(stamp, gyr, imu_idx);
+    };
+  }
 }
 
 void DataProviderBase::registerAccelCallback(const AccelCallback& accel_callback)
 {
   accel_callback_ = accel_callback;
+  if (FLAGS_data_provider_stats && accel_callback)
+  {
+    IngestStatistics* stats = &ingest_stats_;
+    accel_callback_ = [accel_callback, stats](
+        int64_t stamp, const Vector3& acc, uint32_t imu_idx)
+    {
+      StreamCallbackScope scope(stats->stream(IngestStreamType::Accel, imu_idx));
+      accel_callback(stamp, acc, imu_idx);
+    };
+  }
 }
 
 void DataProviderBase::registerCameraCallback(const CameraCallback& camera_callback)
 {
   camera_callback_ = camera_callback;
+  if (FLAGS_data_provider_stats && camera_callback)
+  {
+    IngestStatistics* stats = &ingest_stats_;
+    camera_callback_ = [camera_callback, stats](
+        int64_t stamp, const std::shared_ptr<ImageBase>& img, uint32_t cam_idx)
+    {
+      StreamCallbackScope scope(stats->stream(IngestStreamType::Camera, cam_idx));
+      camera_callback(stamp, img, cam_idx);
+    };
+  }
 }
 
 } // namespace ze
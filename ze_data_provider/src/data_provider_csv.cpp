@@ -25,8 +25,19 @@
 
 #include <ze/data_provider/data_provider_csv.hpp>
 
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
 #include <fstream>
+#include <functional>
 #include <iostream>
+#include <limits>
+#include <thread>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <gflags/gflags.h>
 #include <ze/common/logging.hpp>
 
 #include <imp/bridge/opencv/cv_bridge.hpp>
@@ -34,8 +45,26 @@
 #include <ze/common/time_conversions.hpp>
 #include <ze/common/string_utils.hpp>
 #include <ze/common/file_utils.hpp>
+#include <ze/common/thread_pool.hpp>
+
+DECLARE_double(data_source_start_time_s);
+DECLARE_double(data_source_stop_time_s);
+DEFINE_bool(data_source_csv_write_index, true,
+            "Write the offset index of a data.csv file to "
+            "data_source_csv_index_dir when it is first built.");
+DEFINE_string(data_source_csv_index_dir, "",
+              "Directory for the offset indices of data.csv files, "
+              "$HOME/.cache/ze/csv_index if empty.");
 
 namespace ze {
+
+namespace {
+const std::string kImuHeader = "#timestamp [ns],w_RS_S_x [rad s^-1],w_RS_S_y [rad s^-1],w_RS_S_z [rad s^-1],a_RS_S_x [m s^-2],a_RS_S_y [m s^-2],a_RS_S_z [m s^-2]";
+const std::string kCameraHeader = "#timestamp [ns],filename";
+//! Images are published after the IMU measurements they are synchronized with.
+const int64_t kCameraPlaybackDelay = millisecToNanosec(100);
+} // anonymous namespace
+
 namespace internal {
 
 enum class MeasurementType
@@ -101,7 +130,7 @@ struct CameraMeasurement : public MeasurementBase
   inline ImageBase::Ptr loadImage() const
   {
     //! @todo: Make an option which pixel-type to load.
-    ImageCv8uC1::Ptr img;
+    ImageRaw8uC1::Ptr img;
     cvBridgeLoad<Pixel8uC1>(img, image_filename, PixelOrder::gray);
     CHECK_NOTNULL(img.get());
     CHECK(img->numel() > 0);
@@ -135,6 +164,204 @@ struct FeatureTrackMeasurement : public MeasurementBase
   const double keypoint_std_dev;
 };
 
+//! Sparse index of a data.csv file: the stamp and byte offset of every
+//! c_stride-th line. Only valid for files with non-decreasing stamps.
+struct CsvIndex
+{
+  static constexpr size_t c_stride = 256u;
+  static constexpr const char* c_header = "#timestamp [ns],offset [bytes]";
+
+  std::vector<int64_t> stamps;
+  std::vector<std::streamoff> offsets;
+  bool sorted = true;
+  //! Smallest stamp in the file, also known if the file is not sorted.
+  int64_t min_stamp = std::numeric_limits<int64_t>::max();
+
+  //! Byte offset of a line at or before the first line with stamp >= stamp.
+  std::streamoff lowerBoundOffset(int64_t stamp) const
+  {
+    auto it = std::lower_bound(stamps.begin(), stamps.end(), stamp);
+    if (it == stamps.begin())
+    {
+      return offsets.front();
+    }
+    return offsets[std::distance(stamps.begin(), it) - 1];
+  }
+};
+
+inline int64_t fileSize(const std::string& filename)
+{
+  std::ifstream fs(filename, std::ios::binary | std::ios::ate);
+  return fs ? static_cast<int64_t>(fs.tellg()) : -1;
+}
+
+//! Create dir and its parents, false on failure.
+bool createDirectories(const std::string& dir)
+{
+  for (size_t pos = dir.find('/', 1u); ; pos = dir.find('/', pos + 1u))
+  {
+    const std::string parent = dir.substr(0u, pos);
+    if (::mkdir(parent.c_str(), 0755) != 0 && errno != EEXIST)
+    {
+      return false;
+    }
+    if (pos == std::string::npos)
+    {
+      return true;
+    }
+  }
+}
+
+//! Index file of the data file in the cache directory, named after the
+//! absolute path of the data file. Empty if there is no cache directory.
+std::string csvIndexFile(const std::string& data_file)
+{
+  std::string dir = FLAGS_data_source_csv_index_dir;
+  if (dir.empty())
+  {
+    const char* home = std::getenv("HOME");
+    if (!home)
+    {
+      return std::string();
+    }
+    dir = joinPath(home, ".cache/ze/csv_index");
+  }
+  char path[PATH_MAX];
+  if (!::realpath(data_file.c_str(), path))
+  {
+    return std::string();
+  }
+  // Escape '%' and '/', such that different paths get different names.
+  std::string name;
+  for (const char* c = path; *c != '\0'; ++c)
+  {
+    if (*c == '%')
+    {
+      name += "%25";
+    }
+    else if (*c == '/')
+    {
+      name += "%2F";
+    }
+    else
+    {
+      name += *c;
+    }
+  }
+  return joinPath(dir, name + ".idx");
+}
+
+//! Load the index file of the data file. The first line holds the size of
+//! the data file, such that a modified file is re-indexed.
+bool loadCsvIndex(
+    const std::string& index_file,
+    const int64_t data_size,
+    CsvIndex* index)
+{
+  if (index_file.empty() || !fileExists(index_file))
+  {
+    return false;
+  }
+  std::ifstream fs(index_file);
+  std::string line;
+  if (!std::getline(fs, line) || line != "#size [bytes]," + std::to_string(data_size)
+      || !std::getline(fs, line) || line != CsvIndex::c_header)
+  {
+    VLOG(1) << "Outdated csv index: " << index_file;
+    return false;
+  }
+  while (std::getline(fs, line))
+  {
+    std::vector<std::string> items = splitString(line, ',');
+    CHECK_EQ(items.size(), 2u);
+    index->stamps.push_back(std::stoll(items[0]));
+    index->offsets.push_back(std::stoll(items[1]));
+  }
+  if (index->stamps.empty())
+  {
+    return false;
+  }
+  index->min_stamp = index->stamps.front();
+  return true;
+}
+
+//! Scan the stamps of the data file and write the index file.
+void buildCsvIndex(
+    const std::string& data_file,
+    const std::string& header,
+    const std::string& index_file,
+    const int64_t data_size,
+    CsvIndex* index)
+{
+  std::ifstream fs;
+  openFileStreamAndCheckHeader(data_file, header, &fs);
+  std::string line;
+  size_t i = 0u;
+  int64_t last_stamp = std::numeric_limits<int64_t>::lowest();
+  std::streamoff offset = fs.tellg();
+  while (std::getline(fs, line))
+  {
+    if (!line.empty())
+    {
+      const int64_t stamp = std::stoll(line.substr(0, line.find(',')));
+      index->min_stamp = std::min(index->min_stamp, stamp);
+      if (stamp < last_stamp && index->sorted)
+      {
+        LOG(WARNING) << "Stamps are not sorted, not indexing " << data_file;
+        index->sorted = false;
+        index->stamps.clear();
+        index->offsets.clear();
+      }
+      if (index->sorted && i % CsvIndex::c_stride == 0u)
+      {
+        index->stamps.push_back(stamp);
+        index->offsets.push_back(offset);
+      }
+      last_stamp = stamp;
+      ++i;
+    }
+    offset = fs.tellg();
+  }
+  if (!index->sorted || index->stamps.empty())
+  {
+    return;
+  }
+
+  if (FLAGS_data_source_csv_write_index && !index_file.empty())
+  {
+    const std::string index_dir = index_file.substr(0u, index_file.rfind('/'));
+    if (!createDirectories(index_dir))
+    {
+      LOG(WARNING) << "Could not create csv index directory " << index_dir;
+      return;
+    }
+    // Write to a unique file and rename, such that data providers that are
+    // created concurrently never read a partially written index.
+    const std::string tmp_file = index_file + ".tmp" + std::to_string(getpid())
+        + "_" + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id()));
+    {
+      std::ofstream out(tmp_file);
+      if (!out)
+      {
+        LOG(WARNING) << "Could not write csv index " << index_file;
+        return;
+      }
+      out << "#size [bytes]," << data_size << "\n" << CsvIndex::c_header << "\n";
+      for (size_t j = 0u; j < index->stamps.size(); ++j)
+      {
+        out << index->stamps[j] << "," << index->offsets[j] << "\n";
+      }
+    }
+    if (std::rename(tmp_file.c_str(), index_file.c_str()) != 0)
+    {
+      LOG(WARNING) << "Could not write csv index " << index_file;
+      std::remove(tmp_file.c_str());
+      return;
+    }
+    VLOG(1) << "Wrote csv index " << index_file;
+  }
+}
+
 } // namespace internal
 
 DataProviderCsv::DataProviderCsv(
@@ -142,27 +369,172 @@ DataProviderCsv::DataProviderCsv(
     const std::map<std::string, size_t>& imu_topics,
     const std::map<std::string, size_t>& camera_topics)
   : DataProviderBase(DataProviderType::Csv)
+  , csv_directory_(csv_directory)
   , imu_topics_(imu_topics)
   , camera_topics_(camera_topics)
 {
   VLOG(1) << "Loading .csv dataset from directory \"" << csv_directory << "\".";
 
-  for (auto it : imu_topics)
+  if (FLAGS_data_source_start_time_s == 0.0 &&
+      FLAGS_data_source_stop_time_s == 0.0)
   {
-    std::string dir = joinPath(csv_directory, it.first);
-    loadImuData(dir, it.second, 0u);
+    // Without window the files are read in full and need no index.
+    setTimeWindow(std::numeric_limits<int64_t>::lowest(),
+                  std::numeric_limits<int64_t>::max());
+    if (!buffer_.empty())
+    {
+      begin_stamp_ = buffer_.cbegin()->first;
+    }
+    VLOG(1) << "done.";
+    return;
   }
 
+  // Earliest playback stamp, the files may not be sorted.
+  int64_t begin_stamp = std::numeric_limits<int64_t>::max();
+  for (auto it : imu_topics)
+  {
+    const internal::CsvIndex& index =
+        csvIndex(joinPath(csv_directory, it.first), kImuHeader);
+    begin_stamp = std::min(begin_stamp, index.min_stamp);
+  }
   for (auto it : camera_topics)
   {
-    std::string dir = joinPath(csv_directory, it.first);
-    loadCameraData(dir, it.second, millisecToNanosec(100));
+    const internal::CsvIndex& index =
+        csvIndex(joinPath(csv_directory, it.first), kCameraHeader);
+    if (index.min_stamp < std::numeric_limits<int64_t>::max())
+    {
+      begin_stamp = std::min(begin_stamp, index.min_stamp + kCameraPlaybackDelay);
+    }
+  }
+  if (begin_stamp < std::numeric_limits<int64_t>::max())
+  {
+    begin_stamp_ = begin_stamp;
   }
 
-  buffer_it_ = buffer_.cbegin();
+  CHECK_GE(FLAGS_data_source_start_time_s, 0);
+  CHECK_GE(FLAGS_data_source_stop_time_s, 0);
+  CHECK_GE(begin_stamp_, 0) << "No measurements in " << csv_directory;
+
+  // Like for bags, the window is relative to the first measurement.
+  const int64_t start_ns = begin_stamp_ + secToNanosec(FLAGS_data_source_start_time_s);
+  int64_t stop_ns = std::numeric_limits<int64_t>::max();
+  if (FLAGS_data_source_stop_time_s != 0.0)
+  {
+    stop_ns = begin_stamp_ + secToNanosec(FLAGS_data_source_stop_time_s);
+    CHECK_LT(start_ns, stop_ns) << "Start time exceeds stop time.";
+  }
+
+  setTimeWindow(start_ns, stop_ns);
   VLOG(1) << "done.";
 }
 
+void DataProviderCsv::setTimeWindow(int64_t start_ns, int64_t stop_ns)
+{
+  CHECK_LE(start_ns, stop_ns);
+  prefetched_.clear();
+  buffer_.clear();
+  window_start_ns_ = start_ns;
+  window_stop_ns_ = stop_ns;
+
+  for (auto it : imu_topics_)
+  {
+    std::string dir = joinPath(csv_directory_, it.first);
+    loadImuData(dir, it.second, 0u, start_ns, stop_ns);
+  }
+
+  for (auto it : camera_topics_)
+  {
+    std::string dir = joinPath(csv_directory_, it.first);
+    loadCameraData(dir, it.second, kCameraPlaybackDelay, start_ns, stop_ns);
+  }
+
+  buffer_it_ = buffer_.cbegin();
+}
+
+void DataProviderCsv::seek(int64_t stamp_ns)
+{
+  if (stamp_ns < window_start_ns_)
+  {
+    setTimeWindow(stamp_ns, window_stop_ns_);
+  }
+  prefetched_.clear();
+  // Past the stop of the window there is nothing left to play, the window is
+  // kept such that a later seek back into it continues as before.
+  buffer_it_ = buffer_.lower_bound(stamp_ns);
+}
+
+void DataProviderCsv::setDecodePool(const std::shared_ptr<ThreadPool>& pool)
+{
+  prefetched_.clear();
+  decode_pool_ = pool;
+}
+
+ImageBase::Ptr DataProviderCsv::prefetchedImage()
+{
+  // Restart prefetching if images were skipped, e.g. without a callback.
+  if (prefetched_.empty() || prefetched_.front().first != buffer_it_)
+  {
+    prefetched_.clear();
+    prefetch_it_ = buffer_it_;
+  }
+  for (; prefetched_.size() < c_num_prefetched_images
+       && prefetch_it_ != buffer_.cend(); ++prefetch_it_)
+  {
+    if (prefetch_it_->second->type == internal::MeasurementType::Camera)
+    {
+      // The task owns the measurement, the buffer may be reloaded meanwhile.
+      internal::CameraMeasurement::ConstPtr cam_data =
+          std::dynamic_pointer_cast<const internal::CameraMeasurement>(
+            prefetch_it_->second);
+      prefetched_.emplace_back(
+            prefetch_it_,
+            decode_pool_->enqueue([cam_data]() { return cam_data->loadImage(); }));
+    }
+  }
+  CHECK(!prefetched_.empty());
+  DEBUG_CHECK(prefetched_.front().first == buffer_it_);
+  ImageBase::Ptr img = prefetched_.front().second.get();
+  prefetched_.pop_front();
+  return img;
+}
+
+const internal::CsvIndex& DataProviderCsv::csvIndex(
+    const std::string& data_dir,
+    const std::string& header)
+{
+  const std::string data_file = joinPath(data_dir, "data.csv");
+  auto it = csv_indices_.find(data_file);
+  if (it != csv_indices_.end())
+  {
+    return *it->second;
+  }
+
+  auto index = std::make_shared<internal::CsvIndex>();
+  const std::string index_file = internal::csvIndexFile(data_file);
+  const int64_t data_size = internal::fileSize(data_file);
+  if (!internal::loadCsvIndex(index_file, data_size, index.get()))
+  {
+    *index = internal::CsvIndex();
+    internal::buildCsvIndex(data_file, header, index_file, data_size, index.get());
+  }
+  csv_indices_[data_file] = index;
+  return *index;
+}
+
+const internal::CsvIndex* DataProviderCsv::windowIndex(
+    const std::string& data_dir,
+    const std::string& header,
+    int64_t start_ns,
+    int64_t stop_ns)
+{
+  if (start_ns == std::numeric_limits<int64_t>::lowest()
+      && stop_ns == std::numeric_limits<int64_t>::max())
+  {
+    return nullptr;
+  }
+  return &csvIndex(data_dir, header);
+}
+
 bool DataProviderCsv::spinOnce()
 {
   if (buffer_it_ != buffer_.cend())
@@ -177,7 +549,7 @@ bool DataProviderCsv::spinOnce()
         internal::CameraMeasurement::ConstPtr cam_data =
             std::dynamic_pointer_cast<const internal::CameraMeasurement>(data);
         camera_callback_(cam_data->stamp_ns,
-                         cam_data->loadImage(),
+                         decode_pool_ ? prefetchedImage() : cam_data->loadImage(),
                          cam_data->camera_index);
       }
       else
@@ -243,23 +615,43 @@ size_t DataProviderCsv::imuCount() const
 void DataProviderCsv::loadImuData(
     const std::string data_dir,
     const size_t imu_index,
-    const int64_t playback_delay)
+    const int64_t playback_delay,
+    const int64_t start_ns,
+    const int64_t stop_ns)
 {
-  const std::string kHeader = "#timestamp [ns],w_RS_S_x [rad s^-1],w_RS_S_y [rad s^-1],w_RS_S_z [rad s^-1],a_RS_S_x [m s^-2],a_RS_S_y [m s^-2],a_RS_S_z [m s^-2]";
+  const internal::CsvIndex* index = windowIndex(data_dir, kImuHeader, start_ns, stop_ns);
   std::ifstream fs;
-  openFileStreamAndCheckHeader(data_dir+"/data.csv", kHeader, &fs);
+  openFileStreamAndCheckHeader(data_dir+"/data.csv", kImuHeader, &fs);
+  if (index && index->sorted && !index->stamps.empty()
+      && start_ns > std::numeric_limits<int64_t>::lowest())
+  {
+    fs.seekg(index->lowerBoundOffset(start_ns - playback_delay));
+  }
   std::string line;
   size_t i = 0;
   while (std::getline(fs, line))
   {
     std::vector<std::string> items = splitString(line, ',');
     CHECK_EQ(items.size(), 7u);
+    const int64_t stamp = std::stoll(items[0]);
+    if (stamp + playback_delay < start_ns)
+    {
+      continue;
+    }
+    if (stamp + playback_delay > stop_ns)
+    {
+      if (index && index->sorted)
+      {
+        break;
+      }
+      continue;
+    }
     Eigen::Vector3d acc, gyr;
     acc << std::stod(items[4]), std::stod(items[5]), std::stod(items[6]);
     gyr << std::stod(items[1]), std::stod(items[2]), std::stod(items[3]);
     auto imu_measurement =
         std::make_shared<internal::ImuMeasurement>(
-          std::stoll(items[0]), imu_index,
+          stamp, imu_index,
           acc.cast<real_t>(), gyr.cast<real_t>());
 
     buffer_.insert(std::make_pair(
@@ -274,20 +666,40 @@ void DataProviderCsv::loadImuData(
 void DataProviderCsv::loadCameraData(
     const std::string& data_dir,
     const size_t camera_index,
-    int64_t playback_delay)
+    int64_t playback_delay,
+    const int64_t start_ns,
+    const int64_t stop_ns)
 {
-  const std::string kHeader = "#timestamp [ns],filename";
+  const internal::CsvIndex* index = windowIndex(data_dir, kCameraHeader, start_ns, stop_ns);
   std::ifstream fs;
-  openFileStreamAndCheckHeader(data_dir+"/data.csv", kHeader, &fs);
+  openFileStreamAndCheckHeader(data_dir+"/data.csv", kCameraHeader, &fs);
+  if (index && index->sorted && !index->stamps.empty()
+      && start_ns > std::numeric_limits<int64_t>::lowest())
+  {
+    fs.seekg(index->lowerBoundOffset(start_ns - playback_delay));
+  }
   std::string line;
   size_t i = 0;
   while (std::getline(fs, line))
   {
     std::vector<std::string> items = splitString(line, ',');
     CHECK_EQ(items.size(), 2u);
+    const int64_t stamp = std::stoll(items[0]);
+    if (stamp + playback_delay < start_ns)
+    {
+      continue;
+    }
+    if (stamp + playback_delay > stop_ns)
+    {
+      if (index && index->sorted)
+      {
+        break;
+      }
+      continue;
+    }
     auto camera_measurement =
         std::make_shared<internal::CameraMeasurement>(
-          std::stoll(items[0]), camera_index, data_dir + "/data/" + items[1]);
+          stamp, camera_index, data_dir + "/data/" + items[1]);
 
     buffer_.insert(std::make_pair(
                      camera_measurement->stamp_ns + playback_delay,
@@ -27,8 +27,10 @@
 #include <ze/data_provider/data_provider_factory.hpp>
 #include <ze/data_provider/data_provider_base.hpp>
 #include <ze/data_provider/data_provider_csv.hpp>
+#include <ze/data_provider/data_provider_recording.hpp>
 #include <ze/data_provider/data_provider_rosbag.hpp>
 #include <ze/data_provider/data_provider_rostopic.hpp>
+#include <ze/data_provider/data_provider_sim.hpp>
 
 DEFINE_string(bag_filename, "dataset.bag", "Name of bagfile in data_dir.");
 
@@ -52,93 +54,120 @@ DEFINE_string(topic_gyr1, "/gyr1", "");
 DEFINE_string(topic_gyr2, "/gyr2", "");
 DEFINE_string(topic_gyr3, "/gyr3", "");
 
-DEFINE_int32(data_source, 1, " 0: CSV, 1: Rosbag, 2: Rostopic");
+DEFINE_int32(data_source, 1, " 0: CSV, 1: Rosbag, 2: Rostopic, 3: Simulation, 4: Recording");
 DEFINE_string(data_dir, "", "Directory for csv dataset.");
+DEFINE_string(recording_filename, "", "File written by the Recorder.");
+DEFINE_int32(data_source_sim_scenario, 1, "Simulation scenario, 1: Outdoor car with stereo camera.");
+DEFINE_int64(data_source_sim_seed, 0, "Seed of the simulation, negative for a random seed.");
 DEFINE_uint64(num_imus, 1, "Number of IMUs used in the pipeline.");
 DEFINE_uint64(num_accels, 0, "Number of Accelerometers used in the pipeline.");
 DEFINE_uint64(num_gyros, 0, "Number of Gyroscopes used in the pipeline.");
 
 namespace ze {
 
-DataProviderBase::Ptr loadDataProviderFromGflags(const uint32_t num_cams)
+DataProviderSpec dataProviderSpecFromGflags(const uint32_t num_cams)
 {
   CHECK_GT(num_cams, 0u);
   CHECK_LE(num_cams, 4u);
   CHECK_LE(FLAGS_num_imus, 4u);
 
+  DataProviderSpec spec;
+  spec.data_source = FLAGS_data_source;
+  spec.bag_filename = FLAGS_bag_filename;
+  spec.data_dir = FLAGS_data_dir;
+  spec.recording_filename = FLAGS_recording_filename;
+  CHECK_GT(FLAGS_data_source_sim_scenario, 0);
+  spec.sim_scenario = static_cast<uint32_t>(FLAGS_data_source_sim_scenario);
+  spec.sim_seed = FLAGS_data_source_sim_seed;
+
   // Fill camera topics.
-  std::map<std::string, size_t> cam_topics;
-  if (num_cams >= 1) cam_topics[FLAGS_topic_cam0] = 0;
-  if (num_cams >= 2) cam_topics[FLAGS_topic_cam1] = 1;
-  if (num_cams >= 3) cam_topics[FLAGS_topic_cam2] = 2;
-  if (num_cams >= 4) cam_topics[FLAGS_topic_cam3] = 3;
+  if (num_cams >= 1) spec.cam_topics[FLAGS_topic_cam0] = 0;
+  if (num_cams >= 2) spec.cam_topics[FLAGS_topic_cam1] = 1;
+  if (num_cams >= 3) spec.cam_topics[FLAGS_topic_cam2] = 2;
+  if (num_cams >= 4) spec.cam_topics[FLAGS_topic_cam3] = 3;
 
   // Fill imu topics.
-  std::map<std::string, size_t> imu_topics;
-  if (FLAGS_num_imus >= 1) imu_topics[FLAGS_topic_imu0] = 0;
-  if (FLAGS_num_imus >= 2) imu_topics[FLAGS_topic_imu1] = 1;
-  if (FLAGS_num_imus >= 3) imu_topics[FLAGS_topic_imu2] = 2;
-  if (FLAGS_num_imus >= 4) imu_topics[FLAGS_topic_imu3] = 3;
+  if (FLAGS_num_imus >= 1) spec.imu_topics[FLAGS_topic_imu0] = 0;
+  if (FLAGS_num_imus >= 2) spec.imu_topics[FLAGS_topic_imu1] = 1;
+  if (FLAGS_num_imus >= 3) spec.imu_topics[FLAGS_topic_imu2] = 2;
+  if (FLAGS_num_imus >= 4) spec.imu_topics[FLAGS_topic_imu3] = 3;
 
   // Fill accelerometer topics.
-  std::map<std::string, size_t> acc_topics;
-  if (FLAGS_num_accels >= 1) acc_topics[FLAGS_topic_acc0] = 0;
-  if (FLAGS_num_accels >= 2) acc_topics[FLAGS_topic_acc1] = 1;
-  if (FLAGS_num_accels >= 3) acc_topics[FLAGS_topic_acc2] = 2;
-  if (FLAGS_num_accels >= 4) acc_topics[FLAGS_topic_acc3] = 3;
+  if (FLAGS_num_accels >= 1) spec.acc_topics[FLAGS_topic_acc0] = 0;
+  if (FLAGS_num_accels >= 2) spec.acc_topics[FLAGS_topic_acc1] = 1;
+  if (FLAGS_num_accels >= 3) spec.acc_topics[FLAGS_topic_acc2] = 2;
+  if (FLAGS_num_accels >= 4) spec.acc_topics[FLAGS_topic_acc3] = 3;
 
   // Fill gyroscope topics.
-  std::map<std::string, size_t> gyr_topics;
-  if (FLAGS_num_gyros >= 1) gyr_topics[FLAGS_topic_gyr0] = 0;
-  if (FLAGS_num_gyros >= 2) gyr_topics[FLAGS_topic_gyr1] = 1;
-  if (FLAGS_num_gyros >= 3) gyr_topics[FLAGS_topic_gyr2] = 2;
-  if (FLAGS_num_gyros >= 4) gyr_topics[FLAGS_topic_gyr3] = 3;
+  if (FLAGS_num_gyros >= 1) spec.gyr_topics[FLAGS_topic_gyr0] = 0;
+  if (FLAGS_num_gyros >= 2) spec.gyr_topics[FLAGS_topic_gyr1] = 1;
+  if (FLAGS_num_gyros >= 3) spec.gyr_topics[FLAGS_topic_gyr2] = 2;
+  if (FLAGS_num_gyros >= 4) spec.gyr_topics[FLAGS_topic_gyr3] = 3;
+
+  return spec;
+}
+
+DataProviderBase::Ptr loadDataProvider(const DataProviderSpec& spec)
+{
+  // Use the split imu dataprovider
+  const bool split_imu = !spec.acc_topics.empty() && !spec.gyr_topics.empty();
 
   // Create data provider.
   ze::DataProviderBase::Ptr data_provider;
-  switch (FLAGS_data_source)
+  switch (spec.data_source)
   {
     case 0: // CSV
     {
       data_provider.reset(
-            new DataProviderCsv(FLAGS_data_dir, imu_topics, cam_topics));
+            new DataProviderCsv(spec.data_dir, spec.imu_topics, spec.cam_topics));
       break;
     }
     case 1: // Rosbag
     {
-      // Use the split imu dataprovider
-      if (FLAGS_num_accels != 0 && FLAGS_num_gyros != 0)
+      if (split_imu)
       {
-        data_provider.reset(new DataProviderRosbag(FLAGS_bag_filename,
-                                                   acc_topics,
-                                                   gyr_topics,
-                                                   cam_topics));
+        data_provider.reset(new DataProviderRosbag(spec.bag_filename,
+                                                   spec.acc_topics,
+                                                   spec.gyr_topics,
+                                                   spec.cam_topics));
       }
       else
       {
-        data_provider.reset(new DataProviderRosbag(FLAGS_bag_filename,
-                                                   imu_topics,
-                                                   cam_topics));
+        data_provider.reset(new DataProviderRosbag(spec.bag_filename,
+                                                   spec.imu_topics,
+                                                   spec.cam_topics));
       }
       break;
     }
     case 2: // Rostopic
     {
-      // Use the split imu dataprovider
-      if (FLAGS_num_accels != 0 && FLAGS_num_gyros != 0)
+      if (split_imu)
       {
-        data_provider.reset(new DataProviderRostopic(acc_topics,
-                                                     gyr_topics,
-                                                     cam_topics));
+        data_provider.reset(new DataProviderRostopic(spec.acc_topics,
+                                                     spec.gyr_topics,
+                                                     spec.cam_topics));
       }
       else
       {
-        data_provider.reset(new DataProviderRostopic(imu_topics,
-                                                     cam_topics));
+        data_provider.reset(new DataProviderRostopic(spec.imu_topics,
+                                                     spec.cam_topics));
       }
 
       break;
     }
+    case 3: // Simulation
+    {
+      ViSimulator::Ptr sim =
+          createViSimulationScenario(spec.sim_scenario, spec.sim_seed);
+      CHECK_EQ(sim->cameraRig()->size(), spec.cam_topics.size());
+      data_provider.reset(new DataProviderSim(sim));
+      break;
+    }
+    case 4: // Recording
+    {
+      data_provider.reset(new DataProviderRecording(spec.recording_filename));
+      break;
+    }
     default:
     {
       LOG(FATAL) << "Data source not known.";
@@ -149,4 +178,9 @@ DataProviderBase::Ptr loadDataProviderFromGflags(const uint32_t num_cams)
   return data_provider;
 }
 
+DataProviderBase::Ptr loadDataProviderFromGflags(const uint32_t num_cams)
+{
+  return loadDataProvider(dataProviderSpecFromGflags(num_cams));
+}
+
 } // namespace ze
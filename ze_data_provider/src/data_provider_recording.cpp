@@ -0,0 +1,260 @@
+// Copyright (c) 2015-2016, ETH Zurich, Wyss Zurich, Zurich Eye
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the ETH Zurich, Wyss Zurich, Zurich Eye nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL ETH Zurich, Wyss Zurich, Zurich Eye BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#include <ze/data_provider/data_provider_recording.hpp>
+
+#include <algorithm>
+#include <limits>
+
+#include <gflags/gflags.h>
+#include <imp/core/image_base.hpp>
+#include <ze/common/logging.hpp>
+#include <ze/common/thread_pool.hpp>
+#include <ze/common/time_conversions.hpp>
+
+DECLARE_double(data_source_start_time_s);
+DECLARE_double(data_source_stop_time_s);
+
+namespace ze {
+
+DataProviderRecording::DataProviderRecording(const std::string& filename)
+  : DataProviderBase(DataProviderType::Recording)
+  , reader_(std::make_shared<RecordingReader>(filename))
+  , start_ns_(std::numeric_limits<int64_t>::lowest())
+  , stop_ns_(std::numeric_limits<int64_t>::max())
+{
+  imu_cursor_.imu_chunks = true;
+  seek(start_ns_);
+  VLOG(1) << "Loading recording \"" << filename << "\" with "
+          << reader_->chunks().size() << " chunks.";
+  if (FLAGS_data_source_start_time_s != 0.0 ||
+      FLAGS_data_source_stop_time_s != 0.0)
+  {
+    CHECK_GE(FLAGS_data_source_start_time_s, 0);
+    CHECK_GE(FLAGS_data_source_stop_time_s, 0);
+
+    // Like for bags, the window is relative to the first measurement.
+    if (FLAGS_data_source_stop_time_s != 0.0)
+    {
+      stop_ns_ = beginStamp() + secToNanosec(FLAGS_data_source_stop_time_s);
+    }
+    seek(beginStamp() + secToNanosec(FLAGS_data_source_start_time_s));
+    CHECK_LT(start_ns_, stop_ns_) << "Start time exceeds stop time.";
+  }
+}
+
+int64_t DataProviderRecording::beginStamp() const
+{
+  int64_t stamp = std::numeric_limits<int64_t>::max();
+  for (const RecordingChunkInfo& info : reader_->chunks())
+  {
+    stamp = std::min(stamp, info.min_stamp);
+  }
+  return reader_->chunks().empty() ? 0 : stamp;
+}
+
+void DataProviderRecording::seek(int64_t stamp_ns)
+{
+  start_ns_ = stamp_ns;
+  resetCursor(camera_cursor_);
+  resetCursor(imu_cursor_);
+  finished_ = false;
+}
+
+void DataProviderRecording::resetCursor(Cursor& cursor)
+{
+  cursor.payload.clear();
+  cursor.offset = 0u;
+  cursor.has_record = false;
+  cursor.finished = false;
+  cursor.next_chunk = nextChunkInWindow(cursor, 0u);
+}
+
+size_t DataProviderRecording::nextChunkInWindow(const Cursor& cursor, size_t chunk) const
+{
+  // The Recorder writes IMU measurements to chunks without images. Chunks
+  // of either stream are in recording order, but a chunk past the window
+  // doesn't mean that all following are.
+  const std::vector<RecordingChunkInfo>& chunks = reader_->chunks();
+  while (chunk < chunks.size() &&
+         ((chunks[chunk].camera_mask == 0u) != cursor.imu_chunks ||
+          chunks[chunk].max_stamp < start_ns_ || chunks[chunk].min_stamp > stop_ns_))
+  {
+    ++chunk;
+  }
+  return chunk;
+}
+
+void DataProviderRecording::setDecodePool(const std::shared_ptr<ThreadPool>& pool)
+{
+  decode_pool_ = pool;
+}
+
+bool DataProviderRecording::loadNextChunk(Cursor& cursor)
+{
+  if (cursor.next_chunk >= reader_->chunks().size())
+  {
+    return false;
+  }
+  if (cursor.prefetched.valid() && cursor.prefetched_chunk == cursor.next_chunk)
+  {
+    cursor.payload = cursor.prefetched.get();
+  }
+  else
+  {
+    cursor.prefetched = std::future<std::vector<uint8_t>>();
+    reader_->readChunk(cursor.next_chunk, &cursor.payload);
+  }
+  cursor.offset = 0u;
+  cursor.next_chunk = nextChunkInWindow(cursor, cursor.next_chunk + 1u);
+
+  if (decode_pool_ && cursor.next_chunk < reader_->chunks().size())
+  {
+    // The task shares the reader, the data provider may be gone meanwhile.
+    std::shared_ptr<const RecordingReader> reader = reader_;
+    const size_t chunk = cursor.next_chunk;
+    cursor.prefetched_chunk = chunk;
+    cursor.prefetched = decode_pool_->enqueue([reader, chunk]()
+    {
+      std::vector<uint8_t> payload;
+      reader->readChunk(chunk, &payload);
+      return payload;
+    });
+  }
+  return true;
+}
+
+bool DataProviderRecording::peek(Cursor& cursor)
+{
+  while (!cursor.has_record && !cursor.finished)
+  {
+    if (!parseRecord(cursor.payload, &cursor.offset, &cursor.record))
+    {
+      cursor.finished = !loadNextChunk(cursor);
+      continue;
+    }
+    // Measurements of other streams may follow within the window.
+    cursor.has_record =
+        cursor.record.stamp >= start_ns_ && cursor.record.stamp <= stop_ns_;
+  }
+  return cursor.has_record;
+}
+
+bool DataProviderRecording::spinOnce()
+{
+  const bool camera = peek(camera_cursor_);
+  const bool imu = peek(imu_cursor_);
+  if (!camera && !imu)
+  {
+    finished_ = true;
+    return false;
+  }
+  // On equal stamps the IMU measurements go first, such that they are
+  // available when the image arrives.
+  Cursor& cursor =
+      !camera || (imu && imu_cursor_.record.stamp <= camera_cursor_.record.stamp)
+      ? imu_cursor_ : camera_cursor_;
+  cursor.has_record = false;
+  const RecordView& record = cursor.record;
+
+  switch (record.type)
+  {
+    case RecordType::Camera:
+    {
+      if (camera_callback_)
+      {
+        camera_callback_(record.stamp, decodeImageRecord(record), record.index);
+      }
+      else
+      {
+        LOG_FIRST_N(WARNING, 1) << "No camera callback registered but measurements available.";
+      }
+      break;
+    }
+    case RecordType::Imu:
+    {
+      if (imu_callback_)
+      {
+        imu_callback_(record.stamp, record.acc, record.gyr, record.index);
+      }
+      else
+      {
+        LOG_FIRST_N(WARNING, 1) << "No IMU callback registered but measurements available";
+      }
+      break;
+    }
+    case RecordType::Gyro:
+    {
+      if (gyro_callback_)
+      {
+        gyro_callback_(record.stamp, record.gyr, record.index);
+      }
+      else
+      {
+        LOG_FIRST_N(WARNING, 1) << "No Gyroscope callback registered but measurements available";
+      }
+      break;
+    }
+    case RecordType::Accel:
+    {
+      if (accel_callback_)
+      {
+        accel_callback_(record.stamp, record.acc, record.index);
+      }
+      else
+      {
+        LOG_FIRST_N(WARNING, 1) << "No Accelerometer callback registered but measurements available";
+      }
+      break;
+    }
+  }
+  return true;
+}
+
+bool DataProviderRecording::ok() const
+{
+  if (!running_)
+  {
+    VLOG(1) << "Data Provider was paused/terminated.";
+    return false;
+  }
+  if (finished_)
+  {
+    VLOG(1) << "All data processed.";
+    return false;
+  }
+  return true;
+}
+
+size_t DataProviderRecording::cameraCount() const
+{
+  return reader_->cameraCount();
+}
+
+size_t DataProviderRecording::imuCount() const
+{
+  return reader_->imuCount();
+}
+
+} // namespace ze
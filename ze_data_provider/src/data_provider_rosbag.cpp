@@ -40,6 +40,9 @@ DEFINE_double(data_source_start_time_s, 0.0,
               "Start time in seconds");
 DEFINE_double(data_source_stop_time_s, 0.0,
               "Stop time in seconds");
+DEFINE_bool(data_source_rosbag_read_ahead, false,
+            "Read, deserialize and convert bag messages on a background "
+            "thread, such that spinOnce only dispatches callbacks.");
 
 namespace ze {
 
@@ -51,6 +54,7 @@ DataProviderRosbag::DataProviderRosbag(
   , img_topic_camidx_map_(img_topic_camidx_map)
   , imu_topic_imuidx_map_(imu_topic_imuidx_map)
   , uses_split_messages_(false)
+  , read_ahead_(FLAGS_data_source_rosbag_read_ahead)
 {
   VLOG(1) << "Create Dataprovider for synchronized Gyro/Accel";
   //! @todo: Display number of messages per topic in the beginning.
@@ -90,6 +94,7 @@ DataProviderRosbag::DataProviderRosbag(
   , accel_topic_imuidx_map_(accel_topic_imuidx_map)
   , gyro_topic_imuidx_map_(gyro_topic_imuidx_map)
   , uses_split_messages_(true)
+  , read_ahead_(FLAGS_data_source_rosbag_read_ahead)
 {
   VLOG(1) << "Create Dataprovider for UN-synchronized Gyro/Accel";
   //! @todo: Check if topics exists.
@@ -245,174 +250,229 @@ size_t DataProviderRosbag::imuCount() const
   return imu_topic_imuidx_map_.size();
 }
 
+DataProviderRosbag::~DataProviderRosbag()
+{
+  stopReadAhead();
+}
+
 bool DataProviderRosbag::spinOnce()
 {
-  if (bag_view_it_ != bag_view_->end())
+  if (!read_ahead_)
   {
-    const rosbag::MessageInstance m = *bag_view_it_;
-
-    // Camera Messages:
-    const sensor_msgs::ImageConstPtr m_img = m.instantiate<sensor_msgs::Image>();
-    if (m_img && camera_callback_)
+    if (bag_view_it_ == bag_view_->end())
     {
-      if (!cameraSpin(m_img, m))
-      {
-        return false;
-      }
-    }
-    else if (m_img && !camera_callback_)
-    {
-      LOG_FIRST_N(WARNING, 1) << "No camera callback registered but measurements available";
+      return false;
     }
+    const DecodedMessage msg = decode(*bag_view_it_);
+    ++bag_view_it_;
+    return dispatch(msg);
+  }
+
+  if (end_of_bag_)
+  {
+    return false;
+  }
+  if (!read_ahead_thread_.joinable())
+  {
+    // Started on the first spin, such that all callbacks are registered.
+    read_ahead_queue_.reset(new ReadAheadQueue);
+    read_ahead_thread_ = std::thread(&DataProviderRosbag::readAhead, this);
+  }
+  const DecodedMessage msg = read_ahead_queue_->read();
+  if (msg.type == DecodedMessage::Type::EndOfBag)
+  {
+    end_of_bag_ = true;
+    return false;
+  }
+  return dispatch(msg);
+}
 
-    // Imu Messages:
-    const sensor_msgs::ImuConstPtr m_imu = m.instantiate<sensor_msgs::Imu>();
-    if (m_imu && imu_callback_)
+void DataProviderRosbag::readAhead()
+{
+  for (; bag_view_it_ != bag_view_->end() && !read_ahead_stop_; ++bag_view_it_)
+  {
+    DecodedMessage msg = decode(*bag_view_it_);
+    while (!read_ahead_stop_ && !read_ahead_queue_->timedWrite(msg, 10u))
+    {}
+  }
+  DecodedMessage end;
+  end.type = DecodedMessage::Type::EndOfBag;
+  while (!read_ahead_stop_ && !read_ahead_queue_->timedWrite(end, 10u))
+  {}
+}
+
+void DataProviderRosbag::stopReadAhead()
+{
+  read_ahead_stop_ = true;
+  if (read_ahead_thread_.joinable())
+  {
+    read_ahead_thread_.join();
+  }
+}
+
+DataProviderRosbag::DecodedMessage DataProviderRosbag::decode(
+    const rosbag::MessageInstance& m) const
+{
+  DecodedMessage msg;
+
+  // Camera Messages:
+  const sensor_msgs::ImagePtr m_img = m.instantiate<sensor_msgs::Image>();
+  if (m_img)
+  {
+    auto it = img_topic_camidx_map_.find(m.getTopic());
+    if (it != img_topic_camidx_map_.end())
     {
-      if (!imuSpin(m_imu, m))
+      msg.type = DecodedMessage::Type::Camera;
+      msg.stamp = m_img->header.stamp.toNSec();
+      msg.idx = it->second;
+      if (camera_callback_)
       {
-        return false;
+        msg.img = toImageCpu(m_img);
       }
     }
-    else if (m_imu && !imu_callback_)
+    else
     {
-      LOG_FIRST_N(WARNING, 1) << "No IMU callback registered but measurements available";
+      LOG_FIRST_N(WARNING, 1) << "Topic in bag that is not subscribed: " << m.getTopic();
     }
+    return msg;
+  }
 
-    // Accelerometer Messages:
-    const ze_ros_msg::bmx055_accConstPtr m_acc =
-        m.instantiate<ze_ros_msg::bmx055_acc>();
-    if (m_acc && accel_callback_)
+  // Imu Messages:
+  const sensor_msgs::ImuConstPtr m_imu = m.instantiate<sensor_msgs::Imu>();
+  if (m_imu)
+  {
+    auto it = imu_topic_imuidx_map_.find(m.getTopic());
+    if (it != imu_topic_imuidx_map_.end())
     {
-      if (!accelSpin(m_acc, m))
-      {
-        return false;
-      }
+      msg.type = DecodedMessage::Type::Imu;
+      msg.stamp = m_imu->header.stamp.toNSec();
+      msg.idx = it->second;
+      msg.gyr = Vector3(
+            m_imu->angular_velocity.x,
+            m_imu->angular_velocity.y,
+            m_imu->angular_velocity.z);
+      msg.acc = Vector3(
+            m_imu->linear_acceleration.x,
+            m_imu->linear_acceleration.y,
+            m_imu->linear_acceleration.z);
     }
-    else if (m_acc && !accel_callback_)
+    else
     {
-      LOG_FIRST_N(WARNING, 1) << "No Accelerometer callback registered but"
-                              << "measurements available";
+      LOG_FIRST_N(WARNING, 1) << "Topic in bag that is not subscribed: " << m.getTopic();
     }
+    return msg;
+  }
 
-    // Gyroscope Messages:
-    const ze_ros_msg::bmx055_gyrConstPtr m_gyr =
-        m.instantiate<ze_ros_msg::bmx055_gyr>();
-    if (m_gyr && gyro_callback_)
+  // Accelerometer Messages:
+  const ze_ros_msg::bmx055_accConstPtr m_acc =
+      m.instantiate<ze_ros_msg::bmx055_acc>();
+  if (m_acc)
+  {
+    auto it = accel_topic_imuidx_map_.find(m.getTopic());
+    if (it != accel_topic_imuidx_map_.end())
     {
-      if(!gyroSpin(m_gyr, m))
-      {
-        return false;
-      }
+      msg.type = DecodedMessage::Type::Accel;
+      msg.stamp = m_acc->header.stamp.toNSec();
+      msg.idx = it->second;
+      msg.acc = Vector3(
+            m_acc->linear_acceleration.x,
+            m_acc->linear_acceleration.y,
+            m_acc->linear_acceleration.z);
     }
-    else if (m_gyr && !gyro_callback_)
+    else
     {
-      LOG_FIRST_N(WARNING, 1) << "No Gyroscope callback registered but"
-                              << "measurements available";
+      LOG_FIRST_N(WARNING, 1) << "Topic in bag that is not subscribed: " << m.getTopic();
     }
-
-    ++bag_view_it_;
-    return true;
+    return msg;
   }
-  return false;
-}
 
-bool DataProviderRosbag::cameraSpin(sensor_msgs::ImageConstPtr m_img,
-                                    const rosbag::MessageInstance& m)
-{
-  auto it = img_topic_camidx_map_.find(m.getTopic());
-  if (it != img_topic_camidx_map_.end())
+  // Gyroscope Messages:
+  const ze_ros_msg::bmx055_gyrConstPtr m_gyr =
+      m.instantiate<ze_ros_msg::bmx055_gyr>();
+  if (m_gyr)
   {
-    ++n_processed_images_;
-    if (FLAGS_data_source_stop_after_n_frames > 0
-        && n_processed_images_ > FLAGS_data_source_stop_after_n_frames)
+    auto it = gyro_topic_imuidx_map_.find(m.getTopic());
+    if (it != gyro_topic_imuidx_map_.end())
     {
-      LOG(WARNING) << "Data source has reached max number of desired frames.";
-      running_ = false;
-      return false;
+      msg.type = DecodedMessage::Type::Gyro;
+      msg.stamp = m_gyr->header.stamp.toNSec();
+      msg.idx = it->second;
+      msg.gyr = Vector3(
+            m_gyr->angular_velocity.x,
+            m_gyr->angular_velocity.y,
+            m_gyr->angular_velocity.z);
+    }
+    else
+    {
+      LOG_FIRST_N(WARNING, 1) << "Topic in bag that is not subscribed: " << m.getTopic();
     }
-
-    ze::ImageBase::Ptr img = toImageCpu(*m_img);
-    camera_callback_(m_img->header.stamp.toNSec(), img, it->second);
-  }
-  else
-  {
-    LOG_FIRST_N(WARNING, 1) << "Topic in bag that is not subscribed: " << m.getTopic();
-  }
-
-  return true;
-}
-
-bool DataProviderRosbag::imuSpin(sensor_msgs::ImuConstPtr m_imu,
-                                 const rosbag::MessageInstance& m)
-{
-  auto it = imu_topic_imuidx_map_.find(m.getTopic());
-  if (it != imu_topic_imuidx_map_.end())
-  {
-    const Vector3 gyr(
-          m_imu->angular_velocity.x,
-          m_imu->angular_velocity.y,
-          m_imu->angular_velocity.z);
-    const Vector3 acc(
-          m_imu->linear_acceleration.x,
-          m_imu->linear_acceleration.y,
-          m_imu->linear_acceleration.z);
-    int64_t stamp = m_imu->header.stamp.toNSec();
-    CHECK_GT(stamp, last_imu_stamp_);
-    imu_callback_(stamp, acc, gyr, it->second);
-    last_imu_stamp_ = stamp;
-  }
-  else
-  {
-    LOG_FIRST_N(WARNING, 1) << "Topic in bag that is not subscribed: " << m.getTopic();
-  }
-
-  return true;
-}
-
-bool DataProviderRosbag::accelSpin(ze_ros_msg::bmx055_accConstPtr m_acc,
-                                   const rosbag::MessageInstance& m)
-{
-  auto it = accel_topic_imuidx_map_.find(m.getTopic());
-  if (it != accel_topic_imuidx_map_.end())
-  {
-    const Vector3 acc(
-          m_acc->linear_acceleration.x,
-          m_acc->linear_acceleration.y,
-          m_acc->linear_acceleration.z);
-    int64_t stamp = m_acc->header.stamp.toNSec();
-    CHECK_GT(stamp, last_acc_stamp_);
-    accel_callback_(stamp, acc, it->second);
-    last_acc_stamp_ = stamp;
-  }
-  else
-  {
-    LOG_FIRST_N(WARNING, 1) << "Topic in bag that is not subscribed: " << m.getTopic();
   }
-
-  return true;
+  return msg;
 }
 
-bool DataProviderRosbag::gyroSpin(ze_ros_msg::bmx055_gyrConstPtr m_gyr,
-                                  const rosbag::MessageInstance& m)
+bool DataProviderRosbag::dispatch(const DecodedMessage& msg)
 {
-  auto it = gyro_topic_imuidx_map_.find(m.getTopic());
-  if (it != gyro_topic_imuidx_map_.end())
+  switch (msg.type)
   {
-    const Vector3 gyr(
-          m_gyr->angular_velocity.x,
-          m_gyr->angular_velocity.y,
-          m_gyr->angular_velocity.z);
-    int64_t stamp = m_gyr->header.stamp.toNSec();
-    CHECK_GT(stamp, last_gyr_stamp_);
-    gyro_callback_(stamp, gyr, it->second);
-    last_gyr_stamp_ = stamp;
-  }
-  else
-  {
-    LOG_FIRST_N(WARNING, 1) << "Topic in bag that is not subscribed: " << m.getTopic();
+    case DecodedMessage::Type::Camera:
+    {
+      if (!camera_callback_)
+      {
+        LOG_FIRST_N(WARNING, 1) << "No camera callback registered but measurements available";
+        break;
+      }
+      ++n_processed_images_;
+      if (FLAGS_data_source_stop_after_n_frames > 0
+          && n_processed_images_ > FLAGS_data_source_stop_after_n_frames)
+      {
+        LOG(WARNING) << "Data source has reached max number of desired frames.";
+        running_ = false;
+        return false;
+      }
+      camera_callback_(msg.stamp, msg.img, msg.idx);
+      break;
+    }
+    case DecodedMessage::Type::Imu:
+    {
+      if (!imu_callback_)
+      {
+        LOG_FIRST_N(WARNING, 1) << "No IMU callback registered but measurements available";
+        break;
+      }
+      CHECK_GT(msg.stamp, last_imu_stamp_);
+      imu_callback_(msg.stamp, msg.acc, msg.gyr, msg.idx);
+      last_imu_stamp_ = msg.stamp;
+      break;
+    }
+    case DecodedMessage::Type::Accel:
+    {
+      if (!accel_callback_)
+      {
+        LOG_FIRST_N(WARNING, 1) << "No Accelerometer callback registered but"
+                                << "measurements available";
+        break;
+      }
+      CHECK_GT(msg.stamp, last_acc_stamp_);
+      accel_callback_(msg.stamp, msg.acc, msg.idx);
+      last_acc_stamp_ = msg.stamp;
+      break;
+    }
+    case DecodedMessage::Type::Gyro:
+    {
+      if (!gyro_callback_)
+      {
+        LOG_FIRST_N(WARNING, 1) << "No Gyroscope callback registered but"
+                                << "measurements available";
+        break;
+      }
+      CHECK_GT(msg.stamp, last_gyr_stamp_);
+      gyro_callback_(msg.stamp, msg.gyr, msg.idx);
+      last_gyr_stamp_ = msg.stamp;
+      break;
+    }
+    default:
+      break;
   }
-
   return true;
 }
 
@@ -423,7 +483,8 @@ bool DataProviderRosbag::ok() const
     VLOG(1) << "Data Provider was paused/terminated.";
     return false;
   }
-  if (bag_view_it_ == bag_view_->end())
+  // With read-ahead, the iterator belongs to the reader thread.
+  if (read_ahead_ ? end_of_bag_ : bag_view_it_ == bag_view_->end())
   {
     VLOG(1) << "All data processed.";
     return false;
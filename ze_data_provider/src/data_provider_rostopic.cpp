@@ -159,6 +159,10 @@ void DataProviderRostopic::imgCallback(
     return;
   }
 
+  // The message is shared with other subscribers of the topic, so the
+  // zero-copy toImageCpu() only gives a read-only image. The camera callback
+  // takes a mutable image, hence every frame is copied here. Passing the
+  // read-only image on would change CameraCallback for all data providers.
   ze::ImageBase::Ptr img = toImageCpu(*m_img);
   camera_callback_(m_img->header.stamp.toNSec(), img, cam_idx);
 }
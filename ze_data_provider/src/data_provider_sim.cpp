@@ -0,0 +1,241 @@
+// Copyright (c) 2015-2016, ETH Zurich, Wyss Zurich, Zurich Eye
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the ETH Zurich, Wyss Zurich, Zurich Eye nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL ETH Zurich, Wyss Zurich, Zurich Eye BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <ze/data_provider/data_provider_sim.hpp>
+
+#include <algorithm>
+#include <thread>
+
+#include <imp/core/image_pool.hpp>
+#include <ze/cameras/camera_rig.hpp>
+#include <ze/common/logging.hpp>
+#include <ze/common/time_conversions.hpp>
+
+namespace ze {
+
+DataProviderSim::DataProviderSim(
+    const ViSimulator::Ptr& simulator,
+    const DataProviderSimOptions& options)
+  : DataProviderBase(DataProviderType::Sim)
+  , simulator_(simulator)
+  , options_(options)
+{
+  CHECK(simulator_);
+  CHECK(!options_.loop || options_.num_buffered_frames > 0u)
+      << "Looping requires buffered frames.";
+  CHECK(!options_.render_images || simulator_->cameraRig())
+      << "Rendering images requires a camera rig.";
+
+  if (options_.num_buffered_frames > 0u)
+  {
+    VLOG(1) << "Simulating " << options_.num_buffered_frames << " frames ...";
+    buffer_.reserve(options_.num_buffered_frames);
+    ViSensorData data;
+    bool success = true;
+    while (buffer_.size() < options_.num_buffered_frames)
+    {
+      std::tie(data, success) = simulator_->getMeasurement();
+      if (!success)
+      {
+        break;
+      }
+      buffer_.push_back(data);
+    }
+    VLOG(1) << "done, buffered " << buffer_.size() << " frames.";
+    CHECK(!buffer_.empty()) << "Simulator did not provide any measurements.";
+  }
+}
+
+bool DataProviderSim::spinOnce()
+{
+  if (!ok())
+  {
+    return false;
+  }
+
+  ViSensorData data;
+  if (!nextFrame(data))
+  {
+    finished_ = true;
+    return false;
+  }
+
+  ++num_frames_;
+  if (options_.real_time_factor > 0.0)
+  {
+    waitUntil(data.timestamp);
+  }
+  publish(data);
+
+  if (options_.max_num_frames > 0u && num_frames_ >= options_.max_num_frames)
+  {
+    finished_ = true;
+  }
+  return true;
+}
+
+bool DataProviderSim::nextFrame(ViSensorData& data)
+{
+  if (buffer_.empty())
+  {
+    bool success;
+    std::tie(data, success) = simulator_->getMeasurement();
+    return success;
+  }
+
+  if (buffer_idx_ == buffer_.size())
+  {
+    if (!options_.loop)
+    {
+      return false;
+    }
+    // Start the next loop one camera period after the last frame.
+    const ViSensorData& first = buffer_.front();
+    const ViSensorData& last = buffer_.back();
+    const int64_t cam_dt = first.imu_stamps(first.imu_stamps.size() - 1)
+                           - first.imu_stamps(0);
+    stamp_offset_ += last.timestamp + cam_dt - first.timestamp;
+    buffer_idx_ = 0u;
+  }
+
+  data = buffer_[buffer_idx_++];
+  if (stamp_offset_ != 0)
+  {
+    data.timestamp += stamp_offset_;
+    data.imu_stamps.array() += stamp_offset_;
+  }
+  return true;
+}
+
+void DataProviderSim::publish(const ViSensorData& data)
+{
+  if (imu_callback_)
+  {
+    for (int i = 0; i < data.imu_stamps.size(); ++i)
+    {
+      // Consecutive frames share the IMU measurement at the camera stamp.
+      const int64_t stamp = data.imu_stamps(i);
+      if (stamp <= last_imu_stamp_)
+      {
+        continue;
+      }
+      imu_callback_(stamp,
+                    data.imu_measurements.col(i).head<3>(),
+                    data.imu_measurements.col(i).tail<3>(),
+                    0u);
+      last_imu_stamp_ = stamp;
+    }
+  }
+  else
+  {
+    LOG_FIRST_N(WARNING, 1) << "No IMU callback registered but measurements available";
+  }
+
+  for (size_t cam_idx = 0u; cam_idx < data.cam_measurements.size(); ++cam_idx)
+  {
+    const CameraMeasurements& m = data.cam_measurements[cam_idx];
+    if (feature_track_callback_)
+    {
+      feature_track_callback_(data.timestamp, m, cam_idx);
+    }
+    if (camera_callback_ && options_.render_images)
+    {
+      camera_callback_(data.timestamp, renderImage(m, cam_idx), cam_idx);
+    }
+  }
+}
+
+std::shared_ptr<ImageBase> DataProviderSim::renderImage(
+    const CameraMeasurements& measurements, uint32_t cam_idx) const
+{
+  const Size2u size = simulator_->cameraRig()->at(cam_idx).size();
+  ImageRaw8uC1::Ptr img = ImagePool::global().acquire<Pixel8uC1>(size, PixelOrder::gray);
+  img->setValue(Pixel8uC1(0u));
+  const ImageView<Pixel8uC1> img_view = img->view();
+
+  // Draw every keypoint as a 3x3 blob.
+  const int w = static_cast<int>(size.width());
+  const int h = static_cast<int>(size.height());
+  for (int i = 0; i < measurements.keypoints_.cols(); ++i)
+  {
+    const int u = static_cast<int>(measurements.keypoints_(0, i) + 0.5);
+    const int v = static_cast<int>(measurements.keypoints_(1, i) + 0.5);
+    for (int y = std::max(v - 1, 0); y <= std::min(v + 1, h - 1); ++y)
+    {
+      for (int x = std::max(u - 1, 0); x <= std::min(u + 1, w - 1); ++x)
+      {
+        img_view(x, y) = Pixel8uC1(255u);
+      }
+    }
+  }
+  return img;
+}
+
+void DataProviderSim::waitUntil(int64_t stamp)
+{
+  if (first_stamp_ < 0)
+  {
+    first_stamp_ = stamp;
+    wall_start_ = std::chrono::steady_clock::now();
+    return;
+  }
+  const int64_t wall_dt_ns = static_cast<int64_t>(
+        (stamp - first_stamp_) / options_.real_time_factor);
+  std::this_thread::sleep_until(
+        wall_start_ + std::chrono::nanoseconds(wall_dt_ns));
+}
+
+bool DataProviderSim::ok() const
+{
+  if (!running_)
+  {
+    VLOG(1) << "Data Provider was paused/terminated.";
+    return false;
+  }
+  if (finished_)
+  {
+    VLOG(1) << "All data processed.";
+    return false;
+  }
+  return true;
+}
+
+size_t DataProviderSim::imuCount() const
+{
+  return 1u;
+}
+
+size_t DataProviderSim::cameraCount() const
+{
+  return simulator_->cameraRig() ? simulator_->cameraRig()->size() : 0u;
+}
+
+void DataProviderSim::registerFeatureTrackCallback(
+    const FeatureTrackCallback& callback)
+{
+  feature_track_callback_ = callback;
+}
+
+} // namespace ze
@@ -0,0 +1,186 @@
+// Copyright (c) 2015-2016, ETH Zurich, Wyss Zurich, Zurich Eye
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the ETH Zurich, Wyss Zurich, Zurich Eye nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL ETH Zurich, Wyss Zurich, Zurich Eye BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <ze/data_provider/ingest_statistics.hpp>
+
+#include <ze/common/time_conversions.hpp>
+
+namespace ze {
+
+// -----------------------------------------------------------------------------
+real_t DurationHistogram::meanMs() const
+{
+  const uint64_t n = count();
+  return n > 0u
+      ? nanosecToMillisecTrunc(sum_ns_.load(std::memory_order_relaxed)) / n
+      : 0.0;
+}
+
+real_t DurationHistogram::maxMs() const
+{
+  return nanosecToMillisecTrunc(max_ns_.load(std::memory_order_relaxed));
+}
+
+real_t DurationHistogram::quantileMs(real_t q) const
+{
+  const uint64_t n = count();
+  if (n == 0u)
+  {
+    return 0.0;
+  }
+  const real_t target = q * n;
+  uint64_t accumulated = 0u;
+  for (int i = 0; i < c_num_bins; ++i)
+  {
+    accumulated += binCount(i);
+    if (accumulated >= target && accumulated > 0u)
+    {
+      return nanosecToMillisecTrunc(int64_t{1} << (i + 1));
+    }
+  }
+  return maxMs();
+}
+
+void DurationHistogram::reset()
+{
+  for (std::atomic<uint64_t>& bin : bins_)
+  {
+    bin.store(0u, std::memory_order_relaxed);
+  }
+  count_.store(0u, std::memory_order_relaxed);
+  sum_ns_.store(0, std::memory_order_relaxed);
+  max_ns_.store(0, std::memory_order_relaxed);
+}
+
+std::ostream& operator<<(std::ostream& out, const DurationHistogram& hist)
+{
+  out << "{num_samples: " << hist.count()
+      << ", mean_ms: " << hist.meanMs()
+      << ", p50_ms: " << hist.quantileMs(0.5)
+      << ", p99_ms: " << hist.quantileMs(0.99)
+      << ", max_ms: " << hist.maxMs() << "}";
+  return out;
+}
+
+// -----------------------------------------------------------------------------
+real_t StreamStatistics::rateHz() const
+{
+  const uint64_t n = numMessages();
+  const int64_t dt = last_arrival_ns_.load(std::memory_order_relaxed)
+                     - first_arrival_ns_.load(std::memory_order_relaxed);
+  if (n < 2u || dt <= 0)
+  {
+    return 0.0;
+  }
+  return (n - 1u) / nanosecToSecTrunc(dt);
+}
+
+void StreamStatistics::reset()
+{
+  inter_arrival.reset();
+  callback_duration.reset();
+  num_messages_.store(0u, std::memory_order_relaxed);
+  first_arrival_ns_.store(-1, std::memory_order_relaxed);
+  last_arrival_ns_.store(-1, std::memory_order_relaxed);
+}
+
+std::ostream& operator<<(std::ostream& out, const StreamStatistics& stats)
+{
+  out << "  num_messages: " << stats.numMessages() << "\n"
+      << "  rate_hz: " << stats.rateHz() << "\n"
+      << "  inter_arrival: " << stats.inter_arrival << "\n"
+      << "  callback_duration: " << stats.callback_duration << "\n";
+  return out;
+}
+
+// -----------------------------------------------------------------------------
+void IngestStatistics::reset()
+{
+  for (auto& streams : streams_)
+  {
+    for (StreamStatistics& stream : streams)
+    {
+      stream.reset();
+    }
+  }
+}
+
+std::ostream& operator<<(std::ostream& out, const IngestStatistics& stats)
+{
+  const std::array<std::pair<IngestStreamType, const char*>, 4> types {{
+      { IngestStreamType::Imu, "imu" },
+      { IngestStreamType::Camera, "cam" },
+      { IngestStreamType::Gyro, "gyr" },
+      { IngestStreamType::Accel, "acc" } }};
+  for (const auto& type : types)
+  {
+    for (uint32_t i = 0u; i < IngestStatistics::c_max_streams_per_type; ++i)
+    {
+      const StreamStatistics* stream = stats.stream(type.first, i);
+      if (stream->numMessages() > 0u)
+      {
+        out << type.second << i << ":\n" << *stream;
+      }
+    }
+  }
+  return out;
+}
+
+// -----------------------------------------------------------------------------
+void FillLevel::reset()
+{
+  last_.store(0u, std::memory_order_relaxed);
+  max_.store(0u, std::memory_order_relaxed);
+  capacity_.store(0u, std::memory_order_relaxed);
+}
+
+void SynchronizerStatistics::reset()
+{
+  bundle_latency.reset();
+  callback_duration.reset();
+  for (FillLevel& fill : imu_fill)
+  {
+    fill.reset();
+  }
+}
+
+std::ostream& operator<<(std::ostream& out, const SynchronizerStatistics& stats)
+{
+  out << "bundle_latency: " << stats.bundle_latency << "\n"
+      << "bundle_callback_duration: " << stats.callback_duration << "\n";
+  for (size_t i = 0u; i < stats.imu_fill.size(); ++i)
+  {
+    const FillLevel& fill = stats.imu_fill[i];
+    if (fill.capacity() > 0u)
+    {
+      out << "imu" << i << "_buffer_fill: {last: " << fill.last()
+          << ", max: " << fill.max()
+          << ", capacity: " << fill.capacity() << "}\n";
+    }
+  }
+  return out;
+}
+
+} // namespace ze
@@ -0,0 +1,269 @@
+// Copyright (c) 2015-2016, ETH Zurich, Wyss Zurich, Zurich Eye
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the ETH Zurich, Wyss Zurich, Zurich Eye nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL ETH Zurich, Wyss Zurich, Zurich Eye BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <ze/data_provider/measurement_queue.hpp>
+
+#include <ze/common/logging.hpp>
+
+namespace ze {
+
+MeasurementQueue::MeasurementQueue(size_t capacity, QueueOverflowPolicy policy)
+  : buffer_(capacity)
+  , policy_(policy)
+{
+  CHECK_GT(capacity, 0u);
+  worker_ = std::thread(&MeasurementQueue::process, this);
+}
+
+MeasurementQueue::~MeasurementQueue()
+{
+  shutdown();
+}
+
+ImuCallback MeasurementQueue::wrapImuCallback(const ImuCallback& callback)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  imu_callback_ = callback;
+  return [this](int64_t stamp, const Vector3& acc, const Vector3& gyr,
+                uint32_t imu_idx)
+  {
+    Measurement m;
+    m.type = MeasurementType::Imu;
+    m.stamp = stamp;
+    m.acc = acc;
+    m.gyr = gyr;
+    m.idx = imu_idx;
+    push(std::move(m));
+  };
+}
+
+GyroCallback MeasurementQueue::wrapGyroCallback(const GyroCallback& callback)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  gyro_callback_ = callback;
+  return [this](int64_t stamp, const Vector3& gyr, uint32_t imu_idx)
+  {
+    Measurement m;
+    m.type = MeasurementType::Gyro;
+    m.stamp = stamp;
+    m.gyr = gyr;
+    m.idx = imu_idx;
+    push(std::move(m));
+  };
+}
+
+AccelCallback MeasurementQueue::wrapAccelCallback(const AccelCallback& callback)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  accel_callback_ = callback;
+  return [this](int64_t stamp, const Vector3& acc, uint32_t imu_idx)
+  {
+    Measurement m;
+    m.type = MeasurementType::Accel;
+    m.stamp = stamp;
+    m.acc = acc;
+    m.idx = imu_idx;
+    push(std::move(m));
+  };
+}
+
+CameraCallback MeasurementQueue::wrapCameraCallback(const CameraCallback& callback)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  camera_callback_ = callback;
+  return [this](int64_t stamp, const std::shared_ptr<ImageBase>& img,
+                uint32_t cam_idx)
+  {
+    Measurement m;
+    m.type = MeasurementType::Camera;
+    m.stamp = stamp;
+    m.img = img;
+    m.idx = cam_idx;
+    push(std::move(m));
+  };
+}
+
+void MeasurementQueue::push(Measurement&& measurement)
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+  ++stats_.num_enqueued;
+
+  if (size_ == buffer_.size())
+  {
+    switch (policy_)
+    {
+      case QueueOverflowPolicy::DropOldest:
+      {
+        erase(0u);
+        ++stats_.num_dropped;
+        break;
+      }
+      case QueueOverflowPolicy::CoalesceImages:
+      {
+        if (measurement.type == MeasurementType::Camera)
+        {
+          int i = findQueuedImage(measurement.idx);
+          if (i >= 0)
+          {
+            erase(i);
+            ++stats_.num_coalesced;
+            break;
+          }
+        }
+        // Fall back to blocking.
+        not_full_.wait(lock, [this] { return size_ < buffer_.size() || !running_; });
+        break;
+      }
+      case QueueOverflowPolicy::Block:
+      {
+        not_full_.wait(lock, [this] { return size_ < buffer_.size() || !running_; });
+        break;
+      }
+    }
+    if (!running_)
+    {
+      return;
+    }
+  }
+
+  buffer_[(head_ + size_) % buffer_.size()] = std::move(measurement);
+  ++size_;
+  stats_.max_depth = std::max(stats_.max_depth, size_);
+  lock.unlock();
+  not_empty_.notify_one();
+}
+
+int MeasurementQueue::findQueuedImage(uint32_t cam_idx) const
+{
+  for (size_t i = 0u; i < size_; ++i)
+  {
+    const Measurement& m = buffer_[(head_ + i) % buffer_.size()];
+    if (m.type == MeasurementType::Camera && m.idx == cam_idx)
+    {
+      return i;
+    }
+  }
+  return -1;
+}
+
+void MeasurementQueue::erase(size_t i)
+{
+  DEBUG_CHECK_LT(i, size_);
+  // Shift all newer elements one slot towards the front.
+  for (; i + 1u < size_; ++i)
+  {
+    buffer_[(head_ + i) % buffer_.size()] =
+        std::move(buffer_[(head_ + i + 1u) % buffer_.size()]);
+  }
+  buffer_[(head_ + size_ - 1u) % buffer_.size()].img.reset();
+  --size_;
+}
+
+void MeasurementQueue::process()
+{
+  Measurement m;
+  while (true)
+  {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      processing_ = false;
+      if (size_ == 0u)
+      {
+        idle_.notify_all();
+      }
+      not_empty_.wait(lock, [this] { return size_ > 0u || !running_; });
+      if (!running_)
+      {
+        return;
+      }
+      m = std::move(buffer_[head_]);
+      buffer_[head_].img.reset();
+      head_ = (head_ + 1u) % buffer_.size();
+      --size_;
+      processing_ = true;
+    }
+    not_full_.notify_one();
+
+    switch (m.type)
+    {
+      case MeasurementType::Imu:
+        if (imu_callback_)
+        {
+          imu_callback_(m.stamp, m.acc, m.gyr, m.idx);
+        }
+        break;
+      case MeasurementType::Gyro:
+        if (gyro_callback_)
+        {
+          gyro_callback_(m.stamp, m.gyr, m.idx);
+        }
+        break;
+      case MeasurementType::Accel:
+        if (accel_callback_)
+        {
+          accel_callback_(m.stamp, m.acc, m.idx);
+        }
+        break;
+      case MeasurementType::Camera:
+        if (camera_callback_)
+        {
+          camera_callback_(m.stamp, m.img, m.idx);
+        }
+        break;
+    }
+    m.img.reset();
+  }
+}
+
+void MeasurementQueue::flush()
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+  idle_.wait(lock, [this] { return (size_ == 0u && !processing_) || !running_; });
+}
+
+void MeasurementQueue::shutdown()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    running_ = false;
+  }
+  not_empty_.notify_all();
+  not_full_.notify_all();
+  idle_.notify_all();
+  if (worker_.joinable())
+  {
+    worker_.join();
+  }
+}
+
+MeasurementQueueStats MeasurementQueue::stats() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  MeasurementQueueStats stats = stats_;
+  stats.depth = size_;
+  return stats;
+}
+
+} // namespace ze
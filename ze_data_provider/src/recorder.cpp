@@ -0,0 +1,472 @@
+// Copyright (c) 2015-2016, ETH Zurich, Wyss Zurich, Zurich Eye
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the ETH Zurich, Wyss Zurich, Zurich Eye nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL ETH Zurich, Wyss Zurich, Zurich Eye BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#include <ze/data_provider/recorder.hpp>
+
+#include <limits>
+
+#include <ze/common/logging.hpp>
+#include <ze/common/time_conversions.hpp>
+
+namespace ze {
+
+namespace {
+
+//! Record sizes of IMU measurements with 6 and 3 values.
+constexpr size_t c_imu_record_bytes = 16u + 6u * sizeof(double);
+constexpr size_t c_gyro_record_bytes = 16u + 3u * sizeof(double);
+
+} // anonymous namespace
+
+Recorder::Recorder(const std::string& filename)
+  : Recorder(filename, Options())
+{}
+
+Recorder::Recorder(const std::string& filename, const Options& options)
+  : options_(options)
+  , writer_(filename)
+{
+  CHECK_GT(options_.num_threads, 0u);
+  CHECK_GT(options_.chunk_bytes, 0u);
+  initStream(images_, options_.num_threads);
+  // IMU chunks compress quickly, a thread of their own keeps them from
+  // queueing behind images.
+  initStream(imu_, 1u);
+}
+
+Recorder::~Recorder()
+{
+  close();
+}
+
+void Recorder::subscribe(DataProviderBase& data_provider)
+{
+  data_provider.registerImuCallback(wrapImuCallback(nullptr));
+  data_provider.registerGyroCallback(wrapGyroCallback(nullptr));
+  data_provider.registerAccelCallback(wrapAccelCallback(nullptr));
+  data_provider.registerCameraCallback(wrapCameraCallback(nullptr));
+}
+
+ImuCallback Recorder::wrapImuCallback(const ImuCallback& callback)
+{
+  return [this, callback](int64_t stamp, const Vector3& acc, const Vector3& gyr,
+                          uint32_t imu_idx)
+  {
+    addImu(stamp, acc, gyr, imu_idx);
+    if (callback)
+    {
+      callback(stamp, acc, gyr, imu_idx);
+    }
+  };
+}
+
+GyroCallback Recorder::wrapGyroCallback(const GyroCallback& callback)
+{
+  return [this, callback](int64_t stamp, const Vector3& gyr, uint32_t imu_idx)
+  {
+    addGyro(stamp, gyr, imu_idx);
+    if (callback)
+    {
+      callback(stamp, gyr, imu_idx);
+    }
+  };
+}
+
+AccelCallback Recorder::wrapAccelCallback(const AccelCallback& callback)
+{
+  return [this, callback](int64_t stamp, const Vector3& acc, uint32_t imu_idx)
+  {
+    addAccel(stamp, acc, imu_idx);
+    if (callback)
+    {
+      callback(stamp, acc, imu_idx);
+    }
+  };
+}
+
+CameraCallback Recorder::wrapCameraCallback(const CameraCallback& callback)
+{
+  return [this, callback](int64_t stamp, const ImageBase::Ptr& img, uint32_t cam_idx)
+  {
+    CHECK(img);
+    addImage(stamp, *img, cam_idx);
+    if (callback)
+    {
+      callback(stamp, img, cam_idx);
+    }
+  };
+}
+
+SynchronizedCameraImuCallback Recorder::wrapCameraImuCallback(
+    const SynchronizedCameraImuCallback& callback)
+{
+  // Consecutive bundles share the IMU measurements at their boundary.
+  return [this, callback](const StampedImages& images,
+                          const ImuStampsVector& imu_stamps,
+                          const ImuAccGyrVector& imu_acc_gyr)
+  {
+    for (size_t i = 0u; i < images.size(); ++i)
+    {
+      CHECK(images[i].second);
+      addImage(images[i].first, *images[i].second, i);
+    }
+    if (last_bundle_imu_stamps_.size() < imu_stamps.size())
+    {
+      last_bundle_imu_stamps_.resize(imu_stamps.size(),
+                                     std::numeric_limits<int64_t>::lowest());
+    }
+    for (size_t i = 0u; i < imu_stamps.size(); ++i)
+    {
+      for (int j = 0; j < imu_stamps[i].size(); ++j)
+      {
+        const int64_t stamp = imu_stamps[i](j);
+        if (stamp > last_bundle_imu_stamps_[i])
+        {
+          addImu(stamp, imu_acc_gyr[i].col(j).head<3>(),
+                 imu_acc_gyr[i].col(j).tail<3>(), i);
+          last_bundle_imu_stamps_[i] = stamp;
+        }
+      }
+    }
+    if (callback)
+    {
+      callback(images, imu_stamps, imu_acc_gyr);
+    }
+  };
+}
+
+bool Recorder::addImage(int64_t stamp, const ImageBase& img, uint32_t camera_idx)
+{
+  const size_t bytes = imageRecordBytes(img);
+  if (bytes > options_.chunk_bytes)
+  {
+    return addLargeImage(stamp, img, camera_idx);
+  }
+  ChunkPtr sealed;
+  bool added = false;
+  {
+    std::lock_guard<std::mutex> lock(images_.mutex);
+    if (!closed_ && reserve(bytes))
+    {
+      added = prepareChunk(images_, bytes, stamp, &sealed);
+      if (added)
+      {
+        appendImageRecord(stamp, img, camera_idx, options_.filter,
+                          &images_.current->payload);
+        images_.current->info.addRecord(RecordType::Camera, stamp, camera_idx);
+      }
+      else
+      {
+        pending_bytes_ -= bytes;
+      }
+    }
+  }
+  enqueue(images_, sealed);
+  if (added)
+  {
+    ++num_images_;
+  }
+  else
+  {
+    ++num_dropped_images_;
+  }
+  return added;
+}
+
+bool Recorder::addLargeImage(int64_t stamp, const ImageBase& img, uint32_t camera_idx)
+{
+  const size_t bytes = imageRecordBytes(img);
+  ChunkPtr chunk = std::make_shared<Chunk>();
+  chunk->payload.reserve(bytes);
+  appendImageRecord(stamp, img, camera_idx, options_.filter, &chunk->payload);
+  chunk->info.addRecord(RecordType::Camera, stamp, camera_idx);
+
+  ChunkPtr sealed;
+  {
+    std::lock_guard<std::mutex> lock(images_.mutex);
+    if (closed_ || !reserve(bytes))
+    {
+      ++num_dropped_images_;
+      return false;
+    }
+    // Keep the images in order.
+    sealed = sealChunk(images_);
+    chunk->sequence = next_sequence_++;
+    ++num_images_;
+  }
+  enqueue(images_, sealed);
+  enqueue(images_, chunk);
+  return true;
+}
+
+bool Recorder::addImu(
+    int64_t stamp, const Vector3& acc, const Vector3& gyr, uint32_t imu_idx)
+{
+  return addImuRecord(RecordType::Imu, stamp, acc, gyr, imu_idx);
+}
+
+bool Recorder::addGyro(int64_t stamp, const Vector3& gyr, uint32_t imu_idx)
+{
+  return addImuRecord(RecordType::Gyro, stamp, Vector3::Zero(), gyr, imu_idx);
+}
+
+bool Recorder::addAccel(int64_t stamp, const Vector3& acc, uint32_t imu_idx)
+{
+  return addImuRecord(RecordType::Accel, stamp, acc, Vector3::Zero(), imu_idx);
+}
+
+bool Recorder::addImuRecord(
+    RecordType type, int64_t stamp, const Vector3& acc, const Vector3& gyr,
+    uint32_t imu_idx)
+{
+  const size_t bytes = type == RecordType::Imu ? c_imu_record_bytes : c_gyro_record_bytes;
+  ChunkPtr sealed;
+  bool added = false;
+  {
+    std::lock_guard<std::mutex> lock(imu_.mutex);
+    if (!closed_ && reserve(bytes))
+    {
+      added = prepareChunk(imu_, bytes, stamp, &sealed);
+      if (added)
+      {
+        appendImuRecord(type, stamp, acc, gyr, imu_idx, &imu_.current->payload);
+        imu_.current->info.addRecord(type, stamp, imu_idx);
+      }
+      else
+      {
+        pending_bytes_ -= bytes;
+      }
+    }
+  }
+  enqueue(imu_, sealed);
+  if (added)
+  {
+    ++num_imu_;
+  }
+  else
+  {
+    ++num_dropped_imu_;
+  }
+  return added;
+}
+
+void Recorder::flush()
+{
+  flushStreams();
+}
+
+void Recorder::close()
+{
+  if (closed_.exchange(true))
+  {
+    return;
+  }
+  flushStreams();
+  std::lock_guard<std::mutex> lock(write_mutex_);
+  writer_.close();
+  VLOG(1) << "Recorded " << num_images_ << " images and " << num_imu_
+          << " IMU measurements in " << writer_.chunks().size() << " chunks, "
+          << writer_.bytesWritten() << " bytes. Dropped " << num_dropped_images_
+          << " images and " << num_dropped_imu_ << " IMU measurements.";
+}
+
+void Recorder::flushStreams()
+{
+  ChunkPtr images;
+  {
+    std::lock_guard<std::mutex> lock(images_.mutex);
+    images = sealChunk(images_);
+  }
+  ChunkPtr imu;
+  {
+    std::lock_guard<std::mutex> lock(imu_.mutex);
+    imu = sealChunk(imu_);
+  }
+  enqueue(images_, images);
+  enqueue(imu_, imu);
+  waitUntilWritten(next_sequence_);
+}
+
+RecorderStats Recorder::stats() const
+{
+  RecorderStats stats;
+  stats.num_images = num_images_;
+  stats.num_dropped_images = num_dropped_images_;
+  stats.num_imu = num_imu_;
+  stats.num_dropped_imu = num_dropped_imu_;
+  stats.pending_bytes = pending_bytes_;
+  stats.max_pending_bytes = max_pending_bytes_;
+  std::lock_guard<std::mutex> lock(write_mutex_);
+  stats.num_chunks = writer_.chunks().size();
+  stats.raw_bytes = written_raw_bytes_;
+  stats.file_bytes = writer_.bytesWritten();
+  return stats;
+}
+
+void Recorder::initStream(Stream& stream, uint32_t num_threads)
+{
+  // The current, the compressing and the waiting chunks.
+  const size_t num_chunks = 2u * num_threads + 2u;
+  stream.free.reserve(num_chunks);
+  for (size_t i = 0u; i < num_chunks; ++i)
+  {
+    ChunkPtr chunk = std::make_shared<Chunk>();
+    chunk->payload.reserve(options_.chunk_bytes);
+    stream.free.push_back(chunk);
+  }
+  stream.pool.reset(new ThreadPool(num_threads));
+}
+
+bool Recorder::reserve(size_t bytes)
+{
+  // Both streams reserve concurrently, the compression threads only
+  // decrease the backlog meanwhile.
+  size_t pending = pending_bytes_;
+  do
+  {
+    if (pending + bytes > options_.max_pending_bytes)
+    {
+      return false;
+    }
+  } while (!pending_bytes_.compare_exchange_weak(pending, pending + bytes));
+  pending += bytes;
+  size_t max_pending = max_pending_bytes_;
+  while (pending > max_pending
+         && !max_pending_bytes_.compare_exchange_weak(max_pending, pending))
+  {}
+  return true;
+}
+
+bool Recorder::prepareChunk(
+    Stream& stream, size_t bytes, int64_t stamp, ChunkPtr* sealed)
+{
+  if (stream.current)
+  {
+    const RecordingChunkInfo& info = stream.current->info;
+    if (stream.current->payload.size() + bytes > options_.chunk_bytes
+        || stamp - info.min_stamp >= secToNanosec(options_.max_chunk_duration_s))
+    {
+      *sealed = sealChunk(stream);
+    }
+  }
+  if (!stream.current)
+  {
+    if (stream.free.empty())
+    {
+      // Compression lags behind, the caller must not wait for it.
+      return false;
+    }
+    stream.current = std::move(stream.free.back());
+    stream.free.pop_back();
+  }
+  return true;
+}
+
+Recorder::ChunkPtr Recorder::sealChunk(Stream& stream)
+{
+  if (!stream.current || stream.current->info.num_records == 0u)
+  {
+    return nullptr;
+  }
+  ChunkPtr chunk = std::move(stream.current);
+  stream.current = nullptr;
+  chunk->sequence = next_sequence_++;
+  return chunk;
+}
+
+void Recorder::enqueue(Stream& stream, const ChunkPtr& chunk)
+{
+  if (chunk)
+  {
+    stream.pool->enqueue([this, &stream, chunk]() { compressAndWrite(stream, chunk); });
+  }
+}
+
+void Recorder::compressAndWrite(Stream& stream, const ChunkPtr& chunk)
+{
+  if (options_.filter != RecordingFilter::None)
+  {
+    filterImageRecords(&chunk->payload);
+  }
+  std::vector<uint8_t> compressed;
+  {
+    std::lock_guard<std::mutex> lock(buffers_mutex_);
+    if (!free_buffers_.empty())
+    {
+      compressed = std::move(free_buffers_.back());
+      free_buffers_.pop_back();
+    }
+  }
+  compressPayload(options_.codec, options_.compression_level, chunk->payload,
+                  &compressed);
+  RecordingChunkInfo info = chunk->info;
+  info.codec = options_.codec;
+  info.raw_bytes = chunk->payload.size();
+  info.compressed_bytes = compressed.size();
+  const uint64_t sequence = chunk->sequence;
+
+  // Return the chunk right away, the ingest may be waiting for one. Chunks
+  // of large images are not part of the stream and just released.
+  chunk->payload.clear();
+  chunk->info = RecordingChunkInfo();
+  {
+    std::lock_guard<std::mutex> lock(stream.mutex);
+    if (stream.free.size() < stream.free.capacity())
+    {
+      stream.free.push_back(chunk);
+    }
+  }
+
+  // Chunks are written in the order they were sealed.
+  {
+    std::lock_guard<std::mutex> lock(write_mutex_);
+    ready_.emplace(sequence, std::make_pair(info, std::move(compressed)));
+    for (auto it = ready_.find(next_write_sequence_); it != ready_.end();
+         it = ready_.find(next_write_sequence_))
+    {
+      writer_.writeChunk(it->second.first, it->second.second);
+      written_raw_bytes_ += it->second.first.raw_bytes;
+      pending_bytes_ -= it->second.first.raw_bytes;
+      {
+        std::lock_guard<std::mutex> buffers_lock(buffers_mutex_);
+        // One per compression thread.
+        if (free_buffers_.size() < options_.num_threads + 1u)
+        {
+          free_buffers_.push_back(std::move(it->second.second));
+        }
+      }
+      ready_.erase(it);
+      ++next_write_sequence_;
+    }
+  }
+  written_.notify_all();
+}
+
+void Recorder::waitUntilWritten(uint64_t sequence)
+{
+  std::unique_lock<std::mutex> lock(write_mutex_);
+  written_.wait(lock, [this, sequence]() { return next_write_sequence_ >= sequence; });
+}
+
+} // namespace ze
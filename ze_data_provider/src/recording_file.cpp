@@ -0,0 +1,708 @@
+// Copyright (c) 2015-2016, ETH Zurich, Wyss Zurich, Zurich Eye
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the ETH Zurich, Wyss Zurich, Zurich Eye nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL ETH Zurich, Wyss Zurich, Zurich Eye BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#include <ze/data_provider/recording_file.hpp>
+
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+
+#include <lz4.h>
+#include <zstd.h>
+
+#include <imp/core/image.hpp>
+#include <imp/core/image_pool.hpp>
+#include <ze/common/logging.hpp>
+
+namespace ze {
+
+namespace {
+
+constexpr char c_file_magic[8] = {'Z', 'E', 'R', 'E', 'C', '0', '0', '1'};
+constexpr char c_chunk_magic[4] = {'Z', 'R', 'C', 'K'};
+constexpr char c_index_magic[8] = {'Z', 'E', 'R', 'E', 'C', 'I', 'D', 'X'};
+
+struct ChunkHeader
+{
+  char magic[4];
+  uint8_t codec;
+  uint8_t reserved[3];
+  uint32_t num_records;
+  uint32_t camera_mask;
+  uint64_t raw_bytes;
+  uint64_t compressed_bytes;
+  int64_t min_stamp;
+  int64_t max_stamp;
+  uint32_t imu_mask;
+  uint32_t reserved2;
+};
+static_assert(sizeof(ChunkHeader) == 56, "Unexpected padding in ChunkHeader.");
+
+struct IndexEntry
+{
+  uint64_t offset;
+  ChunkHeader header;
+};
+
+struct Footer
+{
+  uint64_t index_offset;
+  uint64_t num_chunks;
+  char magic[8];
+};
+
+struct RecordHeader
+{
+  int64_t stamp;
+  uint32_t bytes;   //!< Of the data following the header.
+  uint8_t type;
+  uint8_t index;
+  uint16_t reserved;
+};
+static_assert(sizeof(RecordHeader) == 16, "Unexpected padding in RecordHeader.");
+
+struct ImageRecordHeader
+{
+  uint32_t width;
+  uint32_t height;
+  int8_t pixel_type;
+  int8_t pixel_order;
+  uint8_t filter;
+  uint8_t pixel_size;
+  uint32_t reserved;
+};
+static_assert(sizeof(ImageRecordHeader) == 16, "Unexpected padding in ImageRecordHeader.");
+
+ChunkHeader toChunkHeader(const RecordingChunkInfo& info)
+{
+  ChunkHeader header;
+  std::memset(&header, 0, sizeof(header));
+  std::memcpy(header.magic, c_chunk_magic, sizeof(header.magic));
+  header.codec = static_cast<uint8_t>(info.codec);
+  header.num_records = info.num_records;
+  header.camera_mask = info.camera_mask;
+  header.raw_bytes = info.raw_bytes;
+  header.compressed_bytes = info.compressed_bytes;
+  header.min_stamp = info.min_stamp;
+  header.max_stamp = info.max_stamp;
+  header.imu_mask = info.imu_mask;
+  return header;
+}
+
+RecordingChunkInfo toChunkInfo(uint64_t offset, const ChunkHeader& header)
+{
+  RecordingChunkInfo info;
+  info.offset = offset;
+  info.codec = static_cast<RecordingCodec>(header.codec);
+  info.num_records = header.num_records;
+  info.camera_mask = header.camera_mask;
+  info.raw_bytes = header.raw_bytes;
+  info.compressed_bytes = header.compressed_bytes;
+  info.min_stamp = header.min_stamp;
+  info.max_stamp = header.max_stamp;
+  info.imu_mask = header.imu_mask;
+  return info;
+}
+
+template<typename T>
+inline void appendBytes(const T& value, std::vector<uint8_t>* payload)
+{
+  const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&value);
+  payload->insert(payload->end(), bytes, bytes + sizeof(T));
+}
+
+template<typename T>
+inline T readBytes(const uint8_t* data)
+{
+  T value;
+  std::memcpy(&value, data, sizeof(T));
+  return value;
+}
+
+//! Calls visitor.visit<Pixel>() with the pixel of the given type, for all
+//! pixel types ImageRaw is instantiated with.
+template<typename Visitor>
+auto visitPixelType(PixelType type, Visitor& visitor)
+-> decltype(visitor.template visit<Pixel8uC1>())
+{
+  switch (type)
+  {
+    case PixelType::i8uC1: return visitor.template visit<Pixel8uC1>();
+    case PixelType::i8uC2: return visitor.template visit<Pixel8uC2>();
+    case PixelType::i8uC3: return visitor.template visit<Pixel8uC3>();
+    case PixelType::i8uC4: return visitor.template visit<Pixel8uC4>();
+    case PixelType::i16sC1: return visitor.template visit<Pixel16sC1>();
+    case PixelType::i16sC2: return visitor.template visit<Pixel16sC2>();
+    case PixelType::i16sC3: return visitor.template visit<Pixel16sC3>();
+    case PixelType::i16sC4: return visitor.template visit<Pixel16sC4>();
+    case PixelType::i16uC1: return visitor.template visit<Pixel16uC1>();
+    case PixelType::i16uC2: return visitor.template visit<Pixel16uC2>();
+    case PixelType::i16uC3: return visitor.template visit<Pixel16uC3>();
+    case PixelType::i16uC4: return visitor.template visit<Pixel16uC4>();
+    case PixelType::i32sC1: return visitor.template visit<Pixel32sC1>();
+    case PixelType::i32sC2: return visitor.template visit<Pixel32sC2>();
+    case PixelType::i32sC3: return visitor.template visit<Pixel32sC3>();
+    case PixelType::i32sC4: return visitor.template visit<Pixel32sC4>();
+    case PixelType::i32fC1: return visitor.template visit<Pixel32fC1>();
+    case PixelType::i32fC2: return visitor.template visit<Pixel32fC2>();
+    case PixelType::i32fC3: return visitor.template visit<Pixel32fC3>();
+    case PixelType::i32fC4: return visitor.template visit<Pixel32fC4>();
+    case PixelType::i16fC1: return visitor.template visit<Pixel16fC1>();
+    case PixelType::i16fC2: return visitor.template visit<Pixel16fC2>();
+    case PixelType::i16fC3: return visitor.template visit<Pixel16fC3>();
+    case PixelType::i16fC4: return visitor.template visit<Pixel16fC4>();
+    default:
+      LOG(FATAL) << "Pixel type not supported for recording.";
+  }
+  return visitor.template visit<Pixel8uC1>();
+}
+
+//! First byte of the region of interest of a CPU image.
+struct RoiData
+{
+  const ImageBase& img;
+
+  template<typename Pixel>
+  const uint8_t* visit() const
+  {
+    const Image<Pixel>& typed = dynamic_cast<const Image<Pixel>&>(img);
+    CHECK(!typed.isGpuMemory());
+    return reinterpret_cast<const uint8_t*>(typed.data(img.roi().x(), img.roi().y()));
+  }
+};
+
+//! Image from the global pool.
+struct PooledImage
+{
+  Size2u size;
+  PixelOrder pixel_order;
+  uint8_t* data;
+  uint32_t pitch;
+
+  template<typename Pixel>
+  ImageBase::Ptr visit()
+  {
+    ImageRawPtr<Pixel> img = ImagePool::global().acquire<Pixel>(size, pixel_order);
+    data = reinterpret_cast<uint8_t*>(img->data());
+    // Step rows like data(x, y) does, the pitch of 3-byte pixels is not a
+    // multiple of the pixel size.
+    pitch = img->stride() * sizeof(Pixel);
+    return img;
+  }
+};
+
+inline uint8_t paethPredictor(int a, int b, int c)
+{
+  const int p = a + b - c;
+  const int pa = std::abs(p - a);
+  const int pb = std::abs(p - b);
+  const int pc = std::abs(p - c);
+  if (pa <= pb && pa <= pc)
+  {
+    return static_cast<uint8_t>(a);
+  }
+  return static_cast<uint8_t>(pb <= pc ? b : c);
+}
+
+//! Filters the rows in place, from the last byte to the first, such that
+//! the predictors still see the unfiltered bytes.
+void filterRows(RecordingFilter filter, uint8_t* rows, size_t row_bytes,
+                uint32_t height, uint32_t bpp)
+{
+  for (uint32_t y = height; y-- > 0u; )
+  {
+    uint8_t* row = rows + y * row_bytes;
+    const uint8_t* up = y > 0u ? row - row_bytes : nullptr;
+    switch (filter)
+    {
+      case RecordingFilter::None:
+        return;
+      case RecordingFilter::Sub:
+        for (size_t i = row_bytes; i-- > bpp; )
+        {
+          row[i] -= row[i - bpp];
+        }
+        break;
+      case RecordingFilter::Paeth:
+        for (size_t i = row_bytes; i-- > 0u; )
+        {
+          const int a = i >= bpp ? row[i - bpp] : 0;
+          const int b = up ? up[i] : 0;
+          const int c = (up && i >= bpp) ? up[i - bpp] : 0;
+          row[i] -= paethPredictor(a, b, c);
+        }
+        break;
+    }
+  }
+}
+
+//! Reverts the filter of a row, up is the unfiltered row above or null.
+void unfilterRow(RecordingFilter filter, uint8_t* row, const uint8_t* up,
+                 size_t row_bytes, uint32_t bpp)
+{
+  switch (filter)
+  {
+    case RecordingFilter::None:
+      break;
+    case RecordingFilter::Sub:
+      for (size_t i = bpp; i < row_bytes; ++i)
+      {
+        row[i] += row[i - bpp];
+      }
+      break;
+    case RecordingFilter::Paeth:
+      for (size_t i = 0u; i < row_bytes; ++i)
+      {
+        const int a = i >= bpp ? row[i - bpp] : 0;
+        const int b = up ? up[i] : 0;
+        const int c = (up && i >= bpp) ? up[i - bpp] : 0;
+        row[i] += paethPredictor(a, b, c);
+      }
+      break;
+  }
+}
+
+} // anonymous namespace
+
+//-----------------------------------------------------------------------------
+void RecordingChunkInfo::addRecord(RecordType type, int64_t stamp, uint32_t idx)
+{
+  CHECK_LT(idx, 32u) << "At most 32 streams per type can be recorded.";
+  min_stamp = num_records == 0u ? stamp : std::min(min_stamp, stamp);
+  max_stamp = num_records == 0u ? stamp : std::max(max_stamp, stamp);
+  ++num_records;
+  if (type == RecordType::Camera)
+  {
+    camera_mask |= 1u << idx;
+  }
+  else
+  {
+    imu_mask |= 1u << idx;
+  }
+}
+
+//-----------------------------------------------------------------------------
+size_t imageRecordBytes(const ImageBase& img)
+{
+  return sizeof(RecordHeader) + sizeof(ImageRecordHeader)
+      + size_t{img.roi().width()} * img.roi().height() * (img.bitDepth() / 8u);
+}
+
+void appendImageRecord(
+    int64_t stamp, const ImageBase& img, uint32_t camera_idx,
+    RecordingFilter filter, std::vector<uint8_t>* payload)
+{
+  CHECK_NOTNULL(payload);
+  const uint32_t pixel_size = img.bitDepth() / 8u;
+  const size_t row_bytes = size_t{img.roi().width()} * pixel_size;
+  const size_t bytes = imageRecordBytes(img);
+  CHECK_LE(bytes, std::numeric_limits<uint32_t>::max());
+
+  RecordHeader record{stamp, static_cast<uint32_t>(bytes - sizeof(RecordHeader)),
+                      static_cast<uint8_t>(RecordType::Camera),
+                      static_cast<uint8_t>(camera_idx), 0u};
+  ImageRecordHeader image{img.roi().width(), img.roi().height(),
+                    static_cast<int8_t>(img.pixelType()),
+                    static_cast<int8_t>(img.pixelOrder()),
+                    static_cast<uint8_t>(filter),
+                    static_cast<uint8_t>(pixel_size), 0u};
+  appendBytes(record, payload);
+  appendBytes(image, payload);
+  if (row_bytes == 0u || image.height == 0u)
+  {
+    return;
+  }
+
+  RoiData roi_data{img};
+  const uint8_t* src = visitPixelType(img.pixelType(), roi_data);
+  size_t offset = payload->size();
+  payload->resize(offset + row_bytes * image.height);
+  uint8_t* dst = payload->data() + offset;
+  const size_t src_pitch = img.stride() * pixel_size;
+  if (src_pitch == row_bytes)
+  {
+    std::memcpy(dst, src, row_bytes * image.height);
+    return;
+  }
+  for (uint32_t y = 0u; y < image.height; ++y)
+  {
+    std::memcpy(dst + y * row_bytes, src + y * src_pitch, row_bytes);
+  }
+}
+
+void appendImuRecord(
+    RecordType type, int64_t stamp, const Vector3& acc, const Vector3& gyr,
+    uint32_t imu_idx, std::vector<uint8_t>* payload)
+{
+  CHECK_NOTNULL(payload);
+  CHECK(type != RecordType::Camera);
+  const uint32_t num_values = type == RecordType::Imu ? 6u : 3u;
+  RecordHeader record{stamp, num_values * static_cast<uint32_t>(sizeof(double)),
+                      static_cast<uint8_t>(type), static_cast<uint8_t>(imu_idx), 0u};
+  appendBytes(record, payload);
+  if (type != RecordType::Gyro)
+  {
+    for (int i = 0; i < 3; ++i)
+    {
+      appendBytes(static_cast<double>(acc(i)), payload);
+    }
+  }
+  if (type != RecordType::Accel)
+  {
+    for (int i = 0; i < 3; ++i)
+    {
+      appendBytes(static_cast<double>(gyr(i)), payload);
+    }
+  }
+}
+
+void filterImageRecords(std::vector<uint8_t>* payload)
+{
+  CHECK_NOTNULL(payload);
+  size_t offset = 0u;
+  RecordView record;
+  while (parseRecord(*payload, &offset, &record))
+  {
+    if (record.type == RecordType::Camera && record.filter != RecordingFilter::None)
+    {
+      filterRows(record.filter, const_cast<uint8_t*>(record.pixels),
+                 size_t{record.width} * record.pixel_size, record.height,
+                 record.pixel_size);
+    }
+  }
+}
+
+bool parseRecord(const std::vector<uint8_t>& payload, size_t* offset,
+                 RecordView* record)
+{
+  CHECK_NOTNULL(offset);
+  CHECK_NOTNULL(record);
+  if (*offset + sizeof(RecordHeader) > payload.size())
+  {
+    return false;
+  }
+  const uint8_t* data = payload.data() + *offset;
+  const RecordHeader header = readBytes<RecordHeader>(data);
+  CHECK_LE(*offset + sizeof(RecordHeader) + header.bytes, payload.size())
+      << "Corrupt record.";
+  data += sizeof(RecordHeader);
+  *offset += sizeof(RecordHeader) + header.bytes;
+
+  record->type = static_cast<RecordType>(header.type);
+  record->stamp = header.stamp;
+  record->index = header.index;
+  switch (record->type)
+  {
+    case RecordType::Imu:
+    case RecordType::Accel:
+    case RecordType::Gyro:
+    {
+      double buffer[6];
+      const uint32_t num_values = record->type == RecordType::Imu ? 6u : 3u;
+      CHECK_EQ(header.bytes, num_values * sizeof(double)) << "Corrupt record.";
+      std::memcpy(buffer, data, header.bytes);
+      const double* values = buffer;
+      if (record->type != RecordType::Gyro)
+      {
+        record->acc = Vector3(values[0], values[1], values[2]);
+        values += 3;
+      }
+      if (record->type != RecordType::Accel)
+      {
+        record->gyr = Vector3(values[0], values[1], values[2]);
+      }
+      break;
+    }
+    case RecordType::Camera:
+    {
+      const ImageRecordHeader image = readBytes<ImageRecordHeader>(data);
+      record->pixel_type = static_cast<PixelType>(image.pixel_type);
+      record->pixel_order = static_cast<PixelOrder>(image.pixel_order);
+      record->filter = static_cast<RecordingFilter>(image.filter);
+      record->width = image.width;
+      record->height = image.height;
+      record->pixel_size = image.pixel_size;
+      record->pixels = data + sizeof(ImageRecordHeader);
+      CHECK_EQ(header.bytes, sizeof(ImageRecordHeader)
+               + size_t{image.width} * image.height * image.pixel_size);
+      break;
+    }
+    default:
+      LOG(FATAL) << "Unknown record type " << static_cast<int>(header.type);
+  }
+  return true;
+}
+
+ImageBase::Ptr decodeImageRecord(const RecordView& record)
+{
+  CHECK(record.type == RecordType::Camera);
+  PooledImage pooled{Size2u(record.width, record.height), record.pixel_order,
+                     nullptr, 0u};
+  ImageBase::Ptr img = visitPixelType(record.pixel_type, pooled);
+  CHECK_EQ(img->bitDepth() / 8u, record.pixel_size);
+  const size_t row_bytes = size_t{record.width} * record.pixel_size;
+  for (uint32_t y = 0u; y < record.height; ++y)
+  {
+    uint8_t* row = pooled.data + size_t{y} * pooled.pitch;
+    std::memcpy(row, record.pixels + y * row_bytes, row_bytes);
+    unfilterRow(record.filter, row, y > 0u ? row - pooled.pitch : nullptr,
+                row_bytes, record.pixel_size);
+  }
+  return img;
+}
+
+//-----------------------------------------------------------------------------
+void compressPayload(
+    RecordingCodec codec, int level, const std::vector<uint8_t>& raw,
+    std::vector<uint8_t>* compressed)
+{
+  CHECK_NOTNULL(compressed);
+  switch (codec)
+  {
+    case RecordingCodec::None:
+      compressed->assign(raw.begin(), raw.end());
+      break;
+    case RecordingCodec::Lz4:
+    {
+      CHECK_LE(raw.size(), static_cast<size_t>(std::numeric_limits<int>::max()));
+      const int n = static_cast<int>(raw.size());
+      compressed->resize(static_cast<size_t>(LZ4_compressBound(n)));
+      const int bytes = LZ4_compress_default(
+            reinterpret_cast<const char*>(raw.data()),
+            reinterpret_cast<char*>(compressed->data()),
+            n, static_cast<int>(compressed->size()));
+      CHECK(bytes > 0 || n == 0) << "LZ4 compression failed.";
+      compressed->resize(static_cast<size_t>(bytes));
+      break;
+    }
+    case RecordingCodec::Zstd:
+    {
+      compressed->resize(ZSTD_compressBound(raw.size()));
+      const size_t bytes = ZSTD_compress(compressed->data(), compressed->size(),
+                                         raw.data(), raw.size(), level);
+      CHECK(!ZSTD_isError(bytes)) << "Zstd compression failed: "
+                                  << ZSTD_getErrorName(bytes);
+      compressed->resize(bytes);
+      break;
+    }
+  }
+}
+
+void decompressPayload(
+    RecordingCodec codec, const std::vector<uint8_t>& compressed,
+    size_t raw_bytes, std::vector<uint8_t>* raw)
+{
+  CHECK_NOTNULL(raw);
+  raw->resize(raw_bytes);
+  switch (codec)
+  {
+    case RecordingCodec::None:
+      CHECK_EQ(compressed.size(), raw_bytes);
+      std::memcpy(raw->data(), compressed.data(), raw_bytes);
+      break;
+    case RecordingCodec::Lz4:
+    {
+      CHECK_LE(raw_bytes, static_cast<size_t>(std::numeric_limits<int>::max()));
+      const int bytes = LZ4_decompress_safe(
+            reinterpret_cast<const char*>(compressed.data()),
+            reinterpret_cast<char*>(raw->data()),
+            static_cast<int>(compressed.size()), static_cast<int>(raw_bytes));
+      CHECK_EQ(bytes, static_cast<int>(raw_bytes)) << "LZ4 decompression failed.";
+      break;
+    }
+    case RecordingCodec::Zstd:
+    {
+      const size_t bytes = ZSTD_decompress(raw->data(), raw_bytes,
+                                           compressed.data(), compressed.size());
+      CHECK(!ZSTD_isError(bytes)) << "Zstd decompression failed: "
+                                  << ZSTD_getErrorName(bytes);
+      CHECK_EQ(bytes, raw_bytes);
+      break;
+    }
+    default:
+      LOG(FATAL) << "Unknown codec " << static_cast<int>(codec);
+  }
+}
+
+//-----------------------------------------------------------------------------
+RecordingWriter::RecordingWriter(const std::string& filename)
+  : file_(filename, std::ios::binary | std::ios::trunc)
+{
+  CHECK(file_.is_open()) << "Could not open " << filename;
+  file_.write(c_file_magic, sizeof(c_file_magic));
+  offset_ = sizeof(c_file_magic);
+}
+
+RecordingWriter::~RecordingWriter()
+{
+  close();
+}
+
+void RecordingWriter::writeChunk(
+    const RecordingChunkInfo& info, const std::vector<uint8_t>& compressed)
+{
+  CHECK(!closed_);
+  CHECK_EQ(info.compressed_bytes, compressed.size());
+  const ChunkHeader header = toChunkHeader(info);
+  file_.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  file_.write(reinterpret_cast<const char*>(compressed.data()), compressed.size());
+  // Flush every chunk, such that a crash loses at most the pending chunks.
+  file_.flush();
+  CHECK(file_.good()) << "Writing the recording failed.";
+  chunks_.push_back(info);
+  chunks_.back().offset = offset_;
+  offset_ += sizeof(header) + compressed.size();
+}
+
+void RecordingWriter::close()
+{
+  if (closed_)
+  {
+    return;
+  }
+  closed_ = true;
+  for (const RecordingChunkInfo& info : chunks_)
+  {
+    const IndexEntry entry{info.offset, toChunkHeader(info)};
+    file_.write(reinterpret_cast<const char*>(&entry), sizeof(entry));
+  }
+  Footer footer;
+  footer.index_offset = offset_;
+  footer.num_chunks = chunks_.size();
+  std::memcpy(footer.magic, c_index_magic, sizeof(footer.magic));
+  file_.write(reinterpret_cast<const char*>(&footer), sizeof(footer));
+  offset_ += chunks_.size() * sizeof(IndexEntry) + sizeof(Footer);
+  file_.close();
+  CHECK(!file_.fail()) << "Writing the recording index failed.";
+}
+
+//-----------------------------------------------------------------------------
+RecordingReader::RecordingReader(const std::string& filename)
+  : file_(filename, std::ios::binary)
+{
+  CHECK(file_.is_open()) << "Could not open " << filename;
+  char magic[sizeof(c_file_magic)];
+  file_.read(magic, sizeof(magic));
+  CHECK(file_.good() && std::memcmp(magic, c_file_magic, sizeof(magic)) == 0)
+      << filename << " is not a recording.";
+  file_.seekg(0, std::ios::end);
+  const uint64_t file_size = static_cast<uint64_t>(file_.tellg());
+  has_index_ = loadIndex(file_size);
+  if (!has_index_)
+  {
+    scanChunks(file_size);
+    LOG(WARNING) << "Recording " << filename << " has no index, it was not "
+                 << "closed. Found " << chunks_.size() << " complete chunks.";
+  }
+}
+
+uint32_t RecordingReader::cameraCount() const
+{
+  uint32_t mask = 0u;
+  for (const RecordingChunkInfo& info : chunks_)
+  {
+    mask |= info.camera_mask;
+  }
+  uint32_t count = 0u;
+  for (; count < 32u && (mask >> count) != 0u; ++count) {}
+  return count;
+}
+
+uint32_t RecordingReader::imuCount() const
+{
+  uint32_t mask = 0u;
+  for (const RecordingChunkInfo& info : chunks_)
+  {
+    mask |= info.imu_mask;
+  }
+  uint32_t count = 0u;
+  for (; count < 32u && (mask >> count) != 0u; ++count) {}
+  return count;
+}
+
+void RecordingReader::readChunk(size_t i, std::vector<uint8_t>* payload) const
+{
+  CHECK_LT(i, chunks_.size());
+  const RecordingChunkInfo& info = chunks_[i];
+  std::vector<uint8_t> compressed(info.compressed_bytes);
+  {
+    std::lock_guard<std::mutex> lock(file_mutex_);
+    file_.clear();
+    file_.seekg(static_cast<std::streamoff>(info.offset + sizeof(ChunkHeader)));
+    file_.read(reinterpret_cast<char*>(compressed.data()), compressed.size());
+    CHECK(file_.good()) << "Reading chunk " << i << " failed.";
+  }
+  decompressPayload(info.codec, compressed, info.raw_bytes, payload);
+}
+
+bool RecordingReader::loadIndex(uint64_t file_size)
+{
+  if (file_size < sizeof(c_file_magic) + sizeof(Footer))
+  {
+    return false;
+  }
+  Footer footer;
+  file_.seekg(static_cast<std::streamoff>(file_size - sizeof(Footer)));
+  file_.read(reinterpret_cast<char*>(&footer), sizeof(footer));
+  if (!file_.good()
+      || std::memcmp(footer.magic, c_index_magic, sizeof(footer.magic)) != 0
+      || footer.index_offset + footer.num_chunks * sizeof(IndexEntry) + sizeof(Footer)
+         != file_size)
+  {
+    file_.clear();
+    return false;
+  }
+  std::vector<IndexEntry> entries(footer.num_chunks);
+  file_.seekg(static_cast<std::streamoff>(footer.index_offset));
+  file_.read(reinterpret_cast<char*>(entries.data()), entries.size() * sizeof(IndexEntry));
+  CHECK(file_.good()) << "Reading the recording index failed.";
+  chunks_.reserve(entries.size());
+  for (const IndexEntry& entry : entries)
+  {
+    chunks_.push_back(toChunkInfo(entry.offset, entry.header));
+  }
+  return true;
+}
+
+void RecordingReader::scanChunks(uint64_t file_size)
+{
+  uint64_t offset = sizeof(c_file_magic);
+  while (offset + sizeof(ChunkHeader) <= file_size)
+  {
+    ChunkHeader header;
+    file_.seekg(static_cast<std::streamoff>(offset));
+    file_.read(reinterpret_cast<char*>(&header), sizeof(header));
+    if (!file_.good()
+        || std::memcmp(header.magic, c_chunk_magic, sizeof(header.magic)) != 0
+        || offset + sizeof(header) + header.compressed_bytes > file_size)
+    {
+      break;
+    }
+    chunks_.push_back(toChunkInfo(offset, header));
+    offset += sizeof(header) + header.compressed_bytes;
+  }
+  file_.clear();
+}
+
+} // namespace ze
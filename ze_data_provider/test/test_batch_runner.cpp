@@ -0,0 +1,103 @@
+// Copyright (c) 2015-2016, ETH Zurich, Wyss Zurich, Zurich Eye
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the ETH Zurich, Wyss Zurich, Zurich Eye nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL ETH Zurich, Wyss Zurich, Zurich Eye BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+#include <ze/common/test_entrypoint.hpp>
+#include <ze/common/test_utils.hpp>
+#include <ze/common/path_utils.hpp>
+#include <ze/data_provider/batch_runner.hpp>
+#include <ze/data_provider/camera_imu_synchronizer.hpp>
+
+TEST(BatchRunnerTests, testParseCpuList)
+{
+  using namespace ze;
+  std::vector<int> cpus = parseCpuList("0-3,8,10-11\n");
+  std::vector<int> expected = {0, 1, 2, 3, 8, 10, 11};
+  EXPECT_EQ(cpus, expected);
+  EXPECT_TRUE(parseCpuList("").empty());
+}
+
+TEST(BatchRunnerTests, testRunCsvSequences)
+{
+  using namespace ze;
+
+  std::string data_dir = getTestDataDir("csv_dataset");
+  EXPECT_FALSE(data_dir.empty());
+
+  std::vector<BatchSequence> sequences(3);
+  for (size_t i = 0u; i < sequences.size(); ++i)
+  {
+    sequences[i].name = "seq" + std::to_string(i);
+    sequences[i].spec.data_source = 0;
+    sequences[i].spec.data_dir = joinPath(data_dir, "data");
+    sequences[i].spec.imu_topics = {{"imu0", 0}};
+    sequences[i].spec.cam_topics = {{"cam0", 0}};
+  }
+
+  BatchRunnerOptions options;
+  options.num_parallel = 2u;
+  options.output_dir = "/tmp/test_batch_runner";
+  BatchRunner runner(options);
+
+  std::vector<std::atomic<int>> num_bundles(sequences.size());
+  for (std::atomic<int>& n : num_bundles)
+  {
+    n = 0;
+  }
+  std::vector<BatchSequenceResult> results = runner.run(
+        sequences,
+        [&](const BatchSequence& sequence, CameraImuSynchronizer& sync,
+            BatchResources& /*resources*/, const std::string& output_dir)
+  {
+    EXPECT_FALSE(output_dir.empty());
+    std::atomic<int>& n = num_bundles[std::stoi(sequence.name.substr(3))];
+    sync.registerCameraImuCallback(
+          [&n](const StampedImages& images,
+               const ImuStampsVector& /*imu_timestamps*/,
+               const ImuAccGyrVector& /*imu_measurements*/)
+    {
+      EXPECT_TRUE(images[0].second != nullptr);
+      ++n;
+    });
+  });
+
+  ASSERT_EQ(results.size(), sequences.size());
+  for (size_t i = 0u; i < sequences.size(); ++i)
+  {
+    EXPECT_EQ(results[i].name, sequences[i].name);
+    EXPECT_LT(results[i].worker, options.num_parallel);
+    EXPECT_GE(results[i].wall_time_s, results[i].spin_time_s);
+    EXPECT_GT(num_bundles[i].load(), 0);
+    EXPECT_EQ(num_bundles[i].load(), num_bundles[0].load());
+    EXPECT_TRUE(fileExists(
+                  joinPath(options.output_dir, sequences[i].name, "timing.yaml")));
+  }
+  EXPECT_TRUE(fileExists(joinPath(options.output_dir, "batch_summary.csv")));
+}
+
+ZE_UNITTEST_ENTRYPOINT
@@ -23,8 +23,10 @@
 // (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
 // SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
+#include <atomic>
 #include <string>
 #include <iostream>
+#include <thread>
 
 #include <imp/core/image_base.hpp>
 #include <imp/core/image_raw.hpp>
@@ -36,6 +38,9 @@
 #include <ze/data_provider/camera_imu_synchronizer.hpp>
 
 namespace ze {
+DECLARE_bool(data_sync_decoupled);
+DECLARE_bool(data_provider_stats);
+
 // a dummy data provider
 class DataProviderDummy : public DataProviderBase
 {
@@ -54,6 +59,8 @@ public:
   }
   size_t imu_count_;
   size_t camera_count_;
+  using DataProviderBase::imu_callback_;
+  using DataProviderBase::camera_callback_;
 };
 }
 
@@ -267,4 +274,99 @@ TEST(CameraImuSynchronizerTest, testImagesAreDiscardedIfNoImuAfter)
   EXPECT_EQ(0, measurements);
 }
 
+TEST(CameraImuSynchronizerTest, testDecoupled)
+{
+  using namespace ze;
+  DataProviderDummy data_provider;
+  data_provider.camera_count_ = 1;
+  data_provider.imu_count_ = 1;
+
+  FLAGS_data_sync_decoupled = true;
+  CameraImuSynchronizer sync(data_provider);
+  FLAGS_data_sync_decoupled = false;
+  EXPECT_TRUE(sync.decoupled());
+
+  const std::thread::id provider_thread = std::this_thread::get_id();
+  std::atomic<size_t> measurements { 0u };
+  std::atomic<bool> called_on_provider_thread { false };
+  sync.registerCameraImuCallback(
+        [&](const StampedImages& images,
+            const ImuStampsVector& imu_timestamps,
+            const ImuAccGyrVector& imu_measurements)
+        {
+          ++measurements;
+          if (std::this_thread::get_id() == provider_thread)
+          {
+            called_on_provider_thread = true;
+          }
+        }
+  );
+
+  // Measurements are fed through the data provider callbacks.
+  auto img = std::make_shared<ImageRaw8uC1>(1, 1);
+  for (int i = 0; i < 100; ++i)
+  {
+    const int64_t stamp = secToNanosec(1) + i * millisecToNanosec(5);
+    if (i > 0 && i % 10 == 0)
+    {
+      data_provider.camera_callback_(stamp - millisecToNanosec(1), img, 0);
+    }
+    data_provider.imu_callback_(stamp, Vector3::Zero(), Vector3::Zero(), 0);
+  }
+  sync.flush();
+
+  EXPECT_EQ(9u, measurements);
+  EXPECT_FALSE(called_on_provider_thread);
+  EXPECT_EQ(109u, sync.queueStats().num_enqueued);
+  EXPECT_EQ(0u, sync.queueStats().depth);
+}
+
+TEST(CameraImuSynchronizerTest, testStatistics)
+{
+  using namespace ze;
+  FLAGS_data_provider_stats = true;
+  DataProviderDummy data_provider;
+  data_provider.camera_count_ = 1;
+  data_provider.imu_count_ = 1;
+  CameraImuSynchronizer sync(data_provider);
+  FLAGS_data_provider_stats = false;
+
+  size_t measurements = 0u;
+  sync.registerCameraImuCallback(
+        [&](const StampedImages& images,
+            const ImuStampsVector& imu_timestamps,
+            const ImuAccGyrVector& imu_measurements)
+        {
+          ++measurements;
+        }
+  );
+
+  auto img = std::make_shared<ImageRaw8uC1>(1, 1);
+  for (int i = 0; i < 100; ++i)
+  {
+    const int64_t stamp = secToNanosec(1) + i * millisecToNanosec(5);
+    if (i > 0 && i % 10 == 0)
+    {
+      data_provider.camera_callback_(stamp - millisecToNanosec(1), img, 0);
+    }
+    data_provider.imu_callback_(stamp, Vector3::Zero(), Vector3::Zero(), 0);
+  }
+  EXPECT_EQ(9u, measurements);
+
+  const IngestStatistics& ingest = data_provider.ingestStatistics();
+  EXPECT_EQ(100u, ingest.stream(IngestStreamType::Imu, 0)->numMessages());
+  EXPECT_EQ(99u, ingest.stream(IngestStreamType::Imu, 0)->inter_arrival.count());
+  EXPECT_EQ(100u, ingest.stream(IngestStreamType::Imu, 0)->callback_duration.count());
+  EXPECT_EQ(9u, ingest.stream(IngestStreamType::Camera, 0)->numMessages());
+  EXPECT_EQ(0u, ingest.stream(IngestStreamType::Camera, 1)->numMessages());
+
+  const SynchronizerStatistics& stats = sync.synchronizerStatistics();
+  EXPECT_EQ(9u, stats.bundle_latency.count());
+  EXPECT_EQ(9u, stats.callback_duration.count());
+  EXPECT_EQ(CameraImuSynchronizer::ImuSyncBuffer::capacity(), stats.imu_fill[0].capacity());
+  // The last bundle is complete with the 91st IMU measurement.
+  EXPECT_EQ(91u, stats.imu_fill[0].max());
+  EXPECT_EQ(0u, stats.imu_fill[1].capacity());
+}
+
 ZE_UNITTEST_ENTRYPOINT
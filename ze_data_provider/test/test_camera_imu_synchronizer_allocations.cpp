@@ -0,0 +1,218 @@
+// Copyright (c) 2015-2016, ETH Zurich, Wyss Zurich, Zurich Eye
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the ETH Zurich, Wyss Zurich, Zurich Eye nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL ETH Zurich, Wyss Zurich, Zurich Eye BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <cstdlib>
+#include <new>
+
+#include <imp/core/image_raw.hpp>
+#include <ze/common/test_entrypoint.hpp>
+#include <ze/data_provider/camera_imu_synchronizer.hpp>
+
+// This test has its own binary, as counting allocations requires replacing
+// the global operator new.
+
+namespace {
+
+//! Counts the heap allocations of the current thread during its lifetime.
+//! Allocations of other threads and outside of the scope are not counted.
+class ScopedAllocationCounter
+{
+public:
+  ScopedAllocationCounter()
+    : previous_(active_)
+  {
+    active_ = this;
+  }
+
+  ~ScopedAllocationCounter()
+  {
+    active_ = previous_;
+  }
+
+  ScopedAllocationCounter(const ScopedAllocationCounter&) = delete;
+  ScopedAllocationCounter& operator=(const ScopedAllocationCounter&) = delete;
+
+  inline size_t count() const { return count_; }
+
+  static inline void recordAllocation()
+  {
+    if (active_)
+    {
+      ++active_->count_;
+    }
+  }
+
+private:
+  static thread_local ScopedAllocationCounter* active_;
+  ScopedAllocationCounter* previous_;
+  size_t count_ { 0u };
+};
+
+thread_local ScopedAllocationCounter* ScopedAllocationCounter::active_ = nullptr;
+
+} // anonymous namespace
+
+void* operator new(size_t size)
+{
+  ScopedAllocationCounter::recordAllocation();
+  if (void* ptr = std::malloc(size == 0u ? 1u : size))
+  {
+    return ptr;
+  }
+  throw std::bad_alloc();
+}
+
+// Not inlined, such that the compiler does not pair operator new with free().
+__attribute__((noinline)) void operator delete(void* ptr) noexcept
+{
+  std::free(ptr);
+}
+
+namespace ze {
+
+// a dummy data provider
+class DataProviderDummy : public DataProviderBase
+{
+public:
+  DataProviderDummy(): DataProviderBase(DataProviderType::Rosbag) {}
+  virtual bool spinOnce() { return true; }
+  virtual bool ok() const { return true; }
+  virtual size_t imuCount() const { return 1u; }
+  virtual size_t cameraCount() const { return 1u; }
+};
+
+} // namespace ze
+
+TEST(CameraImuSynchronizerAllocationsTest, testSteadyStateDoesNotAllocate)
+{
+  using namespace ze;
+  DataProviderDummy data_provider;
+  CameraImuSynchronizer sync(data_provider);
+
+  size_t measurements = 0u;
+  const int64_t* imu_stamps_data = nullptr;
+  const real_t* imu_acc_gyr_data = nullptr;
+  bool storage_reused = true;
+  sync.registerCameraImuCallback(
+        [&](const StampedImages& images,
+            const ImuStampsVector& imu_timestamps,
+            const ImuAccGyrVector& imu_measurements)
+        {
+          ++measurements;
+          // The first bundle contains all IMU measurements received so far.
+          if (measurements > 1u
+              && (imu_timestamps[0].data() != imu_stamps_data
+                  || imu_measurements[0].data() != imu_acc_gyr_data))
+          {
+            storage_reused = false;
+          }
+          imu_stamps_data = imu_timestamps[0].data();
+          imu_acc_gyr_data = imu_measurements[0].data();
+          EXPECT_EQ(imu_timestamps[0].size(), imu_measurements[0].cols());
+          EXPECT_EQ(images[0].first, imu_timestamps[0](imu_timestamps[0].size() - 1));
+        }
+  );
+
+  // 200 Hz IMU, 20 Hz camera with images in between IMU samples.
+  auto img = std::make_shared<ImageRaw8uC1>(1, 1);
+  const Vector3 acc(0.1, 0.2, 9.81);
+  const Vector3 gyr(0.01, 0.02, 0.03);
+  const int64_t imu_dt = millisecToNanosec(5);
+  const int64_t start = secToNanosec(1);
+  auto spin = [&](int begin, int end)
+  {
+    for (int i = begin; i < end; ++i)
+    {
+      const int64_t stamp = start + i * imu_dt;
+      if (i > 0 && i % 10 == 0)
+      {
+        sync.addImgData(stamp - millisecToNanosec(1), img, 0);
+      }
+      sync.addImuData(stamp, acc, gyr, 0);
+    }
+  };
+
+  // Warm up, such that the buffers are sized.
+  spin(0, 30);
+  ASSERT_EQ(2u, measurements);
+
+  // Run long enough to wrap around the IMU ring buffer.
+  {
+    ScopedAllocationCounter allocations;
+    spin(30, 2500);
+    EXPECT_EQ(0u, allocations.count());
+  }
+  EXPECT_EQ(249u, measurements);
+  EXPECT_TRUE(storage_reused);
+}
+
+TEST(CameraImuSynchronizerAllocationsTest, testCopiesOutliveCallback)
+{
+  using namespace ze;
+  DataProviderDummy data_provider;
+  CameraImuSynchronizer sync(data_provider);
+
+  std::vector<ImuStampsContainerVector> stamps;
+  std::vector<ImuAccGyrContainerVector> acc_gyr;
+  sync.registerCameraImuCallback(
+        [&](const StampedImages& /*images*/,
+            const ImuStampsVector& imu_timestamps,
+            const ImuAccGyrVector& imu_measurements)
+        {
+          stamps.push_back(copyImuStamps(imu_timestamps));
+          acc_gyr.push_back(copyImuAccGyr(imu_measurements));
+        }
+  );
+
+  auto img = std::make_shared<ImageRaw8uC1>(1, 1);
+  const int64_t imu_dt = millisecToNanosec(5);
+  const int64_t start = secToNanosec(1);
+  for (int i = 0; i < 50; ++i)
+  {
+    const int64_t stamp = start + i * imu_dt;
+    if (i > 0 && i % 10 == 0)
+    {
+      sync.addImgData(stamp - millisecToNanosec(1), img, 0);
+    }
+    sync.addImuData(stamp, Vector3::Constant(i), Vector3::Constant(-i), 0);
+  }
+
+  // The later bundles overwrote the storage the views pointed to, the copies
+  // still hold the measurements of their own bundle.
+  ASSERT_EQ(4u, stamps.size());
+  for (size_t i = 1u; i < stamps.size(); ++i)
+  {
+    ASSERT_EQ(1u, stamps[i].size());
+    const ImuStamps& s = stamps[i][0];
+    const ImuAccGyrContainer& m = acc_gyr[i][0];
+    ASSERT_EQ(s.size(), m.cols());
+    EXPECT_EQ(stamps[i - 1][0](stamps[i - 1][0].size() - 1), s(0));
+    EXPECT_EQ(start + static_cast<int64_t>(i + 1) * 10 * imu_dt - millisecToNanosec(1),
+              s(s.size() - 1));
+    EXPECT_GT(m(0, s.size() - 1), m(0, 0));
+  }
+}
+
+ZE_UNITTEST_ENTRYPOINT
@@ -23,16 +23,64 @@
 // (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
 // SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
 #include <string>
 #include <iostream>
+#include <thread>
+#include <tuple>
+#include <vector>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 #include <ze/common/test_entrypoint.hpp>
 #include <ze/common/test_utils.hpp>
 #include <ze/common/path_utils.hpp>
+#include <ze/common/time_conversions.hpp>
+#include <ze/common/timer.hpp>
 #include <ze/data_provider/data_provider_csv.hpp>
 #include <ze/data_provider/data_provider_rosbag.hpp>
+#include <ze/data_provider/data_provider_sim.hpp>
 #include <imp/core/image_base.hpp>
 
+DECLARE_bool(data_source_rosbag_read_ahead);
+DECLARE_double(data_source_start_time_s);
+DECLARE_string(data_source_csv_index_dir);
+
+namespace {
+
+// Type, sensor index, stamp and a checksum of a dispatched message.
+using ReplayedMessage = std::tuple<int, uint32_t, int64_t, double>;
+
+std::vector<ReplayedMessage> replayRosbag(const std::string& bag_filename,
+                                          bool read_ahead)
+{
+  using namespace ze;
+  FLAGS_data_source_rosbag_read_ahead = read_ahead;
+  DataProviderRosbag dp(bag_filename, {{"/imu0", 0}}, { {"/cam0/image_raw", 0},
+                                                        {"/cam1/image_raw", 1} });
+  FLAGS_data_source_rosbag_read_ahead = false;
+
+  std::vector<ReplayedMessage> messages;
+  dp.registerImuCallback(
+        [&](int64_t stamp, const Vector3& acc, const Vector3& gyr, const uint32_t imu_idx)
+  {
+    messages.emplace_back(0, imu_idx, stamp, acc.sum() + gyr.sum());
+  });
+  dp.registerCameraCallback(
+        [&](int64_t stamp, const ImageBase::Ptr& img, uint32_t cam_idx)
+  {
+    messages.emplace_back(1, cam_idx, stamp,
+                          static_cast<double>(img->width() * img->height()));
+  });
+  dp.spin();
+  return messages;
+}
+
+} // anonymous namespace
+
 TEST(DataProviderTests, testCsv)
 {
   using namespace ze;
@@ -74,6 +122,178 @@ TEST(DataProviderTests, testCsv)
   EXPECT_EQ(num_imu_measurements, 69u);
 }
 
+TEST(DataProviderTests, testCsvSeek)
+{
+  using namespace ze;
+
+  std::string data_dir = getTestDataDir("csv_dataset");
+  EXPECT_FALSE(data_dir.empty());
+
+  DataProviderCsv dp(joinPath(data_dir, "data"), {{"imu0", 0}}, {{"cam0", 0}});
+
+  // Record the playback stamps of the full dataset (cameras are delayed).
+  std::vector<int64_t> stamps;
+  dp.registerImuCallback(
+        [&](int64_t stamp, const Vector3& /*acc*/, const Vector3& /*gyr*/, const uint32_t /*imu_idx*/)
+  {
+    stamps.push_back(stamp);
+  });
+  dp.registerCameraCallback(
+        [&](int64_t stamp, const ImageBase::Ptr& /*img*/, uint32_t /*cam_idx*/)
+  {
+    stamps.push_back(stamp + millisecToNanosec(100));
+  });
+  dp.spin();
+  ASSERT_EQ(stamps.size(), 74u);
+  ASSERT_TRUE(std::is_sorted(stamps.begin(), stamps.end()));
+  EXPECT_EQ(dp.beginStamp(), stamps.front());
+
+  size_t num_measurements = 0u;
+  dp.registerImuCallback(
+        [&](int64_t /*stamp*/, const Vector3& /*acc*/, const Vector3& /*gyr*/, const uint32_t /*imu_idx*/)
+  {
+    ++num_measurements;
+  });
+  dp.registerCameraCallback(
+        [&](int64_t /*stamp*/, const ImageBase::Ptr& /*img*/, uint32_t /*cam_idx*/)
+  {
+    ++num_measurements;
+  });
+  auto countInWindow = [&](int64_t start, int64_t stop) -> size_t
+  {
+    return std::upper_bound(stamps.begin(), stamps.end(), stop)
+        - std::lower_bound(stamps.begin(), stamps.end(), start);
+  };
+
+  // Seek within the loaded data.
+  dp.seek(stamps[40]);
+  dp.spin();
+  EXPECT_EQ(num_measurements, countInWindow(stamps[40], stamps.back()));
+
+  // Reload a window.
+  num_measurements = 0u;
+  dp.setTimeWindow(stamps[20], stamps[50]);
+  dp.spin();
+  EXPECT_EQ(num_measurements, countInWindow(stamps[20], stamps[50]));
+
+  // Seek before the loaded window.
+  num_measurements = 0u;
+  dp.seek(stamps[10]);
+  dp.spin();
+  EXPECT_EQ(num_measurements, countInWindow(stamps[10], stamps[50]));
+
+  // Seek past the stop of the window, which is kept.
+  num_measurements = 0u;
+  dp.seek(stamps[60]);
+  dp.spin();
+  EXPECT_EQ(num_measurements, 0u);
+  dp.seek(stamps[30]);
+  dp.spin();
+  EXPECT_EQ(num_measurements, countInWindow(stamps[30], stamps[50]));
+}
+
+TEST(DataProviderTests, testCsvUnsorted)
+{
+  using namespace ze;
+
+  const std::string data_dir = "/tmp/test_data_provider_csv_unsorted";
+  const std::string imu_dir = joinPath(data_dir, "imu0");
+  mkdir(data_dir.c_str(), 0755);
+  mkdir(imu_dir.c_str(), 0755);
+  ASSERT_TRUE(isDir(imu_dir));
+  {
+    std::ofstream fs(joinPath(imu_dir, "data.csv"));
+    fs << "#timestamp [ns],w_RS_S_x [rad s^-1],w_RS_S_y [rad s^-1],"
+       << "w_RS_S_z [rad s^-1],a_RS_S_x [m s^-2],a_RS_S_y [m s^-2],"
+       << "a_RS_S_z [m s^-2]\n";
+    for (int64_t stamp : {300, 100, 400, 200})
+    {
+      fs << stamp << ",0,0,0,0,0,9.81\n";
+    }
+  }
+
+  DataProviderCsv dp(data_dir, {{"imu0", 0}}, {});
+  EXPECT_EQ(dp.beginStamp(), 100);
+
+  std::vector<int64_t> stamps;
+  dp.registerImuCallback(
+        [&](int64_t stamp, const Vector3& /*acc*/, const Vector3& /*gyr*/, const uint32_t /*imu_idx*/)
+  {
+    stamps.push_back(stamp);
+  });
+  dp.spin();
+  EXPECT_EQ(stamps, std::vector<int64_t>({100, 200, 300, 400}));
+}
+
+TEST(DataProviderTests, testCsvIndexCache)
+{
+  using namespace ze;
+
+  const std::string tmp_dir = "/tmp/test_data_provider_" + std::to_string(getpid());
+  const std::string data_dir = joinPath(tmp_dir, "dataset");
+  const std::string imu_dir = joinPath(data_dir, "imu0");
+  const std::string data_file = joinPath(imu_dir, "data.csv");
+  const std::string cache_dir = joinPath(tmp_dir, "cache/csv_index");
+  mkdir(tmp_dir.c_str(), 0755);
+  mkdir(data_dir.c_str(), 0755);
+  mkdir(imu_dir.c_str(), 0755);
+  ASSERT_TRUE(isDir(imu_dir));
+  {
+    std::ofstream fs(data_file);
+    fs << "#timestamp [ns],w_RS_S_x [rad s^-1],w_RS_S_y [rad s^-1],"
+       << "w_RS_S_z [rad s^-1],a_RS_S_x [m s^-2],a_RS_S_y [m s^-2],"
+       << "a_RS_S_z [m s^-2]\n";
+    for (int64_t i = 0; i < 1000; ++i)
+    {
+      fs << 1000 + i * millisecToNanosec(1.0) << ",0,0,0,0,0,9.81\n";
+    }
+  }
+  FLAGS_data_source_csv_index_dir = cache_dir;
+
+  // Playing the whole file needs no index.
+  {
+    DataProviderCsv dp(data_dir, {{"imu0", 0}}, {});
+    EXPECT_EQ(1000u, dp.size());
+    EXPECT_EQ(1000, dp.beginStamp());
+    EXPECT_FALSE(isDir(cache_dir));
+  }
+
+  // A window builds the index and caches it outside of the dataset.
+  std::string index_file;
+  for (int run = 0; run < 2; ++run)
+  {
+    FLAGS_data_source_start_time_s = 0.5;
+    DataProviderCsv dp(data_dir, {{"imu0", 0}}, {});
+    FLAGS_data_source_start_time_s = 0.0;
+    EXPECT_EQ(500u, dp.size());
+    EXPECT_EQ(1000, dp.beginStamp());
+
+    std::vector<std::string> files;
+    DIR* dir = opendir(cache_dir.c_str());
+    ASSERT_TRUE(dir != nullptr);
+    for (dirent* entry = readdir(dir); entry != nullptr; entry = readdir(dir))
+    {
+      if (entry->d_name[0] != '.')
+      {
+        files.push_back(entry->d_name);
+      }
+    }
+    closedir(dir);
+    ASSERT_EQ(1u, files.size());
+    index_file = joinPath(cache_dir, files[0]);
+  }
+  EXPECT_FALSE(fileExists(data_file + ".idx"));
+  FLAGS_data_source_csv_index_dir = "";
+
+  std::remove(index_file.c_str());
+  rmdir(cache_dir.c_str());
+  rmdir(joinPath(tmp_dir, "cache").c_str());
+  std::remove(data_file.c_str());
+  rmdir(imu_dir.c_str());
+  rmdir(data_dir.c_str());
+  rmdir(tmp_dir.c_str());
+}
+
 TEST(DataProviderTests, testRosbag)
 {
   using namespace ze;
@@ -155,5 +375,172 @@ TEST(DataProviderTests, testRosbagCamOnly)
   EXPECT_EQ(num_imu_measurements, 0u);
 }
 
+TEST(DataProviderTests, testRosbagReadAhead)
+{
+  using namespace ze;
+
+  std::string data_dir = getTestDataDir("rosbag_euroc_snippet");
+  std::string bag_filename = joinPath(data_dir, "dataset.bag");
+  ASSERT_TRUE(fileExists(bag_filename));
+
+  const std::vector<ReplayedMessage> expected = replayRosbag(bag_filename, false);
+  const std::vector<ReplayedMessage> actual = replayRosbag(bag_filename, true);
+  ASSERT_EQ(251u, expected.size());
+  ASSERT_EQ(expected.size(), actual.size());
+  for (size_t i = 0u; i < expected.size(); ++i)
+  {
+    EXPECT_TRUE(expected[i] == actual[i]) << "message " << i;
+  }
+}
+
+TEST(DataProviderTests, testRosbagReadAheadShutdown)
+{
+  using namespace ze;
+
+  std::string data_dir = getTestDataDir("rosbag_euroc_snippet");
+  std::string bag_filename = joinPath(data_dir, "dataset.bag");
+  ASSERT_TRUE(fileExists(bag_filename));
+
+  FLAGS_data_source_rosbag_read_ahead = true;
+  for (int num_spins : {0, 1, 10})
+  {
+    Timer timer;
+    {
+      DataProviderRosbag dp(bag_filename, {{"/imu0", 0}}, { {"/cam0/image_raw", 0} });
+      size_t num_messages = 0u;
+      dp.registerImuCallback(
+            [&](int64_t, const Vector3&, const Vector3&, const uint32_t)
+      {
+        ++num_messages;
+      });
+      dp.registerCameraCallback(
+            [&](int64_t, const ImageBase::Ptr&, uint32_t)
+      {
+        ++num_messages;
+      });
+      for (int i = 0; i < num_spins; ++i)
+      {
+        ASSERT_TRUE(dp.spinOnce());
+      }
+      EXPECT_EQ(static_cast<size_t>(num_spins), num_messages);
+      if (num_spins > 0)
+      {
+        // Let the reader fill the queue, it then waits to write the next
+        // message while being stopped.
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        dp.shutdown();
+        EXPECT_FALSE(dp.ok());
+      }
+      // The destructor stops and joins the reader.
+    }
+    EXPECT_LT(timer.stopAndGetMilliseconds(), 1000.0) << num_spins << " spins";
+  }
+  FLAGS_data_source_rosbag_read_ahead = false;
+}
+
+TEST(DataProviderTests, testSimLoop)
+{
+  using namespace ze;
+
+  DataProviderSimOptions options;
+  options.num_buffered_frames = 10u;
+  options.loop = true;
+  options.max_num_frames = 25u;
+  options.render_images = true;
+  DataProviderSim dp(createViSimulationScenario1(), options);
+
+  size_t num_imu_measurements = 0u;
+  int64_t last_imu_stamp = -1;
+  dp.registerImuCallback(
+        [&](int64_t stamp, const Vector3& /*acc*/, const Vector3& /*gyr*/, const uint32_t /*imu_idx*/)
+  {
+    EXPECT_GT(stamp, last_imu_stamp);
+    last_imu_stamp = stamp;
+    ++num_imu_measurements;
+  });
+
+  size_t num_cam_measurements = 0u;
+  dp.registerCameraCallback(
+        [&](int64_t stamp, const ImageBase::Ptr& img, uint32_t /*cam_idx*/)
+  {
+    EXPECT_GT(stamp, 0);
+    ASSERT_TRUE(img);
+    ++num_cam_measurements;
+  });
+
+  // Frame 0 and 10 replay the same buffered frame.
+  std::vector<Keypoints> cam0_keypoints;
+  dp.registerFeatureTrackCallback(
+        [&](int64_t /*stamp*/, const CameraMeasurements& m, uint32_t cam_idx)
+  {
+    if (cam_idx == 0)
+    {
+      cam0_keypoints.push_back(m.keypoints_);
+    }
+  });
+
+  dp.spin();
+
+  EXPECT_EQ(dp.numFrames(), 25u);
+  EXPECT_EQ(num_cam_measurements, 25u * dp.cameraCount());
+  ASSERT_EQ(cam0_keypoints.size(), 25u);
+  EXPECT_TRUE(cam0_keypoints[0] == cam0_keypoints[10]);
+  EXPECT_TRUE(cam0_keypoints[3] == cam0_keypoints[23]);
+
+  // 20Hz camera and 200Hz IMU, the first frame also has the initial sample.
+  EXPECT_EQ(num_imu_measurements, 25u * 10u + 1u);
+}
+
+TEST(DataProviderTests, testSimDeterministic)
+{
+  using namespace ze;
+
+  // IMU and camera-0 keypoints of the first frames, simulated on demand.
+  auto run = [](int64_t seed)
+  {
+    DataProviderSimOptions options;
+    options.max_num_frames = 20u;
+    DataProviderSim dp(createViSimulationScenario(1u, seed), options);
+    std::vector<Vector6> imu;
+    dp.registerImuCallback(
+          [&](int64_t /*stamp*/, const Vector3& acc, const Vector3& gyr, const uint32_t /*imu_idx*/)
+    {
+      Vector6 acc_gyr;
+      acc_gyr << acc, gyr;
+      imu.push_back(acc_gyr);
+    });
+    std::vector<Keypoints> keypoints;
+    dp.registerFeatureTrackCallback(
+          [&](int64_t /*stamp*/, const CameraMeasurements& m, uint32_t cam_idx)
+    {
+      if (cam_idx == 0)
+      {
+        keypoints.push_back(m.keypoints_);
+      }
+    });
+    dp.spin();
+    return std::make_pair(imu, keypoints);
+  };
+
+  const auto a = run(42);
+  const auto b = run(42);
+  const auto c = run(43);
+  ASSERT_EQ(a.first.size(), 20u * 10u + 1u);
+  ASSERT_EQ(a.first.size(), b.first.size());
+  ASSERT_EQ(a.second.size(), 20u);
+  ASSERT_EQ(a.second.size(), b.second.size());
+  for (size_t i = 0u; i < a.first.size(); ++i)
+  {
+    EXPECT_TRUE(a.first[i] == b.first[i]) << "IMU measurement " << i;
+  }
+  for (size_t i = 0u; i < a.second.size(); ++i)
+  {
+    EXPECT_TRUE(a.second[i] == b.second[i]) << "frame " << i;
+  }
+
+  // A different seed gives different noise.
+  ASSERT_EQ(a.first.size(), c.first.size());
+  EXPECT_FALSE(a.first[1] == c.first[1]);
+}
 
 ZE_UNITTEST_ENTRYPOINT
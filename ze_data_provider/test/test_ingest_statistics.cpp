@@ -0,0 +1,108 @@
+// Copyright (c) 2015-2016, ETH Zurich, Wyss Zurich, Zurich Eye
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the ETH Zurich, Wyss Zurich, Zurich Eye nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL ETH Zurich, Wyss Zurich, Zurich Eye BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <sstream>
+#include <thread>
+
+#include <ze/common/test_entrypoint.hpp>
+#include <ze/common/time_conversions.hpp>
+#include <ze/data_provider/ingest_statistics.hpp>
+
+TEST(IngestStatisticsTest, testDurationHistogram)
+{
+  using namespace ze;
+  DurationHistogram hist;
+  EXPECT_EQ(0u, hist.count());
+  EXPECT_DOUBLE_EQ(0.0, hist.quantileMs(0.5));
+
+  for (int i = 0; i < 99; ++i)
+  {
+    hist.addSample(millisecToNanosec(1));
+  }
+  hist.addSample(millisecToNanosec(100));
+
+  EXPECT_EQ(100u, hist.count());
+  EXPECT_NEAR(1.99, hist.meanMs(), 1e-6);
+  EXPECT_NEAR(100.0, hist.maxMs(), 1e-6);
+
+  // 1ms falls into the bin [2^19, 2^20) ns, 100ms into [2^26, 2^27) ns.
+  EXPECT_NEAR(nanosecToMillisecTrunc(1 << 20), hist.quantileMs(0.5), 1e-6);
+  EXPECT_NEAR(nanosecToMillisecTrunc(1 << 20), hist.quantileMs(0.99), 1e-6);
+  EXPECT_NEAR(nanosecToMillisecTrunc(1 << 27), hist.quantileMs(1.0), 1e-6);
+
+  hist.reset();
+  EXPECT_EQ(0u, hist.count());
+  EXPECT_DOUBLE_EQ(0.0, hist.maxMs());
+}
+
+TEST(IngestStatisticsTest, testStreamRate)
+{
+  using namespace ze;
+  IngestStatistics stats;
+  StreamStatistics* imu = stats.stream(IngestStreamType::Imu, 1);
+  ASSERT_NE(nullptr, imu);
+  EXPECT_EQ(nullptr, stats.stream(IngestStreamType::Imu,
+                                  IngestStatistics::c_max_streams_per_type));
+
+  for (int i = 0; i < 201; ++i)
+  {
+    imu->addArrival(secToNanosec(10) + i * millisecToNanosec(5));
+  }
+  EXPECT_EQ(201u, imu->numMessages());
+  EXPECT_EQ(200u, imu->inter_arrival.count());
+  EXPECT_NEAR(200.0, imu->rateHz(), 1e-6);
+
+  // Only streams with messages are printed.
+  std::stringstream ss;
+  ss << stats;
+  EXPECT_NE(std::string::npos, ss.str().find("imu1"));
+  EXPECT_EQ(std::string::npos, ss.str().find("imu0"));
+
+  stats.reset();
+  EXPECT_EQ(0u, imu->numMessages());
+  EXPECT_DOUBLE_EQ(0.0, imu->rateHz());
+}
+
+TEST(IngestStatisticsTest, testConcurrentReaders)
+{
+  using namespace ze;
+  StreamStatistics stats;
+  std::thread reader([&stats]()
+  {
+    for (int i = 0; i < 1000; ++i)
+    {
+      EXPECT_LE(stats.callback_duration.meanMs(), 1.0);
+    }
+  });
+  for (int i = 0; i < 1000; ++i)
+  {
+    StreamCallbackScope scope(&stats);
+  }
+  reader.join();
+  EXPECT_EQ(1000u, stats.numMessages());
+  EXPECT_EQ(1000u, stats.callback_duration.count());
+}
+
+ZE_UNITTEST_ENTRYPOINT
@@ -0,0 +1,169 @@
+// Copyright (c) 2015-2016, ETH Zurich, Wyss Zurich, Zurich Eye
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the ETH Zurich, Wyss Zurich, Zurich Eye nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL ETH Zurich, Wyss Zurich, Zurich Eye BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include <imp/core/image_raw.hpp>
+#include <ze/common/test_entrypoint.hpp>
+#include <ze/data_provider/measurement_queue.hpp>
+
+namespace {
+
+using namespace ze;
+
+// Consumer that blocks until released, such that the queue fills up.
+struct BlockingConsumer
+{
+  std::atomic<bool> released { false };
+  std::vector<int64_t> imu_stamps;
+  std::vector<int64_t> img_stamps;
+
+  void wait()
+  {
+    while (!released)
+    {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+  }
+};
+
+} // unnamed namespace
+
+TEST(MeasurementQueueTest, testOrderIsPreserved)
+{
+  using namespace ze;
+  MeasurementQueue queue(4u, QueueOverflowPolicy::Block);
+
+  std::vector<int64_t> stamps;
+  ImuCallback imu_cb = queue.wrapImuCallback(
+        [&](int64_t stamp, const Vector3&, const Vector3&, uint32_t)
+        { stamps.push_back(stamp); });
+  CameraCallback cam_cb = queue.wrapCameraCallback(
+        [&](int64_t stamp, const ImageBase::Ptr&, uint32_t)
+        { stamps.push_back(stamp); });
+
+  auto img = std::make_shared<ImageRaw8uC1>(1, 1);
+  for (int64_t i = 0; i < 100; ++i)
+  {
+    if (i % 10 == 0)
+    {
+      cam_cb(i, img, 0u);
+    }
+    else
+    {
+      imu_cb(i, Vector3::Zero(), Vector3::Zero(), 0u);
+    }
+  }
+  queue.flush();
+
+  ASSERT_EQ(100u, stamps.size());
+  for (int64_t i = 0; i < 100; ++i)
+  {
+    EXPECT_EQ(i, stamps[i]);
+  }
+  EXPECT_EQ(100u, queue.stats().num_enqueued);
+  EXPECT_EQ(0u, queue.stats().num_dropped);
+  EXPECT_LE(queue.stats().max_depth, 4u);
+}
+
+TEST(MeasurementQueueTest, testDropOldest)
+{
+  using namespace ze;
+  MeasurementQueue queue(4u, QueueOverflowPolicy::DropOldest);
+
+  BlockingConsumer consumer;
+  ImuCallback imu_cb = queue.wrapImuCallback(
+        [&](int64_t stamp, const Vector3&, const Vector3&, uint32_t)
+        {
+          consumer.wait();
+          consumer.imu_stamps.push_back(stamp);
+        });
+
+  // The first measurement blocks the consumer, 4 are queued, 5 are dropped.
+  imu_cb(0, Vector3::Zero(), Vector3::Zero(), 0u);
+  while (queue.stats().depth > 0u)
+  {
+    std::this_thread::yield();
+  }
+  for (int64_t i = 1; i < 10; ++i)
+  {
+    imu_cb(i, Vector3::Zero(), Vector3::Zero(), 0u);
+  }
+  EXPECT_EQ(4u, queue.stats().depth);
+  EXPECT_EQ(5u, queue.stats().num_dropped);
+
+  consumer.released = true;
+  queue.flush();
+  ASSERT_EQ(5u, consumer.imu_stamps.size());
+  EXPECT_EQ(0, consumer.imu_stamps[0]);
+  EXPECT_EQ(6, consumer.imu_stamps[1]);
+  EXPECT_EQ(9, consumer.imu_stamps[4]);
+}
+
+TEST(MeasurementQueueTest, testCoalesceImages)
+{
+  using namespace ze;
+  MeasurementQueue queue(4u, QueueOverflowPolicy::CoalesceImages);
+
+  BlockingConsumer consumer;
+  ImuCallback imu_cb = queue.wrapImuCallback(
+        [&](int64_t stamp, const Vector3&, const Vector3&, uint32_t)
+        {
+          consumer.wait();
+          consumer.imu_stamps.push_back(stamp);
+        });
+  CameraCallback cam_cb = queue.wrapCameraCallback(
+        [&](int64_t stamp, const ImageBase::Ptr&, uint32_t)
+        {
+          consumer.img_stamps.push_back(stamp);
+        });
+
+  auto img = std::make_shared<ImageRaw8uC1>(1, 1);
+  imu_cb(0, Vector3::Zero(), Vector3::Zero(), 0u);
+  while (queue.stats().depth > 0u)
+  {
+    std::this_thread::yield();
+  }
+  imu_cb(1, Vector3::Zero(), Vector3::Zero(), 0u);
+  cam_cb(2, img, 0u);
+  imu_cb(3, Vector3::Zero(), Vector3::Zero(), 0u);
+  imu_cb(4, Vector3::Zero(), Vector3::Zero(), 0u);
+  // Queue is full, the images replace the queued image of camera 0.
+  cam_cb(5, img, 0u);
+  cam_cb(6, img, 0u);
+  EXPECT_EQ(4u, queue.stats().depth);
+  EXPECT_EQ(2u, queue.stats().num_coalesced);
+  EXPECT_EQ(0u, queue.stats().num_dropped);
+
+  consumer.released = true;
+  queue.flush();
+  EXPECT_EQ(std::vector<int64_t>({0, 1, 3, 4}), consumer.imu_stamps);
+  EXPECT_EQ(std::vector<int64_t>({6}), consumer.img_stamps);
+}
+
+ZE_UNITTEST_ENTRYPOINT
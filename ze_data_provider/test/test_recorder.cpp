@@ -0,0 +1,626 @@
+// Copyright (c) 2015-2016, ETH Zurich, Wyss Zurich, Zurich Eye
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the ETH Zurich, Wyss Zurich, Zurich Eye nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL ETH Zurich, Wyss Zurich, Zurich Eye BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+#include <gflags/gflags.h>
+#include <imp/core/image_raw.hpp>
+#include <ze/common/benchmark.hpp>
+#include <ze/common/random.hpp>
+#include <ze/common/test_entrypoint.hpp>
+#include <ze/data_provider/data_provider_recording.hpp>
+#include <ze/data_provider/recorder.hpp>
+
+DECLARE_double(data_source_start_time_s);
+DECLARE_double(data_source_stop_time_s);
+DEFINE_bool(run_benchmark, false, "Benchmark the recorder?");
+
+namespace {
+
+using namespace ze;
+
+struct Measurement
+{
+  RecordType type;
+  int64_t stamp;
+  uint32_t idx;
+  Vector3 acc;
+  Vector3 gyr;
+  ImageBase::Ptr img;
+};
+
+// Smooth gradient with noise, such that the filters have something to do.
+// Different frames have a shifted gradient and different noise.
+template<typename Pixel>
+std::shared_ptr<ImageRaw<Pixel>> testImage(uint32_t width, uint32_t height,
+                                           PixelOrder order = PixelOrder::undefined,
+                                           uint32_t frame = 0u)
+{
+  std::mt19937 gen(frame);
+  std::uniform_int_distribution<int> noise(0, 3);
+  auto img = std::make_shared<ImageRaw<Pixel>>(width, height, order);
+  using T = typename Pixel::T;
+  const size_t channels = sizeof(Pixel) / sizeof(T);
+  for (uint32_t y = 0u; y < height; ++y)
+  {
+    T* row = reinterpret_cast<T*>(img->data(0u, y));
+    for (size_t i = 0u; i < width * channels; ++i)
+    {
+      row[i] = static_cast<T>((i / channels + frame) * 3u + y * 2u + i % channels
+                              + noise(gen));
+    }
+  }
+  return img;
+}
+
+// Compares the region of interest of expected with actual.
+template<typename Pixel>
+void expectSameImage(const ImageBase::Ptr& expected, const ImageBase::Ptr& actual)
+{
+  auto a = std::dynamic_pointer_cast<Image<Pixel>>(expected);
+  auto b = std::dynamic_pointer_cast<Image<Pixel>>(actual);
+  ASSERT_TRUE(a && b);
+  EXPECT_EQ(a->pixelOrder(), b->pixelOrder());
+  ASSERT_EQ(a->roi().size(), b->size());
+  for (uint32_t y = 0u; y < b->height(); ++y)
+  {
+    EXPECT_EQ(0, std::memcmp(a->data(a->roi().x(), a->roi().y() + y), b->data(0u, y),
+                             b->width() * sizeof(Pixel))) << "row " << y;
+  }
+}
+
+void expectSameMeasurement(const Measurement& expected, const Measurement& actual)
+{
+  ASSERT_EQ(expected.type, actual.type);
+  EXPECT_EQ(expected.stamp, actual.stamp);
+  EXPECT_EQ(expected.idx, actual.idx);
+  if (expected.type != RecordType::Camera)
+  {
+    EXPECT_TRUE(expected.acc == actual.acc);
+    EXPECT_TRUE(expected.gyr == actual.gyr);
+    return;
+  }
+  ASSERT_EQ(expected.img->pixelType(), actual.img->pixelType());
+  switch (expected.img->pixelType())
+  {
+    case PixelType::i8uC1: expectSameImage<Pixel8uC1>(expected.img, actual.img); break;
+    case PixelType::i8uC3: expectSameImage<Pixel8uC3>(expected.img, actual.img); break;
+    case PixelType::i16uC1: expectSameImage<Pixel16uC1>(expected.img, actual.img); break;
+    case PixelType::i32fC1: expectSameImage<Pixel32fC1>(expected.img, actual.img); break;
+    default: FAIL() << "Pixel type not covered by the test.";
+  }
+}
+
+// Two cameras with different pixel types, a third with a region of interest,
+// one IMU and split gyro and accelerometer measurements of a second one.
+std::vector<Measurement> testMeasurements()
+{
+  auto value = uniformDistribution<double>(ZE_DETERMINISTIC, -10.0, 10.0);
+  std::vector<Measurement> measurements;
+  for (int64_t i = 0; i < 60; ++i)
+  {
+    const int64_t stamp = i * millisecToNanosec(5.0);
+    measurements.push_back({RecordType::Imu, stamp, 0u,
+                            Vector3(value(), value(), value()),
+                            Vector3(value(), value(), value()), nullptr});
+    if (i % 3 == 0)
+    {
+      measurements.push_back({RecordType::Gyro, stamp, 1u, Vector3::Zero(),
+                              Vector3(value(), value(), value()), nullptr});
+      measurements.push_back({RecordType::Accel, stamp + 1, 1u,
+                              Vector3(value(), value(), value()), Vector3::Zero(),
+                              nullptr});
+    }
+    if (i % 10 == 0)
+    {
+      measurements.push_back({RecordType::Camera, stamp, 0u, Vector3::Zero(),
+                              Vector3::Zero(), testImage<Pixel8uC1>(64, 48)});
+      measurements.push_back({RecordType::Camera, stamp, 1u, Vector3::Zero(),
+                              Vector3::Zero(), testImage<Pixel16uC1>(40, 30)});
+      ImageBase::Ptr rgb = testImage<Pixel8uC3>(50, 40, PixelOrder::rgb);
+      rgb->setRoi(Roi2u(10, 5, 21, 15));
+      measurements.push_back({RecordType::Camera, stamp, 2u, Vector3::Zero(),
+                              Vector3::Zero(), rgb});
+    }
+    if (i == 30)
+    {
+      measurements.push_back({RecordType::Camera, stamp, 3u, Vector3::Zero(),
+                              Vector3::Zero(), testImage<Pixel32fC1>(33, 17)});
+    }
+  }
+  return measurements;
+}
+
+// Flushing every few measurements keeps tiny chunks from being dropped.
+void record(Recorder& recorder, const std::vector<Measurement>& measurements,
+            size_t flush_every = 0u)
+{
+  for (size_t i = 0u; i < measurements.size(); ++i)
+  {
+    const Measurement& m = measurements[i];
+    switch (m.type)
+    {
+      case RecordType::Imu: recorder.addImu(m.stamp, m.acc, m.gyr, m.idx); break;
+      case RecordType::Gyro: recorder.addGyro(m.stamp, m.gyr, m.idx); break;
+      case RecordType::Accel: recorder.addAccel(m.stamp, m.acc, m.idx); break;
+      case RecordType::Camera: recorder.addImage(m.stamp, *m.img, m.idx); break;
+    }
+    if (flush_every > 0u && i % flush_every == flush_every - 1u)
+    {
+      recorder.flush();
+    }
+  }
+}
+
+std::vector<Measurement> replay(DataProviderBase& data_provider)
+{
+  std::vector<Measurement> measurements;
+  data_provider.registerImuCallback(
+        [&](int64_t stamp, const Vector3& acc, const Vector3& gyr, uint32_t idx)
+  {
+    measurements.push_back({RecordType::Imu, stamp, idx, acc, gyr, nullptr});
+  });
+  data_provider.registerGyroCallback(
+        [&](int64_t stamp, const Vector3& gyr, uint32_t idx)
+  {
+    measurements.push_back({RecordType::Gyro, stamp, idx, Vector3::Zero(), gyr, nullptr});
+  });
+  data_provider.registerAccelCallback(
+        [&](int64_t stamp, const Vector3& acc, uint32_t idx)
+  {
+    measurements.push_back({RecordType::Accel, stamp, idx, acc, Vector3::Zero(), nullptr});
+  });
+  data_provider.registerCameraCallback(
+        [&](int64_t stamp, const ImageBase::Ptr& img, uint32_t idx)
+  {
+    measurements.push_back({RecordType::Camera, stamp, idx, Vector3::Zero(),
+                            Vector3::Zero(), img});
+  });
+  data_provider.spin();
+  return measurements;
+}
+
+// Replay order of measurements of which each stream is recorded in stamp
+// order: by stamp, IMU measurements before images of the same stamp.
+std::vector<Measurement> replayOrder(std::vector<Measurement> measurements)
+{
+  std::stable_sort(measurements.begin(), measurements.end(),
+                   [](const Measurement& a, const Measurement& b)
+  {
+    return a.stamp < b.stamp
+        || (a.stamp == b.stamp && a.type != RecordType::Camera
+            && b.type == RecordType::Camera);
+  });
+  return measurements;
+}
+
+// Unique file in /tmp that is removed when going out of scope.
+class TempFile
+{
+public:
+  TempFile()
+  {
+    char name[] = "/tmp/test_recorder_XXXXXX";
+    const int fd = mkstemp(name);
+    CHECK_GE(fd, 0) << "Failed to create a temporary file.";
+    close(fd);
+    path_ = name;
+  }
+
+  ~TempFile()
+  {
+    std::remove(path_.c_str());
+  }
+
+  const std::string& path() const { return path_; }
+
+private:
+  std::string path_;
+};
+
+std::vector<char> readFile(const std::string& filename)
+{
+  std::ifstream fs(filename, std::ios::binary);
+  return std::vector<char>(std::istreambuf_iterator<char>(fs),
+                           std::istreambuf_iterator<char>());
+}
+
+} // anonymous namespace
+
+TEST(RecorderTest, testRoundTrip)
+{
+  using namespace ze;
+
+  const std::vector<Measurement> measurements = testMeasurements();
+  const TempFile file;
+  const std::string& filename = file.path();
+  for (RecordingCodec codec : {RecordingCodec::None, RecordingCodec::Lz4,
+                               RecordingCodec::Zstd})
+  {
+    for (RecordingFilter filter : {RecordingFilter::None, RecordingFilter::Sub,
+                                   RecordingFilter::Paeth})
+    {
+      Recorder::Options options;
+      options.codec = codec;
+      options.filter = filter;
+      // Small chunks, such that chunks are written out of order.
+      options.chunk_bytes = 8u * 1024u;
+      options.num_threads = 3u;
+      {
+        Recorder recorder(filename, options);
+        record(recorder, measurements, 16u);
+        recorder.close();
+        const RecorderStats stats = recorder.stats();
+        EXPECT_EQ(0u, stats.num_dropped_images);
+        EXPECT_EQ(0u, stats.num_dropped_imu);
+        EXPECT_EQ(measurements.size(), stats.num_images + stats.num_imu);
+        EXPECT_GT(stats.num_chunks, 3u);
+        EXPECT_EQ(0u, stats.pending_bytes);
+        if (codec != RecordingCodec::None)
+        {
+          EXPECT_LT(stats.file_bytes, stats.raw_bytes);
+        }
+      }
+
+      DataProviderRecording data_provider(filename);
+      EXPECT_TRUE(data_provider.reader().hasIndex());
+      EXPECT_EQ(4u, data_provider.cameraCount());
+      EXPECT_EQ(2u, data_provider.imuCount());
+      const std::vector<Measurement> expected = replayOrder(measurements);
+      const std::vector<Measurement> replayed = replay(data_provider);
+      ASSERT_EQ(expected.size(), replayed.size());
+      for (size_t i = 0u; i < expected.size(); ++i)
+      {
+        expectSameMeasurement(expected[i], replayed[i]);
+      }
+    }
+  }
+}
+
+TEST(RecorderTest, testPlaybackWindow)
+{
+  using namespace ze;
+
+  // The camera stream lags 100 ms behind the IMU, its measurements within the
+  // window are recorded after IMU measurements past the stop and replayed in
+  // stamp order.
+  std::vector<Measurement> measurements;
+  for (int64_t i = 0; i < 100; ++i)
+  {
+    measurements.push_back({RecordType::Imu, i * millisecToNanosec(5.0), 0u,
+                            Vector3::Constant(i), Vector3::Zero(), nullptr});
+    if (i % 10 == 0 && i >= 20)
+    {
+      measurements.push_back({RecordType::Camera, (i - 20) * millisecToNanosec(5.0),
+                              0u, Vector3::Zero(), Vector3::Zero(),
+                              testImage<Pixel8uC1>(16, 12)});
+    }
+  }
+  const TempFile file;
+  const std::string& filename = file.path();
+  {
+    Recorder::Options options;
+    // Small chunks, such that chunks past the window are skipped.
+    options.chunk_bytes = 512u;
+    Recorder recorder(filename, options);
+    record(recorder, measurements, 8u);
+    recorder.close();
+    EXPECT_EQ(0u, recorder.stats().num_dropped_images);
+    EXPECT_EQ(0u, recorder.stats().num_dropped_imu);
+    EXPECT_GT(recorder.stats().num_chunks, 5u);
+  }
+
+  FLAGS_data_source_start_time_s = 0.05;
+  FLAGS_data_source_stop_time_s = 0.3;
+  DataProviderRecording data_provider(filename);
+  FLAGS_data_source_start_time_s = 0.0;
+  FLAGS_data_source_stop_time_s = 0.0;
+  const std::vector<Measurement> replayed = replay(data_provider);
+
+  std::vector<Measurement> expected;
+  for (const Measurement& m : replayOrder(measurements))
+  {
+    if (m.stamp >= millisecToNanosec(50.0) && m.stamp <= millisecToNanosec(300.0))
+    {
+      expected.push_back(m);
+    }
+  }
+  ASSERT_EQ(expected.size(), replayed.size());
+  for (size_t i = 0u; i < expected.size(); ++i)
+  {
+    expectSameMeasurement(expected[i], replayed[i]);
+  }
+  EXPECT_EQ(RecordType::Camera, replayed.back().type);
+  EXPECT_EQ(millisecToNanosec(300.0), replayed.back().stamp);
+}
+
+TEST(RecorderTest, testUnclosedAndTruncatedRecording)
+{
+  using namespace ze;
+
+  const std::vector<Measurement> measurements = testMeasurements();
+  const TempFile file;
+  const std::string& filename = file.path();
+  const TempFile truncated_file;
+  const std::string& truncated = truncated_file.path();
+  Recorder::Options options;
+  options.chunk_bytes = 4u * 1024u;
+  Recorder recorder(filename, options);
+  record(recorder, measurements, 16u);
+  recorder.flush();
+
+  // Killed while recording: the written chunks are found without index.
+  const RecorderStats stats = recorder.stats();
+  {
+    DataProviderRecording data_provider(filename);
+    EXPECT_FALSE(data_provider.reader().hasIndex());
+    EXPECT_EQ(stats.num_chunks, data_provider.reader().chunks().size());
+    const std::vector<Measurement> expected = replayOrder(measurements);
+    const std::vector<Measurement> replayed = replay(data_provider);
+    ASSERT_EQ(expected.size(), replayed.size());
+    for (size_t i = 0u; i < expected.size(); ++i)
+    {
+      expectSameMeasurement(expected[i], replayed[i]);
+    }
+  }
+
+  // Killed while writing a chunk: the incomplete chunk is ignored.
+  std::vector<char> data = readFile(filename);
+  data.resize(data.size() - 10u);
+  std::ofstream(truncated, std::ios::binary).write(data.data(), data.size());
+  RecordingReader reader(truncated);
+  EXPECT_FALSE(reader.hasIndex());
+  EXPECT_EQ(stats.num_chunks - 1u, reader.chunks().size());
+}
+
+TEST(RecorderTest, testDropsWhenBacklogIsFull)
+{
+  using namespace ze;
+
+  Recorder::Options options;
+  // Smaller than an image, images are dropped, IMU measurements still fit.
+  options.max_pending_bytes = 2048u;
+  options.chunk_bytes = 1024u;
+  const TempFile file;
+  Recorder recorder(file.path(), options);
+
+  auto img = testImage<Pixel8uC1>(64, 48);
+  EXPECT_FALSE(recorder.addImage(0, *img, 0u));
+  EXPECT_TRUE(recorder.addImu(1, Vector3::Ones(), Vector3::Ones(), 0u));
+  EXPECT_FALSE(recorder.addImage(2, *img, 0u));
+  recorder.close();
+  EXPECT_FALSE(recorder.addImu(3, Vector3::Ones(), Vector3::Ones(), 0u));
+
+  const RecorderStats stats = recorder.stats();
+  EXPECT_EQ(0u, stats.num_images);
+  EXPECT_EQ(2u, stats.num_dropped_images);
+  EXPECT_EQ(1u, stats.num_imu);
+  EXPECT_EQ(1u, stats.num_dropped_imu);
+  EXPECT_EQ(1u, stats.num_chunks);
+}
+
+TEST(RecorderTest, testImagesLargerThanChunks)
+{
+  using namespace ze;
+
+  std::vector<Measurement> measurements;
+  for (int64_t i = 0; i < 6; ++i)
+  {
+    measurements.push_back({RecordType::Imu, i * 10, 0u, Vector3::Constant(i),
+                            Vector3::Zero(), nullptr});
+    measurements.push_back({RecordType::Camera, i * 10, static_cast<uint32_t>(i % 2), Vector3::Zero(),
+                            Vector3::Zero(),
+                            testImage<Pixel8uC1>(64, 48, PixelOrder::undefined, static_cast<uint32_t>(i))});
+  }
+  const TempFile file;
+  const std::string& filename = file.path();
+  {
+    Recorder::Options options;
+    options.chunk_bytes = 1024u;
+    Recorder recorder(filename, options);
+    record(recorder, measurements);
+    recorder.close();
+    EXPECT_EQ(6u, recorder.stats().num_images);
+    EXPECT_EQ(0u, recorder.stats().num_dropped_images);
+  }
+
+  DataProviderRecording data_provider(filename);
+  const std::vector<Measurement> expected = replayOrder(measurements);
+  const std::vector<Measurement> replayed = replay(data_provider);
+  ASSERT_EQ(expected.size(), replayed.size());
+  for (size_t i = 0u; i < expected.size(); ++i)
+  {
+    expectSameMeasurement(expected[i], replayed[i]);
+  }
+}
+
+TEST(RecorderTest, testCompressionSlowerThanIngest)
+{
+  using namespace ze;
+
+  Recorder::Options options;
+  options.codec = RecordingCodec::Zstd;
+  options.compression_level = 19;
+  options.num_threads = 1u;
+  // Three images per chunk, four image chunks are allocated.
+  options.chunk_bytes = 3u * 640u * 480u + 1024u;
+  const TempFile file;
+  const std::string& filename = file.path();
+  std::vector<std::shared_ptr<ImageRaw<Pixel8uC1>>> images;
+  for (uint32_t i = 0u; i < 4u; ++i)
+  {
+    images.push_back(testImage<Pixel8uC1>(640, 480, PixelOrder::undefined, i));
+  }
+
+  // Images arrive much faster than they are compressed: they are dropped
+  // instead of blocking, the IMU measurements in between are all recorded.
+  size_t num_imu = 0u;
+  std::chrono::steady_clock::duration max_add_time { 0 };
+  {
+    Recorder recorder(filename, options);
+    for (int64_t i = 0; i < 200; ++i)
+    {
+      const int64_t stamp = i * millisecToNanosec(5.0);
+      for (int64_t j = 0; j < 10; ++j)
+      {
+        EXPECT_TRUE(recorder.addImu(stamp + j * millisecToNanosec(0.5),
+                                    Vector3::Ones(), Vector3::Ones(), 0u));
+        ++num_imu;
+      }
+      const auto start = std::chrono::steady_clock::now();
+      recorder.addImage(stamp, *images[i % images.size()], 0u);
+      max_add_time = std::max(max_add_time, std::chrono::steady_clock::now() - start);
+    }
+    const RecorderStats stats = recorder.stats();
+    EXPECT_GT(stats.num_dropped_images, 0u);
+    EXPECT_EQ(200u, stats.num_images + stats.num_dropped_images);
+    EXPECT_EQ(num_imu, stats.num_imu);
+    EXPECT_EQ(0u, stats.num_dropped_imu);
+    recorder.close();
+  }
+  VLOG(1) << "Slowest addImage took "
+          << std::chrono::duration_cast<std::chrono::microseconds>(max_add_time).count()
+          << " us.";
+
+  DataProviderRecording data_provider(filename);
+  const std::vector<Measurement> replayed = replay(data_provider);
+  size_t num_replayed_imu = 0u;
+  for (size_t i = 0u; i < replayed.size(); ++i)
+  {
+    if (replayed[i].type == RecordType::Imu)
+    {
+      ++num_replayed_imu;
+    }
+    if (i > 0u)
+    {
+      EXPECT_LE(replayed[i - 1u].stamp, replayed[i].stamp);
+    }
+  }
+  EXPECT_EQ(num_imu, num_replayed_imu);
+}
+
+TEST(RecorderTest, testWrapCameraImuCallback)
+{
+  using namespace ze;
+
+  const TempFile file;
+  const std::string& filename = file.path();
+  int num_bundles = 0;
+  {
+    Recorder recorder(filename);
+    SynchronizedCameraImuCallback callback = recorder.wrapCameraImuCallback(
+          [&](const StampedImages&, const ImuStampsVector&, const ImuAccGyrVector&)
+    {
+      ++num_bundles;
+    });
+
+    // Consecutive bundles share the IMU measurement at their boundary.
+    ImuStamps stamps(3);
+    ImuAccGyrContainer acc_gyr = ImuAccGyrContainer::Random(6, 3);
+    StampedImages images;
+    images.push_back(std::make_pair(int64_t{20}, testImage<Pixel8uC1>(8, 6)));
+    stamps << 0, 10, 20;
+    callback(images, {ImuStampsView(stamps.data(), 3)},
+             {ImuAccGyrView(acc_gyr.data(), 6, 3)});
+    images[0].first = 40;
+    stamps << 20, 30, 40;
+    callback(images, {ImuStampsView(stamps.data(), 3)},
+             {ImuAccGyrView(acc_gyr.data(), 6, 3)});
+    EXPECT_EQ(2, num_bundles);
+    recorder.close();
+    EXPECT_EQ(2u, recorder.stats().num_images);
+    EXPECT_EQ(5u, recorder.stats().num_imu);
+  }
+
+  DataProviderRecording data_provider(filename);
+  std::vector<int64_t> imu_stamps;
+  data_provider.registerImuCallback(
+        [&](int64_t stamp, const Vector3&, const Vector3&, uint32_t)
+  {
+    imu_stamps.push_back(stamp);
+  });
+  data_provider.registerCameraCallback(
+        [](int64_t, const ImageBase::Ptr&, uint32_t) {});
+  data_provider.spin();
+  EXPECT_EQ((std::vector<int64_t>{0, 10, 20, 30, 40}), imu_stamps);
+}
+
+TEST(RecorderTest, benchmarkRecording)
+{
+  if (!FLAGS_run_benchmark) {
+    return;
+  }
+
+  using namespace ze;
+
+  // 100 frames of 1280x960 at 20 Hz.
+  std::vector<ImageBase::Ptr> frames;
+  for (uint32_t i = 0u; i < 4u; ++i)
+  {
+    frames.push_back(testImage<Pixel8uC1>(1280, 960, PixelOrder::undefined, i));
+  }
+  for (RecordingCodec codec : {RecordingCodec::None, RecordingCodec::Lz4,
+                               RecordingCodec::Zstd})
+  {
+    for (RecordingFilter filter : {RecordingFilter::None, RecordingFilter::Sub,
+                                   RecordingFilter::Paeth})
+    {
+      Recorder::Options options;
+      options.codec = codec;
+      options.filter = filter;
+      const TempFile file;
+      Recorder recorder(file.path(), options);
+      int64_t stamp = 0;
+      size_t frame = 0u;
+      auto addFrame = [&]()
+      {
+        recorder.addImage(stamp, *frames[frame++ % frames.size()], 0u);
+        stamp += millisecToNanosec(50.0);
+      };
+      const uint64_t ingest_ns = runTimingBenchmark(addFrame, 1, 100);
+      Timer timer;
+      recorder.close();
+      const RecorderStats stats = recorder.stats();
+      VLOG(1) << "Codec " << static_cast<int>(codec) << ", filter "
+              << static_cast<int>(filter) << ": add image " << ingest_ns * 1e-3
+              << " us, close " << timer.stopAndGetMilliseconds() << " ms, ratio "
+              << static_cast<double>(stats.raw_bytes) / stats.file_bytes
+              << ", dropped " << stats.num_dropped_images;
+      EXPECT_EQ(100u, stats.num_images + stats.num_dropped_images);
+    }
+  }
+}
+
+ZE_UNITTEST_ENTRYPOINT
@@ -27,6 +27,7 @@
 
 #include <ze/common/transformation.hpp>
 #include <ze/cameras/camera_utils.hpp>
+#include <ze/cameras/camera_dispatch.hpp>
 #include <ze/cameras/camera_impl.hpp>
 #include <ze/cameras/camera_rig.hpp>
 #include <ze/geometry/robust_cost.hpp>
@@ -107,10 +108,13 @@ private:
   real_t prior_weight_rot_;
 };
 
-inline Vector2 reprojectionResidual(
+//! Reprojection residual, templated on the camera model. With a concrete
+//! model (see visitCamera) projection and Jacobian are inlined.
+template<typename CameraModel>
+inline Vector2 reprojectionResidualImpl(
     const Eigen::Ref<const Bearing>& f_Br, //!< Bearing vector in reference body frame (Br).
     const Eigen::Ref<const Position>& p_Br, //!< Reference camera center pos in Br.
-    const Camera& cam,
+    const CameraModel& cam,
     const Transformation& T_C_B,
     const Transformation& T_Bc_Br,
     const real_t inv_depth,
@@ -147,4 +151,20 @@ inline Vector2 reprojectionResidual(
   return px_err;
 }
 
+inline Vector2 reprojectionResidual(
+    const Eigen::Ref<const Bearing>& f_Br, //!< Bearing vector in reference body frame (Br).
+    const Eigen::Ref<const Position>& p_Br, //!< Reference camera center pos in Br.
+    const Camera& cam,
+    const Transformation& T_C_B,
+    const Transformation& T_Bc_Br,
+    const real_t inv_depth,
+    const Eigen::Ref<const Keypoint>& px_measured,
+    Matrix26* H1 = nullptr, //!< Jacobian dreprojectionResidual() / dT_Bc_Br
+    Matrix21* H2 = nullptr  //!< Jacobian dreprojectionResidual() / dinv_depth
+    )
+{
+  return reprojectionResidualImpl(
+        f_Br, p_Br, cam, T_C_B, T_Bc_Br, inv_depth, px_measured, H1, H2);
+}
+
 } // namespace ze
@@ -29,6 +29,62 @@
 
 namespace ze {
 
+namespace {
+
+//! Accumulates the mapping residuals of one frame. Templated on the camera
+//! model such that projection and Jacobian are inlined.
+struct ClamMappingResiduals
+{
+  const ClamLandmarks& landmarks;
+  const ClamFrameData& data;
+  const Transformation& T_Bc_Br;
+  const VectorX& inv_depth;
+  const real_t measurement_sigma;
+  Clam::HessianMatrix* H;
+  Clam::GradientVector* g;
+
+  template<typename CameraModel>
+  real_t operator()(const CameraModel& cam) const
+  {
+    real_t chi2 = 0.0;
+    for (const std::pair<uint32_t, Keypoint>& m : data.landmark_measurements)
+    {
+      Matrix26 H1;
+      Matrix21 H2;
+      CHECK_LT(m.first, landmarks.f_Br.cols());
+      CHECK_LT(m.first, inv_depth.size());
+      Vector2 err = reprojectionResidualImpl(
+            landmarks.f_Br.col(m.first), landmarks.origin_Br.col(m.first),
+            cam, data.T_C_B, T_Bc_Br, inv_depth(m.first), m.second, &H1, &H2);
+
+      // Robust cost function.
+      const real_t weight = 1.0; //!< @todo(cfo)
+
+      // Whiten error and Jacobian.
+      err /= measurement_sigma;
+      H1 /= measurement_sigma;
+      H2 /= measurement_sigma;
+
+      // Compute Hessian and Gradient Vector. The Jacobian is non-zero only
+      // for the pose and the inverse depth of the landmark.
+      const int k = 6 + m.first;
+      const Matrix61 H1t_H2 = H1.transpose() * H2 * weight;
+      H->topLeftCorner<6,6>().noalias() += H1.transpose() * H1 * weight;
+      H->block<6,1>(0, k) += H1t_H2;
+      H->block<1,6>(k, 0) += H1t_H2.transpose();
+      (*H)(k, k) += H2.squaredNorm() * weight;
+      g->head<6>().noalias() -= H1.transpose() * err * weight;
+      (*g)(k) -= H2.dot(err) * weight;
+
+      // Compute log-likelihood : 1/(2*sigma^2)*(z-h(x))^2 = 1/2*e'R'*R*e
+      chi2 += 0.5 * weight * err.squaredNorm();
+    }
+    return chi2;
+  }
+};
+
+} // anonymous namespace
+
 Clam::Clam(
     const ClamLandmarks& landmarks,
     const std::vector<ClamFrameData>& data,
@@ -125,43 +181,12 @@ real_t Clam::evaluateError(
 
   // ---------------------------------------------------------------------------
   // Mapping
-
-  //! @todo(cfo): This can be optimized a lot!
   for (size_t i = 0; i < data_.size(); ++i)
   {
-    const ClamFrameData& data = data_[i];
-    const Camera& cam = rig_.at(i);
-    for (const std::pair<uint32_t, Keypoint>& m : data.landmark_measurements)
-    {
-      Matrix26 H1;
-      Matrix21 H2;
-      CHECK_LT(m.first, landmarks_.f_Br.cols());
-      CHECK_LT(m.first, inv_depth.size());
-      Vector2 err = reprojectionResidual(
-            landmarks_.f_Br.col(m.first), landmarks_.origin_Br.col(m.first),
-            cam, data.T_C_B, T_Bc_Br, inv_depth(m.first), m.second, &H1, &H2);
-
-      // Robust cost function.
-      const real_t weight = 1.0; //!< @todo(cfo)
-
-      // Whiten error
-      err /= measurement_sigma_mapping_;
-
-      Matrix2X J(2, g->size());
-      J.setZero();
-      J.block<2,6>(0, 0) = H1;
-      J.block<2,1>(0, 6 + m.first) = H2;
-
-      // Whiten Jacobian.
-      J /= measurement_sigma_mapping_;
-
-      // Compute Hessian and Gradient Vector.
-      H->noalias() += J.transpose() * J * weight;
-      g->noalias() -= J.transpose() * err * weight;
-
-      // Compute log-likelihood : 1/(2*sigma^2)*(z-h(x))^2 = 1/2*e'R'*R*e
-      chi2 += 0.5 * weight * err.squaredNorm();
-    }
+    // Dispatch the camera model once per frame instead of once per residual.
+    ClamMappingResiduals residuals = {
+      landmarks_, data_[i], T_Bc_Br, inv_depth, measurement_sigma_mapping_, H, g };
+    chi2 += visitCamera(rig_.at(i), residuals);
   }
 
   // ---------------------------------------------------------------------------
@@ -24,6 +24,7 @@
 // SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include <random>
+#include <ze/common/benchmark.hpp>
 #include <ze/common/test_entrypoint.hpp>
 #include <ze/common/test_utils.hpp>
 #include <ze/common/matrix.hpp>
@@ -35,6 +36,41 @@
 #include <ze/cameras/camera_impl.hpp>
 #include <ze/geometry/clam.hpp>
 
+namespace ze {
+
+//! Mapping residuals of one frame, like the Clam mapping loop. Called with
+//! Camera each projection is a virtual call, with a concrete camera model
+//! (visitCamera) it is inlined.
+struct ClamBenchmarkResiduals
+{
+  const ClamLandmarks& landmarks;
+  const ClamFrameData& data;
+  const Transformation& T_Bc_Br;
+  const VectorX& inv_depth;
+  Matrix6& H;
+  Vector6& g;
+
+  template<typename CameraModel>
+  real_t operator()(const CameraModel& cam) const
+  {
+    real_t chi2 = 0.0;
+    for (const std::pair<uint32_t, Keypoint>& m : data.landmark_measurements)
+    {
+      Matrix26 H1;
+      Matrix21 H2;
+      Vector2 err = reprojectionResidualImpl(
+            landmarks.f_Br.col(m.first), landmarks.origin_Br.col(m.first),
+            cam, data.T_C_B, T_Bc_Br, inv_depth(m.first), m.second, &H1, &H2);
+      H.noalias() += H1.transpose() * H1;
+      g.noalias() -= H1.transpose() * err;
+      chi2 += 0.5 * err.squaredNorm() + H2.squaredNorm();
+    }
+    return chi2;
+  }
+};
+
+} // namespace ze
+
 TEST(ClamTests, testJacobians)
 {
 #ifndef ZE_SINGLE_PRECISION_FLOAT
@@ -76,6 +112,116 @@ TEST(ClamTests, testJacobians)
 }
 
 
+TEST(ClamTests, testStaticCameraDispatch)
+{
+  using namespace ze;
+
+  Transformation T_C_B, T_Bc_Br;
+  T_C_B.setRandom();
+  T_Bc_Br = Transformation::exp((Vector6() << 0.2, 0.2, 0.2, 0.1, 0.1, 0.1).finished());
+
+  RadTanCamera cam = createRadTanCamera(640, 480, 329.11, 329.11, 320.0, 240.0,
+                                        -0.1, 0.02, 0.001, -0.002);
+  const Camera& cam_base = cam;
+
+  struct TypeVisitor
+  {
+    CameraType operator()(const PinholeCamera& c) const { return c.type(); }
+    CameraType operator()(const FovCamera& c) const { return c.type(); }
+    CameraType operator()(const RadTanCamera& c) const { return c.type(); }
+    CameraType operator()(const EquidistantCamera& c) const { return c.type(); }
+  };
+  EXPECT_TRUE(visitCamera(cam_base, TypeVisitor()) == CameraType::PinholeRadialTangential);
+
+  // Residual and Jacobians through the concrete model must match the
+  // virtual interface.
+  Keypoint px_Cr(230.4, 325.6);
+  Bearing f_Br = T_C_B.getRotation().inverse().rotate(cam.backProject(px_Cr));
+  Position p_Br = T_C_B.inverse().getPosition();
+  Keypoint px_Cc(220.0, 310.0);
+  Matrix26 H1_virtual, H1_static;
+  Matrix21 H2_virtual, H2_static;
+  Vector2 res_virtual = reprojectionResidual(
+        f_Br, p_Br, cam_base, T_C_B, T_Bc_Br, 0.455, px_Cc, &H1_virtual, &H2_virtual);
+  Vector2 res_static = reprojectionResidualImpl(
+        f_Br, p_Br, cam, T_C_B, T_Bc_Br, 0.455, px_Cc, &H1_static, &H2_static);
+  EXPECT_TRUE(EIGEN_MATRIX_NEAR(res_virtual, res_static, 1e-8));
+  EXPECT_TRUE(EIGEN_MATRIX_NEAR(H1_virtual, H1_static, 1e-8));
+  EXPECT_TRUE(EIGEN_MATRIX_NEAR(H2_virtual, H2_static, 1e-8));
+}
+
+
+TEST(ClamTests, benchmarkStaticCameraDispatch)
+{
+  using namespace ze;
+
+  Transformation T_C_B, T_Bc_Br;
+  T_C_B.setRandom();
+  T_Bc_Br = Transformation::exp((Vector6() << 0.2, 0.2, 0.2, 0.1, 0.1, 0.1).finished());
+
+  std::vector<Camera::Ptr> cams = {
+    std::make_shared<PinholeCamera>(createTestPinholeCamera()),
+    std::make_shared<FovCamera>(
+      createFovCamera(752, 480, 310, 320, 376.0, 240.0, 0.947367)),
+    std::make_shared<RadTanCamera>(
+      createRadTanCamera(752, 480, 310, 320, 376.0, 240.0,
+                         -0.2834, 0.0739, 0.00019, 1.76e-05)),
+    std::make_shared<EquidistantCamera>(
+      createEquidistantCamera(752, 480, 310, 320, 376.0, 240.0,
+                              -0.00279, 0.02414, -0.04304, 0.03118)) };
+
+  // Mapping problem of testExperiment: landmarks at 1 to 3 meters.
+  const size_t n = 120;
+  std::ranlux24 gen;
+  std::uniform_real_distribution<real_t> scale(1.0, 3.0);
+  for (const Camera::Ptr& cam : cams)
+  {
+    Keypoints px_Cr = generateRandomKeypoints(cam->size(), 10, n);
+    Bearings f_Cr = cam->backProjectVectorized(px_Cr);
+    VectorX inv_depth(n);
+    Positions p_Cr = f_Cr;
+    for (size_t i = 0; i < n; ++i)
+    {
+      inv_depth(i) = 1.0 / scale(gen);
+      p_Cr.col(i) /= inv_depth(i);
+    }
+    Keypoints px_Cc = cam->projectVectorized(
+          (T_C_B * T_Bc_Br * T_C_B.inverse()).transformVectorized(p_Cr));
+
+    ClamFrameData data;
+    data.T_C_B = T_C_B;
+    for (size_t i = 0; i < n; ++i)
+    {
+      data.landmark_measurements.push_back(std::make_pair(i, px_Cc.col(i)));
+    }
+    ClamLandmarks landmarks;
+    landmarks.f_Br = T_C_B.getRotation().inverse().rotateVectorized(f_Cr);
+    landmarks.origin_Br =
+        T_C_B.inverse().getPosition().replicate(1, landmarks.f_Br.cols());
+
+    Matrix6 H;
+    Vector6 g;
+    ClamBenchmarkResiduals residuals = { landmarks, data, T_Bc_Br, inv_depth, H, g };
+    real_t chi2_virtual = 0.0, chi2_static = 0.0;
+    const uint64_t t_virtual = runTimingBenchmark([&]()
+    {
+      H.setZero();
+      g.setZero();
+      chi2_virtual = residuals(static_cast<const Camera&>(*cam));
+    }, 100, 10, "CLAM residuals, virtual " + cam->typeAsString(), true);
+    const uint64_t t_static = runTimingBenchmark([&]()
+    {
+      H.setZero();
+      g.setZero();
+      chi2_static = visitCamera(*cam, residuals);
+    }, 100, 10, "CLAM residuals, static " + cam->typeAsString(), true);
+    EXPECT_NEAR(chi2_virtual, chi2_static, 1e-8 * chi2_virtual);
+    VLOG(1) << cam->typeAsString() << ": static dispatch speed-up "
+            << static_cast<double>(t_virtual) / t_static;
+  }
+}
+
+
 TEST(ClamTests, testExperiment)
 {
   using namespace ze;
@@ -25,6 +25,7 @@
 
 #pragma once
 
+#include <algorithm>
 #include <mutex>
 
 #include <ze/imu/imu_model.hpp>
@@ -106,10 +107,29 @@ public:
   std::pair<ImuStamps, ImuAccGyrContainer>
   getBetweenValuesInterpolated(int64_t stamp_from, int64_t stamp_to);
 
+  //! Same as above, but fills the first N entries of caller-owned storage in
+  //! place and returns N. The storage is only resized if it is too small,
+  //! hence reusing it does not allocate. Returns 0 if not successful.
+  size_t getBetweenValuesInterpolated(int64_t stamp_from, int64_t stamp_to,
+                                      ImuStamps& stamps,
+                                      ImuAccGyrContainer& rectified_measurements);
+
   //! Get the oldest and newest timestamps for which both Accelerometers
   //! and Gyroscopes have measurements.
   std::tuple<int64_t, int64_t, bool> getOldestAndNewestStamp() const;
 
+  //! Number of buffered measurements of the fuller of both buffers.
+  inline size_t size() const
+  {
+    return std::max(acc_buffer_.size(), gyr_buffer_.size());
+  }
+
+  //! Maximum number of measurements per buffer.
+  static constexpr size_t capacity()
+  {
+    return BufferSize;
+  }
+
   //! Get the delay corrected timestamps (Delays are negative if in the past).
   inline int64_t correctStampGyro(int64_t t)
   {
@@ -106,13 +106,25 @@ template<int BufferSize, typename GyroInterp, typename AccelInterp>
 std::pair<ImuStamps, ImuAccGyrContainer>
 ImuBuffer<BufferSize, GyroInterp, AccelInterp>::getBetweenValuesInterpolated(
     int64_t stamp_from, int64_t stamp_to)
+{
+  // Empty storage is resized to exactly the requested range.
+  ImuAccGyrContainer rectified_measurements;
+  ImuStamps stamps;
+  getBetweenValuesInterpolated(stamp_from, stamp_to, stamps, rectified_measurements);
+  return std::make_pair(stamps, rectified_measurements);
+}
+
+template<int BufferSize, typename GyroInterp, typename AccelInterp>
+size_t ImuBuffer<BufferSize, GyroInterp, AccelInterp>::getBetweenValuesInterpolated(
+    int64_t stamp_from,
+    int64_t stamp_to,
+    ImuStamps& stamps,
+    ImuAccGyrContainer& rectified_measurements)
 {
   //Takes gyroscope timestamps and interpolates accelerometer measurements at
   // same times. Rectifies all measurements.
   CHECK_GE(stamp_from, 0u);
   CHECK_LT(stamp_from, stamp_to);
-  ImuAccGyrContainer rectified_measurements;
-  ImuStamps stamps;
 
   std::lock_guard<std::mutex> gyr_lock(gyr_buffer_.mutex());
   std::lock_guard<std::mutex> acc_lock(acc_buffer_.mutex());
@@ -120,8 +132,7 @@ ImuBuffer<BufferSize, GyroInterp, AccelInterp>::getBetweenValuesInterpolated(
   if(gyr_buffer_.times().size() < 2)
   {
     LOG(WARNING) << "Buffer has less than 2 entries.";
-    // return empty means unsuccessful.
-    return std::make_pair(stamps, rectified_measurements);
+    return 0u;
   }
 
   const time_t oldest_stamp = gyr_buffer_.times().front();
@@ -129,14 +140,12 @@ ImuBuffer<BufferSize, GyroInterp, AccelInterp>::getBetweenValuesInterpolated(
   if (stamp_from < oldest_stamp)
   {
     LOG(WARNING) << "Requests older timestamp than in buffer.";
-    // return empty means unsuccessful.
-    return std::make_pair(stamps, rectified_measurements);
+    return 0u;
   }
   if (stamp_to > newest_stamp)
   {
     LOG(WARNING) << "Requests newer timestamp than in buffer.";
-    // return empty means unsuccessful.
-    return std::make_pair(stamps, rectified_measurements);
+    return 0u;
   }
 
   const auto it_from_before = gyr_buffer_.iterator_equal_or_before(stamp_from);
@@ -148,20 +157,24 @@ ImuBuffer<BufferSize, GyroInterp, AccelInterp>::getBetweenValuesInterpolated(
   if (it_from_after == it_to_before)
   {
     LOG(WARNING) << "Not enough data for interpolation";
-    // return empty means unsuccessful.
-    return std::make_pair(stamps, rectified_measurements);
+    return 0u;
   }
 
-  // resize containers
+  // grow containers if necessary
   const size_t range = it_to_before.index() - it_from_after.index() + 3;
-  rectified_measurements.resize(Eigen::NoChange, range);
-  stamps.resize(range);
+  if (static_cast<size_t>(stamps.size()) < range)
+  {
+    rectified_measurements.resize(Eigen::NoChange, range);
+    stamps.resize(range);
+  }
 
+  // The interpolators return fixed-size vectors, hence no temporaries are
+  // allocated in the loop below.
   // first element
-  VectorX w = GyroInterp::interpolate(&gyr_buffer_, stamp_from, it_from_before);
-  VectorX a = AccelInterp::interpolate(&acc_buffer_, stamp_from);
   stamps(0) = stamp_from;
-  rectified_measurements.col(0) = imu_model_->undistort(a, w);
+  rectified_measurements.col(0) = imu_model_->undistort(
+        AccelInterp::interpolate(&acc_buffer_, stamp_from),
+        GyroInterp::interpolate(&gyr_buffer_, stamp_from, it_from_before));
 
   // this is a real edge case where we hit the two consecutive timestamps
   //  with from and to.
@@ -169,21 +182,21 @@ ImuBuffer<BufferSize, GyroInterp, AccelInterp>::getBetweenValuesInterpolated(
   if (range > 2)
   {
     for (auto it=it_from_before+1; it!=it_to_after; ++it) {
-      w = GyroInterp::interpolate(&gyr_buffer_, (*it), it);
-      a = AccelInterp::interpolate(&acc_buffer_, (*it));
       stamps(col) = (*it);
-      rectified_measurements.col(col) = imu_model_->undistort(a, w);
+      rectified_measurements.col(col) = imu_model_->undistort(
+            AccelInterp::interpolate(&acc_buffer_, (*it)),
+            GyroInterp::interpolate(&gyr_buffer_, (*it), it));
       ++col;
     }
   }
 
   // last element
-  w = GyroInterp::interpolate(&gyr_buffer_, stamp_to, it_to_before);
-  a = AccelInterp::interpolate(&acc_buffer_, stamp_to);
   stamps(range - 1) = stamp_to;
-  rectified_measurements.col(range - 1) = imu_model_->undistort(a, w);
+  rectified_measurements.col(range - 1) = imu_model_->undistort(
+        AccelInterp::interpolate(&acc_buffer_, stamp_to),
+        GyroInterp::interpolate(&gyr_buffer_, stamp_to, it_to_before));
 
-  return std::make_pair(stamps, rectified_measurements);
+  return range;
 }
 
 template<int BufferSize, typename GyroInterp, typename AccelInterp>
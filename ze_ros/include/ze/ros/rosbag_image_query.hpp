@@ -4,9 +4,13 @@
 
 #pragma once
 
+#include <list>
+#include <map>
 #include <string>
+#include <utility>
 #include <vector>
 #include <rosbag/bag.h>
+#include <rosbag/message_instance.h>
 
 #include <imp/bridge/ros/ros_bridge.hpp>
 #include <imp/core/image.hpp>
@@ -14,6 +18,12 @@
 
 namespace ze {
 
+//! Random access to the images of a bag by timestamp.
+//!
+//! On the first query of a topic, a time-sorted index of all its messages is
+//! built. A rosbag::MessageInstance refers to the chunk and offset of the
+//! message, hence queries are answered by binary search and only the matching
+//! message is read and deserialized.
 class RosbagImageQuery
 {
 public:
@@ -25,13 +35,57 @@ public:
 
   bool loadRosbag(const std::string& bagfile_path);
 
+  //! Returns the image closest to stamp_ns within the search range, or
+  //! (-1, nullptr) if there is none.
   StampedImage getStampedImageAtTime(
       const std::string& img_topic,
       const int64_t stamp_ns,
       const real_t search_range_ms = 10.0);
 
+  //! Batch version of getStampedImageAtTime. The stamps must be sorted, the
+  //! result has the same order. Messages are read in bag order, such that
+  //! every chunk is decompressed at most once.
+  StampedImages getStampedImagesAtTimes(
+      const std::string& img_topic,
+      const std::vector<int64_t>& sorted_stamps_ns,
+      const real_t search_range_ms = 10.0);
+
+  //! Keep up to num_images decoded images in a least-recently-used cache.
+  //! Disabled (0) by default.
+  void setImageCacheSize(size_t num_images);
+
+  //! Build the index of a topic. Called lazily by the queries.
+  void buildIndex(const std::string& img_topic);
+
 private:
+  struct IndexEntry
+  {
+    int64_t stamp;                    //!< Time the message was recorded.
+    rosbag::MessageInstance message;  //!< Refers to chunk/offset in the bag.
+  };
+  using TopicIndex = std::vector<IndexEntry>;
+
+  //! Returns the index of the topic, builds it if necessary.
+  const TopicIndex& topicIndex(const std::string& img_topic);
+
+  //! Position of the entry closest to stamp_ns within search range, -1 if none.
+  int findClosest(const TopicIndex& index, int64_t stamp_ns,
+                  int64_t search_range_ns) const;
+
+  //! Deserialize the message at position i of the topic index, or take it
+  //! from the cache.
+  StampedImage loadImage(const std::string& img_topic,
+                         const TopicIndex& index, int i);
+
   rosbag::Bag bag_;
+  std::map<std::string, TopicIndex> index_;
+
+  // LRU cache, most recently used in front.
+  using CacheKey = std::pair<std::string, int>;
+  using CacheEntry = std::pair<CacheKey, StampedImage>;
+  size_t cache_size_ { 0u };
+  std::list<CacheEntry> cache_;
+  std::map<CacheKey, std::list<CacheEntry>::iterator> cache_lookup_;
 };
 
 }  // namespace ze
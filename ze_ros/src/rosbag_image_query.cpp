@@ -4,6 +4,7 @@
 
 #include <ze/ros/rosbag_image_query.hpp>
 
+#include <algorithm>
 #include <glog/logging.h>
 #include <rosbag/view.h>
 #include <ze/common/file_utils.hpp>
@@ -32,52 +33,151 @@ bool RosbagImageQuery::loadRosbag(const std::string& bagfile_path)
   return true;
 }
 
-StampedImage RosbagImageQuery::getStampedImageAtTime(
-    const std::string& img_topic,
-    const int64_t stamp_ns,
-    const real_t search_range_ms)
+void RosbagImageQuery::buildIndex(const std::string& img_topic)
 {
-  // Considering rounding errors.
-  const int64_t search_range_ns = millisecToNanosec(search_range_ms);
-  ros::Time time_min, time_max;
-  time_min.fromNSec(stamp_ns - search_range_ns);
-  time_max.fromNSec(stamp_ns + search_range_ns);
-  rosbag::View view(bag_, rosbag::TopicQuery(img_topic), time_min, time_max);
-
-  VLOG(100) << "Found messages that fit = " << view.size();
-  int64_t best_time_diff = std::numeric_limits<int64_t>::max();
-  sensor_msgs::ImageConstPtr best_match_message;
+  TopicIndex& index = index_[img_topic];
+  index.clear();
+  rosbag::View view(bag_, rosbag::TopicQuery(img_topic));
+  index.reserve(view.size());
   for (const rosbag::MessageInstance& message : view)
   {
-    const int64_t time_diff =
-        std::abs(static_cast<int64_t>(message.getTime().toNSec()) - stamp_ns);
-    if (time_diff < best_time_diff)
+    // The view returns the messages sorted by time.
+    index.push_back(IndexEntry{
+                      static_cast<int64_t>(message.getTime().toNSec()),
+                      message});
+  }
+  VLOG(1) << "Indexed " << index.size() << " messages of topic " << img_topic;
+}
+
+const RosbagImageQuery::TopicIndex& RosbagImageQuery::topicIndex(
+    const std::string& img_topic)
+{
+  auto it = index_.find(img_topic);
+  if (it == index_.end())
+  {
+    buildIndex(img_topic);
+    it = index_.find(img_topic);
+  }
+  return it->second;
+}
+
+int RosbagImageQuery::findClosest(
+    const TopicIndex& index,
+    int64_t stamp_ns,
+    int64_t search_range_ns) const
+{
+  auto it = std::lower_bound(
+        index.begin(), index.end(), stamp_ns,
+        [](const IndexEntry& entry, int64_t stamp) { return entry.stamp < stamp; });
+
+  // Candidates are the first entry not before the stamp and the one before.
+  int best = -1;
+  int64_t best_time_diff = search_range_ns;
+  if (it != index.end() && it->stamp - stamp_ns <= best_time_diff)
+  {
+    best = it - index.begin();
+    best_time_diff = it->stamp - stamp_ns;
+  }
+  if (it != index.begin() && stamp_ns - (it - 1)->stamp < best_time_diff)
+  {
+    best = it - 1 - index.begin();
+  }
+  return best;
+}
+
+StampedImage RosbagImageQuery::loadImage(
+    const std::string& img_topic,
+    const TopicIndex& index,
+    int i)
+{
+  const CacheKey key(img_topic, i);
+  if (cache_size_ > 0u)
+  {
+    auto it = cache_lookup_.find(key);
+    if (it != cache_lookup_.end())
     {
-      best_time_diff = time_diff;
-      best_match_message = message.instantiate<sensor_msgs::Image>();
-      CHECK(best_match_message);
+      cache_.splice(cache_.begin(), cache_, it->second);
+      return it->second->second;
     }
-    else
+  }
+
+  sensor_msgs::ImagePtr message =
+      index.at(i).message.instantiate<sensor_msgs::Image>();
+  CHECK(message);
+  StampedImage stamped_image(message->header.stamp.toNSec(),
+                             toImageCpu(message));
+
+  if (cache_size_ > 0u)
+  {
+    cache_.emplace_front(key, stamped_image);
+    cache_lookup_[key] = cache_.begin();
+    if (cache_.size() > cache_size_)
     {
-      break; // Already passed relevant time.
+      cache_lookup_.erase(cache_.back().first);
+      cache_.pop_back();
     }
   }
+  return stamped_image;
+}
 
-  // Extract image
-  int64_t best_match_stamp = -1;
-  ImageBase::Ptr best_match_img;
-  if (best_match_message)
+void RosbagImageQuery::setImageCacheSize(size_t num_images)
+{
+  cache_size_ = num_images;
+  while (cache_.size() > cache_size_)
   {
-    best_match_stamp = best_match_message->header.stamp.toNSec();
-    best_match_img = toImageCpu(*best_match_message);
+    cache_lookup_.erase(cache_.back().first);
+    cache_.pop_back();
   }
-  else
+}
+
+StampedImage RosbagImageQuery::getStampedImageAtTime(
+    const std::string& img_topic,
+    const int64_t stamp_ns,
+    const real_t search_range_ms)
+{
+  const TopicIndex& index = topicIndex(img_topic);
+  const int i = findClosest(index, stamp_ns, millisecToNanosec(search_range_ms));
+  if (i < 0)
   {
     LOG(WARNING) << "No image found in bag with this timestamp. If this "
                  << "problem is persistent, you may need to re-index the bag: "
                  << "rosrun ze_rosbag_tools bagrestamper.py -i dataset.bag -o dataset_new.bag";
+    return std::make_pair(-1, ImageBase::Ptr());
+  }
+  return loadImage(img_topic, index, i);
+}
+
+StampedImages RosbagImageQuery::getStampedImagesAtTimes(
+    const std::string& img_topic,
+    const std::vector<int64_t>& sorted_stamps_ns,
+    const real_t search_range_ms)
+{
+  CHECK(std::is_sorted(sorted_stamps_ns.begin(), sorted_stamps_ns.end()));
+  const TopicIndex& index = topicIndex(img_topic);
+  const int64_t search_range_ns = millisecToNanosec(search_range_ms);
+
+  // As the stamps are sorted, the matches are sorted too and every message
+  // is deserialized once, in the order it is stored in the bag.
+  StampedImages images(sorted_stamps_ns.size(),
+                       std::make_pair(-1, ImageBase::Ptr()));
+  int last_i = -1;
+  StampedImage last_image;
+  for (size_t k = 0u; k < sorted_stamps_ns.size(); ++k)
+  {
+    const int i = findClosest(index, sorted_stamps_ns[k], search_range_ns);
+    if (i < 0)
+    {
+      LOG(WARNING) << "No image found in bag for timestamp " << sorted_stamps_ns[k];
+      continue;
+    }
+    if (i != last_i)
+    {
+      last_image = loadImage(img_topic, index, i);
+      last_i = i;
+    }
+    images[k] = last_image;
   }
-  return std::make_pair(best_match_stamp, best_match_img);
+  return images;
 }
 
 }  // namespace ze
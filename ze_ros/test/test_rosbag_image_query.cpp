@@ -58,4 +58,37 @@ TEST(RosbagImageQueryTests, testImageQuery)
   }
 }
 
+TEST(RosbagImageQueryTests, testBatchImageQuery)
+{
+  using namespace ze;
+
+  std::string data_dir = getTestDataDir("rosbag_euroc_snippet");
+  std::string bag_filename = joinPath(data_dir, "dataset.bag");
+  RosbagImageQuery rosbag(bag_filename);
+  rosbag.setImageCacheSize(2u);
+
+  const int64_t nsec_first = nanosecFromSecAndNanosec(1403636617, 863555500);
+  const int64_t nsec_other = nanosecFromSecAndNanosec(1403636618, 463555500);
+  std::vector<int64_t> stamps = {
+    nsec_first - millisecToNanosec(100.0), // before the first image
+    nsec_first,
+    nsec_first + millisecToNanosec(1.0),   // closest is still the first image
+    nsec_other };
+
+  StampedImages res = rosbag.getStampedImagesAtTimes("/cam0/image_raw", stamps);
+  ASSERT_EQ(stamps.size(), res.size());
+  EXPECT_EQ(-1, res[0].first);
+  EXPECT_TRUE(res[0].second == nullptr);
+  EXPECT_EQ(nsec_first, res[1].first);
+  EXPECT_EQ(nsec_first, res[2].first);
+  EXPECT_TRUE(res[1].second == res[2].second);
+  EXPECT_EQ(nsec_other, res[3].first);
+  EXPECT_TRUE(res[3].second != nullptr);
+
+  // Single queries give the same result, the cached image is shared.
+  auto single = rosbag.getStampedImageAtTime("/cam0/image_raw", nsec_other);
+  EXPECT_EQ(nsec_other, single.first);
+  EXPECT_TRUE(single.second == res[3].second);
+}
+
 ZE_UNITTEST_ENTRYPOINT
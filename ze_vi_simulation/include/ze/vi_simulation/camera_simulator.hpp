@@ -26,6 +26,7 @@
 #pragma once
 
 #include <memory>
+#include <random>
 #include <unordered_map>
 #include <ze/common/macros.hpp>
 #include <ze/common/timer_collection.hpp>
@@ -37,6 +38,8 @@ namespace ze {
 
 // fwd.
 class CameraRig;
+struct CameraVisibility;
+struct VisibilityOptions;
 class TrajectorySimulator;
 class Visualizer;
 
@@ -48,6 +51,9 @@ struct CameraSimulatorOptions
   uint32_t max_num_landmarks_ { 10000 };
   real_t min_depth_m { 2.0 };
   real_t max_depth_m { 7.0 };
+
+  //! Seed of the landmarks and keypoint noise, negative for a random seed.
+  int64_t random_seed { -1 };
 };
 
 // -----------------------------------------------------------------------------
@@ -69,6 +75,9 @@ public:
     : trajectory_(trajectory)
     , rig_(camera_rig)
     , options_(options)
+    , generator_(options.random_seed >= 0
+                 ? static_cast<uint32_t>(options.random_seed)
+                 : std::random_device{}())
   {}
 
   void setVisualizer(const std::shared_ptr<Visualizer>& visualizer);
@@ -100,9 +109,16 @@ private:
       const uint32_t lm_min_idx,
       const uint32_t lm_max_idx);
 
+  //! Depth range of the simulated camera.
+  VisibilityOptions visibilityOptions() const;
+
+  static CameraMeasurements measurementsFromVisibility(
+      const CameraVisibility& vis);
+
   std::shared_ptr<TrajectorySimulator> trajectory_;
   std::shared_ptr<CameraRig> rig_;
   CameraSimulatorOptions options_;
+  std::mt19937 generator_;
 
   std::shared_ptr<Visualizer> viz_;
 
@@ -82,7 +82,9 @@ class ContinuousBiasSimulator : public ImuBiasSimulator
 {
 public:
   //! Given the process noise, start/end times and number of samples to take
-  //! initializes a spline from a discrete random walk.
+  //! initializes a spline from a discrete random walk. The random walk is
+  //! drawn from a generator seeded with random_seed, or from the generator
+  //! shared by all samplers if random_seed is negative.
   ContinuousBiasSimulator(
       const Vector3& gyr_bias_noise_density,
       const Vector3& acc_bias_noise_density,
@@ -91,7 +93,8 @@ public:
       size_t samples,
       size_t spline_order = 3,
       size_t spline_segments = 0,
-      size_t spline_smoothing_lambda = 1e-5);
+      size_t spline_smoothing_lambda = 1e-5,
+      int64_t random_seed = -1);
 
   //! Get accelerometer bias at time t.
   const Vector3 accelerometer(real_t t) const
@@ -130,6 +133,9 @@ private:
   size_t spline_segments_;
   real_t spline_smoothing_lambda_;
 
+  //! Samples the increments of the random walk, acc first.
+  RandomVectorSampler<6>::Ptr sampler_;
+
   //! The first three elements are the accelerometer bias, last 3 elements are
   //! the gyrocope bias.
   BSpline bs_;
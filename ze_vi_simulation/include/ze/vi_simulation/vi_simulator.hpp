@@ -77,6 +77,10 @@ class ViSimulator
 public:
   ZE_POINTER_TYPEDEFS(ViSimulator);
 
+  //! All random numbers (bias random walk, IMU noise, landmarks and keypoint
+  //! noise) are derived from random_seed, such that two simulators with the
+  //! same seed produce the same measurements. A negative seed draws a random
+  //! seed for every component.
   ViSimulator(
       const std::shared_ptr<TrajectorySimulator>& trajectory,
       const std::shared_ptr<CameraRig>& camera_rig,
@@ -87,7 +91,8 @@ public:
       const real_t acc_noise_sigma = 0.00186,
       const uint32_t cam_framerate_hz = 20,
       const uint32_t imu_bandwidth_hz = 200,
-      const real_t gravity_magnitude = 9.81);
+      const real_t gravity_magnitude = 9.81,
+      const int64_t random_seed = -1);
 
   void initialize();
 
@@ -95,6 +100,8 @@ public:
 
   void setVisualizer(const std::shared_ptr<Visualizer>& visualizer);
 
+  inline const std::shared_ptr<CameraRig>& cameraRig() const { return rig_; }
+
   void visualize(
       real_t dt = 0.2,
       real_t marker_size_trajectory = 0.2,
@@ -103,6 +110,7 @@ public:
 private:
   // Modules
   std::shared_ptr<TrajectorySimulator> trajectory_;
+  std::shared_ptr<CameraRig> rig_;
   std::shared_ptr<ImuSimulator> imu_;
   std::shared_ptr<CameraSimulator> camera_;
   std::shared_ptr<Visualizer> viz_;
@@ -117,6 +125,11 @@ private:
 // -----------------------------------------------------------------------------
 
 //! Outdoor car scenario with stereo camera.
-ViSimulator::Ptr createViSimulationScenario1();
+ViSimulator::Ptr createViSimulationScenario1(int64_t random_seed = -1);
+
+//! Create the scenario with the given number, e.g. 1 for
+//! createViSimulationScenario1().
+ViSimulator::Ptr createViSimulationScenario(uint32_t scenario,
+                                            int64_t random_seed = -1);
 
 } // namespace ze
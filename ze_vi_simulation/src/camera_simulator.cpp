@@ -66,7 +66,7 @@ void CameraSimulator::initializeMap()
       std::tie(std::ignore, std::ignore, p_C) =
           generateRandomVisible3dPoints(
             rig_->at(cam_idx), num_new_landmarks,
-            10u, options_.min_depth_m, options_.max_depth_m);
+            10u, options_.min_depth_m, options_.max_depth_m, generator_);
 
       DEBUG_CHECK_LE(static_cast<int>(num_landmarks + num_new_landmarks),
                      landmarks_W_.cols());
@@ -98,33 +98,35 @@ CameraMeasurements CameraSimulator::visibleLandmarks(
     return CameraMeasurements();
   }
 
-  const Size2u image_size = rig_->at(cam_idx).size();
-  const auto lm_W = landmarks_W_.middleCols(lm_min_idx, num_landmarks);
-  const auto lm_C = (T_W_B * rig_->T_B_C(cam_idx)).inverse().transformVectorized(lm_W);
-  Keypoints px = rig_->at(cam_idx).projectVectorized(lm_C);
-  std::vector<uint32_t> visible_indices;
-  for (uint32_t i = 0u; i < num_landmarks; ++i)
-  {
-    if (lm_C(2,i) < options_.min_depth_m ||
-        lm_C(2,i) > options_.max_depth_m)
-    {
-      // Landmark is either behind or too far from the camera.
-      continue;
-    }
+  const Transformation T_C_W = (T_W_B * rig_->T_B_C(cam_idx)).inverse();
+  return measurementsFromVisibility(
+        computeCameraVisibility(
+          rig_->at(cam_idx), T_C_W,
+          landmarks_W_.middleCols(lm_min_idx, num_landmarks),
+          visibilityOptions()));
+}
 
-    if (isVisible(image_size, px.col(i)))
-    {
-      visible_indices.push_back(i);
-    }
-  }
+// -----------------------------------------------------------------------------
+VisibilityOptions CameraSimulator::visibilityOptions() const
+{
+  VisibilityOptions options;
+  options.min_depth = options_.min_depth_m;
+  options.max_depth = options_.max_depth_m;
+  return options;
+}
 
+// -----------------------------------------------------------------------------
+CameraMeasurements CameraSimulator::measurementsFromVisibility(
+    const CameraVisibility& vis)
+{
   // Copy visible indices into Camera Measurements struct:
+  const std::vector<uint32_t> visible_indices = vis.visibleIndices();
   CameraMeasurements m;
   m.keypoints_.resize(Eigen::NoChange, visible_indices.size());
   m.global_landmark_ids_.resize(visible_indices.size());
   for (size_t i = 0; i < visible_indices.size(); ++i)
   {
-    m.keypoints_.col(i) = px.col(visible_indices[i]);
+    m.keypoints_.col(i) = vis.px.col(visible_indices[i]);
     m.global_landmark_ids_[i] = visible_indices[i];
   }
 
@@ -144,9 +146,16 @@ CameraMeasurementsVector CameraSimulator::getMeasurements(real_t time)
   std::unordered_map<int32_t, int32_t> new_global_lm_id_to_track_id_map;
   CameraMeasurementsVector measurements;
 
+  RigVisibility visibility;
+  {
+    auto t = timer_[SimTimer::visible_landmarks].timeScope();
+    visibility = computeRigVisibility(
+          *rig_, T_W_B, landmarks_W_, visibilityOptions());
+  }
+
   for (uint32_t cam_idx = 0u; cam_idx < rig_->size(); ++cam_idx)
   {
-    CameraMeasurements m = visibleLandmarks(cam_idx, T_W_B, 0u, landmarks_W_.cols());
+    CameraMeasurements m = measurementsFromVisibility(visibility[cam_idx]);
     m.local_track_ids_.resize(m.keypoints_.cols());
     for (int32_t i = 0; i < m.keypoints_.cols(); ++i)
     {
@@ -184,8 +193,11 @@ CameraMeasurementsVector CameraSimulator::getMeasurementsCorrupted(real_t time)
   CameraMeasurementsVector measurements = getMeasurements(time);
   for (CameraMeasurements& m : measurements)
   {
-    m.keypoints_ += randomMatrixNormalDistributed(2, m.keypoints_.cols(), false,
-                                                  0.0, options_.keypoint_noise_sigma);
+    std::normal_distribution<real_t> noise(0.0, options_.keypoint_noise_sigma);
+    for (int i = 0; i < m.keypoints_.size(); ++i)
+    {
+      m.keypoints_(i) += noise(generator_);
+    }
   }
   return measurements;
 }
@@ -36,7 +36,8 @@ ContinuousBiasSimulator::ContinuousBiasSimulator(
     size_t samples,
     size_t spline_order,
     size_t spline_segments,
-    size_t spline_smoothing_lambda)
+    size_t spline_smoothing_lambda,
+    int64_t random_seed)
   : gyr_bias_noise_density_(gyr_bias_noise_density)
   , acc_bias_noise_density_(acc_bias_noise_density)
   , start_(start_time)
@@ -52,18 +53,22 @@ ContinuousBiasSimulator::ContinuousBiasSimulator(
     // this is usually a good setting
     spline_segments_ = samples / 2;
   }
+
+  // merge acc and bias noise
+  Vector6 noise;
+  noise.head<3>() = acc_bias_noise_density_;
+  noise.tail<3>() = gyr_bias_noise_density_;
+  sampler_ = RandomVectorSampler<6>::sigmas(noise);
+  if (random_seed >= 0)
+  {
+    sampler_->setSeed(static_cast<uint32_t>(random_seed));
+  }
   initialize();
 }
 
 //------------------------------------------------------------------------------
 void ContinuousBiasSimulator::initialize()
 {
-  Vector6 noise;
-  noise.head<3>() = acc_bias_noise_density_;
-  noise.tail<3>() = gyr_bias_noise_density_;
-  // merge acc and bias noise
-  RandomVectorSampler<6>::Ptr sampler = RandomVectorSampler<6>::sigmas(noise);
-
   // sampling interval
   real_t dt = (end_ - start_) / samples_;
   real_t dt_sqrt = sqrt(dt);
@@ -78,7 +83,7 @@ void ContinuousBiasSimulator::initialize()
   {
     times(i) = start_ + dt * i;
     points.col(i) = points.col(i-1) +
-        dt_sqrt * sampler->sample();
+        dt_sqrt * sampler_->sample();
   }
 
   // initialize spline
@@ -25,6 +25,10 @@
 
 #include <ze/vi_simulation/vi_simulator.hpp>
 
+#include <algorithm>
+#include <array>
+#include <random>
+
 #include <ze/cameras/camera_rig.hpp>
 #include <ze/common/test_utils.hpp>
 #include <ze/common/csv_trajectory.hpp>
@@ -47,14 +51,28 @@ ViSimulator::ViSimulator(
     const real_t acc_noise_sigma,
     const uint32_t cam_framerate_hz,
     const uint32_t imu_bandwidth_hz,
-    const real_t gravity_magnitude)
+    const real_t gravity_magnitude,
+    const int64_t random_seed)
   : trajectory_(trajectory)
+  , rig_(camera_rig)
   , cam_dt_ns_(secToNanosec(1.0 / cam_framerate_hz))
   , imu_dt_ns_(secToNanosec(1.0 / imu_bandwidth_hz))
   , last_sample_stamp_ns_(secToNanosec(trajectory->start()))
 {
   CHECK(imu_bandwidth_hz % cam_framerate_hz == 0);
 
+  // One seed per random source: bias, accelerometer, gyroscope and camera.
+  std::array<int64_t, 4> seeds;
+  seeds.fill(-1);
+  if (random_seed >= 0)
+  {
+    std::seed_seq seq { static_cast<uint32_t>(random_seed),
+                        static_cast<uint32_t>(random_seed >> 32) };
+    std::array<uint32_t, 4> values;
+    seq.generate(values.begin(), values.end());
+    std::copy(values.begin(), values.end(), seeds.begin());
+  }
+
   ImuBiasSimulator::Ptr bias;
   try
   {
@@ -64,7 +82,8 @@ ViSimulator::ViSimulator(
              Vector3::Constant(acc_bias_noise_sigma),
              trajectory->start(),
              trajectory->end(),
-             100); // Results in malloc: (trajectory->end() - trajectory->start()) * imu_bandwidth_hz);
+             100, // Results in malloc: (trajectory->end() - trajectory->start()) * imu_bandwidth_hz);
+             3, 0, 1e-5, seeds[0]);
     VLOG(1) << "done.";
   }
   catch (const std::bad_alloc& e)
@@ -74,20 +93,34 @@ ViSimulator::ViSimulator(
   }
 
   VLOG(1) << "Initialize IMU ...";
+  RandomVectorSampler<3>::Ptr acc_noise =
+      RandomVectorSampler<3>::sigmas(Vector3::Constant(acc_noise_sigma));
+  RandomVectorSampler<3>::Ptr gyr_noise =
+      RandomVectorSampler<3>::sigmas(Vector3::Constant(gyr_noise_sigma));
+  if (random_seed >= 0)
+  {
+    acc_noise->setSeed(static_cast<uint32_t>(seeds[1]));
+    gyr_noise->setSeed(static_cast<uint32_t>(seeds[2]));
+  }
   imu_ = std::make_shared<ImuSimulator>(
            trajectory,
            bias,
-           RandomVectorSampler<3>::sigmas(Vector3::Constant(acc_noise_sigma)),
-           RandomVectorSampler<3>::sigmas(Vector3::Constant(gyr_noise_sigma)),
+           acc_noise,
+           gyr_noise,
            imu_bandwidth_hz,
            imu_bandwidth_hz,
            gravity_magnitude);
   VLOG(1) << "done.";
 
+  CameraSimulatorOptions camera_options = camera_sim_options;
+  if (random_seed >= 0)
+  {
+    camera_options.random_seed = seeds[3];
+  }
   camera_ = std::make_shared<CameraSimulator>(
               trajectory,
               camera_rig,
-              camera_sim_options);
+              camera_options);
 }
 
 // -----------------------------------------------------------------------------
@@ -166,7 +199,7 @@ void ViSimulator::visualize(
 }
 
 // -----------------------------------------------------------------------------
-ViSimulator::Ptr createViSimulationScenario1()
+ViSimulator::Ptr createViSimulationScenario1(int64_t random_seed)
 {
   // Create trajectory:
   PoseSeries pose_series;
@@ -194,9 +227,25 @@ ViSimulator::Ptr createViSimulationScenario1()
   cam_sim_options.max_depth_m = 10.0;
   cam_sim_options.max_num_landmarks_ = 20000;
   ViSimulator::Ptr vi_sim =
-      std::make_shared<ViSimulator>(trajectory, rig, cam_sim_options);
+      std::make_shared<ViSimulator>(trajectory, rig, cam_sim_options,
+                                    0.0000266, 0.000433, 0.000186, 0.00186,
+                                    20, 200, 9.81, random_seed);
   vi_sim->initialize();
   return vi_sim;
 }
 
+// -----------------------------------------------------------------------------
+ViSimulator::Ptr createViSimulationScenario(uint32_t scenario,
+                                            int64_t random_seed)
+{
+  switch (scenario)
+  {
+    case 1:
+      return createViSimulationScenario1(random_seed);
+    default:
+      LOG(FATAL) << "Unknown simulation scenario " << scenario << ".";
+  }
+  return nullptr;
+}
+
 } // namespace ze